@@ -15,6 +15,16 @@ namespace nova::renderer::rhi {
     struct Renderpass;
     struct ResourceBarrier;
 
+    /*!
+     * \brief How many commands a command list dropped because they would have bound what was already bound
+     */
+    struct EliminatedCommandCounts {
+        uint32_t pipeline_binds = 0;
+        uint32_t descriptor_set_binds = 0;
+        uint32_t vertex_buffer_binds = 0;
+        uint32_t index_buffer_binds = 0;
+    };
+
     /*!
      * \brief An API-agnostic command list
      *
@@ -126,6 +136,45 @@ namespace nova::renderer::rhi {
          */
         virtual void draw_indexed_mesh(uint32_t num_indices, uint32_t num_instances) = 0;
 
+        /*!
+         * \brief Records rendering instances of a mesh which lives somewhere in the middle of the current vertex and index buffers
+         *
+         * \param num_indices The number of indices to read from the current index buffer
+         * \param num_instances The number of instances of the current mesh to render
+         * \param first_index The index of the first index to read from the current index buffer
+         * \param vertex_offset A value to add to every index before reading from the vertex buffers
+         * \param first_instance The instance index of the first instance. Shaders see it in `gl_InstanceIndex`, so instances can find their
+         * data in per-instance buffers
+         */
+        virtual void draw_indexed_mesh(
+            uint32_t num_indices, uint32_t num_instances, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) = 0;
+
+        /*!
+         * \brief Records indexed draws whose arguments are read from a buffer when the draws execute
+         *
+         * \param buffer The buffer to read the arguments from. It must have been created with `BufferUsage::IndirectBuffer`
+         * \param offset The offset in the buffer of the first draw's arguments. Measured in bytes
+         * \param num_draws How many draws to record. Each draw's arguments are an `IndexedIndirectDrawCommand`, packed one after
+         * another
+         */
+        virtual void draw_indexed_indirect(const Buffer* buffer, uint64_t offset, uint32_t num_draws) = 0;
+
+        /*!
+         * \brief Records running the currently bound compute pipeline
+         *
+         * \param num_groups_x The number of work groups to run in the X dimension
+         * \param num_groups_y The number of work groups to run in the Y dimension
+         * \param num_groups_z The number of work groups to run in the Z dimension
+         */
+        virtual void dispatch(uint32_t num_groups_x, uint32_t num_groups_y, uint32_t num_groups_z) = 0;
+
+        /*!
+         * \brief Counts the binds that this command list didn't record because the same thing was already bound
+         *
+         * Command lists that don't filter redundant binds always return zeroes
+         */
+        [[nodiscard]] virtual EliminatedCommandCounts get_eliminated_command_counts() const { return {}; }
+
         virtual ~CommandList() = default;
     };
 } // namespace nova::renderer::rhi
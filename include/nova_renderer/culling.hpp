@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "nova_renderer/renderables.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief An axis-aligned bounding box
+     */
+    struct Aabb {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    /*!
+     * \brief A list of AABBs, stored as one array per component so that they can be tested several at a time
+     *
+     * Every array has padding at the end so that SIMD loads of the last few boxes don't read past the end
+     */
+    class AabbList {
+    public:
+        void push_back(const Aabb& aabb);
+
+        void set(uint32_t index, const Aabb& aabb);
+
+        [[nodiscard]] Aabb get(uint32_t index) const;
+
+        /*!
+         * \brief Moves the last AABB into `index`, then removes the last AABB
+         */
+        void swap_remove(uint32_t index);
+
+        void clear();
+
+        [[nodiscard]] uint32_t size() const;
+
+        std::vector<float> min_x;
+        std::vector<float> min_y;
+        std::vector<float> min_z;
+        std::vector<float> max_x;
+        std::vector<float> max_y;
+        std::vector<float> max_z;
+
+    private:
+        uint32_t num_aabbs = 0;
+
+        void resize_arrays();
+    };
+
+    /*!
+     * \brief The six planes of a view frustum, pointing inwards
+     *
+     * Each plane is stored as (a, b, c, d), where a point p is on the inside of the plane if `dot(p, abc) + d >= 0`
+     */
+    struct Frustum {
+        std::array<glm::vec4, 6> planes;
+    };
+
+    /*!
+     * \brief Extracts the frustum planes from a view-projection matrix, using the Vulkan/D3D depth range of [0, 1]
+     */
+    [[nodiscard]] Frustum make_frustum(const glm::mat4& view_projection);
+
+    /*!
+     * \brief A frustum that contains everything, for when there's no camera to cull against
+     */
+    [[nodiscard]] Frustum make_infinite_frustum();
+
+    /*!
+     * \brief Computes the bounding box of some vertices. Returns an empty box at the origin if there's no vertices
+     */
+    [[nodiscard]] Aabb compute_bounds(const FullVertex* vertices, size_t num_vertices);
+
+    /*!
+     * \brief Computes the smallest box that contains both boxes
+     */
+    [[nodiscard]] Aabb merge_aabbs(const Aabb& a, const Aabb& b);
+
+    /*!
+     * \brief Computes the world-space bounds of a box that's transformed by a matrix
+     */
+    [[nodiscard]] Aabb transform_aabb(const Aabb& aabb, const glm::mat4& transform);
+
+    /*!
+     * \brief Picks which level of detail renderables are drawn with, from how large they are on the screen
+     *
+     * A default-constructed selector always picks the most detailed LOD
+     */
+    struct LodSelector {
+        /*!
+         * \brief The row of the view-projection matrix that gives a point's clip-space W, which is its distance along the view direction
+         */
+        glm::vec4 depth_row = glm::vec4(0, 0, 0, 1);
+
+        /*!
+         * \brief How much the projection scales vertical distances, or zero to disable LOD selection
+         */
+        float screen_scale = 0;
+
+        /*!
+         * \brief How far past a LOD's threshold a renderable's size has to be before the renderable switches LODs, as a fraction of
+         * the threshold
+         *
+         * Renderables that sit right at a threshold would otherwise flicker between two LODs as the camera moves
+         */
+        float hysteresis = 0;
+
+        /*!
+         * \brief How much of the screen's height the box's bounding sphere covers. Boxes around the camera are infinitely large
+         */
+        [[nodiscard]] float get_screen_size(const Aabb& bounds) const;
+
+        /*!
+         * \brief Picks the LOD for a renderable with the given size on screen, which drew with `current_lod` last frame
+         */
+        [[nodiscard]] uint32_t select_lod(float screen_size, uint32_t current_lod, const MeshLod* lods, uint32_t num_lods) const;
+    };
+
+    /*!
+     * \brief Makes a LOD selector for a camera with a perspective projection
+     */
+    [[nodiscard]] LodSelector make_lod_selector(const glm::mat4& view_projection, float hysteresis);
+
+    /*!
+     * \brief Tests a range of AABBs against a frustum, writing the indices of the visible AABBs to `visible_indices`
+     *
+     * AABBs are tested four or eight at a time, depending on what SIMD instructions are available. AABBs that intersect the frustum are
+     * considered visible. The test is conservative: a few boxes just outside of a corner of the frustum may be reported as visible
+     *
+     * \param frustum The frustum to cull against
+     * \param aabbs The AABBs to cull
+     * \param begin Index of the first AABB to test
+     * \param end One past the index of the last AABB to test
+     * \param enabled One byte per AABB. AABBs with a byte of zero are never visible. May be nullptr, in which case every AABB is enabled
+     * \param visible_indices Where to write the indices of the visible AABBs. Must have space for `end - begin` indices
+     *
+     * \return The number of visible AABBs
+     */
+    uint32_t cull_aabbs(const Frustum& frustum,
+                        const AabbList& aabbs,
+                        uint32_t begin,
+                        uint32_t end,
+                        const uint8_t* enabled,
+                        uint32_t* visible_indices);
+
+    /*!
+     * \brief Does the same thing as `cull_aabbs`, one AABB at a time
+     */
+    uint32_t cull_aabbs_scalar(const Frustum& frustum,
+                               const AabbList& aabbs,
+                               uint32_t begin,
+                               uint32_t end,
+                               const uint8_t* enabled,
+                               uint32_t* visible_indices);
+} // namespace nova::renderer
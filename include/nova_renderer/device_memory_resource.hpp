@@ -26,6 +26,11 @@ namespace nova::renderer {
 
         [[nodiscard]] DeviceMemoryAllocation allocate(bvestl::polyalloc::Bytes size) const;
 
+        /*!
+         * \brief Gives an allocation from `allocate` back to the allocation strategy
+         */
+        void free(const DeviceMemoryAllocation& allocation) const;
+
         bvestl::polyalloc::AllocationStrategy* allocation_strategy;
 
         rhi::DeviceMemory* memory;
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <array>
+#include <limits>
 #include <memory>
 #include <string>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
+#include "nova_renderer/culling.hpp"
 #include "nova_renderer/device_memory_resource.hpp"
 #include "nova_renderer/nova_settings.hpp"
 #include "nova_renderer/polyalloc.hpp"
@@ -14,21 +18,63 @@
 #include "../../src/render_engine/configuration.hpp"
 #include "renderables.hpp"
 
-namespace spirv_cross {
-    class CompilerGLSL;
-    struct Resource;
-} // namespace spirv_cross
+namespace nova::ttl {
+    class condition_counter;
+    class task_scheduler;
+} // namespace nova::ttl
 
 namespace nova::renderer {
     namespace rhi {
         class Swapchain;
     }
 
+    namespace shaderpack {
+        class ShaderCache;
+        class ShaderOptimizer;
+        class ShaderpackDependencies;
+        class ShaderpackWatcher;
+    } // namespace shaderpack
+
+    class GeometryArena;
+    class GpuCulling;
+    class MeshUploadManager;
+    class RenderableRegistry;
+    class SpatialIndex;
+    class TransformHierarchy;
+    struct RenderableLocation;
+
+    /*!
+     * \brief The resource name that material passes bind the model matrix buffer with
+     *
+     * The buffer is an array of mat4s, and each instance's model matrix is at `gl_InstanceIndex`
+     */
+    constexpr const char* MODEL_MATRIX_BUFFER_NAME = "NovaModelMatrices";
+
+    /*!
+     * \brief The resource name that material passes bind the instance data buffer with
+     *
+     * The buffer is an array of `InstanceData`, laid out with std430 rules. Each instance's data is at `gl_InstanceIndex`, just like its
+     * model matrix
+     */
+    constexpr const char* INSTANCE_DATA_BUFFER_NAME = "NovaInstanceData";
+
 #pragma region Runtime optimized data
-    template <typename RenderableType>
+    /*!
+     * \brief All the renderables that draw the same mesh with the same material pass
+     *
+     * The renderables are stored as parallel arrays, so each loop over them only touches the data it needs. Removing a renderable moves the
+     * batch's last renderable into its place, so the arrays never have holes
+     */
     struct MeshBatch {
-        rhi::Buffer* vertex_buffer = nullptr;
-        rhi::Buffer* index_buffer = nullptr;
+        /*!
+         * \brief How many renderables are culled together as one task
+         */
+        static constexpr uint32_t CULLING_CHUNK_SIZE = 1024;
+
+        /*!
+         * \brief The mesh that all the renderables in this batch draw
+         */
+        MeshId mesh = 0;
 
         /*!
          * \brief A buffer to hold all the per-draw data
@@ -40,13 +86,93 @@ namespace nova::renderer {
          */
         rhi::Buffer* per_renderable_data = nullptr;
 
-        std::vector<RenderableType> renderables;
+        std::vector<RenderableId> renderable_ids;
+
+        /*!
+         * \brief How many of this batch's renderables are static
+         *
+         * The static renderables are kept at the start of the batch's arrays. They're culled through the renderer's spatial index,
+         * rather than one chunk at a time like the dynamic renderables after them
+         */
+        uint32_t num_static = 0;
+
+        /*!
+         * \brief The indirect draw that GPU culling writes this batch's visible static renderables to, if GPU culling is enabled and the
+         * batch has ever had a static renderable
+         */
+        uint32_t gpu_draw = std::numeric_limits<uint32_t>::max();
+
+        std::vector<glm::mat4> model_matrices;
+
+        /*!
+         * \brief The transform that positions each renderable. The transform hierarchy writes its world matrix to `model_matrices`
+         * whenever it changes
+         */
+        std::vector<TransformId> transforms;
+
+        /*!
+         * \brief Each renderable's per-instance data. It's only copied to the GPU if the batch's pipeline reads it
+         */
+        std::vector<InstanceData> instance_data;
+
+        /*!
+         * \brief Whether each renderable should be drawn. Bytes rather than bools so that the vector isn't bit-packed
+         */
+        std::vector<uint8_t> visibilities;
+
+        /*!
+         * \brief The LOD that each renderable was last drawn with, so that LOD changes can have hysteresis
+         */
+        std::vector<uint8_t> lods;
+
+        /*!
+         * \brief The world-space bounds of each renderable, for frustum culling
+         */
+        AabbList world_bounds;
+
+        /*!
+         * \brief Indices of the renderables that survived culling this frame
+         *
+         * The first `num_visible_static` entries are the visible static renderables. After them, each culling chunk of dynamic
+         * renderables writes to its own part of this array, starting at `num_static + chunk_index * CULLING_CHUNK_SIZE`. Only the first
+         * `num_visible_per_chunk[chunk_index]` entries of each part are valid
+         */
+        std::vector<uint32_t> visible_indices;
+
+        /*!
+         * \brief The model matrices of the renderables that survived culling this frame, in the same layout as `visible_indices`
+         */
+        std::vector<glm::mat4> visible_model_matrices;
+
+        uint32_t num_visible_static = 0;
+
+        std::vector<uint32_t> num_visible_per_chunk;
+
+        /*!
+         * \brief How many of each group's visible renderables are drawn with each LOD
+         *
+         * Group 0 is the visible static renderables, and group `chunk_index + 1` is the visible dynamic renderables of that chunk. Each
+         * group's entries in `visible_indices` and `visible_model_matrices` are ordered by LOD, so each LOD of a group is written with a
+         * single copy
+         */
+        std::vector<std::array<uint32_t, MAX_MESH_LODS>> visible_lod_counts;
+
+        /*!
+         * \brief Space to order visible renderables by LOD in, with the same layout as `visible_indices`
+         */
+        std::vector<uint32_t> lod_sort_scratch;
     };
 
     struct MaterialPass {
         // Descriptors for the material pass
 
-        std::vector<MeshBatch<StaticMeshRenderCommand>> static_mesh_draws;
+        std::vector<MeshBatch> static_mesh_draws;
+
+        /*!
+         * \brief Index of each mesh's batch in `static_mesh_draws`
+         */
+        std::unordered_map<MeshId, uint32_t> static_mesh_batch_indices;
+
         std::vector<rhi::DescriptorSet*> descriptor_sets;
         const rhi::PipelineInterface* pipeline_interface = nullptr;
     };
@@ -54,6 +180,16 @@ namespace nova::renderer {
     struct Pipeline {
         rhi::Pipeline* pipeline = nullptr;
 
+        /*!
+         * \brief Which queue this pipeline's draws are sorted into
+         */
+        shaderpack::RenderQueueEnum render_queue = shaderpack::RenderQueueEnum::Opaque;
+
+        /*!
+         * \brief Whether this pipeline's vertex fields include any per-instance fields, so its draws have to write instance data
+         */
+        bool reads_instance_data = false;
+
         std::vector<MaterialPass> passes;
     };
 
@@ -71,11 +207,60 @@ namespace nova::renderer {
         std::vector<rhi::ResourceBarrier> write_texture_barriers;
     };
 
+    /*!
+     * \brief A mesh that lives in the geometry arena
+     */
     struct Mesh {
-        rhi::Buffer* vertex_buffer = nullptr;
-        rhi::Buffer* index_buffer = nullptr;
+        /*!
+         * \brief The geometry arena page that this mesh's vertices and indices live in
+         */
+        uint32_t page = 0;
+
+        bvestl::polyalloc::AllocationInfo vertex_allocation;
+        bvestl::polyalloc::AllocationInfo index_allocation;
+
+        /*!
+         * \brief The index of this mesh's first vertex in its page's vertex buffer. Added to every index of this mesh when drawing
+         */
+        int32_t vertex_offset = 0;
+
+        /*!
+         * \brief The index of this mesh's first index in its page's index buffer
+         */
+        uint32_t first_index = 0;
+
+        uint32_t num_vertices = 0;
 
         uint32_t num_indices = 0;
+
+        /*!
+         * \brief The mesh's levels of detail. If this is empty, the mesh has a single LOD that draws all of its indices
+         */
+        std::vector<MeshLod> lods;
+
+        /*!
+         * \brief The bounds of the mesh's vertices
+         *
+         * Updates to part of a mesh only ever grow its bounds, so they may be a bit loose for meshes that have been partially updated
+         */
+        Aabb bounds;
+
+        /*!
+         * \brief Whether this mesh's data has been uploaded to the GPU. Meshes are not drawn until it has
+         */
+        bool is_ready = false;
+
+        /*!
+         * \brief Whether this mesh's initial data is still being optimized. Its data is uploaded once the optimizations are done
+         */
+        bool is_optimizing = false;
+
+        /*!
+         * \brief Whether this mesh's vertices and indices have been reordered by the mesh optimizations
+         *
+         * The caller's vertex and index numbers don't match the mesh's data after that, so the mesh can only be replaced as a whole
+         */
+        bool is_optimized = false;
     };
 #pragma endregion
 
@@ -101,15 +286,47 @@ namespace nova::renderer {
         shaderpack::MaterialPass data;
     };
 
+    /*!
+     * \brief Whether a pipeline variant's shaders have been compiled yet
+     */
+    enum class PipelineVariantStateEnum {
+        /*!
+         * \brief The pipeline draws with its own shaders
+         */
+        Compiled,
+
+        /*!
+         * \brief Nothing has been drawn with the variant yet, so it draws with its fallback pipeline
+         */
+        NotCompiled,
+
+        /*!
+         * \brief The variant's shaders are being compiled in the background. It draws with its fallback pipeline until they're done
+         */
+        Compiling,
+    };
+
     struct PipelineMetadata {
         shaderpack::PipelineCreateInfo data;
 
+        /*!
+         * \brief The index of the pipeline in its renderpass's pipelines
+         */
+        uint32_t pipeline_index = 0;
+
+        PipelineVariantStateEnum variant_state = PipelineVariantStateEnum::Compiled;
+
         std::unordered_map<FullMaterialPassName, MaterialPassMetadata, FullMaterialPassNameHasher> material_metadatas{};
     };
 
     struct RenderpassMetadata {
         shaderpack::RenderPassCreateInfo data;
 
+        /*!
+         * \brief The textures that the renderpass's framebuffer was created with, color attachments first and then the depth attachment
+         */
+        std::vector<rhi::Image*> attachments;
+
         std::unordered_map<std::string, PipelineMetadata> pipeline_metadata{};
     };
 #pragma endregion
@@ -168,24 +385,113 @@ namespace nova::renderer {
         void set_num_meshes(uint32_t num_meshes);
 
         /*!
-         * \brief Creates a new mesh and uploads its data to the GPU, returning the ID of the newly created mesh
+         * \brief Creates a new mesh and queues its data for upload to the GPU, returning the ID of the newly created mesh
+         *
+         * The mesh's data is uploaded asynchronously, with all the other meshes created this frame. The mesh will be drawn starting with
+         * the first frame whose uploads include it
          *
-         * \param mesh_data The mesh's initial data
+         * If any of the mesh optimizations in `NovaSettings::mesh_optimization` are enabled, they run on a worker thread first, and the
+         * mesh is uploaded with the first frame after they finish. The optimizations reorder the mesh's vertices and indices, so an
+         * optimized mesh can't be partially updated with `update_mesh`
+         *
+         * \param mesh_data The mesh's initial data. Nova copies this data, so you may free it as soon as this method returns
          */
         [[nodiscard]] MeshId create_mesh(const MeshData& mesh_data);
 
+        /*!
+         * \brief Replaces part of a mesh's data
+         *
+         * If the mesh's new data fits in the mesh's current memory, only the updated ranges are uploaded. Otherwise the mesh moves to a
+         * larger range of the geometry arena, and its old range is freed once no in-flight frame can be using it. Either way the mesh
+         * keeps its ID, so renderables that use the mesh don't need to change
+         *
+         * Like `create_mesh`, the new data is uploaded asynchronously. The mesh isn't drawn until its new data is on the GPU, which is
+         * usually the next frame
+         *
+         * Meshes that were optimized when they were created can only be updated as a whole, since their vertices and indices are no
+         * longer where the caller put them. A full update replaces the optimized data with the caller's data, which isn't optimized
+         *
+         * \param mesh_id The mesh to update
+         * \param mesh_data The new vertices and indices for the range being updated
+         * \param range Where in the mesh the new data goes, and how large the mesh is afterwards
+         */
+        void update_mesh(MeshId mesh_id, const MeshData& mesh_data, const MeshUpdateRange& range = {});
+
         /*!
          * \brief Destroys the mesh with the provided ID, freeing up whatever VRAM it was using
          *
-         * In debug builds, this method checks that no renderables are using the mesh
+         * Meshes that renderables are still using aren't destroyed. Remove the renderables first
          *
          * \param mesh_to_destroy The handle of the mesh you want to destroy
          */
         void destroy_mesh(MeshId mesh_to_destroy);
 #pragma endregion
 
+#pragma region Renderables
+        /*!
+         * \brief Adds a renderable that draws a mesh with a material pass
+         *
+         * \return The ID of the new renderable, or `std::numeric_limits<RenderableId>::max()` if the material pass or mesh doesn't exist
+         */
         RenderableId add_renderable_for_material(const FullMaterialPassName& material_name, const StaticMeshRenderableData& renderable);
 
+        /*!
+         * \brief Changes a renderable's mesh, transform, and instance data
+         *
+         * Takes constant time. Changing the mesh moves the renderable to the mesh's batch within the same material pass. The new
+         * transform takes effect at the start of the next frame, when the transform hierarchy is updated
+         */
+        void update_renderable(RenderableId renderable, const StaticMeshRenderableUpdateData& update_data);
+
+        /*!
+         * \brief Shows or hides a renderable. Hidden renderables keep all their data, they just aren't drawn
+         *
+         * Takes constant time
+         */
+        void set_visibility(RenderableId renderable, bool is_visible);
+
+        /*!
+         * \brief Removes a renderable, so that it's never drawn again and its ID becomes invalid
+         *
+         * Takes constant time
+         */
+        void remove_renderable(RenderableId renderable);
+
+        /*!
+         * \brief The transform that positions a renderable, so that other renderables and transforms can be attached to it
+         *
+         * \return The renderable's transform, or NO_TRANSFORM if the renderable doesn't exist
+         */
+        [[nodiscard]] TransformId get_renderable_transform(RenderableId renderable);
+
+        /*!
+         * \brief Creates a transform that doesn't draw anything, but that renderables and other transforms can be attached to
+         *
+         * \return The new transform's ID, or NO_TRANSFORM if its parent doesn't exist
+         */
+        [[nodiscard]] TransformId create_transform(const TransformData& transform);
+
+        /*!
+         * \brief Changes a transform created with `create_transform`. Everything attached to it moves along with it at the start of the
+         * next frame
+         */
+        void update_transform(TransformId transform, const TransformData& data);
+
+        /*!
+         * \brief Destroys a transform created with `create_transform`. Everything attached to it is attached to its parent instead
+         */
+        void destroy_transform(TransformId transform);
+
+        /*!
+         * \brief Sets the camera that renderables are frustum culled against
+         *
+         * Until this is called, no renderables are culled
+         *
+         * \param view_projection The camera's view-projection matrix, with a depth range of [0, 1]
+         */
+        void set_culling_camera(const glm::mat4& view_projection);
+#pragma endregion
+
         [[nodiscard]] rhi::RenderEngine* get_engine() const;
 
         static NovaRenderer* initialize(const NovaSettings& settings);
@@ -218,6 +524,7 @@ namespace nova::renderer {
 
         std::unique_ptr<DeviceMemoryResource> ubo_memory;
         std::unique_ptr<DeviceMemoryResource> staging_buffer_memory;
+        std::unique_ptr<DeviceMemoryResource> gpu_culling_memory;
         void* staging_buffer_memory_ptr;
 
 #pragma region Initialization
@@ -236,6 +543,11 @@ namespace nova::renderer {
         void create_global_sync_objects();
 
         void create_uniform_buffers();
+
+        /*!
+         * \brief Creates the GPU culling pass, if it's enabled and the render engine supports it
+         */
+        void create_gpu_culling();
 #pragma endregion
 
 #pragma region Shaderpack
@@ -245,6 +557,112 @@ namespace nova::renderer {
 
         std::mutex shaderpack_loading_mutex;
 
+        /*!
+         * \brief Compiled shaders from previous shaderpack loads, or nullptr if the shader cache is disabled
+         */
+        std::unique_ptr<shaderpack::ShaderCache> shader_cache;
+
+        /*!
+         * \brief Optimizes newly compiled shaders, or nullptr if every shader optimization is disabled
+         */
+        std::unique_ptr<shaderpack::ShaderOptimizer> shader_optimizer;
+
+        /*!
+         * \brief An API pipeline and the interface that it was created with
+         */
+        struct CachedPipeline {
+            rhi::PipelineInterface* pipeline_interface = nullptr;
+
+            rhi::Pipeline* pipeline = nullptr;
+        };
+
+        /*!
+         * \brief The API pipelines of the current shaderpack, by the key of everything that they were created from
+         *
+         * When a shaderpack is loaded, pipelines whose create info, SPIR-V, and pass attachments haven't changed reuse their API pipeline
+         * from the last load. Only the pipelines that changed are created again
+         */
+        std::unordered_map<std::string, CachedPipeline> pipeline_cache;
+
+        /*!
+         * \brief The name of the loaded shaderpack, as it was passed to `load_shaderpack`
+         */
+        std::string loaded_shaderpack_name;
+
+        /*!
+         * \brief Which files each pipeline of the loaded shaderpack was loaded from
+         */
+        std::unique_ptr<shaderpack::ShaderpackDependencies> shaderpack_dependencies;
+
+        /*!
+         * \brief Watches the loaded shaderpack's files, or nullptr if shaderpacks aren't reloaded when they change
+         */
+        std::unique_ptr<shaderpack::ShaderpackWatcher> shaderpack_watcher;
+
+        /*!
+         * \brief Reloads whatever the changes to the loaded shaderpack's files since the last frame affect
+         *
+         * When only pipelines and their shaders changed, just those pipelines are reloaded and swapped into the render graph. Anything
+         * else reloads the whole shaderpack
+         */
+        void reload_changed_shaderpack_files();
+
+        /*!
+         * \brief Reloads the given pipelines and swaps them into the render graph
+         *
+         * \return False if the pipelines can't be swapped in on their own, and the whole shaderpack has to be reloaded
+         */
+        [[nodiscard]] bool reload_pipelines(const std::vector<fs::path>& pipeline_files);
+
+        /*!
+         * \brief Replaces the API pipeline of the pipeline with the same name. The pipeline's material passes keep their descriptor sets
+         *
+         * \return False if the pipeline can't be replaced without recreating its material passes
+         */
+        [[nodiscard]] bool swap_in_pipeline(const shaderpack::PipelineCreateInfo& pipeline_create_info);
+
+        /*!
+         * \brief Incremented every time a shaderpack is loaded, so that variants compiled for an old shaderpack can be thrown away
+         */
+        uint32_t shaderpack_generation = 0;
+
+        /*!
+         * \brief The descriptor pool that the material passes of the loaded shaderpack allocate their descriptor sets from
+         */
+        rhi::DescriptorPool* material_descriptor_pool = nullptr;
+
+        /*!
+         * \brief The threads that compile pipeline variants when they're first used
+         *
+         * These are separate from the culling threads, so that compiling a variant can't hold up a frame's culling
+         */
+        std::unique_ptr<ttl::task_scheduler> pipeline_variant_scheduler;
+
+        std::unique_ptr<ttl::condition_counter> pipeline_variant_tasks;
+
+        std::mutex compiled_pipeline_variants_mutex;
+
+        /*!
+         * \brief Variants that the pipeline variant threads have compiled, and the shaderpack generation they were compiled for
+         */
+        std::vector<std::pair<uint32_t, shaderpack::PipelineCreateInfo>> compiled_pipeline_variants;
+
+        /*!
+         * \brief Starts compiling the pipeline variant that a material pass uses, if it hasn't been compiled yet
+         */
+        void compile_pipeline_variant_for(const MaterialPassKey& key);
+
+        /*!
+         * \brief Swaps the variants that the pipeline variant threads have compiled in for their fallback pipelines
+         */
+        void swap_in_compiled_pipeline_variants();
+
+        /*!
+         * \brief Replaces a variant's fallback API pipeline with the variant's own. Material passes whose descriptor sets don't fit the
+         * variant get new descriptor sets
+         */
+        void swap_in_pipeline_variant(const shaderpack::PipelineCreateInfo& pipeline_create_info);
+
         /*!
          * \brief The renderpasses in the shaderpack, in submission order
          *
@@ -259,11 +677,41 @@ namespace nova::renderer {
         std::unordered_map<std::string, rhi::Image*> dynamic_textures;
         std::unordered_map<std::string, shaderpack::TextureCreateInfo> dynamic_texture_infos;
 
-        void create_dynamic_textures(const std::vector<shaderpack::TextureCreateInfo>& texture_create_infos);
+        /*!
+         * \brief The API objects of a renderpass from the previous shaderpack, which the new shaderpack can reuse
+         */
+        struct OldRenderpass {
+            rhi::Renderpass* renderpass = nullptr;
+
+            rhi::Framebuffer* framebuffer = nullptr;
 
-        void create_render_passes(const std::vector<shaderpack::RenderPassCreateInfo>& pass_create_infos,
-                                  const std::vector<shaderpack::PipelineCreateInfo>& pipelines,
-                                  const std::vector<shaderpack::MaterialData>& materials);
+            shaderpack::RenderPassCreateInfo data;
+
+            std::vector<rhi::Image*> attachments;
+        };
+
+        /*!
+         * \brief Makes the dynamic textures match the new shaderpack's textures
+         *
+         * Textures that have the same format as before are kept, so the renderpasses that use them can be kept too. Every other texture
+         * from the previous shaderpack is destroyed once the frames in flight have finished
+         *
+         * \return The number of textures that were kept
+         */
+        uint32_t update_dynamic_textures(const std::vector<shaderpack::TextureCreateInfo>& texture_create_infos);
+
+        /*!
+         * \brief Creates the render graph
+         *
+         * \param old_renderpasses The API objects of the previous shaderpack's renderpasses. A renderpass with the same name, attachments,
+         * and attachment textures as one of these uses its API renderpass and framebuffer, and the rest are destroyed
+         *
+         * \return The number of renderpasses that reused an old renderpass
+         */
+        uint32_t create_render_passes(const std::vector<shaderpack::RenderPassCreateInfo>& pass_create_infos,
+                                      const std::vector<shaderpack::PipelineCreateInfo>& pipelines,
+                                      const std::vector<shaderpack::MaterialData>& materials,
+                                      std::unordered_map<std::string, OldRenderpass> old_renderpasses);
 
         void create_materials_for_pipeline(
             Pipeline& pipeline,
@@ -277,9 +725,8 @@ namespace nova::renderer {
         /*!
          * \brief Binds the resources for one material to that material's descriptor sets
          *
-         * This method does not perform any validation. It assumes that descriptor_descriptions has a description for
-         * every descriptor that the material wants to bind to, and it assumes that material has all the needed
-         * descriptors
+         * This method does not perform much validation. Descriptors that descriptor_descriptions doesn't describe are skipped, and it
+         * assumes that material has all the needed descriptor sets
          *
          * \param material The material to bind resources to
          * \param bindings What resources should be bound to what descriptor. The key is the descriptor name and the
@@ -297,28 +744,213 @@ namespace nova::renderer {
             const std::vector<shaderpack::TextureAttachmentInfo>& color_attachments,
             const std::optional<shaderpack::TextureAttachmentInfo>& depth_texture) const;
 
-        [[nodiscard]] ntl::Result<PipelineReturn> create_graphics_pipeline(
-            rhi::PipelineInterface* pipeline_interface, const shaderpack::PipelineCreateInfo& pipeline_create_info) const;
+        /*!
+         * \brief Finds the pipeline in the pipeline cache, or creates it and adds it to the cache if it isn't there
+         */
+        [[nodiscard]] ntl::Result<CachedPipeline> get_or_create_pipeline(const shaderpack::PipelineCreateInfo& pipeline_create_info,
+                                                                          const shaderpack::RenderPassCreateInfo& pass_create_info);
+
+        [[nodiscard]] static PipelineReturn create_graphics_pipeline(rhi::Pipeline* rhi_pipeline,
+                                                                     const shaderpack::PipelineCreateInfo& pipeline_create_info);
 
-        static void get_shader_module_descriptors(const std::vector<uint32_t>& spirv,
+        /*!
+         * \brief Adds the resources from a shader's reflection record to the bindings of its pipeline
+         */
+        static void get_shader_module_descriptors(const shaderpack::ShaderReflection& reflection,
                                                   rhi::ShaderStageFlags shader_stage,
                                                   std::unordered_map<std::string, rhi::ResourceBindingDescription>& bindings);
 
         static void add_resource_to_bindings(std::unordered_map<std::string, rhi::ResourceBindingDescription>& bindings,
                                              rhi::ShaderStageFlags shader_stage,
-                                             const spirv_cross::CompilerGLSL& shader_compiler,
-                                             const spirv_cross::Resource& resource,
-                                             rhi::DescriptorType type);
+                                             const shaderpack::ShaderResourceReflection& resource);
 
-        void destroy_render_passes();
+        /*!
+         * \brief Destroys the render graph, but not the API renderpasses and framebuffers, so that the next shaderpack can reuse them
+         *
+         * \return The API objects of each renderpass, by the renderpass's name
+         */
+        [[nodiscard]] std::unordered_map<std::string, OldRenderpass> destroy_render_passes();
 
-        void destroy_dynamic_resources();
+        /*!
+         * \brief Destroys the pipelines in the pipeline cache that no renderpass uses
+         */
+        void destroy_unused_pipelines();
 #pragma endregion
 
 #pragma region Meshes
+        /*!
+         * \brief All the vertex and index data for all of Nova's meshes
+         */
+        std::unique_ptr<GeometryArena> geometry_arena;
+
+        /*!
+         * \brief Stages mesh data and uploads it to the geometry arena
+         */
+        std::unique_ptr<MeshUploadManager> mesh_upload_manager;
+
         MeshId next_mesh_id = 0;
 
         std::unordered_map<MeshId, Mesh> meshes;
+
+        /*!
+         * \brief Geometry arena ranges that meshes have moved out of, but that pending copies still read from
+         *
+         * They're retired in the frame that flushes the mesh's copies
+         */
+        std::unordered_map<MeshId, std::vector<Mesh>> mesh_ranges_waiting_for_copies;
+
+        /*!
+         * \brief Frees the mesh's geometry arena ranges once no in-flight frame can be using them
+         */
+        void retire_mesh_range(const Mesh& mesh);
+
+        /*!
+         * \brief The threads that optimize new meshes
+         *
+         * These are separate from the culling threads, so that optimizing a large mesh can't hold up a frame's culling
+         */
+        std::unique_ptr<ttl::task_scheduler> mesh_optimization_scheduler;
+
+        std::unique_ptr<ttl::condition_counter> mesh_optimization_tasks;
+
+        std::mutex optimized_meshes_mutex;
+
+        /*!
+         * \brief Meshes that the mesh optimization threads have finished with, which are waiting to be uploaded
+         */
+        std::vector<std::pair<MeshId, MeshData>> optimized_meshes;
+
+        /*!
+         * \brief Queues the uploads of a mesh's data to its geometry arena ranges
+         */
+        [[nodiscard]] bool enqueue_mesh_upload(MeshId mesh_id, const Mesh& mesh, const MeshData& mesh_data);
+
+        /*!
+         * \brief Queues the uploads of every mesh that the mesh optimization threads have finished with
+         */
+        void upload_optimized_meshes();
+#pragma endregion
+
+#pragma region Renderables
+        /*!
+         * \brief Where each renderable's data lives in the render graph
+         */
+        std::unique_ptr<RenderableRegistry> renderable_registry;
+
+        /*!
+         * \brief Every renderable's transform, and every transform that renderables can be attached to
+         */
+        std::unique_ptr<TransformHierarchy> transforms;
+
+        /*!
+         * \brief Recomputes the world matrices of the transforms that changed since the last frame, and moves the renderables that they
+         * position
+         */
+        void update_transforms();
+
+        [[nodiscard]] MaterialPass& get_material_pass(const MaterialPassKey& key);
+
+        /*!
+         * \brief Finds the batch for the mesh in the material pass, creating it if needed, and returns its index
+         */
+        static uint32_t get_or_create_mesh_batch(MaterialPass& material_pass, MeshId mesh);
+
+        /*!
+         * \brief Adds a renderable to a batch, returning the renderable's location
+         *
+         * Dynamic renderables go at the end of the batch, and static renderables go at the end of the batch's static renderables
+         */
+        RenderableLocation add_to_mesh_batch(const MaterialPassKey& key,
+                                             MeshId mesh,
+                                             RenderableId id,
+                                             TransformId transform,
+                                             const glm::mat4& model_matrix,
+                                             const InstanceData& instance_data,
+                                             bool is_visible,
+                                             bool is_static);
+
+        /*!
+         * \brief Swap-removes a renderable from its batch, updating the locations of the renderables that move
+         */
+        void remove_from_mesh_batch(const RenderableLocation& location);
+
+        /*!
+         * \brief Swaps two renderables in a batch, updating both of their locations
+         */
+        void swap_in_mesh_batch(MeshBatch& batch, uint32_t first_index, uint32_t second_index);
+
+        /*!
+         * \brief Recomputes the world-space bounds of every renderable that uses the mesh, after the mesh's bounds changed
+         */
+        void update_world_bounds_for_mesh(MeshId mesh);
+#pragma endregion
+
+#pragma region Culling
+        /*!
+         * \brief The threads that cull renderables
+         */
+        std::unique_ptr<ttl::task_scheduler> culling_scheduler;
+
+        /*!
+         * \brief The world-space bounds of every static renderable, so that culling them only touches the ones that are visible
+         */
+        std::unique_ptr<SpatialIndex> static_renderable_index;
+
+        /*!
+         * \brief Scratch space for the static renderables that the spatial index finds each frame
+         */
+        std::vector<RenderableId> visible_static_renderables;
+
+        /*!
+         * \brief Culls static renderables on the GPU, if it's enabled and supported. When this is null, static renderables are culled
+         * with the spatial index
+         */
+        std::unique_ptr<GpuCulling> gpu_culling;
+
+        /*!
+         * \brief The static renderables that GPU culling didn't have room for, which are culled with the spatial index instead
+         */
+        std::unordered_set<RenderableId> cpu_culled_static_renderables;
+
+        /*!
+         * \brief Gives the batch an indirect draw for GPU culling, if it doesn't already have one
+         */
+        void create_gpu_draw_for_batch(MeshBatch& batch);
+
+        /*!
+         * \brief Adds a static renderable to GPU culling, or culls it on the CPU if GPU culling is full
+         */
+        void add_to_gpu_culling(RenderableId renderable, MeshBatch& batch, uint32_t index_in_batch);
+
+        Frustum culling_frustum = make_infinite_frustum();
+
+        LodSelector lod_selector;
+
+        /*!
+         * \brief The culling camera's view-projection matrix, which draws are depth sorted with
+         */
+        glm::mat4 culling_view_projection = glm::mat4(1);
+
+        /*!
+         * \brief Frustum culls every mesh batch that will be drawn this frame, filling in the batches' visible lists
+         *
+         * Static renderables are found with a query of the spatial index, unless they're culled on the GPU. Dynamic renderables are split
+         * into chunks of `MeshBatch::CULLING_CHUNK_SIZE` renderables, and each chunk is culled on one of the culling scheduler's threads
+         */
+        void cull_renderables();
+
+        static void cull_mesh_batch_chunk(
+            const Frustum& frustum, const LodSelector& selector, const Mesh& mesh, MeshBatch& batch, uint32_t chunk_index);
+
+        /*!
+         * \brief Picks the LOD of each of a group of visible renderables, and orders the group's visible indices by LOD
+         *
+         * \param group The group's index in `MeshBatch::visible_lod_counts`
+         * \param group_start The index of the group's first entry in `MeshBatch::visible_indices`
+         * \param num_visible How many visible renderables the group has
+         */
+        static void sort_visible_renderables_by_lod(
+            const LodSelector& selector, const Mesh& mesh, MeshBatch& batch, uint32_t group, uint32_t group_start, uint32_t num_visible);
 #pragma endregion
 
 #pragma region Rendering
@@ -329,18 +961,100 @@ namespace nova::renderer {
         rhi::Buffer* model_matrix_buffer;
         uint32_t cur_model_matrix_index = 0;
 
+        /*!
+         * \brief Per-instance data, at the same index as each instance's model matrix
+         */
+        rhi::Buffer* instance_data_buffer;
+
+        /*!
+         * \brief Space to gather the instance data of a draw's visible renderables in, before it's written to `instance_data_buffer`
+         */
+        std::vector<InstanceData> instance_data_scratch;
+
+        /*!
+         * \brief The geometry arena page whose buffers are bound to the command list being recorded
+         */
+        uint32_t cur_bound_geometry_page = 0;
+
         std::array<rhi::Fence*, NUM_IN_FLIGHT_FRAMES> frame_fences;
 
         std::vector<RenderpassMetadata> renderpass_metadatas;
         std::unordered_map<FullMaterialPassName, MaterialPassKey, FullMaterialPassNameHasher> material_pass_keys;
 
+        /*!
+         * \brief One draw key for each mesh batch in the renderpass being recorded that has something to draw, sorted into the order
+         * they're recorded in
+         */
+        std::vector<uint64_t> draw_keys;
+
+        std::vector<uint64_t> draw_key_scratch;
+
+        /*!
+         * \brief A draw whose mesh batch index is too large to fit in a draw key
+         */
+        struct UnsortedDraw {
+            uint32_t pipeline;
+            uint32_t material_pass;
+            uint32_t mesh_batch;
+        };
+
+        /*!
+         * \brief The draws in the renderpass being recorded that couldn't be sorted. They're recorded after the sorted draws, in the order
+         * of their batches
+         */
+        std::vector<UnsortedDraw> unsorted_draws;
+
         void record_renderpass(Renderpass& renderpass, rhi::CommandList* cmds);
 
-        void record_pipeline(Pipeline& pipeline, rhi::CommandList* cmds);
+        /*!
+         * \brief Fills `draw_keys` with the renderpass's draws, and sorts them. Draws that don't fit in a draw key go in `unsorted_draws`
+         */
+        void sort_draws(const Renderpass& renderpass);
+
+        /*!
+         * \brief Records the draws in `draw_keys`, then the draws in `unsorted_draws`
+         */
+        void record_sorted_draws(Renderpass& renderpass, rhi::CommandList* cmds);
+
+        /*!
+         * \brief Checks if recording the batch would draw anything this frame
+         */
+        [[nodiscard]] bool has_draws(const MeshBatch& batch) const;
 
-        void record_material_pass(MaterialPass& pass, rhi::CommandList* cmds);
+        /*!
+         * \brief The depth of the batch's visible renderable that's nearest to the camera, or furthest from it if `use_furthest` is true
+         *
+         * Only renderables that were culled on the CPU are considered. Batches whose renderables are all culled on the GPU have a depth of
+         * zero
+         */
+        [[nodiscard]] float get_batch_depth(const MeshBatch& batch, bool use_furthest) const;
 
-        void record_rendering_static_mesh_batch(MeshBatch<StaticMeshRenderCommand>& batch, rhi::CommandList* cmds);
+        /*!
+         * \brief Records one instanced draw for each LOD of the batch's visible renderables
+         *
+         * Each draw's instances get consecutive model matrices, and the draw's first instance is the index of the first one, so shaders
+         * find their model matrix and instance data at `gl_InstanceIndex`
+         *
+         * \param needs_instance_data Whether to write the renderables' instance data too, because the pipeline reads it
+         */
+        void record_rendering_static_mesh_batch(MeshBatch& batch, bool needs_instance_data, rhi::CommandList* cmds);
+
+        /*!
+         * \brief Writes model matrices to the next free part of the model matrix buffer
+         *
+         * \return False if the buffer ran out of space, in which case only the matrices that fit were written
+         */
+        bool write_model_matrices(const glm::mat4* model_matrices, uint32_t num_model_matrices);
+
+        /*!
+         * \brief Writes the instance data of some of a batch's visible renderables to the instance data buffer
+         *
+         * \param batch The batch whose renderables to write
+         * \param first_visible The index in `batch.visible_indices` of the first renderable to write
+         * \param num_instances How many renderables to write
+         * \param first_instance Where in the instance data buffer to write the first renderable's data
+         */
+        void write_instance_data(const MeshBatch& batch, uint32_t first_visible, uint32_t num_instances, uint32_t first_instance);
 #pragma endregion
     };
 } // namespace nova::renderer
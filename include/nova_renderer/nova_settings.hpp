@@ -222,6 +222,132 @@ namespace nova::renderer {
          * \brief Settings for how Nova should allocate index memory
          */
         BlockAllocatorSettings index_memory_settings;
+
+        /*!
+         * \brief The size, in bytes, of the ring buffer that mesh data is staged in before it's copied to the GPU
+         *
+         * Staging memory is reclaimed once the frame that uploaded it has finished executing, so this should be large enough to hold all
+         * the mesh data you create in `max_in_flight_frames` frames. Uploads that don't fit wait in system memory until there's space
+         */
+        uint32_t mesh_staging_buffer_size = 32 * 1024 * 1024;
+
+        /*!
+         * \brief Whether to frustum cull static renderables in a compute shader, and draw them with indirect draws
+         *
+         * This only has an effect if the render engine supports compute shaders and indirect draws. Otherwise, static renderables are
+         * culled on the CPU
+         *
+         * Off by default, since the culling compute shader hasn't been run on a Vulkan implementation yet
+         */
+        bool use_gpu_culling = false;
+
+        /*!
+         * \brief How far past a LOD's screen size threshold a renderable has to be before it switches to another LOD, as a fraction of the
+         * threshold
+         *
+         * Larger values make LOD changes less frequent, at the cost of drawing renderables at a less appropriate LOD for a bit longer
+         */
+        float lod_hysteresis = 0.1F;
+
+        /*!
+         * \brief Optimizations that `NovaRenderer::create_mesh` runs over new meshes before uploading them
+         *
+         * The optimizations run on a worker thread, so they don't block the thread that creates meshes, but each mesh is uploaded a frame
+         * or so later than it would be otherwise. They assume that every mesh is a triangle list, so leave them off if you draw meshes with
+         * any other topology
+         */
+        struct MeshOptimizationOptions {
+            /*!
+             * \brief Reorder triangles so that the GPU transforms each vertex as few times as possible
+             */
+            bool optimize_vertex_cache = false;
+
+            /*!
+             * \brief Reorder clusters of triangles so that the triangles most likely to be in front are drawn first
+             */
+            bool optimize_overdraw = false;
+
+            /*!
+             * \brief How much worse the vertex cache may get so that triangles can be reordered for less overdraw, as a multiple of the
+             * number of vertices transformed without overdraw optimization
+             */
+            float overdraw_threshold = 1.05F;
+
+            /*!
+             * \brief Reorder vertices into the order that the triangles use them
+             */
+            bool optimize_vertex_fetch = false;
+        } mesh_optimization;
+
+        /*!
+         * \brief Options for the cache of compiled shaders
+         *
+         * Compiling GLSL and HLSL to SPIR-V is most of the time that it takes to load a shaderpack. Nova saves the SPIR-V of every shader
+         * it compiles, and loads it the next time the same shader is loaded with the same defines
+         */
+        struct ShaderCacheOptions {
+            /*!
+             * \brief Whether to load shaders from the cache and save newly compiled shaders to it
+             */
+            bool enabled = true;
+
+            /*!
+             * \brief The folder to keep compiled shaders in. Delete it to clear the cache
+             */
+            const char* folder = "cache/shaders";
+        } shader_cache;
+
+        /*!
+         * \brief Options for optimizing the SPIR-V that Nova compiles shaders to
+         *
+         * Optimized SPIR-V is quicker for drivers to turn into pipelines, takes less space in the shader cache, and can run faster on
+         * drivers that don't optimize much themselves. Both options are on in release builds and off in debug builds, so that shaders
+         * are easy to read in graphics debuggers while Nova is being developed
+         */
+        struct ShaderOptimizationOptions {
+#ifdef NDEBUG
+            /*!
+             * \brief Whether to run SPIRV-Tools' performance passes, the same ones that `spirv-opt -O` runs, over every compiled shader
+             */
+            bool optimize_for_performance = true;
+
+            /*!
+             * \brief Whether to remove variable names, source text, and line numbers from every compiled shader
+             */
+            bool strip_debug_info = true;
+#else
+            bool optimize_for_performance = false;
+
+            bool strip_debug_info = false;
+#endif
+        } shader_optimization;
+
+        /*!
+         * \brief Options for the driver's cache of compiled pipelines
+         *
+         * Drivers compile every pipeline's shaders to GPU code when the pipeline is created. The Vulkan render engine saves the driver's
+         * compiled pipelines when it shuts down, and gives them back to the driver when it starts up, so that creating the same
+         * pipelines again is quick
+         */
+        struct PipelineCacheOptions {
+            /*!
+             * \brief Whether to load the driver's pipeline cache at startup and save it at shutdown
+             */
+            bool enabled = true;
+
+            /*!
+             * \brief The folder to keep the driver's pipeline cache in. Each GPU has its own file, so switching GPUs doesn't clear it
+             */
+            const char* folder = "cache/pipelines";
+        } pipeline_cache;
+
+        /*!
+         * \brief Whether to watch the loaded shaderpack's files, and reload whatever they affect when they change
+         *
+         * When only a pipeline or its shaders change, just that pipeline is reloaded, at the start of the next frame. Changes to any other
+         * file reload the whole shaderpack. Shaderpacks in zip files aren't watched
+         */
+        bool reload_shaderpack_on_change = false;
     };
 
     class NovaSettingsAccessManager { // Classes named Manager are an antipattern so yes
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <functional>
 #include <memory>
 
 #include "nova_renderer/command_list.hpp"
@@ -12,6 +14,8 @@
 
 #include "rhi_types.hpp"
 
+#include "../../src/render_engine/configuration.hpp"
+
 namespace nova::renderer::rhi {
     struct Fence;
     struct Image;
@@ -84,7 +88,8 @@ namespace nova::renderer::rhi {
 
         [[nodiscard]] virtual DescriptorPool* create_descriptor_pool(uint32_t num_sampled_images,
                                                                      uint32_t num_samplers,
-                                                                     uint32_t num_uniform_buffers) = 0;
+                                                                     uint32_t num_uniform_buffers,
+                                                                     uint32_t num_storage_buffers = 0) = 0;
 
         [[nodiscard]] virtual std::vector<DescriptorSet*> create_descriptor_sets(const PipelineInterface* pipeline_interface,
                                                                                  DescriptorPool* pool) = 0;
@@ -94,6 +99,31 @@ namespace nova::renderer::rhi {
         [[nodiscard]] virtual ntl::Result<Pipeline*> create_pipeline(PipelineInterface* pipeline_interface,
                                                                      const shaderpack::PipelineCreateInfo& data) = 0;
 
+#pragma region Compute
+        /*!
+         * \brief Whether this render engine can run compute pipelines and draw from indirect buffers
+         *
+         * Indirect draws must be able to start at any instance, since GPU-driven rendering uses the first instance to find each draw's
+         * per-instance data
+         */
+        [[nodiscard]] virtual bool supports_gpu_driven_rendering() const = 0;
+
+        /*!
+         * \brief Creates the interface for a compute pipeline. Compute pipelines have no attachments, only resource bindings
+         */
+        [[nodiscard]] virtual ntl::Result<PipelineInterface*> create_compute_pipeline_interface(
+            const std::unordered_map<std::string, ResourceBindingDescription>& bindings) = 0;
+
+        /*!
+         * \brief Creates a compute pipeline from the SPIR-V of a compute shader
+         *
+         * Compute pipelines are bound with `CommandList::bind_pipeline`, and their descriptor sets with
+         * `CommandList::bind_descriptor_sets`, just like graphics pipelines
+         */
+        [[nodiscard]] virtual ntl::Result<Pipeline*> create_compute_pipeline(PipelineInterface* pipeline_interface,
+                                                                             const shaderpack::ShaderSource& compute_shader) = 0;
+#pragma endregion
+
         /*!
          * \brief Creates a buffer with undefined contents
          */
@@ -147,6 +177,13 @@ namespace nova::renderer::rhi {
 
         virtual void reset_fences(const std::vector<Fence*>& fences) = 0;
 
+        /*!
+         * \brief Clean up any GPU objects a Buffer may own
+         *
+         * The buffer's device memory is not returned to the memory resource it came from
+         */
+        virtual void destroy_buffer(Buffer* buffer) = 0;
+
         /*!
          * \brief Clean up any GPU objects a Renderpass may own
          *
@@ -171,6 +208,11 @@ namespace nova::renderer::rhi {
          */
         virtual void destroy_pipeline_interface(PipelineInterface* pipeline_interface) = 0;
 
+        /*!
+         * \brief Clean up a DescriptorPool, along with every descriptor set that was allocated from it
+         */
+        virtual void destroy_descriptor_pool(DescriptorPool* pool) = 0;
+
         /*!
          * \brief Clean up any GPU objects a Pipeline may own
          *
@@ -203,6 +245,47 @@ namespace nova::renderer::rhi {
          */
         virtual void destroy_fences(std::vector<Fence*>& fences) = 0;
 
+#pragma region Deferred destruction
+        /*!
+         * \brief Tells the render engine that a new frame has started, and destroys everything that was waiting for the last frame with
+         * this index to finish
+         *
+         * Call this at the start of every frame, after waiting for the fence of the last frame with the same index
+         *
+         * \param frame_idx The index of the frame that's starting
+         */
+        void begin_frame(uint32_t frame_idx);
+
+        /*!
+         * \brief Runs the provided function once the GPU has finished the current frame
+         *
+         * Frames that were submitted earlier finish before the current frame does, so this is the right time to destroy anything that any
+         * submitted frame might use. Destroyed objects must not be used by any frame recorded after this call
+         */
+        void defer_destruction(std::function<void()> destroy_func);
+
+        void destroy_buffer_deferred(Buffer* buffer);
+
+        void destroy_renderpass_deferred(Renderpass* pass);
+
+        void destroy_framebuffer_deferred(Framebuffer* framebuffer);
+
+        void destroy_pipeline_interface_deferred(PipelineInterface* pipeline_interface);
+
+        void destroy_descriptor_pool_deferred(DescriptorPool* pool);
+
+        void destroy_pipeline_deferred(Pipeline* pipeline);
+
+        void destroy_texture_deferred(Image* resource);
+
+        /*!
+         * \brief Destroys everything that's waiting on a frame to finish, right now
+         *
+         * Only call this when the GPU is idle, such as when shutting down
+         */
+        void flush_deferred_destructions();
+#pragma endregion
+
         [[nodiscard]] Swapchain* get_swapchain() const;
 
         /*!
@@ -264,5 +347,13 @@ namespace nova::renderer::rhi {
             void* mem = shaderpack_allocator.allocate(sizeof(AllocType));
             return new(mem) AllocType(std::forward<ArgTypes>(args)...);
         }
+
+    private:
+        uint32_t cur_frame_idx = 0;
+
+        /*!
+         * \brief Everything that's waiting on each in-flight frame to finish before it can be destroyed
+         */
+        std::array<std::vector<std::function<void()>>, NUM_IN_FLIGHT_FRAMES> deferred_destructions;
     };
 } // namespace nova::renderer::rhi
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <atomic>
+#include <limits>
+#include <string>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -17,6 +19,32 @@ namespace nova::renderer {
 
     static_assert(sizeof(FullVertex) % 16 == 0, "full_vertex struct is not aligned to 16 bytes!");
 
+    /*!
+     * \brief The maximum number of levels of detail that a mesh may have
+     */
+    constexpr uint32_t MAX_MESH_LODS = 8;
+
+    /*!
+     * \brief One level of detail of a mesh, drawn with a range of the mesh's indices
+     *
+     * Every LOD of a mesh shares the mesh's vertices, so a lower-detail LOD is just a shorter list of indices into the same vertices
+     */
+    struct MeshLod {
+        /*!
+         * \brief The first of this LOD's indices, in the mesh's indices
+         */
+        uint32_t first_index = 0;
+
+        uint32_t num_indices = 0;
+
+        /*!
+         * \brief The smallest size on screen that this LOD is drawn at, as a fraction of the screen's height
+         *
+         * When a renderable is smaller than this, the next LOD is drawn instead. The last LOD is drawn no matter how small it is
+         */
+        float min_screen_size = 0;
+    };
+
     /*!
      * \brief All the data needed to make a single mesh
      *
@@ -27,39 +55,117 @@ namespace nova::renderer {
     struct MeshData {
         std::vector<FullVertex> vertex_data;
         std::vector<uint32_t> indices;
+
+        /*!
+         * \brief The mesh's levels of detail, from the most detailed to the least detailed, with decreasing `min_screen_size`s
+         *
+         * If this is empty, the mesh has one LOD that draws all of its indices. When updating a mesh, leaving this empty keeps the mesh's
+         * current LODs
+         */
+        std::vector<MeshLod> lods;
     };
 
     using MeshId = uint64_t;
 
-    struct StaticMeshRenderableUpdateData {
-        MeshId mesh;
+    /*!
+     * \brief Which part of a mesh an update rewrites
+     *
+     * The update's vertices replace the mesh's vertices starting at `first_vertex`, and its indices replace the mesh's indices starting
+     * at `first_index`. Indices are relative to the mesh's first vertex, just like in `MeshData`. Everything in the mesh outside the
+     * updated ranges is kept, up to the mesh's new size
+     *
+     * The default range replaces the whole mesh
+     */
+    struct MeshUpdateRange {
+        uint32_t first_vertex = 0;
+        uint32_t first_index = 0;
+
+        /*!
+         * \brief How many vertices the mesh has after the update, or 0 to end the mesh at the end of the updated vertices
+         */
+        uint32_t num_vertices = 0;
+
+        /*!
+         * \brief How many indices the mesh has after the update, or 0 to end the mesh at the end of the updated indices
+         */
+        uint32_t num_indices = 0;
     };
 
-    struct StaticMeshRenderableData : StaticMeshRenderableUpdateData {
-        glm::vec3 initial_position = {};
-        glm::vec3 initial_rotation = {};
-        glm::vec3 initial_scale = glm::vec3(1);
-
-        bool is_static = true;
+    /*!
+     * \brief Per-instance data that shaders can read, in addition to the model matrix
+     *
+     * Shaderpacks ask for these fields with the `Instance` vertex fields, and read them from the `NovaInstanceData` storage buffer at
+     * `gl_InstanceIndex`. This is laid out the same way as the buffer's std430 struct
+     */
+    struct InstanceData {
+        glm::vec4 tint = glm::vec4(1);
+        float animation_frame = 0;
+        float light_level = 1;
+
+        /*!
+         * \brief Data for the host application to use however it likes
+         */
+        glm::uvec2 custom_data = {};
     };
 
-    using RenderableId = uint64_t;
+    static_assert(sizeof(InstanceData) == 32, "InstanceData must match the std430 layout of NovaInstanceData");
 
-    static std::atomic<RenderableId> next_renderable_id;
+    /*!
+     * \brief Handle to a transform in the transform hierarchy
+     *
+     * Like renderable handles, handles of removed transforms are never valid again
+     */
+    using TransformId = uint64_t;
 
-    struct RenderableMetadata {
-        RenderableId id = 0;
+    /*!
+     * \brief A transform ID that no transform will ever have, for transforms that don't have a parent
+     */
+    constexpr TransformId NO_TRANSFORM = std::numeric_limits<TransformId>::max();
 
-        std::vector<std::string> passes;
+    /*!
+     * \brief A transform relative to its parent
+     */
+    struct TransformData {
+        glm::vec3 position = {};
+
+        /*!
+         * \brief Rotation around the X, Y, and Z axes, in radians. The rotations are applied in that order
+         */
+        glm::vec3 rotation = {};
+
+        glm::vec3 scale = glm::vec3(1);
+
+        /*!
+         * \brief The transform that this one is relative to, or NO_TRANSFORM if it's relative to the world
+         */
+        TransformId parent = NO_TRANSFORM;
     };
 
-    struct RenderableBase {
-        RenderableId id = 0;
+    /*!
+     * \brief Everything about a static mesh renderable that may be changed after it's created
+     *
+     * The renderable's transform is relative to its parent. Renderables that move every frame can be attached to a parent transform, and
+     * move along with it
+     */
+    struct StaticMeshRenderableUpdateData : TransformData {
+        MeshId mesh;
 
-        bool is_visible = true;
+        InstanceData instance_data = {};
+    };
 
-        glm::mat4 model_matrix = glm::mat4(1);
+    struct StaticMeshRenderableData : StaticMeshRenderableUpdateData {
+        /*!
+         * \brief Whether the renderable rarely moves
+         *
+         * Static renderables are kept in a spatial index, which makes culling them cheap but moving them a bit more expensive
+         */
+        bool is_static = true;
     };
 
-    struct StaticMeshRenderCommand : RenderableBase {};
+    /*!
+     * \brief Handle to a renderable
+     *
+     * Handles of removed renderables are never reused, so using one is an error that Nova can detect
+     */
+    using RenderableId = uint64_t;
 } // namespace nova::renderer
@@ -126,6 +126,16 @@ namespace nova::renderer::rhi {
         IndexBuffer,
         VertexBuffer,
         StagingBuffer,
+
+        /*!
+         * \brief A buffer that shaders may read and write
+         */
+        StorageBuffer,
+
+        /*!
+         * \brief A storage buffer that can also hold the arguments of indirect draws
+         */
+        IndirectBuffer,
     };
 
     enum class ResourceType {
@@ -152,11 +152,37 @@ namespace nova::renderer::rhi {
         Sampler* sampler;
     };
 
+    struct DescriptorBufferUpdate {
+        const Buffer* buffer;
+        uint64_t offset = 0;
+
+        /*!
+         * \brief The number of bytes of the buffer to bind, or 0 to bind everything after `offset`
+         */
+        uint64_t size = 0;
+    };
+
     struct DescriptorSetWrite {
         const DescriptorSet* set;
         uint32_t binding;
         DescriptorImageUpdate* image_info;
         DescriptorType type;
+
+        /*!
+         * \brief The buffer to bind, for uniform and storage buffer descriptors
+         */
+        const DescriptorBufferUpdate* buffer_info = nullptr;
+    };
+
+    /*!
+     * \brief The arguments of one indexed draw, laid out the way every API reads them from an indirect buffer
+     */
+    struct IndexedIndirectDrawCommand {
+        uint32_t num_indices;
+        uint32_t num_instances;
+        uint32_t first_index;
+        int32_t vertex_offset;
+        uint32_t first_instance;
     };
 #pragma endregion
 
@@ -156,6 +156,38 @@ namespace nova::renderer::shaderpack {
          * 12 bytes
          */
         McEntityId,
+
+        /*!
+         * \brief The tint color of the instance being drawn
+         *
+         * This and the other `Instance` fields are per-instance, not per-vertex. Nova doesn't bind them as vertex
+         * attributes, it writes them to the `NovaInstanceData` storage buffer, which shaders index with
+         * `gl_InstanceIndex`. Nova only writes instance data for pipelines that ask for at least one of these fields
+         *
+         * 16 bytes
+         */
+        InstanceTint,
+
+        /*!
+         * \brief The animation frame of the instance being drawn, for meshes that animate in their shaders
+         *
+         * 4 bytes
+         */
+        InstanceAnimationFrame,
+
+        /*!
+         * \brief The light level of the instance being drawn
+         *
+         * 4 bytes
+         */
+        InstanceLightLevel,
+
+        /*!
+         * \brief Two uints that the host application can use however it likes
+         *
+         * 8 bytes
+         */
+        InstanceCustomData,
     };
 
     /*!
@@ -242,9 +274,64 @@ namespace nova::renderer::shaderpack {
         uint32_t write_mask;
     };
 
+    enum class ShaderResourceTypeEnum : uint32_t {
+        SampledImage,
+        UniformBuffer,
+        StorageBuffer,
+    };
+
+    /*!
+     * \brief A descriptor that a shader reads from or writes to
+     */
+    struct ShaderResourceReflection {
+        std::string name;
+        uint32_t set = 0;
+        uint32_t binding = 0;
+
+        /*!
+         * \brief How many descriptors are in the binding. This is more than one for arrays of textures or buffers
+         */
+        uint32_t count = 1;
+
+        ShaderResourceTypeEnum type{};
+    };
+
+    /*!
+     * \brief A vertex attribute, a varying, or a fragment shader output
+     */
+    struct ShaderVariableReflection {
+        std::string name;
+        uint32_t location = 0;
+    };
+
+    /*!
+     * \brief Everything that Nova needs to know about a shader's interface, read from its SPIR-V once when the shader is loaded
+     *
+     * The pipeline interface and the backends use this instead of parsing the SPIR-V again. It's saved in the shader cache next to the
+     * SPIR-V, so shaders that come from the cache don't have to be parsed at all
+     */
+    struct ShaderReflection {
+        std::vector<ShaderResourceReflection> resources;
+
+        /*!
+         * \brief The size of the shader's push constant block in bytes, or 0 if the shader doesn't have any push constants
+         */
+        uint32_t push_constants_size = 0;
+
+        std::vector<ShaderVariableReflection> inputs;
+        std::vector<ShaderVariableReflection> outputs;
+    };
+
     struct ShaderSource {
         fs::path filename;
         std::vector<uint32_t> source;
+
+        ShaderReflection reflection;
+
+        /*!
+         * \brief Every file that the shader `#include`s, directly or through other files, relative to the shaderpack's root
+         */
+        std::vector<fs::path> includes;
     };
 
     struct VertexFieldData {
@@ -252,6 +339,20 @@ namespace nova::renderer::shaderpack {
         VertexFieldEnum field{};
     };
 
+    /*!
+     * \brief A feature that a pipeline can be compiled with in different ways, like fog or the quality of shadows
+     *
+     * Each variant of the pipeline has one of the permutation's values. The variant's shaders are compiled with `#define <name> <value>`
+     */
+    struct PipelinePermutation {
+        std::string name;
+
+        /*!
+         * \brief The values that the permutation can have. The first one is the default
+         */
+        std::vector<std::string> values;
+    };
+
     /*!
      * \brief All the data that Nova uses to build a pipeline
      */
@@ -276,6 +377,22 @@ namespace nova::renderer::shaderpack {
          */
         std::vector<std::string> defines{};
 
+        /*!
+         * \brief The features that this pipeline has variants for
+         *
+         * The pipeline itself is the variant where every permutation has its default value. Other variants are only made if a material
+         * asks for them
+         */
+        std::vector<PipelinePermutation> permutations{};
+
+        /*!
+         * \brief Whether this pipeline is a variant whose shaders are compiled the first time something is drawn with it, instead of when
+         * the shaderpack is loaded
+         *
+         * Until its shaders are compiled, the variant is drawn with its fallback
+         */
+        bool compile_on_first_use = false;
+
         /*!
          * \brief Defines the rasterizer state that's active for this pipeline
          */
@@ -379,10 +496,37 @@ namespace nova::renderer::shaderpack {
 
         /*!
          * \brief Merges this pipeline with the parent, returning the merged pipeline
+         *
+         * Everything that this pipeline doesn't set is taken from the parent. The parent's defines come before this pipeline's. Numbers
+         * and enums that still have their default values count as not set
          */
         [[nodiscard]] PipelineCreateInfo merge_with_parent(const PipelineCreateInfo& parent_pipeline) const;
     };
 
+    /*!
+     * \brief Gets the name of the variant of a pipeline with the given permutation values
+     *
+     * The variant with every permutation's default value is the pipeline itself, so it has the pipeline's name. Other variants have the
+     * values that aren't the defaults after the pipeline's name, like `gbuffers_terrain[FOG=1,SHADOWS=2]`
+     *
+     * \param pipeline The pipeline, as it was loaded from its file
+     * \param permutation The value of each permutation. Permutations that aren't in here have their default values
+     */
+    [[nodiscard]] std::string get_pipeline_variant_name(const PipelineCreateInfo& pipeline,
+                                                        const std::unordered_map<std::string, std::string>& permutation);
+
+    /*!
+     * \brief Makes the variant of a pipeline with the given permutation values, without compiling its shaders
+     *
+     * The variant is the pipeline with the permutations' defines added. Its fallback is the pipeline's fallback if the pipeline has
+     * one, or the pipeline itself if it doesn't
+     *
+     * \param pipeline The pipeline, as it was loaded from its file
+     * \param permutation The value of each permutation. Permutations that aren't in here have their default values
+     */
+    [[nodiscard]] PipelineCreateInfo make_pipeline_variant(const PipelineCreateInfo& pipeline,
+                                                           const std::unordered_map<std::string, std::string>& permutation);
+
     struct TextureFormat {
         /*!
          * \brief The format of the texture
@@ -450,6 +594,9 @@ namespace nova::renderer::shaderpack {
         std::string name;
 
         TextureFormat format{};
+
+        bool operator==(const TextureCreateInfo& other) const;
+        bool operator!=(const TextureCreateInfo& other) const;
     };
 
     struct ShaderpackResourcesData {
@@ -544,6 +691,13 @@ namespace nova::renderer::shaderpack {
         // Ugh why is this constructor explicit
         std::unordered_map<std::string, std::string> bindings = std::unordered_map<std::string, std::string>();
 
+        /*!
+         * \brief The value of each of the pipeline's permutations that this material pass is drawn with
+         *
+         * Permutations that aren't in here have their default values. The loader replaces `pipeline` with the name of the variant
+         */
+        std::unordered_map<std::string, std::string> permutation = std::unordered_map<std::string, std::string>();
+
         /*!
          * \brief All the descriptor sets needed to bind everything used by this material to its pipeline
          *
@@ -576,6 +730,11 @@ namespace nova::renderer::shaderpack {
         std::vector<MaterialData> materials;
 
         ShaderpackResourcesData resources;
+
+        /*!
+         * \brief The file that each pipeline was loaded from, by the pipeline's name
+         */
+        std::unordered_map<std::string, fs::path> pipeline_files;
     };
 
     // TODO: Wrap these in to_json/from_json thingies
@@ -607,6 +766,11 @@ namespace nova::renderer::shaderpack {
     [[nodiscard]] std::string to_string(VertexFieldEnum val);
 
     [[nodiscard]] uint32_t pixel_format_to_pixel_width(PixelFormatEnum format);
+
+    /*!
+     * \brief Checks if a vertex field is read from the instance data buffer, instead of from the vertex buffers
+     */
+    [[nodiscard]] bool is_per_instance_field(VertexFieldEnum field);
 } // namespace nova::renderer
 
 #endif // NOVA_RENDERER_SHADERPACK_DATA_HPP
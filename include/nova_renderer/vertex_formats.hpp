@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "nova_renderer/renderables.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief The formats that a vertex attribute may have
+     *
+     * Normalized formats are read as floats by shaders, everything else is read as the type it's stored as
+     */
+    enum class VertexAttributeFormat {
+        Float3,
+        Float4,
+        UNorm8x2,
+        UNorm8x4,
+        UNorm16x2,
+        UNorm16x4,
+        SNorm16x2,
+        UInt32,
+    };
+
+    /*!
+     * \brief One attribute of a vertex type
+     */
+    struct VertexAttribute {
+        /*!
+         * \brief Human-readable name of this attribute, for debugging
+         */
+        const char* name;
+
+        VertexAttributeFormat format;
+
+        /*!
+         * \brief The offset of this attribute from the start of the vertex, in bytes
+         */
+        uint32_t offset;
+    };
+
+    /*!
+     * \brief Describes the attributes of a vertex type, in shader location order
+     *
+     * Every vertex type Nova can render needs a specialization of this template. The specialization must have a static constexpr
+     * array of `VertexAttribute`s named `attributes`. The render engines generate their vertex input state from that array, so adding a
+     * new vertex type only requires a new specialization
+     *
+     * Every vertex type has the same number of attributes, and attributes with the same location hold the same data, so that shaders
+     * don't need to know which vertex type they're reading from beyond how to decode each attribute
+     */
+    template <typename VertexType>
+    struct VertexLayout;
+
+    template <>
+    struct VertexLayout<FullVertex> {
+        static constexpr std::array<VertexAttribute, 7> attributes = {{
+            {"position", VertexAttributeFormat::Float3, offsetof(FullVertex, position)},
+            {"normal", VertexAttributeFormat::Float3, offsetof(FullVertex, normal)},
+            {"tangent", VertexAttributeFormat::Float3, offsetof(FullVertex, tangent)},
+            {"main_uv", VertexAttributeFormat::UNorm16x2, offsetof(FullVertex, main_uv)},
+            {"secondary_uv", VertexAttributeFormat::UNorm8x2, offsetof(FullVertex, secondary_uv)},
+            {"virtual_texture_id", VertexAttributeFormat::UInt32, offsetof(FullVertex, virtual_texture_id)},
+            {"additional_stuff", VertexAttributeFormat::Float4, offsetof(FullVertex, additional_stuff)},
+        }};
+    };
+
+    /*!
+     * \brief A vertex that's half the size of a `FullVertex`, for meshes with lots of vertices such as chunks
+     *
+     * Positions are quantized to 16 bits per axis within a cube that the mesh fits in. Shaders need that cube's origin and size to
+     * decode the position: `position = origin + decoded_position * size`
+     *
+     * Normals and tangents are octahedral encoded: the unit vector is projected onto an octahedron, which is then unfolded onto a square.
+     * See `decode_octahedral` for how to get the vector back
+     *
+     * The UVs are stored exactly as they are in `FullVertex`, and the additional data is quantized to 8 bits per channel
+     */
+    struct CompactVertex {
+        glm::u16vec4 position;       // 8 bytes, w is always 0
+        glm::i16vec2 normal;         // 4 bytes
+        glm::i16vec2 tangent;        // 4 bytes
+        glm::u16vec2 main_uv;        // 4 bytes
+        glm::u8vec2 secondary_uv;    // 2 bytes
+        uint16_t padding;            // 2 bytes
+        uint32_t virtual_texture_id; // 4 bytes
+        glm::u8vec4 additional_data; // 4 bytes
+    };
+
+    static_assert(sizeof(CompactVertex) == 32, "CompactVertex must be exactly 32 bytes!");
+
+    template <>
+    struct VertexLayout<CompactVertex> {
+        static constexpr std::array<VertexAttribute, 7> attributes = {{
+            {"position", VertexAttributeFormat::UNorm16x4, offsetof(CompactVertex, position)},
+            {"normal", VertexAttributeFormat::SNorm16x2, offsetof(CompactVertex, normal)},
+            {"tangent", VertexAttributeFormat::SNorm16x2, offsetof(CompactVertex, tangent)},
+            {"main_uv", VertexAttributeFormat::UNorm16x2, offsetof(CompactVertex, main_uv)},
+            {"secondary_uv", VertexAttributeFormat::UNorm8x2, offsetof(CompactVertex, secondary_uv)},
+            {"virtual_texture_id", VertexAttributeFormat::UInt32, offsetof(CompactVertex, virtual_texture_id)},
+            {"additional_stuff", VertexAttributeFormat::UNorm8x4, offsetof(CompactVertex, additional_data)},
+        }};
+    };
+
+    /*!
+     * \brief The cube that a `CompactVertex`'s position is quantized within
+     */
+    struct PositionQuantization {
+        /*!
+         * \brief The corner of the cube with the smallest coordinates. For chunks, this is the chunk's origin
+         */
+        glm::vec3 origin;
+
+        /*!
+         * \brief The length of each side of the cube
+         */
+        float size;
+    };
+
+    /*!
+     * \brief Converts `num_vertices` vertices from `src` into compact vertices in `dst`
+     *
+     * Uses SIMD instructions when they're available
+     *
+     * \param src The vertices to convert
+     * \param num_vertices How many vertices to convert
+     * \param quantization The cube that the vertices' positions will be quantized within. Positions outside of it are clamped to it
+     * \param dst Where to write the compact vertices. Must have space for `num_vertices` vertices
+     */
+    void convert_to_compact_vertices(const FullVertex* src, size_t num_vertices, const PositionQuantization& quantization, CompactVertex* dst);
+
+    /*!
+     * \brief Converts vertices one at a time, without any SIMD instructions
+     *
+     * `convert_to_compact_vertices` uses this for the vertices that don't fill a whole SIMD register. It's also useful to check the SIMD
+     * version against
+     */
+    void convert_to_compact_vertices_scalar(const FullVertex* src,
+                                            size_t num_vertices,
+                                            const PositionQuantization& quantization,
+                                            CompactVertex* dst);
+
+    /*!
+     * \brief Octahedral encodes a unit vector into two signed normalized 16-bit values
+     */
+    [[nodiscard]] glm::i16vec2 encode_octahedral(const glm::vec3& vector);
+
+    /*!
+     * \brief Decodes an octahedral encoded unit vector. Shaders should do the same thing
+     */
+    [[nodiscard]] glm::vec3 decode_octahedral(const glm::i16vec2& encoded);
+
+    /*!
+     * \brief Decodes a quantized position. Shaders should do the same thing
+     */
+    [[nodiscard]] glm::vec3 decode_position(const glm::u16vec4& encoded, const PositionQuantization& quantization);
+} // namespace nova::renderer
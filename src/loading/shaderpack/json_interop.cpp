@@ -1,5 +1,7 @@
 #include "json_interop.hpp"
 
+#include <algorithm>
+
 #include "../json_utils.hpp"
 
 namespace nova::renderer::shaderpack {
@@ -52,11 +54,22 @@ namespace nova::renderer::shaderpack {
         vertex_data.field = get_json_value<VertexFieldEnum>(j, "field", vertex_field_enum_from_string).value();
     }
 
+    void from_json(const nlohmann::json& j, PipelinePermutation& permutation) {
+        permutation.name = get_json_value<std::string>(j, "name").value_or("");
+        permutation.values = get_json_array<std::string>(j, "values");
+    }
+
     void from_json(const nlohmann::json& j, PipelineCreateInfo& pipeline) {
         pipeline.name = get_json_value<std::string>(j, "name").value();
         pipeline.parent_name = get_json_value<std::string>(j, "parent").value_or("");
         pipeline.pass = get_json_value<std::string>(j, "pass").value();
         pipeline.defines = get_json_array<std::string>(j, "defines");
+        pipeline.permutations = get_json_array<PipelinePermutation>(j, "permutations");
+        // The validator reports permutations without any values. They can't be used, so they're ignored
+        pipeline.permutations.erase(std::remove_if(pipeline.permutations.begin(),
+                                                   pipeline.permutations.end(),
+                                                   [](const PipelinePermutation& permutation) { return permutation.values.empty(); }),
+                                    pipeline.permutations.end());
         pipeline.states = get_json_array<StateEnum>(j, "states", state_enum_from_string);
         pipeline.vertex_fields = get_json_array<VertexFieldData>(j, "vertexFields");
         pipeline.front_face = get_json_value<StencilOpState>(j, "frontFace");
@@ -116,6 +129,8 @@ namespace nova::renderer::shaderpack {
         pass.name = get_json_value<std::string>(j, "name").value();
         pass.pipeline = get_json_value<std::string>(j, "pipeline").value();
         pass.bindings = get_json_value<std::unordered_map<std::string, std::string>>(j, "bindings").value();
+        pass.permutation = get_json_value<std::unordered_map<std::string, std::string>>(j, "permutation").value_or(
+            std::unordered_map<std::string, std::string>());
     }
 
     void from_json(const nlohmann::json& j, MaterialData& mat) {
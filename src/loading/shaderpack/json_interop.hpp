@@ -19,6 +19,8 @@ namespace nova::renderer::shaderpack {
 
     void from_json(const nlohmann::json& j, TextureAttachmentInfo& tex);
 
+    void from_json(const nlohmann::json& j, PipelinePermutation& permutation);
+
     void from_json(const nlohmann::json& j, PipelineCreateInfo& pipeline);
 
     void from_json(const nlohmann::json& j, StencilOpState& stencil_op);
@@ -0,0 +1,287 @@
+#include "shader_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <utility>
+
+#include "../../util/logger.hpp"
+#include "SPIRV/GlslangToSpv.h"
+#include "shader_optimizer.hpp"
+#include "shader_reflection.hpp"
+
+namespace nova::renderer::shaderpack {
+    /*!
+     * \brief Change this whenever the way Nova compiles shaders changes, so that old cache entries aren't used
+     */
+    constexpr uint32_t SHADER_CACHE_VERSION = 2;
+
+    constexpr uint64_t FNV_PRIME = 0x100000001B3;
+
+    constexpr uint32_t SPIRV_MAGIC_NUMBER = 0x07230203;
+
+    /*!
+     * \brief Added to a key's filename to get the name of the file with the shader's reflection record
+     */
+    constexpr const char* REFLECTION_EXTENSION = ".reflection";
+
+    void ShaderCacheKey::add(const std::string& data) {
+        const uint64_t size = data.size();
+        add_bytes(&size, sizeof(size));
+        add_bytes(data.data(), data.size());
+    }
+
+    void ShaderCacheKey::add(const uint32_t value) { add_bytes(&value, sizeof(value)); }
+
+    void ShaderCacheKey::add(const std::vector<uint32_t>& data) {
+        const uint64_t size = data.size();
+        add_bytes(&size, sizeof(size));
+        add_bytes(data.data(), data.size() * sizeof(uint32_t));
+    }
+
+    void ShaderCacheKey::add(const float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        add(bits);
+    }
+
+    std::string ShaderCacheKey::to_string() const {
+        char hex[33];
+        std::snprintf(hex,
+                      sizeof(hex),
+                      "%08x%08x%08x%08x",
+                      static_cast<uint32_t>(high >> 32),
+                      static_cast<uint32_t>(high),
+                      static_cast<uint32_t>(low >> 32),
+                      static_cast<uint32_t>(low));
+        return hex;
+    }
+
+    bool ShaderCacheKey::operator==(const ShaderCacheKey& other) const { return low == other.low && high == other.high; }
+
+    bool ShaderCacheKey::operator!=(const ShaderCacheKey& other) const { return !(*this == other); }
+
+    void ShaderCacheKey::add_bytes(const void* data, const size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for(size_t i = 0; i < size; i++) {
+            low = (low ^ bytes[i]) * FNV_PRIME;
+            // The bytes are rotated for the high half, so that the two halves don't just differ by their starting value
+            high = (high ^ static_cast<uint8_t>(bytes[i] << 3 | bytes[i] >> 5)) * FNV_PRIME;
+        }
+    }
+
+    ShaderCacheKey make_shader_cache_key(const std::string& source,
+                                         const EShLanguage stage,
+                                         const glslang::EShSource language,
+                                         const std::vector<std::string>& defines,
+                                         const ShaderOptimizer* optimizer) {
+        ShaderCacheKey key;
+        key.add(SHADER_CACHE_VERSION);
+        key.add(glslang::GetGlslVersionString());
+        key.add(static_cast<uint32_t>(glslang::GetSpirvGeneratorVersion()));
+        key.add(static_cast<uint32_t>(stage));
+        key.add(static_cast<uint32_t>(language));
+
+        key.add(static_cast<uint32_t>(defines.size()));
+        for(const std::string& define : defines) {
+            key.add(define);
+        }
+
+        key.add(source);
+
+        key.add(static_cast<uint32_t>(optimizer != nullptr));
+        if(optimizer != nullptr) {
+            optimizer->add_to_key(key);
+        }
+
+        return key;
+    }
+
+    void add_shader_to_key(ShaderCacheKey& key, const std::optional<ShaderSource>& shader) {
+        key.add(static_cast<uint32_t>(shader.has_value()));
+        if(shader) {
+            key.add(shader->source);
+        }
+    }
+
+    void add_stencil_op_to_key(ShaderCacheKey& key, const std::optional<StencilOpState>& stencil_op) {
+        key.add(static_cast<uint32_t>(stencil_op.has_value()));
+        if(stencil_op) {
+            key.add(static_cast<uint32_t>(stencil_op->fail_op));
+            key.add(static_cast<uint32_t>(stencil_op->pass_op));
+            key.add(static_cast<uint32_t>(stencil_op->depth_fail_op));
+            key.add(static_cast<uint32_t>(stencil_op->compare_op));
+            key.add(stencil_op->compare_mask);
+            key.add(stencil_op->write_mask);
+        }
+    }
+
+    void add_attachment_to_key(ShaderCacheKey& key, const TextureAttachmentInfo& attachment) {
+        key.add(attachment.name);
+        key.add(static_cast<uint32_t>(attachment.pixel_format));
+        key.add(static_cast<uint32_t>(attachment.clear));
+    }
+
+    ShaderCacheKey make_pipeline_cache_key(const PipelineCreateInfo& pipeline,
+                                           const std::vector<TextureAttachmentInfo>& color_attachments,
+                                           const std::optional<TextureAttachmentInfo>& depth_texture,
+                                           const glm::uvec2& viewport_size) {
+        ShaderCacheKey key;
+        key.add(SHADER_CACHE_VERSION);
+
+        // The name is in the key because the API pipeline is named after it for debuggers
+        key.add(pipeline.name);
+        key.add(pipeline.pass);
+
+        key.add(static_cast<uint32_t>(pipeline.states.size()));
+        for(const StateEnum state : pipeline.states) {
+            key.add(static_cast<uint32_t>(state));
+        }
+
+        key.add(static_cast<uint32_t>(pipeline.vertex_fields.size()));
+        for(const VertexFieldData& field : pipeline.vertex_fields) {
+            key.add(field.semantic_name);
+            key.add(static_cast<uint32_t>(field.field));
+        }
+
+        add_stencil_op_to_key(key, pipeline.front_face);
+        add_stencil_op_to_key(key, pipeline.back_face);
+
+        key.add(pipeline.depth_bias);
+        key.add(pipeline.slope_scaled_depth_bias);
+        key.add(pipeline.stencil_ref);
+        key.add(pipeline.stencil_read_mask);
+        key.add(pipeline.stencil_write_mask);
+        key.add(static_cast<uint32_t>(pipeline.msaa_support));
+        key.add(static_cast<uint32_t>(pipeline.primitive_mode));
+        key.add(static_cast<uint32_t>(pipeline.source_blend_factor));
+        key.add(static_cast<uint32_t>(pipeline.destination_blend_factor));
+        key.add(static_cast<uint32_t>(pipeline.alpha_src));
+        key.add(static_cast<uint32_t>(pipeline.alpha_dst));
+        key.add(static_cast<uint32_t>(pipeline.depth_func));
+        key.add(static_cast<uint32_t>(pipeline.render_queue));
+
+        // The defines are already part of the SPIR-V
+        key.add(pipeline.vertex_shader.source);
+        add_shader_to_key(key, pipeline.geometry_shader);
+        add_shader_to_key(key, pipeline.tessellation_control_shader);
+        add_shader_to_key(key, pipeline.tessellation_evaluation_shader);
+        add_shader_to_key(key, pipeline.fragment_shader);
+
+        key.add(static_cast<uint32_t>(color_attachments.size()));
+        for(const TextureAttachmentInfo& attachment : color_attachments) {
+            add_attachment_to_key(key, attachment);
+        }
+
+        key.add(static_cast<uint32_t>(depth_texture.has_value()));
+        if(depth_texture) {
+            add_attachment_to_key(key, *depth_texture);
+        }
+
+        key.add(viewport_size.x);
+        key.add(viewport_size.y);
+
+        return key;
+    }
+
+    ShaderCache::ShaderCache(fs::path folder) : folder(std::move(folder)) {
+        std::error_code error;
+        fs::create_directories(this->folder, error);
+        if(error) {
+            NOVA_LOG(WARN) << "Could not create shader cache folder " << this->folder.string() << ": " << error.message();
+        }
+    }
+
+    std::optional<std::vector<uint32_t>> ShaderCache::find(const ShaderCacheKey& key) {
+        const fs::path path = folder / key.to_string();
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file.good()) {
+            num_misses++;
+            return {};
+        }
+
+        const auto size = static_cast<size_t>(file.tellg());
+        std::vector<uint32_t> spirv(size / sizeof(uint32_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+
+        if(!file.good() || size % sizeof(uint32_t) != 0 || spirv.empty() || spirv[0] != SPIRV_MAGIC_NUMBER) {
+            NOVA_LOG(WARN) << "Shader cache entry " << path.string() << " isn't valid SPIR-V. The shader will be compiled again";
+            num_misses++;
+            return {};
+        }
+
+        num_hits++;
+        return spirv;
+    }
+
+    void ShaderCache::store(const ShaderCacheKey& key, const std::vector<uint32_t>& spirv) {
+        if(spirv.empty()) {
+            return;
+        }
+
+        write_entry(folder / key.to_string(), spirv);
+    }
+
+    std::optional<ShaderReflection> ShaderCache::find_reflection(const ShaderCacheKey& key) const {
+        fs::path path = folder / key.to_string();
+        path += REFLECTION_EXTENSION;
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file.good()) {
+            return {};
+        }
+
+        const auto size = static_cast<size_t>(file.tellg());
+        std::vector<uint32_t> data(size / sizeof(uint32_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(uint32_t)));
+        if(!file.good() || size % sizeof(uint32_t) != 0) {
+            return {};
+        }
+
+        return deserialize_reflection(data);
+    }
+
+    void ShaderCache::store_reflection(const ShaderCacheKey& key, const ShaderReflection& reflection) {
+        fs::path path = folder / key.to_string();
+        path += REFLECTION_EXTENSION;
+
+        write_entry(path, serialize_reflection(reflection));
+    }
+
+    void ShaderCache::write_entry(const fs::path& path, const std::vector<uint32_t>& data) {
+        // Other Nova processes might be writing to the same cache, so temporary files are unique per process as well as per write
+        static const uint32_t PROCESS_ID = std::random_device()();
+
+        fs::path temp_path = path;
+        temp_path += ".tmp" + std::to_string(PROCESS_ID) + "." + std::to_string(num_writes++);
+
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(uint32_t)));
+            if(!file.good()) {
+                NOVA_LOG(WARN) << "Could not write shader cache entry " << temp_path.string();
+                file.close();
+
+                std::error_code error;
+                fs::remove(temp_path, error);
+                return;
+            }
+        }
+
+        // The rename replaces any file that's already there. If two threads compiled the same shader, they wrote the same data
+        std::error_code error;
+        fs::rename(temp_path, path, error);
+        if(error) {
+            NOVA_LOG(WARN) << "Could not move shader cache entry into place at " << path.string() << ": " << error.message();
+            fs::remove(temp_path, error);
+        }
+    }
+
+    uint32_t ShaderCache::get_num_hits() const { return num_hits; }
+
+    uint32_t ShaderCache::get_num_misses() const { return num_misses; }
+} // namespace nova::renderer::shaderpack
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <glslang/Public/ShaderLang.h>
+
+#include "nova_renderer/shaderpack_data.hpp"
+#include "nova_renderer/util/filesystem.hpp"
+
+namespace nova::renderer::shaderpack {
+    class ShaderOptimizer;
+
+    /*!
+     * \brief A 128-bit hash of everything that goes into compiling a shader
+     *
+     * This is two 64-bit FNV-1a hashes with different offset bases. It's not a cryptographic hash, but it's plenty to tell shaders apart
+     */
+    class ShaderCacheKey {
+    public:
+        /*!
+         * \brief Adds some data to the key. The data's length is added too, so adding "ab" then "c" is different from adding "a" then "bc"
+         */
+        void add(const std::string& data);
+
+        void add(const std::vector<uint32_t>& data);
+
+        void add(uint32_t value);
+
+        void add(float value);
+
+        /*!
+         * \brief The key as 32 hex digits, which is the name of the key's file in the cache
+         */
+        [[nodiscard]] std::string to_string() const;
+
+        [[nodiscard]] bool operator==(const ShaderCacheKey& other) const;
+
+        [[nodiscard]] bool operator!=(const ShaderCacheKey& other) const;
+
+    private:
+        uint64_t low = 0xCBF29CE484222325;
+        uint64_t high = 0x84222325CBF29CE4;
+
+        void add_bytes(const void* data, size_t size);
+    };
+
+    /*!
+     * \brief Makes the key for a GLSL or HLSL shader
+     *
+     * The key covers the shader's source, the defines that are injected into it, its stage and language, and the version of glslang that
+     * compiles it. The files that the shader includes aren't part of the source, so `ShaderIncludeCache::add_to_key` has to add them
+     *
+     * \param source The shader's source, before the defines are injected
+     * \param optimizer The optimizer that the compiled shader is run through, or nullptr if it isn't optimized
+     */
+    [[nodiscard]] ShaderCacheKey make_shader_cache_key(const std::string& source,
+                                                       EShLanguage stage,
+                                                       glslang::EShSource language,
+                                                       const std::vector<std::string>& defines,
+                                                       const ShaderOptimizer* optimizer = nullptr);
+
+    /*!
+     * \brief Makes the key for a graphics pipeline
+     *
+     * The key covers everything in the pipeline's create info, including the SPIR-V of each of its stages, the attachments of the pass
+     * that it renders to, and the size of its viewport. Two pipelines with the same key can use the same API pipeline
+     *
+     * \param color_attachments The color attachments of the pipeline's pass
+     * \param depth_texture The depth attachment of the pipeline's pass, if it has one
+     * \param viewport_size The size of the viewport that the pipeline renders to
+     */
+    [[nodiscard]] ShaderCacheKey make_pipeline_cache_key(const PipelineCreateInfo& pipeline,
+                                                         const std::vector<TextureAttachmentInfo>& color_attachments,
+                                                         const std::optional<TextureAttachmentInfo>& depth_texture,
+                                                         const glm::uvec2& viewport_size);
+
+    /*!
+     * \brief Compiled SPIR-V, saved on disk so that loading an unchanged shaderpack doesn't need glslang
+     *
+     * Each shader is one file in the cache folder, named after its key. The file is the raw SPIR-V module with no header, so it can be
+     * memory-mapped or handed to tools like `spirv-dis` as-is. Files are written to a temporary file and then renamed, so a crash or
+     * another Nova process never sees half a file
+     *
+     * Each shader's reflection record is saved next to its SPIR-V, in a file with the same name and the `.reflection` extension. The
+     * SPIR-V and its reflection record are separate files so that the SPIR-V stays usable by other tools
+     *
+     * The cache never removes files. Delete the cache folder to clear it
+     *
+     * This class is thread-safe
+     */
+    class ShaderCache {
+    public:
+        /*!
+         * \brief Opens the cache in the given folder, creating the folder if it doesn't exist
+         */
+        explicit ShaderCache(fs::path folder);
+
+        /*!
+         * \brief Loads the SPIR-V with the given key, or returns an empty optional if the cache doesn't have it
+         */
+        [[nodiscard]] std::optional<std::vector<uint32_t>> find(const ShaderCacheKey& key);
+
+        /*!
+         * \brief Saves the SPIR-V with the given key. Failing to save it isn't an error, the shader will just be compiled again next time
+         */
+        void store(const ShaderCacheKey& key, const std::vector<uint32_t>& spirv);
+
+        /*!
+         * \brief Loads the reflection record of the shader with the given key, or returns an empty optional if the cache doesn't have it
+         *
+         * Reflection records don't count towards the hits and misses, since they're only looked for after the SPIR-V was found
+         */
+        [[nodiscard]] std::optional<ShaderReflection> find_reflection(const ShaderCacheKey& key) const;
+
+        /*!
+         * \brief Saves the reflection record of the shader with the given key
+         */
+        void store_reflection(const ShaderCacheKey& key, const ShaderReflection& reflection);
+
+        [[nodiscard]] uint32_t get_num_hits() const;
+
+        [[nodiscard]] uint32_t get_num_misses() const;
+
+    private:
+        fs::path folder;
+
+        std::atomic<uint32_t> num_hits{0};
+
+        std::atomic<uint32_t> num_misses{0};
+
+        /*!
+         * \brief Makes the names of temporary files unique between the threads that write to the cache
+         */
+        std::atomic<uint32_t> num_writes{0};
+
+        /*!
+         * \brief Writes the data to a temporary file, then renames it to the given path so that nothing ever sees half a file
+         */
+        void write_entry(const fs::path& path, const std::vector<uint32_t>& data);
+    };
+} // namespace nova::renderer::shaderpack
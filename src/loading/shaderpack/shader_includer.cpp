@@ -0,0 +1,168 @@
+#include "shader_includer.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "../folder_accessor.hpp"
+#include "shader_cache.hpp"
+
+namespace nova::renderer::shaderpack {
+    /*!
+     * \brief Checks that a path doesn't leave the shaderpack
+     */
+    bool is_in_shaderpack(const fs::path& path) { return !path.empty() && path.is_relative() && *path.begin() != ".."; }
+
+    ShaderIncludeCache::ShaderIncludeCache(std::shared_ptr<FolderAccessorBase> folder_access) : folder_access(std::move(folder_access)) {}
+
+    std::optional<fs::path> ShaderIncludeCache::resolve(const std::string& header_name, const fs::path& includer, const bool is_system) {
+        if(!is_system) {
+            const fs::path relative_to_includer = (includer.parent_path() / header_name).lexically_normal();
+            if(is_in_shaderpack(relative_to_includer) && folder_access->does_resource_exist(relative_to_includer)) {
+                return relative_to_includer;
+            }
+        }
+
+        const fs::path relative_to_root = fs::path(header_name).lexically_normal();
+        if(is_in_shaderpack(relative_to_root) && folder_access->does_resource_exist(relative_to_root)) {
+            return relative_to_root;
+        }
+
+        return {};
+    }
+
+    const std::string* ShaderIncludeCache::read(const fs::path& include_path) {
+        const IncludeFile* file = get_file(include_path);
+        return file != nullptr ? &file->text : nullptr;
+    }
+
+    std::vector<fs::path> ShaderIncludeCache::find_includes(const std::string& source, const fs::path& filename) {
+        std::vector<fs::path> includes;
+        std::unordered_set<std::string> visited_files;
+
+        std::vector<fs::path> files_to_visit = find_direct_includes(source, filename);
+        while(!files_to_visit.empty()) {
+            const fs::path include_path = std::move(files_to_visit.back());
+            files_to_visit.pop_back();
+
+            // Files can include each other, as long as they have include guards
+            if(!visited_files.insert(include_path.generic_string()).second) {
+                continue;
+            }
+
+            const IncludeFile* file = get_file(include_path);
+            if(file == nullptr) {
+                continue;
+            }
+
+            includes.push_back(include_path);
+            files_to_visit.insert(files_to_visit.end(), file->includes.begin(), file->includes.end());
+        }
+
+        std::sort(includes.begin(), includes.end());
+
+        return includes;
+    }
+
+    void ShaderIncludeCache::add_to_key(ShaderCacheKey& key, const std::vector<fs::path>& includes) {
+        key.add(static_cast<uint32_t>(includes.size()));
+        for(const fs::path& include_path : includes) {
+            key.add(include_path.generic_string());
+
+            const std::string* text = read(include_path);
+            key.add(text != nullptr ? *text : std::string());
+        }
+    }
+
+    const ShaderIncludeCache::IncludeFile* ShaderIncludeCache::get_file(const fs::path& include_path) {
+        const std::string file_key = include_path.generic_string();
+        {
+            std::lock_guard l(files_mutex);
+            if(const auto itr = files.find(file_key); itr != files.end()) {
+                return itr->second ? &*itr->second : nullptr;
+            }
+        }
+
+        // Files are read without holding the lock, so that shaders that include different files don't wait for each other. If two
+        // shaders read the same file at once, the first copy is kept
+        std::optional<IncludeFile> file;
+        if(folder_access->does_resource_exist(include_path)) {
+            file = IncludeFile{folder_access->read_text_file(include_path), {}};
+            file->includes = find_direct_includes(file->text, include_path);
+        }
+
+        std::lock_guard l(files_mutex);
+        const auto [itr, inserted] = files.emplace(file_key, std::move(file));
+        return itr->second ? &*itr->second : nullptr;
+    }
+
+    std::vector<fs::path> ShaderIncludeCache::find_direct_includes(const std::string& source, const fs::path& filename) {
+        std::vector<fs::path> includes;
+
+        size_t line_start = 0;
+        while(line_start < source.size()) {
+            size_t line_end = source.find('\n', line_start);
+            if(line_end == std::string::npos) {
+                line_end = source.size();
+            }
+
+            // Directives look like `#include "file"` or `#include <file>`, with any amount of whitespace around the `#`
+            size_t pos = source.find_first_not_of(" \t", line_start);
+            if(pos < line_end && source[pos] == '#') {
+                pos = source.find_first_not_of(" \t", pos + 1);
+                if(pos < line_end && source.compare(pos, 7, "include") == 0) {
+                    pos = source.find_first_not_of(" \t", pos + 7);
+                    if(pos < line_end && (source[pos] == '"' || source[pos] == '<')) {
+                        const bool is_system = source[pos] == '<';
+                        const size_t name_end = source.find(is_system ? '>' : '"', pos + 1);
+                        if(name_end < line_end) {
+                            if(auto include_path = resolve(source.substr(pos + 1, name_end - pos - 1), filename, is_system)) {
+                                includes.push_back(std::move(*include_path));
+                            }
+                        }
+                    }
+                }
+            }
+
+            line_start = line_end + 1;
+        }
+
+        return includes;
+    }
+
+    ShaderIncluder::ShaderIncluder(ShaderIncludeCache& include_cache) : include_cache(include_cache) {}
+
+    glslang::TShader::Includer::IncludeResult* ShaderIncluder::includeSystem(const char* header_name,
+                                                                              const char* includer_name,
+                                                                              size_t /* inclusion_depth */) {
+        return include(header_name, includer_name, true);
+    }
+
+    glslang::TShader::Includer::IncludeResult* ShaderIncluder::includeLocal(const char* header_name,
+                                                                             const char* includer_name,
+                                                                             size_t /* inclusion_depth */) {
+        return include(header_name, includer_name, false);
+    }
+
+    void ShaderIncluder::releaseInclude(IncludeResult* result) {
+        // The text belongs to the include cache
+        delete result;
+    }
+
+    glslang::TShader::Includer::IncludeResult* ShaderIncluder::include(const char* header_name,
+                                                                        const char* includer_name,
+                                                                        const bool is_system) {
+        const std::optional<fs::path> include_path = include_cache.resolve(header_name, includer_name, is_system);
+        if(!include_path) {
+            // glslang reports the missing file
+            return nullptr;
+        }
+
+        const std::string* text = include_cache.read(*include_path);
+        if(text == nullptr) {
+            return nullptr;
+        }
+
+        // glslang passes the header name back as the includer name of the file's own includes, so it has to be the resolved path
+        return new IncludeResult(include_path->generic_string(), text->data(), text->size(), nullptr);
+    }
+} // namespace nova::renderer::shaderpack
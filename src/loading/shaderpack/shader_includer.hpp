@@ -0,0 +1,116 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glslang/Public/ShaderLang.h>
+
+#include "nova_renderer/util/filesystem.hpp"
+
+namespace nova::renderer {
+    class FolderAccessorBase;
+} // namespace nova::renderer
+
+namespace nova::renderer::shaderpack {
+    class ShaderCacheKey;
+
+    /*!
+     * \brief The files that shaders `#include`, read once for every shader that's loaded at the same time
+     *
+     * Shaderpacks usually have a few big libraries of common code that every shader includes. Each library is read from the shaderpack
+     * and scanned for its own `#include`s the first time a shader includes it, then every other shader stage in the same load uses the
+     * copy in memory
+     *
+     * `#include "file"` is relative to the file with the directive, or to the shaderpack's root if there isn't a file there.
+     * `#include <file>` is always relative to the shaderpack's root
+     *
+     * This class is thread-safe
+     */
+    class ShaderIncludeCache {
+    public:
+        explicit ShaderIncludeCache(std::shared_ptr<FolderAccessorBase> folder_access);
+
+        /*!
+         * \brief Finds the file that an `#include` directive refers to
+         *
+         * \param header_name The name of the file in the directive
+         * \param includer The file with the directive, relative to the shaderpack's root
+         * \param is_system True if the name was in angle brackets, false if it was in quotes
+         * \return The path of the file relative to the shaderpack's root, or an empty optional if the shaderpack doesn't have it
+         */
+        [[nodiscard]] std::optional<fs::path> resolve(const std::string& header_name, const fs::path& includer, bool is_system);
+
+        /*!
+         * \brief Returns the text of a file that was found with `resolve`, or nullptr if it can't be read
+         *
+         * The text stays valid for as long as the cache does
+         */
+        [[nodiscard]] const std::string* read(const fs::path& include_path);
+
+        /*!
+         * \brief Finds every file that a shader includes, directly or through other files, sorted by path
+         *
+         * Directives are found without preprocessing the shader, so files that are only included when some macro is defined are in the
+         * list even if the macro isn't defined. Files that don't exist aren't in the list, glslang reports them when the shader is
+         * compiled
+         *
+         * \param source The shader's source
+         * \param filename The shader's file, relative to the shaderpack's root
+         */
+        [[nodiscard]] std::vector<fs::path> find_includes(const std::string& source, const fs::path& filename);
+
+        /*!
+         * \brief Adds the paths and text of a shader's includes, from `find_includes`, to the shader's cache key
+         */
+        void add_to_key(ShaderCacheKey& key, const std::vector<fs::path>& includes);
+
+    private:
+        struct IncludeFile {
+            std::string text;
+
+            /*!
+             * \brief The files that this file includes directly
+             */
+            std::vector<fs::path> includes;
+        };
+
+        std::shared_ptr<FolderAccessorBase> folder_access;
+
+        std::mutex files_mutex;
+
+        /*!
+         * \brief Every file that's been read, by its path. Files that couldn't be read are empty optionals
+         */
+        std::unordered_map<std::string, std::optional<IncludeFile>> files;
+
+        const IncludeFile* get_file(const fs::path& include_path);
+
+        /*!
+         * \brief Finds the files that some source code includes directly
+         */
+        std::vector<fs::path> find_direct_includes(const std::string& source, const fs::path& filename);
+    };
+
+    /*!
+     * \brief Gives glslang the files that a shader includes, from an include cache
+     */
+    class ShaderIncluder : public glslang::TShader::Includer {
+    public:
+        explicit ShaderIncluder(ShaderIncludeCache& include_cache);
+
+        IncludeResult* includeSystem(const char* header_name, const char* includer_name, size_t inclusion_depth) override;
+
+        IncludeResult* includeLocal(const char* header_name, const char* includer_name, size_t inclusion_depth) override;
+
+        void releaseInclude(IncludeResult* result) override;
+
+    private:
+        ShaderIncludeCache& include_cache;
+
+        IncludeResult* include(const char* header_name, const char* includer_name, bool is_system);
+    };
+} // namespace nova::renderer::shaderpack
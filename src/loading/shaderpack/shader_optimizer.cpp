@@ -0,0 +1,108 @@
+#include "shader_optimizer.hpp"
+
+#include <spirv-tools/libspirv.h>
+#include <spirv-tools/optimizer.hpp>
+
+#include "../../util/logger.hpp"
+#include "shader_cache.hpp"
+#include "shader_reflection.hpp"
+
+namespace nova::renderer::shaderpack {
+    /*!
+     * \brief The number of words in a SPIR-V module's header
+     */
+    constexpr size_t SPIRV_HEADER_SIZE = 5;
+
+    /*!
+     * \brief glslang compiles shaders for Vulkan 1.0, which is SPIR-V 1.0
+     */
+    constexpr spv_target_env SPIRV_TARGET_ENVIRONMENT = SPV_ENV_VULKAN_1_0;
+
+    uint32_t count_spirv_instructions(const std::vector<uint32_t>& spirv) {
+        uint32_t num_instructions = 0;
+        size_t word = SPIRV_HEADER_SIZE;
+        while(word < spirv.size()) {
+            // The high half of each instruction's first word is its length in words
+            const uint32_t instruction_size = spirv[word] >> 16;
+            if(instruction_size == 0) {
+                break;
+            }
+
+            word += instruction_size;
+            num_instructions++;
+        }
+
+        return num_instructions;
+    }
+
+    /*!
+     * \brief Runs the passes that `register_passes` registers over the SPIR-V, replacing it if they succeed
+     *
+     * \return True if the passes succeeded, false if the SPIR-V was left alone. The optimizer's messages are added to the report
+     */
+    template <typename RegisterPassesFunc>
+    bool run_passes(std::vector<uint32_t>& spirv, const std::string& name, ValidationReport& report, RegisterPassesFunc&& register_passes) {
+        spvtools::Optimizer optimizer(SPIRV_TARGET_ENVIRONMENT);
+
+        std::string messages;
+        optimizer.SetMessageConsumer(
+            [&](spv_message_level_t /* level */, const char* /* source */, const spv_position_t& position, const char* message) {
+                messages += "\n" + std::to_string(position.index) + ": " + message;
+            });
+
+        register_passes(optimizer);
+
+        std::vector<uint32_t> optimized_spirv;
+        if(!optimizer.Run(spirv.data(), spirv.size(), &optimized_spirv)) {
+            report.warnings.emplace_back("Could not optimize shader " + name + ", it will be used without optimizations:" + messages);
+            return false;
+        }
+
+        spirv = std::move(optimized_spirv);
+        return true;
+    }
+
+    ShaderOptimizer::ShaderOptimizer(const bool optimize_for_performance, const bool strip_debug_info)
+        : optimize_for_performance(optimize_for_performance), strip_debug_info(strip_debug_info) {}
+
+    void ShaderOptimizer::optimize(ShaderSource& shader, const std::string& name, ValidationReport& report) {
+        const uint32_t num_instructions_before = count_spirv_instructions(shader.source);
+        const size_t num_bytes_before = shader.source.size() * sizeof(uint32_t);
+
+        if(optimize_for_performance) {
+            run_passes(shader.source, name, report, [](spvtools::Optimizer& optimizer) { optimizer.RegisterPerformancePasses(); });
+        }
+
+        // Materials bind resources by the names in the debug info, so the shader has to be reflected before they're gone
+        shader.reflection = reflect_shader(shader.source);
+
+        if(strip_debug_info) {
+            run_passes(shader.source, name, report, [](spvtools::Optimizer& optimizer) {
+                optimizer.RegisterPass(spvtools::CreateStripDebugInfoPass());
+            });
+        }
+
+        const uint32_t num_instructions_after = count_spirv_instructions(shader.source);
+        const size_t num_bytes_after = shader.source.size() * sizeof(uint32_t);
+        NOVA_LOG(TRACE) << "Optimized shader " << name << " from " << num_instructions_before << " instructions (" << num_bytes_before
+                        << " bytes) to " << num_instructions_after << " instructions (" << num_bytes_after << " bytes)";
+
+        std::lock_guard l(statistics_mutex);
+        statistics.num_shaders++;
+        statistics.num_instructions_before += num_instructions_before;
+        statistics.num_instructions_after += num_instructions_after;
+        statistics.num_bytes_before += num_bytes_before;
+        statistics.num_bytes_after += num_bytes_after;
+    }
+
+    void ShaderOptimizer::add_to_key(ShaderCacheKey& key) const {
+        key.add(static_cast<uint32_t>(optimize_for_performance));
+        key.add(static_cast<uint32_t>(strip_debug_info));
+        key.add(std::string(spvSoftwareVersionString()));
+    }
+
+    ShaderOptimizationStatistics ShaderOptimizer::get_statistics() const {
+        std::lock_guard l(statistics_mutex);
+        return statistics;
+    }
+} // namespace nova::renderer::shaderpack
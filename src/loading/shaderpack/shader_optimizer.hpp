@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nova_renderer/shaderpack_data.hpp"
+#include "shaderpack_validator.hpp"
+
+namespace nova::renderer::shaderpack {
+    class ShaderCacheKey;
+
+    /*!
+     * \brief How much smaller the optimizer has made the shaders that it's optimized
+     */
+    struct ShaderOptimizationStatistics {
+        uint32_t num_shaders = 0;
+
+        uint64_t num_instructions_before = 0;
+        uint64_t num_instructions_after = 0;
+
+        uint64_t num_bytes_before = 0;
+        uint64_t num_bytes_after = 0;
+    };
+
+    /*!
+     * \brief Counts the instructions in a SPIR-V module, not including its header
+     */
+    [[nodiscard]] uint32_t count_spirv_instructions(const std::vector<uint32_t>& spirv);
+
+    /*!
+     * \brief Runs SPIRV-Tools' optimizer over the SPIR-V that glslang compiles
+     *
+     * glslang doesn't optimize the SPIR-V it makes, and it keeps the name of every variable and type. The performance passes are the
+     * same ones that `spirv-opt -O` runs. Stripping debug info removes the names, which are most of a small shader's size, but the
+     * shader is reflected before the names are stripped so that materials can still bind resources by name
+     *
+     * Shaders that the optimizer fails on are left as glslang compiled them
+     *
+     * This class is thread-safe
+     */
+    class ShaderOptimizer {
+    public:
+        /*!
+         * \param optimize_for_performance Whether to run the performance passes
+         * \param strip_debug_info Whether to strip names, source text, and line numbers from the SPIR-V
+         */
+        ShaderOptimizer(bool optimize_for_performance, bool strip_debug_info);
+
+        /*!
+         * \brief Optimizes a shader that was just compiled, and fills in its reflection record
+         *
+         * \param shader The shader, with the SPIR-V from glslang
+         * \param name The name to use for the shader in warnings, usually its filename
+         * \param report The report to add a warning to if the shader can't be optimized
+         */
+        void optimize(ShaderSource& shader, const std::string& name, ValidationReport& report);
+
+        /*!
+         * \brief Adds the passes that this optimizer runs, and the version of SPIRV-Tools, to a shader's cache key
+         */
+        void add_to_key(ShaderCacheKey& key) const;
+
+        [[nodiscard]] ShaderOptimizationStatistics get_statistics() const;
+
+    private:
+        bool optimize_for_performance;
+
+        bool strip_debug_info;
+
+        mutable std::mutex statistics_mutex;
+
+        ShaderOptimizationStatistics statistics;
+    };
+} // namespace nova::renderer::shaderpack
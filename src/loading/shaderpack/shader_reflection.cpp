@@ -0,0 +1,214 @@
+#include "shader_reflection.hpp"
+
+#include <cstring>
+
+#include <minitrace.h>
+#include <spirv_cross.hpp>
+
+#include "../../util/logger.hpp"
+
+namespace nova::renderer::shaderpack {
+    /*!
+     * \brief Change this whenever the layout of serialized reflection records changes
+     */
+    constexpr uint32_t REFLECTION_FORMAT_VERSION = 1;
+
+    uint32_t get_descriptor_count(const spirv_cross::Compiler& compiler, const spirv_cross::Resource& resource) {
+        const spirv_cross::SPIRType& type = compiler.get_type(resource.type_id);
+
+        uint32_t count = 1;
+        for(uint32_t i = 0; i < type.array.size(); i++) {
+            // Arrays that are sized by specialization constants have the constant's ID instead of a size, so they count as one
+            if(type.array_size_literal[i] && type.array[i] > 0) {
+                count *= type.array[i];
+            }
+        }
+
+        return count;
+    }
+
+    void add_resources(const spirv_cross::Compiler& compiler,
+                       const spirv_cross::SmallVector<spirv_cross::Resource>& resources,
+                       const ShaderResourceTypeEnum type,
+                       std::vector<ShaderResourceReflection>& reflected_resources) {
+        for(const spirv_cross::Resource& resource : resources) {
+            ShaderResourceReflection& reflected_resource = reflected_resources.emplace_back();
+            reflected_resource.name = resource.name;
+            reflected_resource.set = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
+            reflected_resource.binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+            reflected_resource.count = get_descriptor_count(compiler, resource);
+            reflected_resource.type = type;
+        }
+    }
+
+    void add_variables(const spirv_cross::Compiler& compiler,
+                       const spirv_cross::SmallVector<spirv_cross::Resource>& variables,
+                       std::vector<ShaderVariableReflection>& reflected_variables) {
+        reflected_variables.reserve(variables.size());
+        for(const spirv_cross::Resource& variable : variables) {
+            reflected_variables.push_back({variable.name, compiler.get_decoration(variable.id, spv::DecorationLocation)});
+        }
+    }
+
+    ShaderReflection reflect_shader(const std::vector<uint32_t>& spirv) {
+        MTR_SCOPE("reflect_shader", "");
+
+        ShaderReflection reflection;
+        if(spirv.empty()) {
+            return reflection;
+        }
+
+        try {
+            const spirv_cross::Compiler compiler(spirv.data(), spirv.size());
+            const spirv_cross::ShaderResources resources = compiler.get_shader_resources();
+
+            reflection.resources.reserve(resources.sampled_images.size() + resources.uniform_buffers.size() +
+                                         resources.storage_buffers.size());
+            add_resources(compiler, resources.sampled_images, ShaderResourceTypeEnum::SampledImage, reflection.resources);
+            add_resources(compiler, resources.uniform_buffers, ShaderResourceTypeEnum::UniformBuffer, reflection.resources);
+            add_resources(compiler, resources.storage_buffers, ShaderResourceTypeEnum::StorageBuffer, reflection.resources);
+
+            // Vulkan only allows one push constant block per stage
+            if(!resources.push_constant_buffers.empty()) {
+                const spirv_cross::Resource& push_constants = resources.push_constant_buffers.front();
+                reflection.push_constants_size = static_cast<uint32_t>(
+                    compiler.get_declared_struct_size(compiler.get_type(push_constants.base_type_id)));
+            }
+
+            add_variables(compiler, resources.stage_inputs, reflection.inputs);
+            add_variables(compiler, resources.stage_outputs, reflection.outputs);
+        }
+        catch(const std::exception& e) {
+            NOVA_LOG(ERROR) << "Could not reflect shader: " << e.what();
+            return {};
+        }
+
+        return reflection;
+    }
+
+    void write_string(const std::string& str, std::vector<uint32_t>& data) {
+        data.push_back(static_cast<uint32_t>(str.size()));
+
+        const size_t first_word = data.size();
+        data.resize(first_word + (str.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t), 0);
+        std::memcpy(data.data() + first_word, str.data(), str.size());
+    }
+
+    void write_variables(const std::vector<ShaderVariableReflection>& variables, std::vector<uint32_t>& data) {
+        data.push_back(static_cast<uint32_t>(variables.size()));
+        for(const ShaderVariableReflection& variable : variables) {
+            write_string(variable.name, data);
+            data.push_back(variable.location);
+        }
+    }
+
+    std::vector<uint32_t> serialize_reflection(const ShaderReflection& reflection) {
+        std::vector<uint32_t> data;
+        data.push_back(REFLECTION_FORMAT_VERSION);
+
+        data.push_back(static_cast<uint32_t>(reflection.resources.size()));
+        for(const ShaderResourceReflection& resource : reflection.resources) {
+            write_string(resource.name, data);
+            data.push_back(resource.set);
+            data.push_back(resource.binding);
+            data.push_back(resource.count);
+            data.push_back(static_cast<uint32_t>(resource.type));
+        }
+
+        data.push_back(reflection.push_constants_size);
+
+        write_variables(reflection.inputs, data);
+        write_variables(reflection.outputs, data);
+
+        return data;
+    }
+
+    /*!
+     * \brief Reads words from a serialized reflection record, and remembers whether it ever tried to read past the end
+     */
+    class ReflectionReader {
+    public:
+        explicit ReflectionReader(const std::vector<uint32_t>& data) : data(data) {}
+
+        uint32_t read_word() {
+            if(position >= data.size()) {
+                failed = true;
+                return 0;
+            }
+
+            return data[position++];
+        }
+
+        std::string read_string() {
+            const uint32_t size = read_word();
+            const size_t num_words = (static_cast<size_t>(size) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+            if(failed || num_words > data.size() - position) {
+                failed = true;
+                return {};
+            }
+
+            std::string str(reinterpret_cast<const char*>(data.data() + position), size);
+            position += num_words;
+
+            return str;
+        }
+
+        void read_variables(std::vector<ShaderVariableReflection>& variables) {
+            const uint32_t num_variables = read_word();
+            for(uint32_t i = 0; i < num_variables && !failed; i++) {
+                ShaderVariableReflection& variable = variables.emplace_back();
+                variable.name = read_string();
+                variable.location = read_word();
+            }
+        }
+
+        [[nodiscard]] bool has_failed() const { return failed; }
+
+        /*!
+         * \brief Whether every read succeeded and the whole record was read
+         */
+        [[nodiscard]] bool is_valid() const { return !failed && position == data.size(); }
+
+    private:
+        const std::vector<uint32_t>& data;
+
+        size_t position = 0;
+
+        bool failed = false;
+    };
+
+    std::optional<ShaderReflection> deserialize_reflection(const std::vector<uint32_t>& data) {
+        ReflectionReader reader(data);
+        if(reader.read_word() != REFLECTION_FORMAT_VERSION) {
+            return {};
+        }
+
+        ShaderReflection reflection;
+
+        const uint32_t num_resources = reader.read_word();
+        for(uint32_t i = 0; i < num_resources && !reader.has_failed(); i++) {
+            ShaderResourceReflection& resource = reflection.resources.emplace_back();
+            resource.name = reader.read_string();
+            resource.set = reader.read_word();
+            resource.binding = reader.read_word();
+            resource.count = reader.read_word();
+
+            const uint32_t type = reader.read_word();
+            if(type > static_cast<uint32_t>(ShaderResourceTypeEnum::StorageBuffer)) {
+                return {};
+            }
+            resource.type = static_cast<ShaderResourceTypeEnum>(type);
+        }
+
+        reflection.push_constants_size = reader.read_word();
+
+        reader.read_variables(reflection.inputs);
+        reader.read_variables(reflection.outputs);
+
+        if(!reader.is_valid()) {
+            return {};
+        }
+
+        return reflection;
+    }
+} // namespace nova::renderer::shaderpack
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "nova_renderer/shaderpack_data.hpp"
+
+namespace nova::renderer::shaderpack {
+    /*!
+     * \brief Reads the resources, push constants, inputs, and outputs of a SPIR-V shader
+     *
+     * This is the only place that Nova parses SPIR-V for reflection. It runs once per shader, when the shader is loaded
+     */
+    [[nodiscard]] ShaderReflection reflect_shader(const std::vector<uint32_t>& spirv);
+
+    /*!
+     * \brief Packs a reflection record into 32-bit words, so that it can be saved next to the shader's SPIR-V
+     */
+    [[nodiscard]] std::vector<uint32_t> serialize_reflection(const ShaderReflection& reflection);
+
+    /*!
+     * \brief Unpacks a reflection record from `serialize_reflection`, or returns an empty optional if the data isn't a valid record
+     */
+    [[nodiscard]] std::optional<ShaderReflection> deserialize_reflection(const std::vector<uint32_t>& data);
+} // namespace nova::renderer::shaderpack
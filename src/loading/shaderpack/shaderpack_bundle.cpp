@@ -0,0 +1,733 @@
+#include "shaderpack_bundle.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <minitrace.h>
+
+#include "nova_renderer/util/platform.hpp"
+
+#ifdef NOVA_WINDOWS
+#include "../../util/windows.hpp"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../util/logger.hpp"
+#include "shader_reflection.hpp"
+
+namespace nova::renderer::shaderpack {
+    /*!
+     * \brief "NSPB" when the bundle is viewed as bytes on a little-endian machine
+     */
+    constexpr uint32_t SHADERPACK_BUNDLE_MAGIC = 0x4250534E;
+
+    /*!
+     * \brief Change this whenever the layout of bundles changes
+     */
+    constexpr uint32_t SHADERPACK_BUNDLE_FORMAT_VERSION = 1;
+
+    /*!
+     * \brief The tables in a bundle, in the order that they're in the header
+     */
+    enum class BundleTableEnum : uint32_t { Textures, Samplers, Passes, Pipelines, Materials, Count };
+
+    /*!
+     * \brief The index of the first word of the table list in the header. The magic number, version, and size come before it
+     */
+    constexpr uint32_t FIRST_TABLE_WORD = 3;
+
+    /*!
+     * \brief Each table in the header is the offset of its entry offsets, then its number of entries
+     */
+    constexpr uint32_t HEADER_SIZE = FIRST_TABLE_WORD + static_cast<uint32_t>(BundleTableEnum::Count) * 2;
+
+    bool is_shaderpack_bundle(const fs::path& shaderpack_path) { return shaderpack_path.extension() == SHADERPACK_BUNDLE_EXTENSION; }
+
+#pragma region Writing
+    /*!
+     * \brief Appends values to a bundle, one or more words at a time
+     */
+    class BundleWriter {
+    public:
+        BundleWriter() : words(HEADER_SIZE, 0) {
+            words[0] = SHADERPACK_BUNDLE_MAGIC;
+            words[1] = SHADERPACK_BUNDLE_FORMAT_VERSION;
+        }
+
+        void write_word(const uint32_t word) { words.push_back(word); }
+
+        void write_float(const float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            write_word(bits);
+        }
+
+        void write_bool(const bool value) { write_word(value ? 1 : 0); }
+
+        template <typename EnumType>
+        void write_enum(const EnumType value) {
+            write_word(static_cast<uint32_t>(value));
+        }
+
+        void write_string(const std::string& str) {
+            write_word(static_cast<uint32_t>(str.size()));
+
+            const size_t first_word = words.size();
+            words.resize(first_word + (str.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t), 0);
+            std::memcpy(words.data() + first_word, str.data(), str.size());
+        }
+
+        void write_strings(const std::vector<std::string>& strings) {
+            write_word(static_cast<uint32_t>(strings.size()));
+            for(const std::string& str : strings) {
+                write_string(str);
+            }
+        }
+
+        void write_optional_string(const std::optional<std::string>& str) {
+            write_bool(str.has_value());
+            if(str) {
+                write_string(*str);
+            }
+        }
+
+        /*!
+         * \brief Writes a map's entries sorted by key, so that baking the same shaderpack twice gives the same bundle
+         */
+        void write_string_map(const std::unordered_map<std::string, std::string>& map) {
+            std::vector<std::pair<std::string, std::string>> entries(map.begin(), map.end());
+            std::sort(entries.begin(), entries.end());
+
+            write_word(static_cast<uint32_t>(entries.size()));
+            for(const auto& [key, value] : entries) {
+                write_string(key);
+                write_string(value);
+            }
+        }
+
+        void write_words(const std::vector<uint32_t>& data) {
+            write_word(static_cast<uint32_t>(data.size()));
+            words.insert(words.end(), data.begin(), data.end());
+        }
+
+        /*!
+         * \brief Writes a table of entries, and fills in the table's place in the header
+         */
+        template <typename EntryType, typename WriteEntryFunc>
+        void write_table(const BundleTableEnum table, const std::vector<EntryType>& entries, WriteEntryFunc&& write_entry) {
+            const uint32_t table_word = FIRST_TABLE_WORD + static_cast<uint32_t>(table) * 2;
+            words[table_word] = static_cast<uint32_t>(words.size());
+            words[table_word + 1] = static_cast<uint32_t>(entries.size());
+
+            // The entry offsets are filled in as the entries are written
+            const size_t first_offset = words.size();
+            words.resize(first_offset + entries.size(), 0);
+
+            for(size_t i = 0; i < entries.size(); i++) {
+                words[first_offset + i] = static_cast<uint32_t>(words.size());
+                write_entry(*this, entries[i]);
+            }
+        }
+
+        [[nodiscard]] std::vector<uint32_t> finish() {
+            words[2] = static_cast<uint32_t>(words.size());
+            return std::move(words);
+        }
+
+    private:
+        std::vector<uint32_t> words;
+    };
+
+    void write_texture(BundleWriter& writer, const TextureCreateInfo& texture) {
+        writer.write_string(texture.name);
+        writer.write_enum(texture.format.pixel_format);
+        writer.write_enum(texture.format.dimension_type);
+        writer.write_float(texture.format.width);
+        writer.write_float(texture.format.height);
+    }
+
+    void write_sampler(BundleWriter& writer, const SamplerCreateInfo& sampler) {
+        writer.write_string(sampler.name);
+        writer.write_enum(sampler.filter);
+        writer.write_enum(sampler.wrap_mode);
+    }
+
+    void write_attachment(BundleWriter& writer, const TextureAttachmentInfo& attachment) {
+        writer.write_string(attachment.name);
+        writer.write_enum(attachment.pixel_format);
+        writer.write_bool(attachment.clear);
+    }
+
+    void write_pass(BundleWriter& writer, const RenderPassCreateInfo& pass) {
+        writer.write_string(pass.name);
+        writer.write_strings(pass.dependencies);
+        writer.write_strings(pass.texture_inputs);
+
+        writer.write_word(static_cast<uint32_t>(pass.texture_outputs.size()));
+        for(const TextureAttachmentInfo& attachment : pass.texture_outputs) {
+            write_attachment(writer, attachment);
+        }
+
+        writer.write_bool(pass.depth_texture.has_value());
+        if(pass.depth_texture) {
+            write_attachment(writer, *pass.depth_texture);
+        }
+
+        writer.write_strings(pass.input_buffers);
+        writer.write_strings(pass.output_buffers);
+    }
+
+    void write_stencil_op_state(BundleWriter& writer, const std::optional<StencilOpState>& state) {
+        writer.write_bool(state.has_value());
+        if(state) {
+            writer.write_enum(state->fail_op);
+            writer.write_enum(state->pass_op);
+            writer.write_enum(state->depth_fail_op);
+            writer.write_enum(state->compare_op);
+            writer.write_word(state->compare_mask);
+            writer.write_word(state->write_mask);
+        }
+    }
+
+    void write_shader(BundleWriter& writer, const ShaderSource& shader) {
+        writer.write_string(shader.filename.string());
+        writer.write_words(shader.source);
+        writer.write_words(serialize_reflection(shader.reflection));
+    }
+
+    void write_optional_shader(BundleWriter& writer, const std::optional<ShaderSource>& shader) {
+        writer.write_bool(shader.has_value());
+        if(shader) {
+            write_shader(writer, *shader);
+        }
+    }
+
+    void write_pipeline(BundleWriter& writer, const PipelineCreateInfo& pipeline) {
+        writer.write_string(pipeline.name);
+        writer.write_optional_string(pipeline.parent_name);
+        writer.write_string(pipeline.pass);
+        writer.write_strings(pipeline.defines);
+
+        writer.write_word(static_cast<uint32_t>(pipeline.permutations.size()));
+        for(const PipelinePermutation& permutation : pipeline.permutations) {
+            writer.write_string(permutation.name);
+            writer.write_strings(permutation.values);
+        }
+
+        writer.write_bool(pipeline.compile_on_first_use);
+
+        writer.write_word(static_cast<uint32_t>(pipeline.states.size()));
+        for(const StateEnum state : pipeline.states) {
+            writer.write_enum(state);
+        }
+
+        writer.write_word(static_cast<uint32_t>(pipeline.vertex_fields.size()));
+        for(const VertexFieldData& vertex_field : pipeline.vertex_fields) {
+            writer.write_string(vertex_field.semantic_name);
+            writer.write_enum(vertex_field.field);
+        }
+
+        write_stencil_op_state(writer, pipeline.front_face);
+        write_stencil_op_state(writer, pipeline.back_face);
+        writer.write_optional_string(pipeline.fallback);
+
+        writer.write_float(pipeline.depth_bias);
+        writer.write_float(pipeline.slope_scaled_depth_bias);
+        writer.write_word(pipeline.stencil_ref);
+        writer.write_word(pipeline.stencil_read_mask);
+        writer.write_word(pipeline.stencil_write_mask);
+        writer.write_enum(pipeline.msaa_support);
+        writer.write_enum(pipeline.primitive_mode);
+        writer.write_enum(pipeline.source_blend_factor);
+        writer.write_enum(pipeline.destination_blend_factor);
+        writer.write_enum(pipeline.alpha_src);
+        writer.write_enum(pipeline.alpha_dst);
+        writer.write_enum(pipeline.depth_func);
+        writer.write_enum(pipeline.render_queue);
+
+        write_shader(writer, pipeline.vertex_shader);
+        write_optional_shader(writer, pipeline.geometry_shader);
+        write_optional_shader(writer, pipeline.tessellation_control_shader);
+        write_optional_shader(writer, pipeline.tessellation_evaluation_shader);
+        write_optional_shader(writer, pipeline.fragment_shader);
+    }
+
+    void write_material(BundleWriter& writer, const MaterialData& material) {
+        writer.write_string(material.name);
+        writer.write_string(material.geometry_filter);
+
+        writer.write_word(static_cast<uint32_t>(material.passes.size()));
+        for(const MaterialPass& pass : material.passes) {
+            writer.write_string(pass.name);
+            writer.write_string(pass.material_name);
+            writer.write_string(pass.pipeline);
+            writer.write_string_map(pass.bindings);
+            writer.write_string_map(pass.permutation);
+        }
+    }
+
+    std::vector<uint32_t> serialize_shaderpack_bundle(const ShaderpackData& data) {
+        MTR_SCOPE("serialize_shaderpack_bundle", "");
+
+        BundleWriter writer;
+        writer.write_table(BundleTableEnum::Textures, data.resources.textures, write_texture);
+        writer.write_table(BundleTableEnum::Samplers, data.resources.samplers, write_sampler);
+        writer.write_table(BundleTableEnum::Passes, data.passes, write_pass);
+        writer.write_table(BundleTableEnum::Pipelines, data.pipelines, write_pipeline);
+        writer.write_table(BundleTableEnum::Materials, data.materials, write_material);
+
+        return writer.finish();
+    }
+#pragma endregion
+
+#pragma region Reading
+    /*!
+     * \brief Reads values from one entry of a bundle, and remembers whether any of them were invalid or past the end of the bundle
+     */
+    class BundleReader {
+    public:
+        BundleReader(const uint32_t* words, const size_t num_words, const size_t position)
+            : words(words), num_words(num_words), position(position) {}
+
+        uint32_t read_word() {
+            if(position >= num_words) {
+                failed = true;
+                return 0;
+            }
+
+            return words[position++];
+        }
+
+        float read_float() {
+            const uint32_t bits = read_word();
+
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        bool read_bool() {
+            const uint32_t value = read_word();
+            if(value > 1) {
+                failed = true;
+            }
+
+            return value == 1;
+        }
+
+        template <typename EnumType>
+        EnumType read_enum(const EnumType last_value) {
+            const uint32_t value = read_word();
+            if(value > static_cast<uint32_t>(last_value)) {
+                failed = true;
+                return last_value;
+            }
+
+            return static_cast<EnumType>(value);
+        }
+
+        /*!
+         * \brief Reads the number of things in a list. Every thing is at least one word, so there can't be more of them than the
+         * words that are left
+         */
+        uint32_t read_count() {
+            const uint32_t count = read_word();
+            if(failed || count > num_words - position) {
+                failed = true;
+                return 0;
+            }
+
+            return count;
+        }
+
+        std::string read_string() {
+            const uint32_t size = read_word();
+            const size_t string_words = (static_cast<size_t>(size) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+            if(failed || string_words > num_words - position) {
+                failed = true;
+                return {};
+            }
+
+            std::string str(reinterpret_cast<const char*>(words + position), size);
+            position += string_words;
+
+            return str;
+        }
+
+        std::vector<std::string> read_strings() {
+            std::vector<std::string> strings(read_count());
+            for(std::string& str : strings) {
+                str = read_string();
+            }
+
+            return strings;
+        }
+
+        std::optional<std::string> read_optional_string() {
+            if(!read_bool()) {
+                return {};
+            }
+
+            return read_string();
+        }
+
+        std::unordered_map<std::string, std::string> read_string_map() {
+            const uint32_t num_entries = read_count();
+
+            std::unordered_map<std::string, std::string> map;
+            map.reserve(num_entries);
+            for(uint32_t i = 0; i < num_entries && !failed; i++) {
+                std::string key = read_string();
+                map.emplace(std::move(key), read_string());
+            }
+
+            return map;
+        }
+
+        std::vector<uint32_t> read_words() {
+            const uint32_t num_data_words = read_count();
+            if(failed) {
+                return {};
+            }
+
+            std::vector<uint32_t> data(words + position, words + position + num_data_words);
+            position += num_data_words;
+
+            return data;
+        }
+
+        void fail() { failed = true; }
+
+        [[nodiscard]] bool has_failed() const { return failed; }
+
+    private:
+        const uint32_t* words;
+
+        size_t num_words;
+
+        size_t position;
+
+        bool failed = false;
+    };
+
+    /*!
+     * \brief Reads every entry of a table, starting each entry at the offset that the table has for it
+     *
+     * \return True if every entry was valid, false if any weren't
+     */
+    template <typename EntryType, typename ReadEntryFunc>
+    bool read_table(const uint32_t* words,
+                    const size_t num_words,
+                    const BundleTableEnum table,
+                    std::vector<EntryType>& entries,
+                    ReadEntryFunc&& read_entry) {
+        const uint32_t table_word = FIRST_TABLE_WORD + static_cast<uint32_t>(table) * 2;
+        const size_t first_offset = words[table_word];
+        const size_t num_entries = words[table_word + 1];
+        if(first_offset > num_words || num_entries > num_words - first_offset) {
+            return false;
+        }
+
+        entries.resize(num_entries);
+        for(size_t i = 0; i < num_entries; i++) {
+            BundleReader reader(words, num_words, words[first_offset + i]);
+            read_entry(reader, entries[i]);
+            if(reader.has_failed()) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void read_texture(BundleReader& reader, TextureCreateInfo& texture) {
+        texture.name = reader.read_string();
+        texture.format.pixel_format = reader.read_enum(PixelFormatEnum::DepthStencil);
+        texture.format.dimension_type = reader.read_enum(TextureDimensionTypeEnum::Absolute);
+        texture.format.width = reader.read_float();
+        texture.format.height = reader.read_float();
+    }
+
+    void read_sampler(BundleReader& reader, SamplerCreateInfo& sampler) {
+        sampler.name = reader.read_string();
+        sampler.filter = reader.read_enum(TextureFilterEnum::Point);
+        sampler.wrap_mode = reader.read_enum(WrapModeEnum::Clamp);
+    }
+
+    TextureAttachmentInfo read_attachment(BundleReader& reader) {
+        TextureAttachmentInfo attachment;
+        attachment.name = reader.read_string();
+        attachment.pixel_format = reader.read_enum(PixelFormatEnum::DepthStencil);
+        attachment.clear = reader.read_bool();
+
+        return attachment;
+    }
+
+    void read_pass(BundleReader& reader, RenderPassCreateInfo& pass) {
+        pass.name = reader.read_string();
+        pass.dependencies = reader.read_strings();
+        pass.texture_inputs = reader.read_strings();
+
+        pass.texture_outputs.resize(reader.read_count());
+        for(TextureAttachmentInfo& attachment : pass.texture_outputs) {
+            attachment = read_attachment(reader);
+        }
+
+        if(reader.read_bool()) {
+            pass.depth_texture = read_attachment(reader);
+        }
+
+        pass.input_buffers = reader.read_strings();
+        pass.output_buffers = reader.read_strings();
+    }
+
+    std::optional<StencilOpState> read_stencil_op_state(BundleReader& reader) {
+        if(!reader.read_bool()) {
+            return {};
+        }
+
+        StencilOpState state;
+        state.fail_op = reader.read_enum(StencilOpEnum::Invert);
+        state.pass_op = reader.read_enum(StencilOpEnum::Invert);
+        state.depth_fail_op = reader.read_enum(StencilOpEnum::Invert);
+        state.compare_op = reader.read_enum(CompareOpEnum::Always);
+        state.compare_mask = reader.read_word();
+        state.write_mask = reader.read_word();
+
+        return state;
+    }
+
+    ShaderSource read_shader(BundleReader& reader) {
+        ShaderSource shader;
+        shader.filename = reader.read_string();
+        shader.source = reader.read_words();
+
+        std::optional<ShaderReflection> reflection = deserialize_reflection(reader.read_words());
+        if(reflection) {
+            shader.reflection = std::move(*reflection);
+        } else {
+            reader.fail();
+        }
+
+        return shader;
+    }
+
+    std::optional<ShaderSource> read_optional_shader(BundleReader& reader) {
+        if(!reader.read_bool()) {
+            return {};
+        }
+
+        return read_shader(reader);
+    }
+
+    void read_pipeline(BundleReader& reader, PipelineCreateInfo& pipeline) {
+        pipeline.name = reader.read_string();
+        pipeline.parent_name = reader.read_optional_string();
+        pipeline.pass = reader.read_string();
+        pipeline.defines = reader.read_strings();
+
+        pipeline.permutations.resize(reader.read_count());
+        for(PipelinePermutation& permutation : pipeline.permutations) {
+            permutation.name = reader.read_string();
+            permutation.values = reader.read_strings();
+        }
+
+        pipeline.compile_on_first_use = reader.read_bool();
+
+        pipeline.states.resize(reader.read_count());
+        for(StateEnum& state : pipeline.states) {
+            state = reader.read_enum(StateEnum::DisableAlphaWrite);
+        }
+
+        pipeline.vertex_fields.resize(reader.read_count());
+        for(VertexFieldData& vertex_field : pipeline.vertex_fields) {
+            vertex_field.semantic_name = reader.read_string();
+            vertex_field.field = reader.read_enum(VertexFieldEnum::InstanceCustomData);
+        }
+
+        pipeline.front_face = read_stencil_op_state(reader);
+        pipeline.back_face = read_stencil_op_state(reader);
+        pipeline.fallback = reader.read_optional_string();
+
+        pipeline.depth_bias = reader.read_float();
+        pipeline.slope_scaled_depth_bias = reader.read_float();
+        pipeline.stencil_ref = reader.read_word();
+        pipeline.stencil_read_mask = reader.read_word();
+        pipeline.stencil_write_mask = reader.read_word();
+        pipeline.msaa_support = reader.read_enum(MsaaSupportEnum::None);
+        pipeline.primitive_mode = reader.read_enum(PrimitiveTopologyEnum::Lines);
+        pipeline.source_blend_factor = reader.read_enum(BlendFactorEnum::OneMinusDstAlpha);
+        pipeline.destination_blend_factor = reader.read_enum(BlendFactorEnum::OneMinusDstAlpha);
+        pipeline.alpha_src = reader.read_enum(BlendFactorEnum::OneMinusDstAlpha);
+        pipeline.alpha_dst = reader.read_enum(BlendFactorEnum::OneMinusDstAlpha);
+        pipeline.depth_func = reader.read_enum(CompareOpEnum::Always);
+        pipeline.render_queue = reader.read_enum(RenderQueueEnum::Cutout);
+
+        pipeline.vertex_shader = read_shader(reader);
+        pipeline.geometry_shader = read_optional_shader(reader);
+        pipeline.tessellation_control_shader = read_optional_shader(reader);
+        pipeline.tessellation_evaluation_shader = read_optional_shader(reader);
+        pipeline.fragment_shader = read_optional_shader(reader);
+    }
+
+    void read_material(BundleReader& reader, MaterialData& material) {
+        material.name = reader.read_string();
+        material.geometry_filter = reader.read_string();
+
+        material.passes.resize(reader.read_count());
+        for(MaterialPass& pass : material.passes) {
+            pass.name = reader.read_string();
+            pass.material_name = reader.read_string();
+            pass.pipeline = reader.read_string();
+            pass.bindings = reader.read_string_map();
+            pass.permutation = reader.read_string_map();
+        }
+    }
+
+    std::optional<ShaderpackData> deserialize_shaderpack_bundle(const uint32_t* words, const size_t num_words) {
+        MTR_SCOPE("deserialize_shaderpack_bundle", "");
+
+        if(num_words < HEADER_SIZE || words[0] != SHADERPACK_BUNDLE_MAGIC || words[1] != SHADERPACK_BUNDLE_FORMAT_VERSION ||
+           words[2] != num_words) {
+            return {};
+        }
+
+        ShaderpackData data;
+        if(!read_table(words, num_words, BundleTableEnum::Textures, data.resources.textures, read_texture) ||
+           !read_table(words, num_words, BundleTableEnum::Samplers, data.resources.samplers, read_sampler) ||
+           !read_table(words, num_words, BundleTableEnum::Passes, data.passes, read_pass) ||
+           !read_table(words, num_words, BundleTableEnum::Pipelines, data.pipelines, read_pipeline) ||
+           !read_table(words, num_words, BundleTableEnum::Materials, data.materials, read_material)) {
+            return {};
+        }
+
+        return data;
+    }
+#pragma endregion
+
+    bool write_shaderpack_bundle(const ShaderpackData& data, const fs::path& bundle_path) {
+        for(const PipelineCreateInfo& pipeline : data.pipelines) {
+            if(pipeline.compile_on_first_use || pipeline.vertex_shader.source.empty()) {
+                NOVA_LOG(ERROR) << "Pipeline " << pipeline.name << " hasn't been compiled, so it can't be put in a shaderpack bundle";
+                return false;
+            }
+        }
+
+        const std::vector<uint32_t> words = serialize_shaderpack_bundle(data);
+
+        std::ofstream file(bundle_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(uint32_t)));
+        if(!file.good()) {
+            NOVA_LOG(ERROR) << "Could not write shaderpack bundle " << bundle_path.string();
+            return false;
+        }
+
+        return true;
+    }
+
+    /*!
+     * \brief A read-only view of a whole file, which the OS pages in as it's read
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const fs::path& path);
+
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+
+        ~MappedFile();
+
+        /*!
+         * \brief The file's data, or nullptr if it couldn't be mapped. Mapped files always start on a page boundary
+         */
+        [[nodiscard]] const void* get_data() const { return data; }
+
+        [[nodiscard]] size_t get_size() const { return size; }
+
+    private:
+        void* data = nullptr;
+
+        size_t size = 0;
+    };
+
+#ifdef NOVA_WINDOWS
+    MappedFile::MappedFile(const fs::path& path) {
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER file_size;
+        if(GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+            // The view keeps the mapping and the file open, so their handles can be closed right away
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping != nullptr) {
+                data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                size = data != nullptr ? static_cast<size_t>(file_size.QuadPart) : 0;
+                CloseHandle(mapping);
+            }
+        }
+
+        CloseHandle(file);
+    }
+
+    MappedFile::~MappedFile() {
+        if(data != nullptr) {
+            UnmapViewOfFile(data);
+        }
+    }
+
+#else
+    MappedFile::MappedFile(const fs::path& path) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) {
+            return;
+        }
+
+        struct stat file_stats {};
+        if(fstat(fd, &file_stats) == 0 && file_stats.st_size > 0) {
+            // The mapping keeps the file open, so its descriptor can be closed right away
+            void* mapped_data = mmap(nullptr, static_cast<size_t>(file_stats.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped_data != MAP_FAILED) {
+                data = mapped_data;
+                size = static_cast<size_t>(file_stats.st_size);
+            }
+        }
+
+        close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if(data != nullptr) {
+            munmap(data, size);
+        }
+    }
+#endif
+
+    std::optional<ShaderpackData> load_shaderpack_bundle(const fs::path& bundle_path) {
+        MTR_SCOPE("ShaderpackLoading", "load_shaderpack_bundle");
+
+        const MappedFile file(bundle_path);
+        if(file.get_data() == nullptr) {
+            NOVA_LOG(ERROR) << "Could not map shaderpack bundle " << bundle_path.string() << " into memory";
+            return {};
+        }
+
+        std::optional<ShaderpackData> data;
+        if(file.get_size() % sizeof(uint32_t) == 0) {
+            data = deserialize_shaderpack_bundle(static_cast<const uint32_t*>(file.get_data()), file.get_size() / sizeof(uint32_t));
+        }
+
+        if(!data) {
+            NOVA_LOG(ERROR) << "Shaderpack bundle " << bundle_path.string()
+                            << " isn't valid. It may have been baked by a different version of Nova, and should be baked again";
+        }
+
+        return data;
+    }
+} // namespace nova::renderer::shaderpack
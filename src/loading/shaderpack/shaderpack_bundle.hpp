@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "nova_renderer/shaderpack_data.hpp"
+#include "nova_renderer/util/filesystem.hpp"
+
+namespace nova::renderer::shaderpack {
+    /*!
+     * \brief The extension of baked shaderpack bundles
+     */
+    constexpr const char* SHADERPACK_BUNDLE_EXTENSION = ".novapack";
+
+    /*!
+     * \brief Checks if a shaderpack path is a baked shaderpack bundle, instead of a folder or a zip file
+     */
+    [[nodiscard]] bool is_shaderpack_bundle(const fs::path& shaderpack_path);
+
+    /*!
+     * \brief Packs a loaded shaderpack into a bundle, which can be loaded without parsing any JSON or compiling any shaders
+     *
+     * The bundle is a header, then one table for each of the shaderpack's resources, passes, pipelines, and materials. Each table has
+     * the offset of each of its entries, so the entries can be read straight out of a mapped file. Every pipeline must have its SPIR-V
+     * and reflection already, so variants that are compiled on first use have to be compiled before they're bundled
+     *
+     * Bundles store words in the byte order of the machine that baked them, so they should be baked for each platform they're loaded on
+     */
+    [[nodiscard]] std::vector<uint32_t> serialize_shaderpack_bundle(const ShaderpackData& data);
+
+    /*!
+     * \brief Unpacks a bundle from `serialize_shaderpack_bundle`, or returns an empty optional if the words aren't a valid bundle
+     *
+     * The words are read in place. Nothing is copied out of them except what ends up in the shaderpack data
+     */
+    [[nodiscard]] std::optional<ShaderpackData> deserialize_shaderpack_bundle(const uint32_t* words, size_t num_words);
+
+    /*!
+     * \brief Writes a shaderpack to a bundle file
+     *
+     * \return True if the bundle was written, false if it couldn't be. Errors are logged
+     */
+    [[nodiscard]] bool write_shaderpack_bundle(const ShaderpackData& data, const fs::path& bundle_path);
+
+    /*!
+     * \brief Maps a bundle file into memory and reads the shaderpack from it
+     *
+     * \return The shaderpack, or an empty optional if the file can't be read or isn't a valid bundle. Errors are logged
+     */
+    [[nodiscard]] std::optional<ShaderpackData> load_shaderpack_bundle(const fs::path& bundle_path);
+} // namespace nova::renderer::shaderpack
@@ -1,5 +1,7 @@
 #include "nova_renderer/shaderpack_data.hpp"
 
+#include <algorithm>
+
 #include "../json_utils.hpp"
 
 namespace nova::renderer::shaderpack {
@@ -16,6 +18,10 @@ namespace nova::renderer::shaderpack {
 
     bool TextureFormat::operator!=(const TextureFormat& other) const { return !(*this == other); }
 
+    bool TextureCreateInfo::operator==(const TextureCreateInfo& other) const { return name == other.name && format == other.format; }
+
+    bool TextureCreateInfo::operator!=(const TextureCreateInfo& other) const { return !(*this == other); }
+
     bool TextureAttachmentInfo::operator==(const TextureAttachmentInfo& other) const { return other.name == name; }
 
     glm::uvec2 TextureFormat::get_size_in_pixels(const glm::uvec2& screen_size) const {
@@ -292,6 +298,18 @@ namespace nova::renderer::shaderpack {
         if(str == "McEntityId") {
             return VertexFieldEnum::McEntityId;
         }
+        if(str == "InstanceTint") {
+            return VertexFieldEnum::InstanceTint;
+        }
+        if(str == "InstanceAnimationFrame") {
+            return VertexFieldEnum::InstanceAnimationFrame;
+        }
+        if(str == "InstanceLightLevel") {
+            return VertexFieldEnum::InstanceLightLevel;
+        }
+        if(str == "InstanceCustomData") {
+            return VertexFieldEnum::InstanceCustomData;
+        }
 
         NOVA_LOG(ERROR) << "Unsupported vertex field " << str.c_str();
         return {};
@@ -559,6 +577,18 @@ namespace nova::renderer::shaderpack {
 
             case VertexFieldEnum::McEntityId:
                 return "McEntityId";
+
+            case VertexFieldEnum::InstanceTint:
+                return "InstanceTint";
+
+            case VertexFieldEnum::InstanceAnimationFrame:
+                return "InstanceAnimationFrame";
+
+            case VertexFieldEnum::InstanceLightLevel:
+                return "InstanceLightLevel";
+
+            case VertexFieldEnum::InstanceCustomData:
+                return "InstanceCustomData";
         }
 
         return "Unknown value";
@@ -585,4 +615,162 @@ namespace nova::renderer::shaderpack {
                 return 32;
         }
     }
+
+    bool is_per_instance_field(const VertexFieldEnum field) {
+        switch(field) {
+            case VertexFieldEnum::InstanceTint:
+            case VertexFieldEnum::InstanceAnimationFrame:
+            case VertexFieldEnum::InstanceLightLevel:
+            case VertexFieldEnum::InstanceCustomData:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    /*!
+     * \brief Sets the merged value to the child's value, if the child's value isn't the default
+     */
+    template <typename ValueType>
+    void merge_value(ValueType& merged_value, const ValueType& child_value, const ValueType& default_value) {
+        if(child_value != default_value) {
+            merged_value = child_value;
+        }
+    }
+
+    PipelineCreateInfo PipelineCreateInfo::merge_with_parent(const PipelineCreateInfo& parent_pipeline) const {
+        PipelineCreateInfo merged = parent_pipeline;
+        merged.name = name;
+        merged.parent_name = parent_pipeline.name;
+
+        if(!pass.empty()) {
+            merged.pass = pass;
+        }
+
+        merged.defines.insert(merged.defines.end(), defines.begin(), defines.end());
+
+        if(!permutations.empty()) {
+            merged.permutations = permutations;
+        }
+        if(!states.empty()) {
+            merged.states = states;
+        }
+        if(!vertex_fields.empty()) {
+            merged.vertex_fields = vertex_fields;
+        }
+        if(front_face) {
+            merged.front_face = front_face;
+        }
+        if(back_face) {
+            merged.back_face = back_face;
+        }
+        if(fallback && !fallback->empty()) {
+            merged.fallback = fallback;
+        }
+
+        merge_value(merged.compile_on_first_use, compile_on_first_use, default_pipeline.compile_on_first_use);
+        merge_value(merged.depth_bias, depth_bias, default_pipeline.depth_bias);
+        merge_value(merged.slope_scaled_depth_bias, slope_scaled_depth_bias, default_pipeline.slope_scaled_depth_bias);
+        merge_value(merged.stencil_ref, stencil_ref, default_pipeline.stencil_ref);
+        merge_value(merged.stencil_read_mask, stencil_read_mask, default_pipeline.stencil_read_mask);
+        merge_value(merged.stencil_write_mask, stencil_write_mask, default_pipeline.stencil_write_mask);
+        merge_value(merged.msaa_support, msaa_support, default_pipeline.msaa_support);
+        merge_value(merged.primitive_mode, primitive_mode, default_pipeline.primitive_mode);
+        merge_value(merged.source_blend_factor, source_blend_factor, default_pipeline.source_blend_factor);
+        merge_value(merged.destination_blend_factor, destination_blend_factor, default_pipeline.destination_blend_factor);
+        merge_value(merged.alpha_src, alpha_src, default_pipeline.alpha_src);
+        merge_value(merged.alpha_dst, alpha_dst, default_pipeline.alpha_dst);
+        merge_value(merged.depth_func, depth_func, default_pipeline.depth_func);
+        merge_value(merged.render_queue, render_queue, default_pipeline.render_queue);
+
+        if(!vertex_shader.filename.empty()) {
+            merged.vertex_shader = vertex_shader;
+        }
+        if(geometry_shader) {
+            merged.geometry_shader = geometry_shader;
+        }
+        if(tessellation_control_shader) {
+            merged.tessellation_control_shader = tessellation_control_shader;
+        }
+        if(tessellation_evaluation_shader) {
+            merged.tessellation_evaluation_shader = tessellation_evaluation_shader;
+        }
+        if(fragment_shader) {
+            merged.fragment_shader = fragment_shader;
+        }
+
+        return merged;
+    }
+
+    /*!
+     * \brief Finds the value of a permutation, or its default value if it isn't in the permutation values or doesn't have that value
+     */
+    const std::string& get_permutation_value(const PipelinePermutation& permutation,
+                                             const std::unordered_map<std::string, std::string>& permutation_values) {
+        if(const auto itr = permutation_values.find(permutation.name); itr != permutation_values.end()) {
+            if(std::find(permutation.values.begin(), permutation.values.end(), itr->second) != permutation.values.end()) {
+                return itr->second;
+            }
+        }
+
+        return permutation.values.front();
+    }
+
+    std::string get_pipeline_variant_name(const PipelineCreateInfo& pipeline,
+                                          const std::unordered_map<std::string, std::string>& permutation) {
+        std::string name = pipeline.name;
+
+        bool has_non_default_values = false;
+        for(const PipelinePermutation& pipeline_permutation : pipeline.permutations) {
+            const std::string& value = get_permutation_value(pipeline_permutation, permutation);
+            if(value == pipeline_permutation.values.front()) {
+                continue;
+            }
+
+            name += has_non_default_values ? "," : "[";
+            name += pipeline_permutation.name + "=" + value;
+            has_non_default_values = true;
+        }
+
+        if(has_non_default_values) {
+            name += "]";
+        }
+
+        return name;
+    }
+
+    PipelineCreateInfo make_pipeline_variant(const PipelineCreateInfo& pipeline,
+                                             const std::unordered_map<std::string, std::string>& permutation) {
+        PipelineCreateInfo variant_info;
+        variant_info.name = get_pipeline_variant_name(pipeline, permutation);
+        variant_info.compile_on_first_use = variant_info.name != pipeline.name;
+        if(variant_info.compile_on_first_use) {
+            variant_info.fallback = pipeline.fallback && !pipeline.fallback->empty() ? *pipeline.fallback : pipeline.name;
+        }
+
+        variant_info.defines.reserve(pipeline.permutations.size());
+        for(const PipelinePermutation& pipeline_permutation : pipeline.permutations) {
+            variant_info.defines.push_back(pipeline_permutation.name + " " + get_permutation_value(pipeline_permutation, permutation));
+        }
+
+        PipelineCreateInfo variant = variant_info.merge_with_parent(pipeline);
+
+        // The variant's shaders have different defines, so any SPIR-V that the pipeline has isn't the variant's
+        const auto clear_spirv = [](ShaderSource& shader) {
+            shader.source.clear();
+            shader.reflection = {};
+        };
+        clear_spirv(variant.vertex_shader);
+        for(std::optional<ShaderSource>* shader : {&variant.geometry_shader,
+                                                   &variant.tessellation_control_shader,
+                                                   &variant.tessellation_evaluation_shader,
+                                                   &variant.fragment_shader}) {
+            if(*shader) {
+                clear_spirv(**shader);
+            }
+        }
+
+        return variant;
+    }
 } // namespace nova::renderer::shaderpack
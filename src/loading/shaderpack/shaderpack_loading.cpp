@@ -5,6 +5,11 @@
 
 #include "shaderpack_loading.hpp"
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
 #include <glslang/Include/ResourceLimits.h>
 #include <glslang/Public/ShaderLang.h>
 
@@ -17,6 +22,11 @@
 #include "SPIRV/GlslangToSpv.h"
 #include "json_interop.hpp"
 #include "render_graph_builder.hpp"
+#include "shader_cache.hpp"
+#include "shader_includer.hpp"
+#include "shader_optimizer.hpp"
+#include "shader_reflection.hpp"
+#include "shaderpack_bundle.hpp"
 #include "shaderpack_validator.hpp"
 
 namespace nova::renderer::shaderpack {
@@ -127,24 +137,95 @@ namespace nova::renderer::shaderpack {
             /* .generalConstantMatrixVectorIndexing = */ true,
         }};
 
-    std::shared_ptr<FolderAccessorBase> get_shaderpack_accessor(const fs::path& shaderpack_name);
+    /*!
+     * \brief One shader stage of one pipeline. Each stage is loaded as its own task
+     */
+    struct ShaderLoadTask {
+        ShaderSource* shader;
 
-    ShaderpackResourcesData load_dynamic_resources_file(const std::shared_ptr<FolderAccessorBase>& folder_access);
+        EShLanguage stage;
 
-    ntl::Result<std::vector<RenderPassCreateInfo>> load_passes_file(const std::shared_ptr<FolderAccessorBase>& folder_access);
+        uint32_t pipeline_index;
 
-    std::vector<PipelineCreateInfo> load_pipeline_files(const std::shared_ptr<FolderAccessorBase>& folder_access);
-    PipelineCreateInfo load_single_pipeline(const std::shared_ptr<FolderAccessorBase>& folder_access, const fs::path& pipeline_path);
+        ValidationReport report;
+    };
 
-    std::vector<MaterialData> load_material_files(const std::shared_ptr<FolderAccessorBase>& folder_access);
-    MaterialData load_single_material(const std::shared_ptr<FolderAccessorBase>& folder_access, const fs::path& material_path);
+    std::shared_ptr<FolderAccessorBase> get_shaderpack_accessor(const fs::path& shaderpack_name);
+
+    /*!
+     * \brief Runs every task on the scheduler and waits for them all to finish, or runs them on this thread if the scheduler is nullptr
+     */
+    void run_tasks(ttl::task_scheduler* scheduler, const std::vector<std::function<void()>>& tasks);
 
-    std::vector<uint32_t> load_shader_file(const fs::path& filename,
-                                           const std::shared_ptr<FolderAccessorBase>& folder_access,
-                                           EShLanguage stage,
-                                           const std::vector<std::string>& defines);
+    ShaderpackResourcesData load_dynamic_resources_file(const std::shared_ptr<FolderAccessorBase>& folder_access,
+                                                        ValidationReport& report);
 
-    bool loading_failed = false;
+    ntl::Result<std::vector<RenderPassCreateInfo>> load_passes_file(const std::shared_ptr<FolderAccessorBase>& folder_access);
+
+    /*!
+     * \brief Finds the files in a folder that have the given extension, sorted by name so that they're always loaded in the same order
+     */
+    std::vector<fs::path> find_files_with_extension(const std::shared_ptr<FolderAccessorBase>& folder_access,
+                                                    const fs::path& folder,
+                                                    const std::string& extension);
+
+    /*!
+     * \brief Loads a pipeline's JSON, without its shaders
+     */
+    PipelineCreateInfo load_single_pipeline(const std::shared_ptr<FolderAccessorBase>& folder_access,
+                                            const fs::path& pipeline_path,
+                                            ValidationReport& report);
+
+    void add_shader_load_tasks(PipelineCreateInfo& pipeline, uint32_t pipeline_index, std::vector<ShaderLoadTask>& tasks);
+
+    /*!
+     * \brief Compiles the shaders of a single pipeline on this thread
+     */
+    void load_pipeline_shaders(PipelineCreateInfo& pipeline,
+                               const std::shared_ptr<FolderAccessorBase>& folder_access,
+                               ShaderIncludeCache& include_cache,
+                               ShaderCache* shader_cache,
+                               ShaderOptimizer* shader_optimizer,
+                               ValidationReport& report);
+
+    /*!
+     * \brief Adds the pipeline variants that the material passes use to the shaderpack, and points the material passes at them
+     *
+     * Pipelines with permutations become the variant with every permutation's default value. The other variants are added after
+     * every pipeline that was loaded from a file, and aren't compiled until they're first used
+     */
+    void add_pipeline_variants(ShaderpackData& data, std::vector<ValidationReport>& material_reports);
+
+    MaterialData load_single_material(const std::shared_ptr<FolderAccessorBase>& folder_access,
+                                      const fs::path& material_path,
+                                      ValidationReport& report);
+
+    /*!
+     * \brief Loads the SPIR-V of a shader and its reflection record, from the shader cache if it has them
+     *
+     * Newly compiled shaders are run through the optimizer, if there is one, before they're saved to the cache. The files that the
+     * shader includes are read from the include cache, and are part of the shader's cache key
+     */
+    void load_shader_file(ShaderSource& shader,
+                          const std::shared_ptr<FolderAccessorBase>& folder_access,
+                          ShaderIncludeCache& include_cache,
+                          EShLanguage stage,
+                          const std::vector<std::string>& defines,
+                          ShaderCache* shader_cache,
+                          ShaderOptimizer* shader_optimizer,
+                          ValidationReport& report);
+
+    /*!
+     * \brief Compiles a shader, with `#include`s resolved by the includer. If the includer is nullptr, the shader can't include anything
+     */
+    std::vector<uint32_t> compile_shader_source(const std::string& source,
+                                                EShLanguage stage,
+                                                glslang::EShSource language,
+                                                const std::string& name,
+                                                ShaderIncluder* includer,
+                                                ValidationReport& report);
+
+    std::atomic<bool> loading_failed{false};
 
     void fill_in_render_target_formats(ShaderpackData& data) {
         const auto& textures = data.resources.textures;
@@ -182,10 +263,35 @@ namespace nova::renderer::shaderpack {
         }
     }
 
-    ShaderpackData load_shaderpack_data(const fs::path& shaderpack_name) {
+    void initialize_glslang() {
+        static std::once_flag glslang_initialized;
+        std::call_once(glslang_initialized, [] { glslang::InitializeProcess(); });
+    }
+
+    ShaderpackData load_shaderpack_data(const fs::path& shaderpack_name,
+                                        ShaderCache* shader_cache,
+                                        ttl::task_scheduler* scheduler,
+                                        ShaderOptimizer* shader_optimizer) {
         loading_failed = false;
+
+        // Bundles were loaded and compiled when they were baked, so they don't need glslang
+        if(is_shaderpack_bundle(shaderpack_name)) {
+            std::optional<ShaderpackData> data = load_shaderpack_bundle(shaderpack_name);
+            if(!data) {
+                loading_failed = true;
+                return {};
+            }
+
+            return std::move(*data);
+        }
+
+        initialize_glslang();
+
         const std::shared_ptr<FolderAccessorBase> folder_access = get_shaderpack_accessor(shaderpack_name);
 
+        // Every shader stage of every pipeline shares one copy of each file that's included
+        ShaderIncludeCache include_cache(folder_access);
+
         // The shaderpack has a number of items: There's the shaders themselves, of course, but there's so, so much more
         // What else is there?
         // - resources.json, to describe the dynamic resources that a shaderpack needs
@@ -195,17 +301,224 @@ namespace nova::renderer::shaderpack {
         //
         // All these things are loaded from the filesystem
 
+        //
+        // Every file is parsed in its own task, then every shader stage is compiled in its own task. Each task writes its errors to its
+        // own report, and the reports are printed in the same order that the files were loaded in before loading was multithreaded
+
+        const std::vector<fs::path> pipeline_files = find_files_with_extension(folder_access, "materials", ".pipeline");
+        const std::vector<fs::path> material_files = find_files_with_extension(folder_access, "materials", ".mat");
+
         ShaderpackData data{};
-        data.resources = load_dynamic_resources_file(folder_access);
-        data.passes = load_passes_file(folder_access).value;    // TODO: Gracefully handle errors
-        data.pipelines = load_pipeline_files(folder_access);
-        data.materials = load_material_files(folder_access);
+        data.pipelines.resize(pipeline_files.size());
+        data.materials.resize(material_files.size());
+
+        ValidationReport resources_report;
+        std::vector<ValidationReport> pipeline_reports(pipeline_files.size());
+        std::vector<ValidationReport> material_reports(material_files.size());
+
+        std::vector<std::function<void()>> file_tasks;
+        file_tasks.reserve(2 + pipeline_files.size() + material_files.size());
+        file_tasks.emplace_back([&] { data.resources = load_dynamic_resources_file(folder_access, resources_report); });
+        file_tasks.emplace_back([&] {
+            data.passes = load_passes_file(folder_access).value; // TODO: Gracefully handle errors
+        });
+        for(size_t i = 0; i < pipeline_files.size(); i++) {
+            file_tasks.emplace_back(
+                [&, i] { data.pipelines[i] = load_single_pipeline(folder_access, pipeline_files[i], pipeline_reports[i]); });
+        }
+        for(size_t i = 0; i < material_files.size(); i++) {
+            file_tasks.emplace_back(
+                [&, i] { data.materials[i] = load_single_material(folder_access, material_files[i], material_reports[i]); });
+        }
+
+        run_tasks(scheduler, file_tasks);
+
+        add_pipeline_variants(data, material_reports);
+
+        // The variants that the materials asked for are after the pipelines from the files, and are compiled when they're first used
+        std::vector<ShaderLoadTask> shader_load_tasks;
+        for(uint32_t i = 0; i < pipeline_files.size(); i++) {
+            if(pipeline_reports[i].errors.empty()) {
+                add_shader_load_tasks(data.pipelines[i], i, shader_load_tasks);
+            }
+        }
+
+        std::vector<std::function<void()>> shader_tasks;
+        shader_tasks.reserve(shader_load_tasks.size());
+        for(ShaderLoadTask& task : shader_load_tasks) {
+            shader_tasks.emplace_back([&] {
+                load_shader_file(*task.shader,
+                                 folder_access,
+                                 include_cache,
+                                 task.stage,
+                                 data.pipelines[task.pipeline_index].defines,
+                                 shader_cache,
+                                 shader_optimizer,
+                                 task.report);
+            });
+        }
+
+        run_tasks(scheduler, shader_tasks);
+
+        for(const ShaderLoadTask& task : shader_load_tasks) {
+            pipeline_reports[task.pipeline_index].merge_in(task.report);
+        }
+
+        for(uint32_t i = 0; i < pipeline_files.size(); i++) {
+            data.pipeline_files.emplace(data.pipelines[i].name, pipeline_files[i]);
+        }
+
+        print(resources_report);
+        for(const ValidationReport& report : pipeline_reports) {
+            print(report);
+        }
+        for(const ValidationReport& report : material_reports) {
+            print(report);
+        }
 
         fill_in_render_target_formats(data);
 
         return data;
     }
 
+    std::optional<PipelineCreateInfo> load_pipeline(const fs::path& shaderpack_name,
+                                                    const fs::path& pipeline_file,
+                                                    ShaderCache* shader_cache,
+                                                    ShaderOptimizer* shader_optimizer) {
+        initialize_glslang();
+
+        const std::shared_ptr<FolderAccessorBase> folder_access = get_shaderpack_accessor(shaderpack_name);
+        if(!folder_access) {
+            NOVA_LOG(ERROR) << "Could not find shaderpack " << shaderpack_name.string();
+            return {};
+        }
+
+        ValidationReport report;
+        PipelineCreateInfo pipeline = load_single_pipeline(folder_access, pipeline_file, report);
+        ShaderIncludeCache include_cache(folder_access);
+
+        if(report.errors.empty()) {
+            if(!pipeline.permutations.empty()) {
+                pipeline = make_pipeline_variant(pipeline, {});
+            }
+
+            load_pipeline_shaders(pipeline, folder_access, include_cache, shader_cache, shader_optimizer, report);
+        }
+
+        print(report);
+
+        if(!report.errors.empty()) {
+            return {};
+        }
+
+        return pipeline;
+    }
+
+    std::optional<PipelineCreateInfo> compile_pipeline_variant(const fs::path& shaderpack_name,
+                                                               const PipelineCreateInfo& variant,
+                                                               ShaderCache* shader_cache,
+                                                               ShaderOptimizer* shader_optimizer) {
+        initialize_glslang();
+
+        const std::shared_ptr<FolderAccessorBase> folder_access = get_shaderpack_accessor(shaderpack_name);
+        if(!folder_access) {
+            NOVA_LOG(ERROR) << "Could not find shaderpack " << shaderpack_name.string();
+            return {};
+        }
+
+        PipelineCreateInfo compiled_variant = variant;
+        compiled_variant.compile_on_first_use = false;
+
+        ValidationReport report;
+        ShaderIncludeCache include_cache(folder_access);
+        load_pipeline_shaders(compiled_variant, folder_access, include_cache, shader_cache, shader_optimizer, report);
+
+        print(report);
+
+        if(!report.errors.empty()) {
+            return {};
+        }
+
+        return compiled_variant;
+    }
+
+    void load_pipeline_shaders(PipelineCreateInfo& pipeline,
+                               const std::shared_ptr<FolderAccessorBase>& folder_access,
+                               ShaderIncludeCache& include_cache,
+                               ShaderCache* shader_cache,
+                               ShaderOptimizer* shader_optimizer,
+                               ValidationReport& report) {
+        std::vector<ShaderLoadTask> shader_load_tasks;
+        add_shader_load_tasks(pipeline, 0, shader_load_tasks);
+
+        for(ShaderLoadTask& task : shader_load_tasks) {
+            load_shader_file(*task.shader,
+                             folder_access,
+                             include_cache,
+                             task.stage,
+                             pipeline.defines,
+                             shader_cache,
+                             shader_optimizer,
+                             task.report);
+            report.merge_in(task.report);
+        }
+    }
+
+    void add_pipeline_variants(ShaderpackData& data, std::vector<ValidationReport>& material_reports) {
+        const size_t num_loaded_pipelines = data.pipelines.size();
+
+        std::unordered_map<std::string, size_t> pipeline_indices;
+        pipeline_indices.reserve(num_loaded_pipelines);
+        for(size_t i = 0; i < num_loaded_pipelines; i++) {
+            pipeline_indices.emplace(data.pipelines[i].name, i);
+        }
+
+        std::unordered_set<std::string> variant_names;
+        for(size_t i = 0; i < data.materials.size(); i++) {
+            for(MaterialPass& pass : data.materials[i].passes) {
+                if(pass.permutation.empty()) {
+                    continue;
+                }
+
+                const auto pipeline_itr = pipeline_indices.find(pass.pipeline);
+                if(pipeline_itr == pipeline_indices.end()) {
+                    continue;
+                }
+                const PipelineCreateInfo& pipeline = data.pipelines[pipeline_itr->second];
+
+                for(const auto& [permutation_name, value] : pass.permutation) {
+                    const auto permutation = std::find_if(pipeline.permutations.begin(),
+                                                          pipeline.permutations.end(),
+                                                          [&](const PipelinePermutation& p) { return p.name == permutation_name; });
+                    if(permutation == pipeline.permutations.end()) {
+                        material_reports[i].warnings.emplace_back("Material pass " + pass.name + " in material " + pass.material_name +
+                                                                  ": Pipeline " + pipeline.name + " doesn't have a permutation named " +
+                                                                  permutation_name);
+
+                    } else if(std::find(permutation->values.begin(), permutation->values.end(), value) == permutation->values.end()) {
+                        material_reports[i].warnings.emplace_back("Material pass " + pass.name + " in material " + pass.material_name +
+                                                                  ": Permutation " + permutation_name + " can't be " + value +
+                                                                  ", so its default value will be used");
+                    }
+                }
+
+                PipelineCreateInfo variant = make_pipeline_variant(pipeline, pass.permutation);
+                pass.pipeline = variant.name;
+
+                if(variant.compile_on_first_use && variant_names.insert(variant.name).second) {
+                    data.pipelines.push_back(std::move(variant));
+                }
+            }
+        }
+
+        // The variants were made from the pipelines as they were in their files, so the pipelines can become their default variants now
+        for(size_t i = 0; i < num_loaded_pipelines; i++) {
+            if(!data.pipelines[i].permutations.empty()) {
+                data.pipelines[i] = make_pipeline_variant(data.pipelines[i], {});
+            }
+        }
+    }
+
     std::shared_ptr<FolderAccessorBase> get_shaderpack_accessor(const fs::path& shaderpack_name) {
         fs::path path_to_shaderpack = shaderpack_name;
 
@@ -223,13 +536,28 @@ namespace nova::renderer::shaderpack {
         return {};
     }
 
-    ShaderpackResourcesData load_dynamic_resources_file(const std::shared_ptr<FolderAccessorBase>& folder_access) {
+    void run_tasks(ttl::task_scheduler* scheduler, const std::vector<std::function<void()>>& tasks) {
+        if(scheduler == nullptr) {
+            for(const std::function<void()>& task : tasks) {
+                task();
+            }
+            return;
+        }
+
+        ttl::condition_counter tasks_remaining;
+        for(const std::function<void()>& task : tasks) {
+            scheduler->add_task(&tasks_remaining, [&task](ttl::task_scheduler* /* scheduler */) { task(); });
+        }
+        tasks_remaining.wait_for_value(0);
+    }
+
+    ShaderpackResourcesData load_dynamic_resources_file(const std::shared_ptr<FolderAccessorBase>& folder_access,
+                                                        ValidationReport& report) {
         NOVA_LOG(TRACE) << "load_dynamic_resource_file called";
         std::string resources_string = folder_access->read_text_file("resources.json");
         try {
             auto json_resources = nlohmann::json::parse(resources_string.c_str());
-            const ValidationReport report = validate_shaderpack_resources_data(json_resources);
-            print(report);
+            report.merge_in(validate_shaderpack_resources_data(json_resources));
             if(!report.errors.empty()) {
                 loading_failed = true;
                 return {};
@@ -237,8 +565,8 @@ namespace nova::renderer::shaderpack {
 
             return json_resources.get<ShaderpackResourcesData>();
         }
-        catch(nlohmann::json::parse_error& err) {
-            NOVA_LOG(ERROR) << "Could not parse your shaderpack's resources.json: " << err.what();
+        catch(nlohmann::json::exception& err) {
+            report.errors.emplace_back(std::string("Could not parse your shaderpack's resources.json: ") + err.what());
             loading_failed = true;
         }
 
@@ -260,87 +588,81 @@ namespace nova::renderer::shaderpack {
         }
     }
 
-    std::vector<PipelineCreateInfo> load_pipeline_files(const std::shared_ptr<FolderAccessorBase>& folder_access) {
-        NOVA_LOG(TRACE) << "load_pipeline_files called";
-
-        std::vector<fs::path> potential_pipeline_files = folder_access->get_all_items_in_folder("materials");
-
-        std::vector<PipelineCreateInfo> output;
-
-        // The resize will make this vector about twice as big as it should be, but there won't be any reallocating
-        // so I'm into it
-        output.reserve(potential_pipeline_files.size());
-
-        for(const fs::path& potential_file : potential_pipeline_files) {
-            if(potential_file.extension() == ".pipeline") {
-                // Pipeline file!
-                const PipelineCreateInfo& pipeline = load_single_pipeline(folder_access, potential_file);
-                output.push_back(pipeline);
+    std::vector<fs::path> find_files_with_extension(const std::shared_ptr<FolderAccessorBase>& folder_access,
+                                                    const fs::path& folder,
+                                                    const std::string& extension) {
+        std::vector<fs::path> files;
+        for(const fs::path& potential_file : folder_access->get_all_items_in_folder(folder)) {
+            if(potential_file.extension() == extension) {
+                files.push_back(potential_file);
             }
         }
 
-        return output;
+        std::sort(files.begin(), files.end());
+
+        return files;
     }
 
-    PipelineCreateInfo load_single_pipeline(const std::shared_ptr<FolderAccessorBase>& folder_access, const fs::path& pipeline_path) {
+    PipelineCreateInfo load_single_pipeline(const std::shared_ptr<FolderAccessorBase>& folder_access,
+                                            const fs::path& pipeline_path,
+                                            ValidationReport& report) {
         NOVA_LOG(TRACE) << "Task to load pipeline " << pipeline_path << " started";
         const auto pipeline_bytes = folder_access->read_text_file(pipeline_path);
 
-        auto json_pipeline = nlohmann::json::parse(pipeline_bytes);
-        NOVA_LOG(TRACE) << "Parsed JSON from disk for pipeline " << pipeline_path;
-        const ValidationReport report = validate_graphics_pipeline(json_pipeline);
-        NOVA_LOG(TRACE) << "Finished validating JSON for pipeline " << pipeline_path;
-        print(report);
-        if(!report.errors.empty()) {
+        try {
+            auto json_pipeline = nlohmann::json::parse(pipeline_bytes);
+            NOVA_LOG(TRACE) << "Parsed JSON from disk for pipeline " << pipeline_path;
+            report.merge_in(validate_graphics_pipeline(json_pipeline));
+            NOVA_LOG(TRACE) << "Finished validating JSON for pipeline " << pipeline_path;
+            if(!report.errors.empty()) {
+                loading_failed = true;
+                NOVA_LOG(TRACE) << "Loading pipeline file " << pipeline_path << " failed";
+                return {};
+            }
+
+            auto new_pipeline = json_pipeline.get<PipelineCreateInfo>();
+            NOVA_LOG(TRACE) << "Parsed JSON into pipeline_data for pipeline " << pipeline_path;
+
+            return new_pipeline;
+        }
+        catch(nlohmann::json::exception& err) {
+            report.errors.emplace_back("Could not parse pipeline file " + pipeline_path.string() + ": " + err.what());
             loading_failed = true;
-            NOVA_LOG(TRACE) << "Loading pipeline file " << pipeline_path << " failed";
-            return {};
         }
 
-        auto new_pipeline = json_pipeline.get<PipelineCreateInfo>();
-        NOVA_LOG(TRACE) << "Parsed JSON into pipeline_data for pipeline " << pipeline_path;
-        new_pipeline.vertex_shader.source = load_shader_file(new_pipeline.vertex_shader.filename,
-                                                             folder_access,
-                                                             EShLangVertex,
-                                                             new_pipeline.defines);
+        return {};
+    }
+
+    void add_shader_load_tasks(PipelineCreateInfo& pipeline, const uint32_t pipeline_index, std::vector<ShaderLoadTask>& tasks) {
+        tasks.push_back({&pipeline.vertex_shader, EShLangVertex, pipeline_index, {}});
 
-        if(new_pipeline.geometry_shader) {
-            (*new_pipeline.geometry_shader).source = load_shader_file((*new_pipeline.geometry_shader).filename,
-                                                                      folder_access,
-                                                                      EShLangGeometry,
-                                                                      new_pipeline.defines);
+        if(pipeline.geometry_shader) {
+            tasks.push_back({&*pipeline.geometry_shader, EShLangGeometry, pipeline_index, {}});
         }
 
-        if(new_pipeline.tessellation_control_shader) {
-            (*new_pipeline.tessellation_control_shader).source = load_shader_file((*new_pipeline.tessellation_control_shader).filename,
-                                                                                  folder_access,
-                                                                                  EShLangTessControl,
-                                                                                  new_pipeline.defines);
-        }
-        if(new_pipeline.tessellation_evaluation_shader) {
-            (*new_pipeline.tessellation_evaluation_shader)
-                .source = load_shader_file((*new_pipeline.tessellation_evaluation_shader).filename,
-                                           folder_access,
-                                           EShLangTessEvaluation,
-                                           new_pipeline.defines);
+        if(pipeline.tessellation_control_shader) {
+            tasks.push_back({&*pipeline.tessellation_control_shader, EShLangTessControl, pipeline_index, {}});
         }
 
-        if(new_pipeline.fragment_shader) {
-            (*new_pipeline.fragment_shader).source = load_shader_file((*new_pipeline.fragment_shader).filename,
-                                                                      folder_access,
-                                                                      EShLangFragment,
-                                                                      new_pipeline.defines);
+        if(pipeline.tessellation_evaluation_shader) {
+            tasks.push_back({&*pipeline.tessellation_evaluation_shader, EShLangTessEvaluation, pipeline_index, {}});
         }
 
-        NOVA_LOG(TRACE) << "Load of pipeline " << pipeline_path << " succeeded";
-
-        return new_pipeline;
+        if(pipeline.fragment_shader) {
+            tasks.push_back({&*pipeline.fragment_shader, EShLangFragment, pipeline_index, {}});
+        }
     }
 
-    std::vector<uint32_t> load_shader_file(const fs::path& filename,
-                                           const std::shared_ptr<FolderAccessorBase>& folder_access,
-                                           const EShLanguage stage,
-                                           const std::vector<std::string>& defines) {
+    void load_shader_file(ShaderSource& shader,
+                          const std::shared_ptr<FolderAccessorBase>& folder_access,
+                          ShaderIncludeCache& include_cache,
+                          const EShLanguage stage,
+                          const std::vector<std::string>& defines,
+                          ShaderCache* shader_cache,
+                          ShaderOptimizer* shader_optimizer,
+                          ValidationReport& report) {
+        const fs::path& filename = shader.filename;
+
         static std::unordered_map<EShLanguage, std::vector<fs::path>> extensions_by_shader_stage = {{EShLangVertex,
                                                                                                      {
                                                                                                          ".vert.spirv",
@@ -427,23 +749,42 @@ namespace nova::renderer::shaderpack {
                 continue;
             }
 
-            glslang::TShader shader(stage);
-
             // Check the extension to know what kind of shader file the user has provided. SPIR-V files can be loaded
             // as-is, but GLSL, GLSL ES, and HLSL files need to be transpiled to SPIR-V
             if(extension.string().find(".spirv") != std::string::npos) {
                 // SPIR-V file!
                 // TODO: figure out how to handle defines with SPIRV
-                return folder_access->read_spirv_file(full_filename);
-            }
-            if(extension.string().find(".hlsl") != std::string::npos) {
-                shader.setEnvInput(glslang::EShSourceHlsl, stage, glslang::EShClientVulkan, 0);
-            } else {
-                // GLSL files have a lot of possible extensions, but SPIR-V and HLSL don't!
-                shader.setEnvInput(glslang::EShSourceGlsl, stage, glslang::EShClientVulkan, 0);
+                shader.source = folder_access->read_spirv_file(full_filename);
+                shader.reflection = reflect_shader(shader.source);
+                return;
             }
 
+            // GLSL files have a lot of possible extensions, but SPIR-V and HLSL don't!
+            const glslang::EShSource language = extension.string().find(".hlsl") != std::string::npos ? glslang::EShSourceHlsl :
+                                                                                                        glslang::EShSourceGlsl;
+
             std::string shader_source = folder_access->read_text_file(full_filename);
+            shader.includes = include_cache.find_includes(shader_source, full_filename);
+
+            std::optional<ShaderCacheKey> cache_key;
+            if(shader_cache != nullptr) {
+                cache_key = make_shader_cache_key(shader_source, stage, language, defines, shader_optimizer);
+                include_cache.add_to_key(*cache_key, shader.includes);
+                if(auto cached_spirv = shader_cache->find(*cache_key)) {
+                    NOVA_LOG(TRACE) << "Loaded shader " << full_filename.string() << " from the shader cache";
+                    shader.source = std::move(*cached_spirv);
+
+                    // Entries from before reflection records were cached only have the SPIR-V
+                    if(auto cached_reflection = shader_cache->find_reflection(*cache_key)) {
+                        shader.reflection = std::move(*cached_reflection);
+                    } else {
+                        shader.reflection = reflect_shader(shader.source);
+                        shader_cache->store_reflection(*cache_key, shader.reflection);
+                    }
+                    return;
+                }
+            }
+
             std::string::size_type version_pos = shader_source.find("#version");
             std::string::size_type inject_pos = 0;
             if(version_pos != std::string::npos) {
@@ -456,84 +797,127 @@ namespace nova::renderer::shaderpack {
                 shader_source.insert(inject_pos, "#define " + *i + "\n");
             }
 
-            auto* shader_source_data = shader_source.data();
-            shader.setStrings(&shader_source_data, 1);
-            const bool shader_compiled = shader.parse(&default_built_in_resource,
-                                                      450,
-                                                      ECoreProfile,
-                                                      false,
-                                                      false,
-                                                      EShMessages(EShMsgVulkanRules | EShMsgSpvRules));
-
-            const char* info_log = shader.getInfoLog();
-            if(std::strlen(info_log) > 0) {
-                const char* info_debug_log = shader.getInfoDebugLog();
-                NOVA_LOG(INFO) << full_filename.string() << " compilation messages:\n" << info_log << "\n" << info_debug_log;
+            // GLSL needs an extension for `#include`, HLSL has it built in
+            if(language == glslang::EShSourceGlsl && shader_source.find("#include") != std::string::npos) {
+                shader_source.insert(inject_pos, "#extension GL_GOOGLE_include_directive : require\n");
             }
 
-            if(!shader_compiled) {
-                NOVA_LOG(ERROR) << "Shader compilation failed";
+            ShaderIncluder includer(include_cache);
+            shader.source = compile_shader_source(shader_source, stage, language, full_filename.generic_string(), &includer, report);
+            if(shader_optimizer != nullptr && !shader.source.empty()) {
+                shader_optimizer->optimize(shader, full_filename.string(), report);
+            } else {
+                shader.reflection = reflect_shader(shader.source);
             }
 
-            glslang::TProgram program;
-            program.addShader(&shader);
-            const bool shader_linked = program.link(EShMsgDefault);
-            if(!shader_linked) {
-                const char* program_info_log = program.getInfoLog();
-                const char* program_debug_info_log = program.getInfoDebugLog();
-                NOVA_LOG(ERROR) << "Program failed to link: " << program_info_log << "\n" << program_debug_info_log;
+            // Pipelines that use the same shader with different defines are loaded at the same time, and dump to the same file
+            static std::mutex dump_mutex;
+            fs::path dump_filename = filename.filename();
+            dump_filename.replace_extension(std::to_string(stage) + ".spirv.generated");
+            {
+                std::lock_guard l(dump_mutex);
+                write_to_file(shader.source, dump_filename);
             }
 
-            std::vector<uint32_t> spirv_std;
-            GlslangToSpv(*program.getIntermediate(stage), spirv_std);
+            if(cache_key && !shader.source.empty()) {
+                shader_cache->store(*cache_key, shader.source);
+                shader_cache->store_reflection(*cache_key, shader.reflection);
+            }
 
-            std::vector<uint32_t> spirv(spirv_std.begin(), spirv_std.end());
+            return;
+        }
 
-            fs::path dump_filename = filename.filename();
-            dump_filename.replace_extension(std::to_string(stage) + ".spirv.generated");
-            write_to_file(spirv, dump_filename);
+        report.errors.emplace_back("Could not find shader " + filename.string());
+    }
 
-            return spirv;
-        }
+    std::vector<uint32_t> compile_shader_source(const std::string& source,
+                                                const EShLanguage stage,
+                                                const glslang::EShSource language,
+                                                const std::string& name) {
+        ValidationReport report;
+        std::vector<uint32_t> spirv = compile_shader_source(source, stage, language, name, nullptr, report);
+        print(report);
 
-        NOVA_LOG(ERROR) << "Could not find shader " << filename.c_str();
-        return {};
+        return spirv;
     }
 
-    std::vector<MaterialData> load_material_files(const std::shared_ptr<FolderAccessorBase>& folder_access) {
-        std::vector<fs::path> potential_material_files = folder_access->get_all_items_in_folder("materials");
+    std::vector<uint32_t> compile_shader_source(const std::string& source,
+                                                const EShLanguage stage,
+                                                const glslang::EShSource language,
+                                                const std::string& name,
+                                                ShaderIncluder* includer,
+                                                ValidationReport& report) {
+        glslang::TShader shader(stage);
+        shader.setEnvInput(language, stage, glslang::EShClientVulkan, 0);
+
+        // The name is where the includer resolves the shader's `#include "file"`s from
+        const char* shader_source_data = source.c_str();
+        const char* shader_name = name.c_str();
+        shader.setStringsWithLengthsAndNames(&shader_source_data, nullptr, &shader_name, 1);
+
+        glslang::TShader::ForbidIncluder forbid_includer;
+        glslang::TShader::Includer& shader_includer = includer != nullptr ? static_cast<glslang::TShader::Includer&>(*includer) :
+                                                                            forbid_includer;
+        const bool shader_compiled = shader.parse(&default_built_in_resource,
+                                                  450,
+                                                  ECoreProfile,
+                                                  false,
+                                                  false,
+                                                  EShMessages(EShMsgVulkanRules | EShMsgSpvRules),
+                                                  shader_includer);
+
+        const char* info_log = shader.getInfoLog();
+        if(std::strlen(info_log) > 0) {
+            const char* info_debug_log = shader.getInfoDebugLog();
+            report.warnings.emplace_back(name + " compilation messages:\n" + info_log + "\n" + info_debug_log);
+        }
 
-        // The resize will make this vector about twice as big as it should be, but there won't be any reallocating
-        // so I'm into it
-        std::vector<MaterialData> output;
-        output.reserve(potential_material_files.size());
+        if(!shader_compiled) {
+            report.errors.emplace_back("Shader " + name + " failed to compile");
+            return {};
+        }
 
-        for(const fs::path& potential_file : potential_material_files) {
-            if(potential_file.extension() == ".mat") {
-                const MaterialData& material = load_single_material(folder_access, potential_file);
-                output.push_back(material);
-            }
+        glslang::TProgram program;
+        program.addShader(&shader);
+        const bool shader_linked = program.link(EShMsgDefault);
+        if(!shader_linked) {
+            const char* program_info_log = program.getInfoLog();
+            const char* program_debug_info_log = program.getInfoDebugLog();
+            report.errors.emplace_back("Shader " + name + " failed to link: " + program_info_log + "\n" + program_debug_info_log);
+            return {};
         }
 
-        return output;
+        std::vector<uint32_t> spirv;
+        GlslangToSpv(*program.getIntermediate(stage), spirv);
+
+        return spirv;
     }
 
-    MaterialData load_single_material(const std::shared_ptr<FolderAccessorBase>& folder_access, const fs::path& material_path) {
+    MaterialData load_single_material(const std::shared_ptr<FolderAccessorBase>& folder_access,
+                                      const fs::path& material_path,
+                                      ValidationReport& report) {
         const std::string material_text = folder_access->read_text_file(material_path);
 
-        auto json_material = nlohmann::json::parse(material_text);
-        const auto report = validate_material(json_material);
-        print(report);
-        if(!report.errors.empty()) {
-            // There were errors, this material can't be loaded
+        try {
+            auto json_material = nlohmann::json::parse(material_text);
+            report.merge_in(validate_material(json_material));
+            if(!report.errors.empty()) {
+                // There were errors, this material can't be loaded
+                loading_failed = true;
+                NOVA_LOG(TRACE) << "Load of material " << material_path << " failed";
+                return {};
+            }
+
+            auto material = json_material.get<MaterialData>();
+            material.name = material_path.stem().string().c_str();
+            NOVA_LOG(TRACE) << "Load of material " << material_path << " succeeded";
+            return material;
+        }
+        catch(nlohmann::json::exception& err) {
+            report.errors.emplace_back("Could not parse material file " + material_path.string() + ": " + err.what());
             loading_failed = true;
-            NOVA_LOG(TRACE) << "Load of material " << material_path << " failed";
-            return {};
         }
 
-        auto material = json_material.get<MaterialData>();
-        material.name = material_path.stem().string().c_str();
-        NOVA_LOG(TRACE) << "Load of material " << material_path << " succeeded";
-        return material;
+        return {};
     }
 } // namespace nova::renderer::shaderpack
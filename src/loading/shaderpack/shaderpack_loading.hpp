@@ -1,10 +1,19 @@
 #pragma once
 
+#include <glslang/Public/ShaderLang.h>
+
 #include "nova_renderer/shaderpack_data.hpp"
 #include "nova_renderer/util/filesystem.hpp"
 
+namespace nova::ttl {
+    class task_scheduler;
+}
 
 namespace nova::renderer::shaderpack {
+    class ShaderCache;
+
+    class ShaderOptimizer;
+
     /*!
      * \brief Loads all the data for a single shaderpack
      *
@@ -15,10 +24,79 @@ namespace nova::renderer::shaderpack {
      *
      * If the shaderpack can't be loaded, an empty optional is returned
      *
+     * Every file is parsed, and every shader is compiled, as its own task on the scheduler. Errors are logged after all the tasks are
+     * done, in the same order every time
+     *
+     * Shaderpack bundles from `nova-shaderpack-bake` are read straight from the bundle file instead. They were validated and compiled
+     * when they were baked, so neither the shader cache nor the scheduler is used for them
+     *
      * Note: This function is NOT thread-safe. It should only be called for a single thread at a time
      *
      * \param shaderpack_name The name of the shaderpack to loads
+     * \param shader_cache The cache to load compiled shaders from and save newly compiled shaders to. If this is nullptr, every shader
+     * is compiled
+     * \param scheduler The scheduler to load files and compile shaders on. If this is nullptr, the shaderpack is loaded on this thread
+     * \param shader_optimizer The optimizer to run newly compiled shaders through. If this is nullptr, shaders are used as glslang
+     * compiles them
      * \return The shaderpack, if it can be loaded, or an empty optional if it cannot
      */
-    ShaderpackData load_shaderpack_data(const fs::path& shaderpack_name);
+    ShaderpackData load_shaderpack_data(const fs::path& shaderpack_name,
+                                        ShaderCache* shader_cache = nullptr,
+                                        ttl::task_scheduler* scheduler = nullptr,
+                                        ShaderOptimizer* shader_optimizer = nullptr);
+
+    /*!
+     * \brief Loads a single pipeline from a shaderpack and compiles its shaders, without loading anything else
+     *
+     * Any errors are logged
+     *
+     * \param shaderpack_name The name of the shaderpack that the pipeline is in
+     * \param pipeline_file The pipeline's file, as in `ShaderpackData::pipeline_files`
+     * \param shader_cache The cache to load compiled shaders from and save newly compiled shaders to, or nullptr to compile every shader
+     * \param shader_optimizer The optimizer to run newly compiled shaders through, or nullptr to leave them unoptimized
+     * \return The pipeline, or an empty optional if it has any errors
+     */
+    [[nodiscard]] std::optional<PipelineCreateInfo> load_pipeline(const fs::path& shaderpack_name,
+                                                                  const fs::path& pipeline_file,
+                                                                  ShaderCache* shader_cache = nullptr,
+                                                                  ShaderOptimizer* shader_optimizer = nullptr);
+
+    /*!
+     * \brief Compiles the shaders of a pipeline variant that was made when the shaderpack was loaded
+     *
+     * This is safe to call from any thread, including while another shaderpack is being loaded. Any errors are logged
+     *
+     * \param shaderpack_name The name of the shaderpack that the variant's pipeline is in
+     * \param variant A variant from `ShaderpackData::pipelines` that has `compile_on_first_use` set
+     * \param shader_cache The cache to load compiled shaders from and save newly compiled shaders to, or nullptr to compile every shader
+     * \param shader_optimizer The optimizer to run newly compiled shaders through, or nullptr to leave them unoptimized
+     * \return The variant with its shaders compiled, or an empty optional if any of its shaders have errors
+     */
+    [[nodiscard]] std::optional<PipelineCreateInfo> compile_pipeline_variant(const fs::path& shaderpack_name,
+                                                                             const PipelineCreateInfo& variant,
+                                                                             ShaderCache* shader_cache = nullptr,
+                                                                             ShaderOptimizer* shader_optimizer = nullptr);
+
+    /*!
+     * \brief Initializes glslang for this process, if it hasn't been initialized already
+     *
+     * This is safe to call from any thread, any number of times. glslang stays initialized until the process exits
+     */
+    void initialize_glslang();
+
+    /*!
+     * \brief Compiles GLSL or HLSL source code to SPIR-V for Vulkan
+     *
+     * glslang must have been initialized with `initialize_glslang` before calling this function. Any errors are logged
+     *
+     * \param source The full source code of the shader
+     * \param stage The pipeline stage that the shader is for
+     * \param language Whether the source is GLSL or HLSL
+     * \param name The name to use for the shader in error messages, usually its filename
+     * \return The SPIR-V code of the shader, or an empty vector if the shader couldn't be compiled
+     */
+    std::vector<uint32_t> compile_shader_source(const std::string& source,
+                                                EShLanguage stage,
+                                                glslang::EShSource language,
+                                                const std::string& name);
 } // namespace nova::renderer
@@ -72,6 +72,26 @@ namespace nova::renderer::shaderpack {
             }
         }
 
+        // Permutations are optional, so pipelines without them don't get a warning
+        if(const auto permutations_itr = pipeline_json.find("permutations"); permutations_itr != pipeline_json.end()) {
+            if(!permutations_itr->is_array()) {
+                report.errors.emplace_back(pipeline_context + ": Field permutations must be an array");
+            } else {
+                for(const nlohmann::json& permutation : *permutations_itr) {
+                    const std::string permutation_name = get_json_value<std::string>(permutation, "name").value_or("");
+                    if(permutation_name.empty()) {
+                        report.errors.emplace_back(pipeline_context + ": Every permutation must have a name");
+                    }
+
+                    const auto values_itr = permutation.find("values");
+                    if(values_itr == permutation.end() || !values_itr->is_array() || values_itr->empty()) {
+                        report.errors.emplace_back(pipeline_context + ": Permutation " + permutation_name +
+                                                   " must have an array of at least one value");
+                    }
+                }
+            }
+        }
+
         return report;
     }
 
@@ -242,6 +262,11 @@ namespace nova::renderer::shaderpack {
                     report.errors.emplace_back(material_pass_msg(name, pass_name, "Missing field pipeline"));
                 }
 
+                if(const auto permutation_itr = pass_json.find("permutation");
+                   permutation_itr != pass_json.end() && !permutation_itr->is_object()) {
+                    report.errors.emplace_back(material_pass_msg(name, pass_name, "Field permutation must be an object"));
+                }
+
                 const auto bindings_itr = pass_json.find("bindings");
                 if(bindings_itr == pass_json.end()) {
                     report.warnings.emplace_back(material_pass_msg(name, pass_name, "Missing field bindings"));
@@ -283,6 +308,6 @@ namespace nova::renderer::shaderpack {
 
     void ValidationReport::merge_in(const ValidationReport& other) {
         errors.insert(errors.end(), other.errors.begin(), other.errors.end());
-        warnings.insert(warnings.begin(), other.warnings.begin(), other.warnings.end());
+        warnings.insert(warnings.end(), other.warnings.begin(), other.warnings.end());
     }
 } // namespace nova::renderer::shaderpack
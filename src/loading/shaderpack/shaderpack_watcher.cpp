@@ -0,0 +1,248 @@
+#include "shaderpack_watcher.hpp"
+
+#include <algorithm>
+
+#ifdef NOVA_LINUX
+#include <cerrno>
+#include <cstring>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "../../util/logger.hpp"
+
+namespace nova::renderer::shaderpack {
+    std::string to_key(const fs::path& path) { return path.lexically_normal().string(); }
+
+    bool ShaderpackReload::empty() const { return !needs_full_reload && pipeline_files.empty(); }
+
+    /*!
+     * \brief Adds a pipeline file to a list, if it's not in the list already
+     */
+    void add_pipeline_file(std::vector<fs::path>& pipeline_files, const fs::path& pipeline_file) {
+        if(std::find(pipeline_files.begin(), pipeline_files.end(), pipeline_file) == pipeline_files.end()) {
+            pipeline_files.push_back(pipeline_file);
+        }
+    }
+
+    ShaderpackDependencies::ShaderpackDependencies(const fs::path& shaderpack_folder, const ShaderpackData& data) {
+        for(const PipelineCreateInfo& pipeline : data.pipelines) {
+            const auto pipeline_file_itr = data.pipeline_files.find(pipeline.name);
+            if(pipeline_file_itr != data.pipeline_files.end()) {
+                add_pipeline(shaderpack_folder, pipeline, pipeline_file_itr->second);
+            }
+        }
+    }
+
+    void ShaderpackDependencies::add_pipeline(const fs::path& shaderpack_folder,
+                                              const PipelineCreateInfo& pipeline,
+                                              const fs::path& pipeline_file) {
+        pipeline_files.emplace(to_key(pipeline_file), pipeline_file);
+
+        // The loader replaces the extension in the pipeline file with each stage's extensions, so that's what's removed here
+        const auto add_shader = [&](const ShaderSource& shader) {
+            fs::path shader_path = shaderpack_folder / shader.filename;
+            shader_path.replace_extension();
+            add_pipeline_file(pipeline_files_by_shader[to_key(shader_path)], pipeline_file);
+
+            for(const fs::path& include : shader.includes) {
+                add_pipeline_file(pipeline_files_by_include[to_key(shaderpack_folder / include)], pipeline_file);
+            }
+        };
+
+        add_shader(pipeline.vertex_shader);
+        if(pipeline.geometry_shader) {
+            add_shader(*pipeline.geometry_shader);
+        }
+        if(pipeline.tessellation_control_shader) {
+            add_shader(*pipeline.tessellation_control_shader);
+        }
+        if(pipeline.tessellation_evaluation_shader) {
+            add_shader(*pipeline.tessellation_evaluation_shader);
+        }
+        if(pipeline.fragment_shader) {
+            add_shader(*pipeline.fragment_shader);
+        }
+    }
+
+    ShaderpackReload ShaderpackDependencies::get_reload(const std::vector<fs::path>& changed_files) const {
+        ShaderpackReload reload;
+
+        for(const fs::path& changed_file : changed_files) {
+            const fs::path extension = changed_file.extension();
+            if(extension == ".json" || extension == ".mat") {
+                reload.needs_full_reload = true;
+                continue;
+            }
+
+            if(extension == ".pipeline") {
+                if(const auto itr = pipeline_files.find(to_key(changed_file)); itr != pipeline_files.end()) {
+                    reload.pipeline_files.push_back(itr->second);
+                } else {
+                    // A new pipeline needs the materials that use it, so the whole shaderpack is reloaded
+                    reload.needs_full_reload = true;
+                }
+                continue;
+            }
+
+            // Included files can have any extension, so they're looked for by their whole path
+            if(const auto itr = pipeline_files_by_include.find(to_key(changed_file)); itr != pipeline_files_by_include.end()) {
+                reload.pipeline_files.insert(reload.pipeline_files.end(), itr->second.begin(), itr->second.end());
+            }
+
+            // Shader files can have more than one extension, like `.frag.hlsl`, so every prefix of the filename is checked
+            fs::path shader_path = changed_file;
+            while(shader_path.has_extension()) {
+                shader_path.replace_extension();
+                if(const auto itr = pipeline_files_by_shader.find(to_key(shader_path)); itr != pipeline_files_by_shader.end()) {
+                    reload.pipeline_files.insert(reload.pipeline_files.end(), itr->second.begin(), itr->second.end());
+                }
+            }
+        }
+
+        std::sort(reload.pipeline_files.begin(), reload.pipeline_files.end());
+        reload.pipeline_files.erase(std::unique(reload.pipeline_files.begin(), reload.pipeline_files.end()), reload.pipeline_files.end());
+
+        return reload;
+    }
+
+#ifdef NOVA_LINUX
+    constexpr uint32_t WATCHED_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+    ShaderpackWatcher::ShaderpackWatcher(fs::path shaderpack_folder) : folder(std::move(shaderpack_folder)) {
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(inotify_fd < 0) {
+            NOVA_LOG(ERROR) << "Could not create an inotify instance to watch shaderpack " << folder.string() << ": "
+                            << std::strerror(errno);
+            return;
+        }
+
+        add_watch(folder);
+
+        std::error_code error;
+        for(fs::recursive_directory_iterator itr(folder, error), end; itr != end; itr.increment(error)) {
+            if(itr->is_directory()) {
+                add_watch(itr->path());
+            }
+        }
+    }
+
+    ShaderpackWatcher::~ShaderpackWatcher() {
+        if(inotify_fd >= 0) {
+            close(inotify_fd);
+        }
+    }
+
+    std::vector<fs::path> ShaderpackWatcher::get_changed_files() {
+        std::vector<fs::path> changed_files;
+        if(inotify_fd < 0) {
+            return changed_files;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        while(true) {
+            const ssize_t num_bytes = read(inotify_fd, buffer, sizeof(buffer));
+            if(num_bytes <= 0) {
+                // EAGAIN means that there aren't any more events
+                break;
+            }
+
+            for(ssize_t offset = 0; offset < num_bytes;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                const auto folder_itr = folders_by_watch.find(event->wd);
+                if(folder_itr == folders_by_watch.end() || event->len == 0) {
+                    continue;
+                }
+
+                const fs::path path = folder_itr->second / event->name;
+                if((event->mask & IN_ISDIR) != 0) {
+                    if((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+                        add_watch(path);
+                    }
+                    continue;
+                }
+
+                changed_files.push_back(path);
+            }
+        }
+
+        // Editors often write a file more than once when they save it
+        std::sort(changed_files.begin(), changed_files.end());
+        changed_files.erase(std::unique(changed_files.begin(), changed_files.end()), changed_files.end());
+
+        return changed_files;
+    }
+
+    void ShaderpackWatcher::add_watch(const fs::path& watched_folder) {
+        const int watch = inotify_add_watch(inotify_fd, watched_folder.string().c_str(), WATCHED_EVENTS);
+        if(watch < 0) {
+            NOVA_LOG(ERROR) << "Could not watch folder " << watched_folder.string() << " for changes: " << std::strerror(errno);
+            return;
+        }
+
+        folders_by_watch[watch] = watched_folder;
+    }
+
+#else
+    /*!
+     * \brief How often the folder is scanned for changes
+     */
+    constexpr std::chrono::milliseconds SCAN_INTERVAL(500);
+
+    ShaderpackWatcher::ShaderpackWatcher(fs::path shaderpack_folder) : folder(std::move(shaderpack_folder)) {
+        std::vector<fs::path> initial_files;
+        scan(initial_files);
+        last_scan_time = std::chrono::steady_clock::now();
+    }
+
+    ShaderpackWatcher::~ShaderpackWatcher() = default;
+
+    std::vector<fs::path> ShaderpackWatcher::get_changed_files() {
+        std::vector<fs::path> changed_files;
+
+        const auto now = std::chrono::steady_clock::now();
+        if(now - last_scan_time < SCAN_INTERVAL) {
+            return changed_files;
+        }
+        last_scan_time = now;
+
+        scan(changed_files);
+
+        return changed_files;
+    }
+
+    void ShaderpackWatcher::scan(std::vector<fs::path>& changed_files) {
+        std::unordered_map<std::string, fs::file_time_type> new_write_times;
+        new_write_times.reserve(write_times.size());
+
+        std::error_code error;
+        for(fs::recursive_directory_iterator itr(folder, error), end; itr != end; itr.increment(error)) {
+            if(!itr->is_regular_file()) {
+                continue;
+            }
+
+            const fs::file_time_type write_time = fs::last_write_time(itr->path(), error);
+            const std::string path = itr->path().string();
+
+            const auto old_itr = write_times.find(path);
+            if(old_itr == write_times.end() || old_itr->second != write_time) {
+                changed_files.push_back(itr->path());
+            }
+
+            new_write_times.emplace(path, write_time);
+        }
+
+        // Deleted files are changes too
+        for(const auto& [path, write_time] : write_times) {
+            if(new_write_times.find(path) == new_write_times.end()) {
+                changed_files.emplace_back(path);
+            }
+        }
+
+        write_times = std::move(new_write_times);
+    }
+#endif
+} // namespace nova::renderer::shaderpack
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nova_renderer/shaderpack_data.hpp"
+#include "nova_renderer/util/filesystem.hpp"
+#include "nova_renderer/util/platform.hpp"
+
+namespace nova::renderer::shaderpack {
+    /*!
+     * \brief What has to be reloaded after some of a shaderpack's files changed
+     */
+    struct ShaderpackReload {
+        /*!
+         * \brief Whether the whole shaderpack has to be reloaded
+         *
+         * Only pipelines can be reloaded on their own. Any change to the passes, the resources, or a material reloads everything
+         */
+        bool needs_full_reload = false;
+
+        /*!
+         * \brief The files of the pipelines to reload, if the whole shaderpack doesn't have to be reloaded
+         */
+        std::vector<fs::path> pipeline_files;
+
+        [[nodiscard]] bool empty() const;
+    };
+
+    /*!
+     * \brief Which files each part of a shaderpack was loaded from
+     */
+    class ShaderpackDependencies {
+    public:
+        ShaderpackDependencies() = default;
+
+        /*!
+         * \param shaderpack_folder The folder that the shaderpack was loaded from, as it was passed to `load_shaderpack_data`
+         * \param data The shaderpack
+         */
+        ShaderpackDependencies(const fs::path& shaderpack_folder, const ShaderpackData& data);
+
+        /*!
+         * \brief Adds the files that a pipeline was loaded from
+         *
+         * Pipelines that are reloaded on their own are added again, since their shaders may include different files now
+         *
+         * \param shaderpack_folder The folder that the shaderpack was loaded from, as it was passed to `load_shaderpack_data`
+         * \param pipeline The pipeline, with its shaders loaded
+         * \param pipeline_file The pipeline's file
+         */
+        void add_pipeline(const fs::path& shaderpack_folder, const PipelineCreateInfo& pipeline, const fs::path& pipeline_file);
+
+        /*!
+         * \brief Works out what has to be reloaded after the given files changed
+         *
+         * Files that the shaderpack doesn't read, like an editor's swap files, are ignored
+         */
+        [[nodiscard]] ShaderpackReload get_reload(const std::vector<fs::path>& changed_files) const;
+
+    private:
+        /*!
+         * \brief The files of the pipelines that use each shader, by the shader's path without its extension
+         *
+         * A shader's extension depends on its stage and language, so the pipeline file only has the path without it
+         */
+        std::unordered_map<std::string, std::vector<fs::path>> pipeline_files_by_shader;
+
+        /*!
+         * \brief The files of the pipelines whose shaders include each file, by the included file's path
+         */
+        std::unordered_map<std::string, std::vector<fs::path>> pipeline_files_by_include;
+
+        std::unordered_map<std::string, fs::path> pipeline_files;
+    };
+
+    /*!
+     * \brief Watches a shaderpack's folder for files that change
+     *
+     * On Linux this uses inotify. On other platforms the folder is scanned for new write times every so often
+     *
+     * Shaderpacks in zip files can't be watched
+     */
+    class ShaderpackWatcher {
+    public:
+        explicit ShaderpackWatcher(fs::path shaderpack_folder);
+
+        ShaderpackWatcher(ShaderpackWatcher&& old) noexcept = delete;
+        ShaderpackWatcher& operator=(ShaderpackWatcher&& old) noexcept = delete;
+
+        ShaderpackWatcher(const ShaderpackWatcher& other) = delete;
+        ShaderpackWatcher& operator=(const ShaderpackWatcher& other) = delete;
+
+        ~ShaderpackWatcher();
+
+        /*!
+         * \brief Returns every file that was written, created, moved, or deleted since the last call, without waiting for any more
+         */
+        [[nodiscard]] std::vector<fs::path> get_changed_files();
+
+    private:
+        fs::path folder;
+
+#ifdef NOVA_LINUX
+        int inotify_fd = -1;
+
+        /*!
+         * \brief The folder that each inotify watch is for. inotify isn't recursive, so every folder in the shaderpack has a watch
+         */
+        std::unordered_map<int, fs::path> folders_by_watch;
+
+        void add_watch(const fs::path& watched_folder);
+#else
+        std::unordered_map<std::string, fs::file_time_type> write_times;
+
+        std::chrono::steady_clock::time_point last_scan_time;
+
+        /*!
+         * \brief Finds the files whose write times changed since the last scan
+         */
+        void scan(std::vector<fs::path>& changed_files);
+#endif
+    };
+} // namespace nova::renderer::shaderpack
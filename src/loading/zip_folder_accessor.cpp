@@ -26,6 +26,8 @@ namespace nova::renderer {
     void ZipFolderAccessor::delete_file_tree(std::unique_ptr<FileTreeNode>& node) { node = nullptr; }
 
     std::string ZipFolderAccessor::read_text_file(const fs::path& resource_path) {
+        // miniz can only read one file from an archive at a time
+        std::lock_guard l(*resource_existence_mutex);
         const fs::path full_path = *root_folder / resource_path;
 
         const std::string resource_string = full_path.string().c_str();
@@ -20,9 +20,7 @@ namespace bvestl {
 			Block* current = head;
 
 			while (current) {
-				if (current->next) {
-					next = current->next;
-				}
+				next = current->next;
 
 				allocator.deallocate(current, sizeof(Block));
 
@@ -56,15 +54,21 @@ namespace bvestl {
 			}
 
 			if (best_fit->size > size) {
+				// Split off the end of the block we found so the rest of it stays available
 				Block* block = make_new_block(best_fit->offset + size, best_fit->size - size);
 
-				best_fit->next = block;
 				block->previous = best_fit;
 				block->next = best_fit->next;
+				if (block->next) {
+					block->next->previous = block;
+				}
 
-				best_fit = block;
+				best_fit->next = block;
+				best_fit->size = size;
 			}
 
+			best_fit->free = false;
+
 			allocated += size;
 
 			allocation.size = size;
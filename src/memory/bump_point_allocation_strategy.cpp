@@ -1,7 +1,6 @@
 #include "bump_point_allocation_strategy.hpp"
 #include "nova_renderer/allocation_structs.hpp"
 #include "../util/memory_utils.hpp"
-#include <cassert>
 
 namespace bvestl {
 	namespace  polyalloc {
@@ -11,7 +10,7 @@ namespace bvestl {
 			const Bytes free_space = memory_size - allocated_bytes;
 			const Bytes aligned_size = align(size, alignment);
 
-			if (aligned_size < free_space) {
+			if (free_space < aligned_size) {
 				return false;
 			}
 
@@ -24,7 +23,7 @@ namespace bvestl {
 		}
 
 		void BumpPointAllocationStrategy::free(const AllocationInfo&) {
-			assert(false && "Cannot free from a bump-point allocator!\n");
+			// The memory is reclaimed when the whole pool is, so buffers in it can be destroyed without doing anything here
 		}
 	}
 }
@@ -8,8 +8,8 @@ namespace bvestl {
 		struct AllocationInfo;
 
 		/*!
-		 * \brief Allocates memory linearly from a single pool. Memory must be freed all at once, there's no support for freeing individual
-		 * allocations
+		 * \brief Allocates memory linearly from a single pool. Memory must be freed all at once, freeing an individual allocation does
+		 * nothing
 		 */
 		class BumpPointAllocationStrategy final : public AllocationStrategy {
 		public:
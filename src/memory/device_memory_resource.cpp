@@ -10,4 +10,8 @@ namespace nova::renderer {
 
         return {memory, alloc_info};
     }
+
+    void DeviceMemoryResource::free(const DeviceMemoryAllocation& allocation) const {
+        allocation_strategy->free(allocation.allocation_info);
+    }
 } // namespace nova::renderer
\ No newline at end of file
@@ -1,14 +1,16 @@
 #include "nova_renderer/nova_renderer.hpp"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <future>
+#include <thread>
+#include <unordered_set>
 
 #pragma warning(push, 0)
 #include <glm/ext.hpp>
 #include <glm/glm.hpp>
-#include <glslang/MachineIndependent/Initialize.h>
 #include <minitrace.h>
-#include <spirv_glsl.hpp>
 #pragma warning(pop)
 
 #include "nova_renderer/command_list.hpp"
@@ -16,12 +18,24 @@
 
 #include "debugging/renderdoc.hpp"
 #include "loading/shaderpack/render_graph_builder.hpp"
+#include "loading/shaderpack/shader_cache.hpp"
+#include "loading/shaderpack/shader_optimizer.hpp"
 #include "loading/shaderpack/shaderpack_loading.hpp"
+#include "loading/shaderpack/shaderpack_watcher.hpp"
 #include "memory/block_allocation_strategy.hpp"
 #include "memory/bump_point_allocation_strategy.hpp"
 #include "memory/mallocator.hpp"
 #include "memory/system_memory_allocator.hpp"
+#include "render_objects/draw_keys.hpp"
+#include "render_objects/geometry_arena.hpp"
+#include "render_objects/gpu_culling.hpp"
+#include "render_objects/mesh_optimizer.hpp"
+#include "render_objects/mesh_upload_manager.hpp"
+#include "render_objects/renderable_registry.hpp"
+#include "render_objects/spatial_index.hpp"
+#include "render_objects/transform_hierarchy.hpp"
 #include "render_objects/uniform_structs.hpp"
+#include "tasks/task_scheduler.hpp"
 
 // D3D12 MUST be included first because the Vulkan include undefines FAR, yet the D3D12 headers need FAR
 // Windows considered harmful
@@ -43,6 +57,23 @@ using namespace bvestl::polyalloc::operators;
 
 const Bytes global_memory_pool_size = 1_gb;
 
+/*!
+ * \brief The maximum number of model matrices that can be drawn in a single frame
+ */
+constexpr uint32_t MAX_NUM_MODEL_MATRICES = 0x40000;
+
+/*!
+ * \brief The maximum number of static renderables that can be culled on the GPU
+ *
+ * Each one reserves a model matrix, so this leaves the other half of the model matrix buffer for dynamic renderables
+ */
+constexpr uint32_t MAX_NUM_GPU_CULLED_RENDERABLES = MAX_NUM_MODEL_MATRICES / 2;
+
+/*!
+ * \brief The maximum number of mesh batches that can have static renderables culled on the GPU
+ */
+constexpr uint32_t MAX_NUM_GPU_CULLED_DRAWS = 0x4000;
+
 namespace nova::renderer {
     std::unique_ptr<NovaRenderer> NovaRenderer::instance;
 
@@ -128,28 +159,120 @@ namespace nova::renderer {
         create_global_sync_objects();
 
         create_uniform_buffers();
+
+        create_gpu_culling();
+
+        renderable_registry = std::make_unique<RenderableRegistry>();
+        static_renderable_index = std::make_unique<SpatialIndex>();
+        transforms = std::make_unique<TransformHierarchy>();
+
+        if(settings.shader_cache.enabled) {
+            shader_cache = std::make_unique<shaderpack::ShaderCache>(settings.shader_cache.folder);
+        }
+
+        if(settings.shader_optimization.optimize_for_performance || settings.shader_optimization.strip_debug_info) {
+            shader_optimizer = std::make_unique<shaderpack::ShaderOptimizer>(settings.shader_optimization.optimize_for_performance,
+                                                                             settings.shader_optimization.strip_debug_info);
+        }
+
+        // Leave a core for the thread that's recording the frame
+        const uint32_t num_cores = std::thread::hardware_concurrency();
+        culling_scheduler = std::make_unique<ttl::task_scheduler>(num_cores > 1 ? num_cores - 1 : 1, ttl::empty_queue_behavior::SLEEP);
+
+        // Meshes are optimized in the background, so a few threads are plenty
+        mesh_optimization_scheduler = std::make_unique<ttl::task_scheduler>(std::max(num_cores / 4, 1U), ttl::empty_queue_behavior::SLEEP);
+        mesh_optimization_tasks = std::make_unique<ttl::condition_counter>();
+
+        // Variants are compiled one shader at a time, and the frame draws with their fallbacks until they're done
+        pipeline_variant_scheduler = std::make_unique<ttl::task_scheduler>(std::max(num_cores / 4, 1U), ttl::empty_queue_behavior::SLEEP);
+        pipeline_variant_tasks = std::make_unique<ttl::condition_counter>();
     }
 
-    NovaRenderer::~NovaRenderer() { mtr_shutdown(); }
+    NovaRenderer::~NovaRenderer() {
+        // The mesh optimization tasks write to this renderer when they finish
+        mesh_optimization_tasks->wait_for_value(0);
+        pipeline_variant_tasks->wait_for_value(0);
+
+        // Everything waiting on a frame can be destroyed once the GPU has finished all of them
+        rhi->wait_for_fences(std::vector<rhi::Fence*>(frame_fences.begin(), frame_fences.end()));
+        rhi->flush_deferred_destructions();
+
+        mtr_shutdown();
+    }
 
     NovaSettingsAccessManager& NovaRenderer::get_settings() { return render_settings; }
 
     void NovaRenderer::execute_frame() {
         MTR_SCOPE("RenderLoop", "execute_frame");
+
+        // Swapping in the new versions of any shaderpack files that changed before the frame starts means that the whole frame uses them
+        reload_changed_shaderpack_files();
+        swap_in_compiled_pipeline_variants();
+
         frame_count++;
         cur_frame_idx = rhi->get_swapchain()->acquire_next_swapchain_image();
 
         NOVA_LOG(DEBUG) << "\n***********************\n        FRAME START        \n***********************";
 
+        // Once the last frame with this index has finished, everything that was waiting on it can be destroyed
+        rhi->wait_for_fences({frame_fences.at(cur_frame_idx)});
         rhi->reset_fences({frame_fences.at(cur_frame_idx)});
+        rhi->begin_frame(cur_frame_idx);
+
+        // All the meshes created since the last frame go to the GPU in one transfer submission
+        mesh_upload_manager->begin_frame(cur_frame_idx);
+        upload_optimized_meshes();
+        const MeshUploadManager::FlushResult uploads = mesh_upload_manager->flush(cur_frame_idx);
+
+        // Renderables have to be where they'll be drawn before anything is culled
+        update_transforms();
 
         rhi::CommandList* cmds = rhi->get_command_list(0, rhi::QueueType::Graphics);
+        cur_bound_geometry_page = GeometryArena::NO_PAGE;
+
+        MeshUploadManager::record_graphics_commands(uploads, cmds);
+
+        // The GPU culling pass owns the start of the model matrix buffer, so everything culled on the CPU goes after it
+        if(gpu_culling) {
+            gpu_culling->record_culling(culling_frustum, cmds);
+            cur_model_matrix_index = gpu_culling->get_num_instances();
+
+        } else {
+            cur_model_matrix_index = 0;
+        }
+
+        std::vector<rhi::Semaphore*> wait_semaphores;
+        if(uploads.upload_done_semaphore != nullptr) {
+            wait_semaphores.push_back(uploads.upload_done_semaphore);
+        }
+
+        for(const MeshId mesh_id : uploads.uploaded_meshes) {
+            if(const auto mesh_itr = meshes.find(mesh_id); mesh_itr != meshes.end()) {
+                mesh_itr->second.is_ready = true;
+            }
+
+            // This frame executes the mesh's last pending copies, so the ranges they read from can go away after it
+            if(const auto ranges_itr = mesh_ranges_waiting_for_copies.find(mesh_id); ranges_itr != mesh_ranges_waiting_for_copies.end()) {
+                for(const Mesh& old_range : ranges_itr->second) {
+                    retire_mesh_range(old_range);
+                }
+                mesh_ranges_waiting_for_copies.erase(ranges_itr);
+            }
+        }
+
+        cull_renderables();
 
         for(Renderpass& renderpass : renderpasses) {
             record_renderpass(renderpass, cmds);
         }
 
-        rhi->submit_command_list(cmds, rhi::QueueType::Graphics, frame_fences.at(cur_frame_idx));
+        const rhi::EliminatedCommandCounts eliminated_commands = cmds->get_eliminated_command_counts();
+        NOVA_LOG(DEBUG) << "Skipped " << eliminated_commands.pipeline_binds << " pipeline binds, "
+                        << eliminated_commands.descriptor_set_binds << " descriptor set binds, " << eliminated_commands.vertex_buffer_binds
+                        << " vertex buffer binds, and " << eliminated_commands.index_buffer_binds
+                        << " index buffer binds that wouldn't have changed anything";
+
+        rhi->submit_command_list(cmds, rhi::QueueType::Graphics, frame_fences.at(cur_frame_idx), wait_semaphores);
 
         // Wait for the GPU to finish before presenting. This destroys pipelining and throughput, however at this time I'm not sure how best
         // to say "when GPU finishes this task, CPU should do something"
@@ -162,138 +285,733 @@ namespace nova::renderer {
 
     void NovaRenderer::set_num_meshes(const uint32_t num_meshes) { meshes.reserve(num_meshes); }
 
+    /*!
+     * \brief Checks that the mesh doesn't have too many LODs, and that every LOD's indices are inside the mesh's indices
+     */
+    bool are_lods_valid(const std::vector<MeshLod>& lods, const uint32_t num_indices) {
+        if(lods.size() > MAX_MESH_LODS) {
+            return false;
+        }
+
+        return std::all_of(lods.begin(), lods.end(), [&](const MeshLod& lod) {
+            return lod.first_index <= num_indices && lod.num_indices <= num_indices - lod.first_index;
+        });
+    }
+
+    uint32_t get_num_lods(const Mesh& mesh) { return mesh.lods.empty() ? 1 : static_cast<uint32_t>(mesh.lods.size()); }
+
+    MeshLod get_mesh_lod(const Mesh& mesh, const uint32_t lod) {
+        if(mesh.lods.empty()) {
+            return {0, mesh.num_indices, 0};
+        }
+
+        return mesh.lods[lod];
+    }
+
     MeshId NovaRenderer::create_mesh(const MeshData& mesh_data) {
-        rhi::BufferCreateInfo vertex_buffer_create_info;
-        vertex_buffer_create_info.buffer_usage = rhi::BufferUsage::VertexBuffer;
-        vertex_buffer_create_info.size = mesh_data.vertex_data.size() * sizeof(FullVertex);
+        if(!are_lods_valid(mesh_data.lods, static_cast<uint32_t>(mesh_data.indices.size()))) {
+            NOVA_LOG(ERROR) << "Can't create a mesh with " << mesh_data.lods.size() << " LODs and " << mesh_data.indices.size()
+                            << " indices. Meshes may have at most " << MAX_MESH_LODS
+                            << " LODs, and every LOD's indices must be inside the mesh's indices";
+            return std::numeric_limits<MeshId>::max();
+        }
+
+        Mesh mesh;
+        if(!geometry_arena->allocate(static_cast<uint32_t>(mesh_data.vertex_data.size()),
+                                     static_cast<uint32_t>(mesh_data.indices.size()),
+                                     mesh)) {
+            NOVA_LOG(ERROR) << "Could not find space in the geometry arena for a mesh with " << mesh_data.vertex_data.size()
+                            << " vertices and " << mesh_data.indices.size() << " indices";
+            return std::numeric_limits<MeshId>::max();
+        }
 
-        rhi::Buffer* vertex_buffer = rhi->create_buffer(vertex_buffer_create_info, *mesh_memory);
+        // Uploads can only fail if the data is too large for the staging buffer, which we check now so that uploads after the mesh is
+        // optimized can't fail
+        if(!mesh_upload_manager->can_upload(mesh_data.vertex_data.size() * sizeof(FullVertex)) ||
+           !mesh_upload_manager->can_upload(mesh_data.indices.size() * sizeof(uint32_t))) {
+            NOVA_LOG(ERROR) << "A mesh with " << mesh_data.vertex_data.size() << " vertices and " << mesh_data.indices.size()
+                            << " indices is too large for the mesh staging buffer";
+            geometry_arena->free(mesh);
+            return std::numeric_limits<MeshId>::max();
+        }
 
-        // TODO: Try to get staging buffers from a pool
+        const MeshId new_mesh_id = next_mesh_id;
+        next_mesh_id++;
 
-        {
-            rhi::BufferCreateInfo staging_vertex_buffer_create_info = vertex_buffer_create_info;
-            staging_vertex_buffer_create_info.buffer_usage = rhi::BufferUsage::StagingBuffer;
-            rhi::Buffer* staging_vertex_buffer = rhi->create_buffer(staging_vertex_buffer_create_info, *staging_buffer_memory);
-            rhi->write_data_to_buffer(mesh_data.vertex_data.data(),
-                                      mesh_data.vertex_data.size() * sizeof(FullVertex),
-                                      0,
-                                      staging_vertex_buffer);
+        mesh.bounds = compute_bounds(mesh_data.vertex_data.data(), mesh_data.vertex_data.size());
+        mesh.lods = mesh_data.lods;
 
-            rhi::CommandList* vertex_upload_cmds = rhi->get_command_list(0, rhi::QueueType::Transfer);
-            vertex_upload_cmds->copy_buffer(vertex_buffer, 0, staging_vertex_buffer, 0, vertex_buffer_create_info.size);
+        const NovaSettings::MeshOptimizationOptions& optimization_options = render_settings.settings.mesh_optimization;
+        if(optimization_options.optimize_vertex_cache || optimization_options.optimize_overdraw ||
+           optimization_options.optimize_vertex_fetch) {
+            mesh.is_optimizing = true;
+            mesh.is_optimized = true;
 
-            rhi::ResourceBarrier vertex_barrier = {};
-            vertex_barrier.resource_to_barrier = vertex_buffer;
-            vertex_barrier.old_state = rhi::ResourceState::CopyDestination;
-            vertex_barrier.new_state = rhi::ResourceState::Common;
-            vertex_barrier.access_before_barrier = rhi::AccessFlags::CopyWrite;
-            vertex_barrier.access_after_barrier = rhi::AccessFlags::VertexAttributeRead;
-            vertex_barrier.buffer_memory_barrier.offset = 0;
-            vertex_barrier.buffer_memory_barrier.size = vertex_buffer->size;
+            auto optimize = [this, new_mesh_id, optimization_options, data = mesh_data](ttl::task_scheduler* /* scheduler */) mutable {
+                MTR_SCOPE("NovaRenderer", "optimize_mesh");
 
-            vertex_upload_cmds->resource_barriers(rhi::PipelineStageFlags::Transfer,
-                                                  rhi::PipelineStageFlags::VertexInput,
-                                                  {vertex_barrier});
+                const MeshOptimizationReport report = optimize_mesh(data, optimization_options);
+                NOVA_LOG(DEBUG) << "Optimized mesh " << new_mesh_id << ": ACMR " << report.before.acmr << " -> " << report.after.acmr
+                                << ", ATVR " << report.before.atvr << " -> " << report.after.atvr;
 
-            rhi->submit_command_list(vertex_upload_cmds, rhi::QueueType::Transfer);
+                std::lock_guard l(optimized_meshes_mutex);
+                optimized_meshes.emplace_back(new_mesh_id, std::move(data));
+            };
+            mesh_optimization_scheduler->add_task(mesh_optimization_tasks.get(), std::move(optimize));
 
-            // TODO: Barrier on the mesh's first usage
+        } else {
+            // The sizes were checked above, so this can't fail
+            (void) enqueue_mesh_upload(new_mesh_id, mesh, mesh_data);
         }
 
-        rhi::BufferCreateInfo index_buffer_create_info;
-        index_buffer_create_info.buffer_usage = rhi::BufferUsage::IndexBuffer;
-        index_buffer_create_info.size = mesh_data.indices.size() * sizeof(uint32_t);
+        meshes.emplace(new_mesh_id, mesh);
+
+        return new_mesh_id;
+    }
 
-        rhi::Buffer* index_buffer = rhi->create_buffer(index_buffer_create_info, *mesh_memory);
+    bool NovaRenderer::enqueue_mesh_upload(const MeshId mesh_id, const Mesh& mesh, const MeshData& mesh_data) {
+        const bool vertices_queued = mesh_upload_manager->enqueue_upload(mesh_id,
+                                                                         geometry_arena->get_vertex_buffer(mesh.page),
+                                                                         mesh.vertex_allocation.offset.b_count(),
+                                                                         mesh_data.vertex_data.data(),
+                                                                         mesh_data.vertex_data.size() * sizeof(FullVertex),
+                                                                         rhi::AccessFlags::VertexAttributeRead);
+        return vertices_queued && mesh_upload_manager->enqueue_upload(mesh_id,
+                                                                      geometry_arena->get_index_buffer(mesh.page),
+                                                                      mesh.index_allocation.offset.b_count(),
+                                                                      mesh_data.indices.data(),
+                                                                      mesh_data.indices.size() * sizeof(uint32_t),
+                                                                      rhi::AccessFlags::IndexRead);
+    }
 
+    void NovaRenderer::upload_optimized_meshes() {
+        std::vector<std::pair<MeshId, MeshData>> meshes_to_upload;
         {
-            rhi::BufferCreateInfo staging_index_buffer_create_info = index_buffer_create_info;
-            staging_index_buffer_create_info.buffer_usage = rhi::BufferUsage::StagingBuffer;
-            rhi::Buffer* staging_index_buffer = rhi->create_buffer(staging_index_buffer_create_info, *staging_buffer_memory);
-            rhi->write_data_to_buffer(mesh_data.indices.data(), mesh_data.indices.size() * sizeof(uint32_t), 0, staging_index_buffer);
+            std::lock_guard l(optimized_meshes_mutex);
+            meshes_to_upload.swap(optimized_meshes);
+        }
+
+        for(const auto& [mesh_id, mesh_data] : meshes_to_upload) {
+            // The mesh may have been destroyed while it was being optimized
+            const auto mesh_itr = meshes.find(mesh_id);
+            if(mesh_itr == meshes.end()) {
+                continue;
+            }
+
+            // The mesh's size was checked when it was created, so this can't fail
+            (void) enqueue_mesh_upload(mesh_id, mesh_itr->second, mesh_data);
+            mesh_itr->second.is_optimizing = false;
+        }
+    }
+
+    void NovaRenderer::update_mesh(const MeshId mesh_id, const MeshData& mesh_data, const MeshUpdateRange& range) {
+        MTR_SCOPE("NovaRenderer", "update_mesh");
 
-            rhi::CommandList* indices_upload_cmds = rhi->get_command_list(0, rhi::QueueType::Transfer);
-            indices_upload_cmds->copy_buffer(index_buffer, 0, staging_index_buffer, 0, index_buffer_create_info.size);
+        const auto mesh_itr = meshes.find(mesh_id);
+        if(mesh_itr == meshes.end()) {
+            NOVA_LOG(ERROR) << "Can't update mesh " << mesh_id << " because it doesn't exist";
+            return;
+        }
 
-            rhi::ResourceBarrier index_barrier = {};
-            index_barrier.resource_to_barrier = index_buffer;
-            index_barrier.old_state = rhi::ResourceState::CopyDestination;
-            index_barrier.new_state = rhi::ResourceState::Common;
-            index_barrier.access_before_barrier = rhi::AccessFlags::CopyWrite;
-            index_barrier.access_after_barrier = rhi::AccessFlags::IndexRead;
-            index_barrier.buffer_memory_barrier.offset = 0;
-            index_barrier.buffer_memory_barrier.size = index_buffer->size;
+        // The update has to land on top of the mesh's initial data, so that data has to be queued first
+        if(mesh_itr->second.is_optimizing) {
+            mesh_optimization_tasks->wait_for_value(0);
+            upload_optimized_meshes();
+        }
 
-            indices_upload_cmds->resource_barriers(rhi::PipelineStageFlags::Transfer,
-                                                   rhi::PipelineStageFlags::VertexInput,
-                                                   {index_barrier});
+        Mesh& mesh = mesh_itr->second;
 
-            rhi->submit_command_list(indices_upload_cmds, rhi::QueueType::Transfer);
+        const auto update_end_vertex = static_cast<uint32_t>(range.first_vertex + mesh_data.vertex_data.size());
+        const auto update_end_index = static_cast<uint32_t>(range.first_index + mesh_data.indices.size());
+        const uint32_t num_vertices = range.num_vertices == 0 ? update_end_vertex : range.num_vertices;
+        const uint32_t num_indices = range.num_indices == 0 ? update_end_index : range.num_indices;
 
-            // TODO: Barrier on the mesh's first usage
+        // Every part of the updated mesh has to come from either the update or the mesh's current data
+        if(range.first_vertex > mesh.num_vertices || range.first_index > mesh.num_indices || num_vertices < update_end_vertex ||
+           num_indices < update_end_index || num_vertices > std::max(update_end_vertex, mesh.num_vertices) ||
+           num_indices > std::max(update_end_index, mesh.num_indices)) {
+            NOVA_LOG(ERROR) << "Update range for mesh " << mesh_id << " would leave gaps in the mesh's data";
+            return;
         }
 
-        // TODO: Clean up staging buffers
+        const bool replaces_whole_mesh = range.first_vertex == 0 && range.first_index == 0 && update_end_vertex == num_vertices &&
+                                         update_end_index == num_indices;
+        if(mesh.is_optimized && !replaces_whole_mesh) {
+            NOVA_LOG(ERROR) << "Can't partially update mesh " << mesh_id
+                            << " because it was optimized, which moved its vertices and indices. Replace the whole mesh instead";
+            return;
+        }
 
-        Mesh mesh;
-        mesh.vertex_buffer = vertex_buffer;
-        mesh.index_buffer = index_buffer;
-        mesh.num_indices = static_cast<uint32_t>(mesh_data.indices.size());
+        std::vector<MeshLod> lods = mesh_data.lods.empty() ? mesh.lods : mesh_data.lods;
+        if(!are_lods_valid(lods, num_indices)) {
+            NOVA_LOG(ERROR) << "Update for mesh " << mesh_id << " would leave it with LODs that read past the end of its indices";
+            return;
+        }
 
-        MeshId new_mesh_id = next_mesh_id;
-        next_mesh_id++;
-        meshes.emplace(new_mesh_id, mesh);
+        const uint64_t vertex_data_size = mesh_data.vertex_data.size() * sizeof(FullVertex);
+        const uint64_t index_data_size = mesh_data.indices.size() * sizeof(uint32_t);
+        if(!mesh_upload_manager->can_upload(vertex_data_size) || !mesh_upload_manager->can_upload(index_data_size)) {
+            NOVA_LOG(ERROR) << "Update for mesh " << mesh_id << " is too large for the mesh staging buffer";
+            return;
+        }
 
-        return new_mesh_id;
+        // A copy into the mesh's current range may still be waiting to execute, and writing there now would race with it
+        const bool fits_in_place = num_vertices * sizeof(FullVertex) <= mesh.vertex_allocation.size.b_count() &&
+                                   num_indices * sizeof(uint32_t) <= mesh.index_allocation.size.b_count() &&
+                                   !mesh_upload_manager->has_pending_copies(mesh_id);
+
+        if(!fits_in_place) {
+            Mesh new_mesh;
+            if(!geometry_arena->allocate(num_vertices, num_indices, new_mesh)) {
+                NOVA_LOG(ERROR) << "Could not find space in the geometry arena for mesh " << mesh_id << " to grow to " << num_vertices
+                                << " vertices and " << num_indices << " indices";
+                return;
+            }
+
+            // The GPU already has the parts of the mesh that aren't being updated, so we copy them to the new range rather than asking
+            // the caller for them again
+            const auto copy_kept_ranges = [&](const uint32_t first, const uint32_t update_end, const uint32_t old_count,
+                                              const uint32_t new_count, const uint64_t stride, rhi::Buffer* src_buffer,
+                                              const uint64_t src_offset, rhi::Buffer* dst_buffer, const uint64_t dst_offset,
+                                              const rhi::AccessFlags access) {
+                mesh_upload_manager->enqueue_copy(mesh_id, src_buffer, src_offset, dst_buffer, dst_offset, first * stride, access);
+
+                const uint32_t kept_end = std::min(old_count, new_count);
+                if(update_end < kept_end) {
+                    mesh_upload_manager->enqueue_copy(mesh_id,
+                                                      src_buffer,
+                                                      src_offset + update_end * stride,
+                                                      dst_buffer,
+                                                      dst_offset + update_end * stride,
+                                                      (kept_end - update_end) * stride,
+                                                      access);
+                }
+            };
+
+            copy_kept_ranges(range.first_vertex,
+                             update_end_vertex,
+                             mesh.num_vertices,
+                             num_vertices,
+                             sizeof(FullVertex),
+                             geometry_arena->get_vertex_buffer(mesh.page),
+                             mesh.vertex_allocation.offset.b_count(),
+                             geometry_arena->get_vertex_buffer(new_mesh.page),
+                             new_mesh.vertex_allocation.offset.b_count(),
+                             rhi::AccessFlags::VertexAttributeRead);
+            copy_kept_ranges(range.first_index,
+                             update_end_index,
+                             mesh.num_indices,
+                             num_indices,
+                             sizeof(uint32_t),
+                             geometry_arena->get_index_buffer(mesh.page),
+                             mesh.index_allocation.offset.b_count(),
+                             geometry_arena->get_index_buffer(new_mesh.page),
+                             new_mesh.index_allocation.offset.b_count(),
+                             rhi::AccessFlags::IndexRead);
+
+            // Frames that are already in flight might still draw from the old range, and the copies we just queued read from it, so
+            // it can't be freed until the frame that executes the copies has finished
+            mesh_ranges_waiting_for_copies[mesh_id].push_back(mesh);
+            new_mesh.bounds = mesh.bounds;
+            mesh = new_mesh;
+        }
+
+        // The sizes were checked above, so these can't fail
+        (void) mesh_upload_manager->enqueue_upload(mesh_id,
+                                                   geometry_arena->get_vertex_buffer(mesh.page),
+                                                   mesh.vertex_allocation.offset.b_count() + range.first_vertex * sizeof(FullVertex),
+                                                   mesh_data.vertex_data.data(),
+                                                   vertex_data_size,
+                                                   rhi::AccessFlags::VertexAttributeRead);
+        (void) mesh_upload_manager->enqueue_upload(mesh_id,
+                                                   geometry_arena->get_index_buffer(mesh.page),
+                                                   mesh.index_allocation.offset.b_count() + range.first_index * sizeof(uint32_t),
+                                                   mesh_data.indices.data(),
+                                                   index_data_size,
+                                                   rhi::AccessFlags::IndexRead);
+
+        mesh.num_vertices = num_vertices;
+        mesh.num_indices = num_indices;
+        mesh.lods = std::move(lods);
+        mesh.is_optimized = false;
+
+        // The vertices outside of the update keep their positions, so unless the update replaced every vertex the bounds can only grow
+        const Aabb update_bounds = compute_bounds(mesh_data.vertex_data.data(), mesh_data.vertex_data.size());
+        if(range.first_vertex == 0 && update_end_vertex == num_vertices) {
+            mesh.bounds = update_bounds;
+
+        } else if(!mesh_data.vertex_data.empty()) {
+            mesh.bounds = merge_aabbs(mesh.bounds, update_bounds);
+        }
+
+        update_world_bounds_for_mesh(mesh_id);
+
+        // Don't draw the mesh while its data is half-updated. It's drawable again in the frame that flushes this update
+        mesh.is_ready = !mesh_upload_manager->has_pending_operations(mesh_id);
+    }
+
+    void NovaRenderer::destroy_mesh(const MeshId mesh_to_destroy) {
+        const auto mesh_itr = meshes.find(mesh_to_destroy);
+        if(mesh_itr == meshes.end()) {
+            NOVA_LOG(ERROR) << "Can't destroy mesh " << mesh_to_destroy << " because it doesn't exist";
+            return;
+        }
+
+        // The mesh's batches are drawn for as long as they have renderables, so they can't lose their mesh. Empty batches are skipped
+        for(const Renderpass& renderpass : renderpasses) {
+            for(const Pipeline& pipeline : renderpass.pipelines) {
+                for(const MaterialPass& material_pass : pipeline.passes) {
+                    for(const MeshBatch& batch : material_pass.static_mesh_draws) {
+                        if(batch.mesh == mesh_to_destroy && !batch.renderable_ids.empty()) {
+                            NOVA_LOG(ERROR) << "Can't destroy mesh " << mesh_to_destroy << " because " << batch.renderable_ids.size()
+                                            << " renderables still use it";
+                            return;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Nothing else will be written to the mesh's memory, so it only has to wait for the frames that might draw it
+        mesh_upload_manager->cancel_operations(mesh_to_destroy);
+
+        if(const auto ranges_itr = mesh_ranges_waiting_for_copies.find(mesh_to_destroy);
+           ranges_itr != mesh_ranges_waiting_for_copies.end()) {
+            for(const Mesh& old_range : ranges_itr->second) {
+                retire_mesh_range(old_range);
+            }
+            mesh_ranges_waiting_for_copies.erase(ranges_itr);
+        }
+
+        retire_mesh_range(mesh_itr->second);
+        meshes.erase(mesh_itr);
+    }
+
+    void NovaRenderer::retire_mesh_range(const Mesh& mesh) {
+        rhi->defer_destruction([this, mesh] { geometry_arena->free(mesh); });
     }
 
     void NovaRenderer::load_shaderpack(const std::string& shaderpack_name) {
         MTR_SCOPE("ShaderpackLoading", "load_shaderpack");
-        glslang::InitializeProcess();
 
-        const shaderpack::ShaderpackData data = shaderpack::load_shaderpack_data(fs::path(shaderpack_name.c_str()));
+        const fs::path shaderpack_path(shaderpack_name.c_str());
 
-        if(shaderpack_loaded) {
-            destroy_render_passes();
+        shaderpack::ShaderOptimizationStatistics optimization_before_load;
+        if(shader_optimizer) {
+            optimization_before_load = shader_optimizer->get_statistics();
+        }
+
+        // The culling workers are idle between frames, so they load the shaderpack's files and compile its shaders
+        const shaderpack::ShaderpackData data = shaderpack::load_shaderpack_data(shaderpack_path,
+                                                                                 shader_cache.get(),
+                                                                                 culling_scheduler.get(),
+                                                                                 shader_optimizer.get());
+
+        // Shaders from the shader cache were optimized when they were first compiled, so they aren't counted again
+        if(shader_optimizer) {
+            const shaderpack::ShaderOptimizationStatistics optimization = shader_optimizer->get_statistics();
+            const uint32_t num_shaders = optimization.num_shaders - optimization_before_load.num_shaders;
+            if(num_shaders > 0) {
+                NOVA_LOG(DEBUG) << "Optimized " << num_shaders << " shaders from "
+                                << optimization.num_instructions_before - optimization_before_load.num_instructions_before
+                                << " instructions (" << optimization.num_bytes_before - optimization_before_load.num_bytes_before
+                                << " bytes) to " << optimization.num_instructions_after - optimization_before_load.num_instructions_after
+                                << " instructions (" << optimization.num_bytes_after - optimization_before_load.num_bytes_after
+                                << " bytes)";
+            }
+        }
 
-            destroy_dynamic_resources();
+        shaderpack_dependencies = std::make_unique<shaderpack::ShaderpackDependencies>(shaderpack_path, data);
 
-            NOVA_LOG(DEBUG) << "Resources from old shaderpacks destroyed";
+        // Zipped shaderpacks can't be edited in place, so only shaderpack folders are watched
+        if(render_settings.settings.reload_shaderpack_on_change && fs::is_directory(shaderpack_path)) {
+            if(!shaderpack_watcher || shaderpack_name != loaded_shaderpack_name) {
+                shaderpack_watcher = std::make_unique<shaderpack::ShaderpackWatcher>(shaderpack_path);
+            }
+        } else {
+            shaderpack_watcher.reset();
+        }
+        loaded_shaderpack_name = shaderpack_name;
+        shaderpack_generation++;
+
+        // The old shaderpack's textures, renderpasses, framebuffers, and pipelines are kept if the new shaderpack has the same ones, so
+        // reloading a shaderpack only creates what's changed
+        std::unordered_map<std::string, OldRenderpass> old_renderpasses;
+        if(shaderpack_loaded) {
+            old_renderpasses = destroy_render_passes();
         }
 
-        create_dynamic_textures(data.resources.textures);
+        const uint32_t num_reused_textures = update_dynamic_textures(data.resources.textures);
         NOVA_LOG(DEBUG) << "Dynamic textures created";
 
-        create_render_passes(data.passes, data.pipelines, data.materials);
+        const size_t num_cached_pipelines = pipeline_cache.size();
+        const uint32_t num_reused_renderpasses = create_render_passes(data.passes,
+                                                                      data.pipelines,
+                                                                      data.materials,
+                                                                      std::move(old_renderpasses));
         NOVA_LOG(DEBUG) << "Created render passes";
 
+        if(shaderpack_loaded) {
+            NOVA_LOG(INFO) << "Reused " << num_reused_textures << " of " << data.resources.textures.size() << " textures and "
+                           << num_reused_renderpasses << " of " << renderpasses.size()
+                           << " renderpasses and framebuffers from the previous shaderpack, and created "
+                           << pipeline_cache.size() - num_cached_pipelines << " new pipelines";
+        }
+
+        destroy_unused_pipelines();
+
         shaderpack_loaded = true;
 
         NOVA_LOG(INFO) << "Shaderpack " << shaderpack_name.c_str() << " loaded successfully";
     }
 
-    void NovaRenderer::create_dynamic_textures(const std::vector<shaderpack::TextureCreateInfo>& texture_create_infos) {
+    void NovaRenderer::reload_changed_shaderpack_files() {
+        if(!shaderpack_watcher) {
+            return;
+        }
+
+        const std::vector<fs::path> changed_files = shaderpack_watcher->get_changed_files();
+        if(changed_files.empty()) {
+            return;
+        }
+
+        const shaderpack::ShaderpackReload reload = shaderpack_dependencies->get_reload(changed_files);
+        if(reload.empty()) {
+            return;
+        }
+
+        MTR_SCOPE("ShaderpackLoading", "reload_changed_shaderpack_files");
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        std::string reloaded_what = std::to_string(reload.pipeline_files.size()) + " pipelines";
+        if(reload.needs_full_reload || !reload_pipelines(reload.pipeline_files)) {
+            load_shaderpack(loaded_shaderpack_name);
+            reloaded_what = "the whole shaderpack";
+        }
+
+        const std::chrono::duration<double, std::milli> reload_time = std::chrono::high_resolution_clock::now() - start_time;
+        NOVA_LOG(INFO) << "Reloaded " << reloaded_what << " in " << reload_time.count() << " ms, because " << changed_files.size()
+                       << " files changed, including " << changed_files.front().string();
+    }
+
+    bool NovaRenderer::reload_pipelines(const std::vector<fs::path>& pipeline_files) {
+        const fs::path shaderpack_path(loaded_shaderpack_name.c_str());
+
+        for(const fs::path& pipeline_file : pipeline_files) {
+            if(!fs::exists(pipeline_file)) {
+                // The materials that use a deleted pipeline have to go too
+                return false;
+            }
+
+            const std::optional<shaderpack::PipelineCreateInfo> pipeline_create_info = shaderpack::load_pipeline(shaderpack_path,
+                                                                                                                  pipeline_file,
+                                                                                                                  shader_cache.get(),
+                                                                                                                  shader_optimizer.get());
+            if(!pipeline_create_info) {
+                NOVA_LOG(ERROR) << "Pipeline file " << pipeline_file.string() << " has errors, so the old version of it will be used";
+                continue;
+            }
+
+            // The pipeline's variants were made from the old version of it when the shaderpack was loaded
+            if(!pipeline_create_info->permutations.empty()) {
+                return false;
+            }
+
+            if(!swap_in_pipeline(*pipeline_create_info)) {
+                return false;
+            }
+
+            // The pipeline's shaders may include different files now
+            shaderpack_dependencies->add_pipeline(shaderpack_path, *pipeline_create_info, pipeline_file);
+        }
+
+        // Frames that are still in flight use the old pipelines, so they're destroyed once those frames have finished
+        destroy_unused_pipelines();
+
+        return true;
+    }
+
+    bool uses_same_shader_files(const shaderpack::PipelineCreateInfo& old_pipeline, const shaderpack::PipelineCreateInfo& new_pipeline) {
+        const auto same_file = [](const std::optional<shaderpack::ShaderSource>& old_shader,
+                                  const std::optional<shaderpack::ShaderSource>& new_shader) {
+            return old_shader.has_value() == new_shader.has_value() && (!old_shader || old_shader->filename == new_shader->filename);
+        };
+
+        return old_pipeline.vertex_shader.filename == new_pipeline.vertex_shader.filename &&
+               same_file(old_pipeline.geometry_shader, new_pipeline.geometry_shader) &&
+               same_file(old_pipeline.tessellation_control_shader, new_pipeline.tessellation_control_shader) &&
+               same_file(old_pipeline.tessellation_evaluation_shader, new_pipeline.tessellation_evaluation_shader) &&
+               same_file(old_pipeline.fragment_shader, new_pipeline.fragment_shader);
+    }
+
+    bool have_same_bindings(const std::unordered_map<std::string, rhi::ResourceBindingDescription>& old_bindings,
+                            const std::unordered_map<std::string, rhi::ResourceBindingDescription>& new_bindings) {
+        if(old_bindings.size() != new_bindings.size()) {
+            return false;
+        }
+
+        return std::all_of(old_bindings.begin(), old_bindings.end(), [&](const auto& old_binding) {
+            const auto new_binding_itr = new_bindings.find(old_binding.first);
+            if(new_binding_itr == new_bindings.end()) {
+                return false;
+            }
+
+            const rhi::ResourceBindingDescription& old_desc = old_binding.second;
+            const rhi::ResourceBindingDescription& new_desc = new_binding_itr->second;
+            return old_desc.set == new_desc.set && old_desc.binding == new_desc.binding && old_desc.count == new_desc.count &&
+                   old_desc.type == new_desc.type && old_desc.stages == new_desc.stages;
+        });
+    }
+
+    bool NovaRenderer::swap_in_pipeline(const shaderpack::PipelineCreateInfo& pipeline_create_info) {
+        for(Renderpass& renderpass : renderpasses) {
+            RenderpassMetadata& renderpass_metadata = renderpass_metadatas.at(renderpass.id);
+
+            const auto metadata_itr = renderpass_metadata.pipeline_metadata.find(pipeline_create_info.name);
+            if(metadata_itr == renderpass_metadata.pipeline_metadata.end()) {
+                continue;
+            }
+
+            PipelineMetadata& pipeline_metadata = metadata_itr->second;
+
+            // The shader dependencies only know about the shader files that the pipeline used when the shaderpack was loaded
+            if(pipeline_create_info.pass != pipeline_metadata.data.pass ||
+               !uses_same_shader_files(pipeline_metadata.data, pipeline_create_info)) {
+                return false;
+            }
+
+            ntl::Result<CachedPipeline> cached_pipeline = get_or_create_pipeline(pipeline_create_info, renderpass_metadata.data);
+            if(!cached_pipeline) {
+                NOVA_LOG(ERROR) << "Could not create pipeline " << pipeline_create_info.name << ", so the old version of it will be used: "
+                                << cached_pipeline.error.to_string();
+                return true;
+            }
+            const CachedPipeline api_pipeline = *cached_pipeline;
+
+            Pipeline& pipeline = renderpass.pipelines.at(pipeline_metadata.pipeline_index);
+
+            // The material passes' descriptor sets are compatible with the new pipeline as long as it has exactly the same descriptors
+            for(const MaterialPass& material_pass : pipeline.passes) {
+                if(!have_same_bindings(material_pass.pipeline_interface->bindings, api_pipeline.pipeline_interface->bindings)) {
+                    return false;
+                }
+            }
+
+            const auto [new_pipeline, new_metadata] = create_graphics_pipeline(api_pipeline.pipeline, pipeline_create_info);
+            pipeline.pipeline = new_pipeline.pipeline;
+            pipeline.render_queue = new_pipeline.render_queue;
+            pipeline.reads_instance_data = new_pipeline.reads_instance_data;
+
+            for(MaterialPass& material_pass : pipeline.passes) {
+                material_pass.pipeline_interface = api_pipeline.pipeline_interface;
+            }
+
+            pipeline_metadata.data = new_metadata.data;
+
+            NOVA_LOG(DEBUG) << "Swapped in the new version of pipeline " << pipeline_create_info.name;
+            return true;
+        }
+
+        // The pipeline wasn't created when the shaderpack was loaded, so nothing uses it yet
+        return false;
+    }
+
+    void NovaRenderer::compile_pipeline_variant_for(const MaterialPassKey& key) {
+        const Renderpass& renderpass = renderpasses.at(key.renderpass_index);
+        RenderpassMetadata& renderpass_metadata = renderpass_metadatas.at(renderpass.id);
+
+        for(auto& [pipeline_name, pipeline_metadata] : renderpass_metadata.pipeline_metadata) {
+            if(pipeline_metadata.pipeline_index != key.pipeline_index) {
+                continue;
+            }
+
+            if(pipeline_metadata.variant_state != PipelineVariantStateEnum::NotCompiled) {
+                return;
+            }
+            pipeline_metadata.variant_state = PipelineVariantStateEnum::Compiling;
+
+            NOVA_LOG(DEBUG) << "Compiling pipeline variant " << pipeline_name << " in the background";
+
+            auto compile = [this,
+                            shaderpack_path = fs::path(loaded_shaderpack_name.c_str()),
+                            variant = pipeline_metadata.data,
+                            generation = shaderpack_generation](ttl::task_scheduler* /* scheduler */) {
+                MTR_SCOPE("NovaRenderer", "compile_pipeline_variant");
+
+                // If the variant has errors, it keeps drawing with its fallback
+                std::optional<shaderpack::PipelineCreateInfo> compiled_variant = shaderpack::compile_pipeline_variant(
+                    shaderpack_path,
+                    variant,
+                    shader_cache.get(),
+                    shader_optimizer.get());
+                if(compiled_variant) {
+                    std::lock_guard l(compiled_pipeline_variants_mutex);
+                    compiled_pipeline_variants.emplace_back(generation, std::move(*compiled_variant));
+                }
+            };
+            pipeline_variant_scheduler->add_task(pipeline_variant_tasks.get(), std::move(compile));
+
+            return;
+        }
+    }
+
+    void NovaRenderer::swap_in_compiled_pipeline_variants() {
+        std::vector<std::pair<uint32_t, shaderpack::PipelineCreateInfo>> variants;
+        {
+            std::lock_guard l(compiled_pipeline_variants_mutex);
+            variants.swap(compiled_pipeline_variants);
+        }
+
+        for(const auto& [generation, pipeline_create_info] : variants) {
+            // Variants of a shaderpack that has since been reloaded have nowhere to go
+            if(generation == shaderpack_generation) {
+                swap_in_pipeline_variant(pipeline_create_info);
+            }
+        }
+    }
+
+    void NovaRenderer::swap_in_pipeline_variant(const shaderpack::PipelineCreateInfo& pipeline_create_info) {
+        for(Renderpass& renderpass : renderpasses) {
+            RenderpassMetadata& renderpass_metadata = renderpass_metadatas.at(renderpass.id);
+
+            const auto metadata_itr = renderpass_metadata.pipeline_metadata.find(pipeline_create_info.name);
+            if(metadata_itr == renderpass_metadata.pipeline_metadata.end()) {
+                continue;
+            }
+
+            PipelineMetadata& pipeline_metadata = metadata_itr->second;
+
+            ntl::Result<CachedPipeline> cached_pipeline = get_or_create_pipeline(pipeline_create_info, renderpass_metadata.data);
+            if(!cached_pipeline) {
+                NOVA_LOG(ERROR) << "Could not create pipeline variant " << pipeline_create_info.name
+                                << ", so it will keep drawing with its fallback: " << cached_pipeline.error.to_string();
+                return;
+            }
+            const CachedPipeline api_pipeline = *cached_pipeline;
+
+            Pipeline& pipeline = renderpass.pipelines.at(pipeline_metadata.pipeline_index);
+
+            const auto [new_pipeline, new_metadata] = create_graphics_pipeline(api_pipeline.pipeline, pipeline_create_info);
+            pipeline.pipeline = new_pipeline.pipeline;
+            pipeline.render_queue = new_pipeline.render_queue;
+            pipeline.reads_instance_data = new_pipeline.reads_instance_data;
+
+            for(const auto& [full_pass_name, pass_metadata] : pipeline_metadata.material_metadatas) {
+                MaterialPass& material_pass = pipeline.passes.at(material_pass_keys.at(full_pass_name).material_pass_index);
+
+                // The descriptor sets from the fallback still work if the variant has exactly the same descriptors
+                if(!have_same_bindings(material_pass.pipeline_interface->bindings, api_pipeline.pipeline_interface->bindings)) {
+                    material_pass.descriptor_sets = rhi->create_descriptor_sets(api_pipeline.pipeline_interface, material_descriptor_pool);
+                    bind_data_to_material_descriptor_sets(material_pass,
+                                                          pass_metadata.data.bindings,
+                                                          api_pipeline.pipeline_interface->bindings);
+                }
+
+                material_pass.pipeline_interface = api_pipeline.pipeline_interface;
+            }
+
+            pipeline_metadata.data = new_metadata.data;
+            pipeline_metadata.variant_state = PipelineVariantStateEnum::Compiled;
+
+            NOVA_LOG(DEBUG) << "Swapped in pipeline variant " << pipeline_create_info.name;
+            return;
+        }
+    }
+
+    uint32_t NovaRenderer::update_dynamic_textures(const std::vector<shaderpack::TextureCreateInfo>& texture_create_infos) {
+        std::unordered_map<std::string, const shaderpack::TextureCreateInfo*> new_texture_infos;
+        new_texture_infos.reserve(texture_create_infos.size());
+        for(const shaderpack::TextureCreateInfo& create_info : texture_create_infos) {
+            new_texture_infos.emplace(create_info.name, &create_info);
+        }
+
+        // Frames that are still in flight use the old textures, so they're destroyed once those frames have finished
+        for(auto itr = dynamic_textures.begin(); itr != dynamic_textures.end();) {
+            const auto new_info_itr = new_texture_infos.find(itr->first);
+            if(new_info_itr != new_texture_infos.end() && *new_info_itr->second == dynamic_texture_infos.at(itr->first)) {
+                ++itr;
+                continue;
+            }
+
+            rhi->destroy_texture_deferred(itr->second);
+            dynamic_texture_infos.erase(itr->first);
+            itr = dynamic_textures.erase(itr);
+        }
+
+        uint32_t num_reused_textures = 0;
         for(const shaderpack::TextureCreateInfo& create_info : texture_create_infos) {
+            if(dynamic_textures.find(create_info.name) != dynamic_textures.end()) {
+                num_reused_textures++;
+                continue;
+            }
+
             rhi::Image* new_texture = rhi->create_image(create_info);
             dynamic_textures.emplace(create_info.name, new_texture);
             dynamic_texture_infos.emplace(create_info.name, create_info);
         }
+
+        return num_reused_textures;
+    }
+
+    /*!
+     * \brief Checks if two versions of a renderpass write to the same attachments in the same way
+     *
+     * `TextureAttachmentInfo::operator==` only checks the attachments' names, but API renderpasses also depend on their formats and
+     * whether they're cleared
+     */
+    bool has_same_attachments(const shaderpack::RenderPassCreateInfo& old_pass, const shaderpack::RenderPassCreateInfo& new_pass) {
+        const auto same_attachment = [](const shaderpack::TextureAttachmentInfo& old_attachment,
+                                        const shaderpack::TextureAttachmentInfo& new_attachment) {
+            return old_attachment.name == new_attachment.name && old_attachment.pixel_format == new_attachment.pixel_format &&
+                   old_attachment.clear == new_attachment.clear;
+        };
+
+        if(old_pass.depth_texture.has_value() != new_pass.depth_texture.has_value() ||
+           (old_pass.depth_texture && !same_attachment(*old_pass.depth_texture, *new_pass.depth_texture))) {
+            return false;
+        }
+
+        return std::equal(old_pass.texture_outputs.begin(),
+                          old_pass.texture_outputs.end(),
+                          new_pass.texture_outputs.begin(),
+                          new_pass.texture_outputs.end(),
+                          same_attachment);
     }
 
-    void NovaRenderer::create_render_passes(const std::vector<shaderpack::RenderPassCreateInfo>& pass_create_infos,
-                                            const std::vector<shaderpack::PipelineCreateInfo>& pipelines,
-                                            const std::vector<shaderpack::MaterialData>& materials) {
+    uint32_t NovaRenderer::create_render_passes(const std::vector<shaderpack::RenderPassCreateInfo>& pass_create_infos,
+                                                const std::vector<shaderpack::PipelineCreateInfo>& pipelines,
+                                                const std::vector<shaderpack::MaterialData>& materials,
+                                                std::unordered_map<std::string, OldRenderpass> old_renderpasses) {
         rhi->set_num_renderpasses(static_cast<uint32_t>(pass_create_infos.size()));
 
+        std::unordered_set<std::string> variants_compiled_on_first_use;
+        for(const shaderpack::PipelineCreateInfo& pipeline_create_info : pipelines) {
+            if(pipeline_create_info.compile_on_first_use) {
+                variants_compiled_on_first_use.insert(pipeline_create_info.name);
+            }
+        }
+
         uint32_t total_num_descriptors = 0;
         for(const shaderpack::MaterialData& material_data : materials) {
             for(const shaderpack::MaterialPass& material_pass : material_data.passes) {
                 total_num_descriptors += static_cast<uint32_t>(material_pass.bindings.size());
+
+                // Material passes that use a variant get new descriptor sets when the variant is compiled
+                if(variants_compiled_on_first_use.find(material_pass.pipeline) != variants_compiled_on_first_use.end()) {
+                    total_num_descriptors += static_cast<uint32_t>(material_pass.bindings.size());
+                }
             }
         }
 
-        rhi::DescriptorPool* descriptor_pool = rhi->create_descriptor_pool(total_num_descriptors, 5, total_num_descriptors);
+        // The old material passes are gone, but frames that are still in flight use their descriptor sets
+        if(material_descriptor_pool != nullptr) {
+            rhi->destroy_descriptor_pool_deferred(material_descriptor_pool);
+        }
+
+        // Any binding might be the model matrix or instance data buffer, so there's room for each of them to be a storage buffer
+        material_descriptor_pool = rhi->create_descriptor_pool(total_num_descriptors, 5, total_num_descriptors, total_num_descriptors);
+
+        uint32_t num_reused_renderpasses = 0;
 
         for(const shaderpack::RenderPassCreateInfo& create_info : pass_create_infos) {
             Renderpass renderpass;
@@ -376,52 +1094,86 @@ namespace nova::renderer {
                 continue;
             }
 
-            ntl::Result<rhi::Renderpass*> renderpass_result = rhi->create_renderpass(create_info, framebuffer_size);
-            if(renderpass_result) {
-                renderpass.renderpass = renderpass_result.value;
+            metadata.attachments = color_attachments;
+            if(depth_attachment) {
+                metadata.attachments.push_back(*depth_attachment);
+            }
+
+            // The attachments' textures were only kept if their sizes didn't change, so the old framebuffer has the right size too
+            if(const auto old_itr = old_renderpasses.find(create_info.name);
+               old_itr != old_renderpasses.end() && old_itr->second.attachments == metadata.attachments &&
+               has_same_attachments(old_itr->second.data, create_info)) {
+                renderpass.renderpass = old_itr->second.renderpass;
+                renderpass.framebuffer = old_itr->second.framebuffer;
+                old_renderpasses.erase(old_itr);
+                num_reused_renderpasses++;
 
             } else {
-                NOVA_LOG(ERROR) << "Could not create renderpass " << create_info.name << ": " << renderpass_result.error.to_string();
-                continue;
-            }
+                ntl::Result<rhi::Renderpass*> renderpass_result = rhi->create_renderpass(create_info, framebuffer_size);
+                if(renderpass_result) {
+                    renderpass.renderpass = renderpass_result.value;
+
+                } else {
+                    NOVA_LOG(ERROR) << "Could not create renderpass " << create_info.name << ": " << renderpass_result.error.to_string();
+                    continue;
+                }
 
-            // Backbuffer framebuffers are owned by the swapchain, not the renderpass that writes to them, so if the
-            // renderpass writes to the backbuffer then we don't need to create a framebuffer for it
-            if(!writes_to_backbuffer) {
-                renderpass.framebuffer = rhi->create_framebuffer(renderpass.renderpass,
-                                                                 color_attachments,
-                                                                 depth_attachment,
-                                                                 framebuffer_size);
+                // Backbuffer framebuffers are owned by the swapchain, not the renderpass that writes to them, so if the
+                // renderpass writes to the backbuffer then we don't need to create a framebuffer for it
+                if(!writes_to_backbuffer) {
+                    renderpass.framebuffer = rhi->create_framebuffer(renderpass.renderpass,
+                                                                     color_attachments,
+                                                                     depth_attachment,
+                                                                     framebuffer_size);
+                }
             }
 
             renderpass.pipelines.reserve(pipelines.size());
             for(const shaderpack::PipelineCreateInfo& pipeline_create_info : pipelines) {
                 if(pipeline_create_info.pass == create_info.name) {
-                    std::unordered_map<std::string, ResourceBinding> bindings;
-
-                    ntl::Result<rhi::PipelineInterface*> pipeline_interface = create_pipeline_interface(pipeline_create_info,
-                                                                                                        create_info.texture_outputs,
-                                                                                                        create_info.depth_texture);
-                    if(!pipeline_interface) {
-                        NOVA_LOG(ERROR) << "Pipeline " << create_info.name
-                                        << " has an invalid interface: " << pipeline_interface.error.to_string();
+                    if(renderpass.pipelines.size() == MAX_PIPELINE) {
+                        NOVA_LOG(ERROR) << "Renderpass " << create_info.name << " can't have more than " << MAX_PIPELINE
+                                        << " pipelines, so pipeline " << pipeline_create_info.name << " will not be created";
                         continue;
                     }
 
-                    ntl::Result<PipelineReturn> pipeline_result = create_graphics_pipeline(*pipeline_interface, pipeline_create_info);
-                    if(pipeline_result) {
-                        auto [pipeline, pipeline_metadata] = *pipeline_result;
+                    // Variants that are compiled on first use draw with their fallback's API pipeline until they're compiled. The
+                    // variants come after every other pipeline, so their fallbacks have already been created
+                    const shaderpack::PipelineCreateInfo* api_pipeline_create_info = &pipeline_create_info;
+                    if(pipeline_create_info.compile_on_first_use) {
+                        auto fallback_itr = metadata.pipeline_metadata.find(pipeline_create_info.fallback.value_or(""));
+                        if(fallback_itr == metadata.pipeline_metadata.end()) {
+                            fallback_itr = metadata.pipeline_metadata.find(pipeline_create_info.parent_name.value_or(""));
+                        }
+
+                        if(fallback_itr == metadata.pipeline_metadata.end()) {
+                            NOVA_LOG(ERROR) << "Pipeline variant " << pipeline_create_info.name << " has no fallback in pass "
+                                            << create_info.name << ", so it will not be created";
+                            continue;
+                        }
+
+                        api_pipeline_create_info = &fallback_itr->second.data;
+                    }
+
+                    ntl::Result<CachedPipeline> cached_pipeline = get_or_create_pipeline(*api_pipeline_create_info, create_info);
+                    if(cached_pipeline) {
+                        const CachedPipeline api_pipeline = *cached_pipeline;
+                        auto [pipeline, pipeline_metadata] = create_graphics_pipeline(api_pipeline.pipeline, pipeline_create_info);
+                        if(pipeline_create_info.compile_on_first_use) {
+                            pipeline_metadata.variant_state = PipelineVariantStateEnum::NotCompiled;
+                        }
 
                         MaterialPassKey template_key = {};
                         template_key.renderpass_index = static_cast<uint32_t>(renderpasses.size());
                         template_key.pipeline_index = static_cast<uint32_t>(renderpass.pipelines.size());
+                        pipeline_metadata.pipeline_index = template_key.pipeline_index;
 
                         create_materials_for_pipeline(pipeline,
                                                       pipeline_metadata.material_metadatas,
                                                       materials,
                                                       pipeline_create_info.name,
-                                                      *pipeline_interface,
-                                                      descriptor_pool,
+                                                      api_pipeline.pipeline_interface,
+                                                      material_descriptor_pool,
                                                       template_key);
 
                         renderpass.pipelines.push_back(pipeline);
@@ -430,7 +1182,7 @@ namespace nova::renderer {
 
                     } else {
                         NOVA_LOG(ERROR) << "Could not create pipeline " << pipeline_create_info.name << ": "
-                                        << pipeline_result.error.to_string();
+                                        << cached_pipeline.error.to_string();
                     }
                 }
             }
@@ -440,6 +1192,16 @@ namespace nova::renderer {
             renderpasses.push_back(renderpass);
             renderpass_metadatas.push_back(metadata);
         }
+
+        // Frames that are still in flight use the old render passes, so they're destroyed once those frames have finished
+        for(auto& [name, old_renderpass] : old_renderpasses) {
+            rhi->destroy_renderpass_deferred(old_renderpass.renderpass);
+            if(old_renderpass.framebuffer != nullptr) {
+                rhi->destroy_framebuffer_deferred(old_renderpass.framebuffer);
+            }
+        }
+
+        return num_reused_renderpasses;
     }
 
     void NovaRenderer::create_materials_for_pipeline(
@@ -459,6 +1221,13 @@ namespace nova::renderer {
         for(const shaderpack::MaterialData& material_data : materials) {
             for(const shaderpack::MaterialPass& pass_data : material_data.passes) {
                 if(pass_data.pipeline == pipeline_name) {
+                    if(pipeline.passes.size() == MAX_MATERIAL_PASS) {
+                        NOVA_LOG(ERROR) << "Pipeline " << pipeline_name << " can't have more than " << MAX_MATERIAL_PASS
+                                        << " material passes, so pass " << pass_data.name << " of material " << pass_data.material_name
+                                        << " will not be created";
+                        continue;
+                    }
+
                     MaterialPass pass = {};
                     pass.pipeline_interface = pipeline_interface;
 
@@ -493,11 +1262,20 @@ namespace nova::renderer {
         std::vector<rhi::DescriptorSetWrite> writes;
         writes.reserve(bindings.size());
 
+        // The writes point into these, so they must not reallocate
         std::vector<rhi::DescriptorImageUpdate> image_updates;
         image_updates.reserve(bindings.size());
 
+        std::vector<rhi::DescriptorBufferUpdate> buffer_updates;
+        buffer_updates.reserve(bindings.size());
+
         for(const auto& [descriptor_name, resource_name] : bindings) {
-            const rhi::ResourceBindingDescription& binding_desc = descriptor_descriptions.at(descriptor_name);
+            // Variants that haven't been compiled yet use their fallback's descriptors, which might not include all of the variant's
+            const auto binding_desc_itr = descriptor_descriptions.find(descriptor_name);
+            if(binding_desc_itr == descriptor_descriptions.end()) {
+                continue;
+            }
+            const rhi::ResourceBindingDescription& binding_desc = binding_desc_itr->second;
             const rhi::DescriptorSet* descriptor_set = material.descriptor_sets.at(binding_desc.set);
 
             rhi::DescriptorSetWrite write = {};
@@ -515,12 +1293,23 @@ namespace nova::renderer {
 
                 image_updates.push_back(image_update);
 
-                write.image_info = &(*image_updates.end());
+                write.image_info = &image_updates.back();
                 write.type = rhi::DescriptorType::CombinedImageSampler;
 
                 writes.push_back(write);
 
-            } else {
+            } else if(resource_name == MODEL_MATRIX_BUFFER_NAME || resource_name == INSTANCE_DATA_BUFFER_NAME) {
+                rhi::DescriptorBufferUpdate buffer_update = {};
+                buffer_update.buffer = resource_name == MODEL_MATRIX_BUFFER_NAME ? model_matrix_buffer : instance_data_buffer;
+
+                buffer_updates.push_back(buffer_update);
+
+                write.buffer_info = &buffer_updates.back();
+                write.type = rhi::DescriptorType::StorageBuffer;
+
+                writes.push_back(write);
+
+            } else {
                 is_known = false;
             }
 
@@ -539,88 +1328,114 @@ namespace nova::renderer {
         std::unordered_map<std::string, rhi::ResourceBindingDescription> bindings;
         bindings.reserve(32); // Probably a good estimate
 
-        get_shader_module_descriptors(pipeline_create_info.vertex_shader.source, rhi::ShaderStageFlags::Vertex, bindings);
+        get_shader_module_descriptors(pipeline_create_info.vertex_shader.reflection, rhi::ShaderStageFlags::Vertex, bindings);
 
         if(pipeline_create_info.tessellation_control_shader) {
-            get_shader_module_descriptors(pipeline_create_info.tessellation_control_shader->source,
+            get_shader_module_descriptors(pipeline_create_info.tessellation_control_shader->reflection,
                                           rhi::ShaderStageFlags::TessellationControl,
                                           bindings);
         }
         if(pipeline_create_info.tessellation_evaluation_shader) {
-            get_shader_module_descriptors(pipeline_create_info.tessellation_evaluation_shader->source,
+            get_shader_module_descriptors(pipeline_create_info.tessellation_evaluation_shader->reflection,
                                           rhi::ShaderStageFlags::TessellationEvaluation,
                                           bindings);
         }
         if(pipeline_create_info.geometry_shader) {
-            get_shader_module_descriptors(pipeline_create_info.geometry_shader->source, rhi::ShaderStageFlags::Geometry, bindings);
+            get_shader_module_descriptors(pipeline_create_info.geometry_shader->reflection, rhi::ShaderStageFlags::Geometry, bindings);
         }
         if(pipeline_create_info.fragment_shader) {
-            get_shader_module_descriptors(pipeline_create_info.fragment_shader->source, rhi::ShaderStageFlags::Fragment, bindings);
+            get_shader_module_descriptors(pipeline_create_info.fragment_shader->reflection, rhi::ShaderStageFlags::Fragment, bindings);
         }
 
         return rhi->create_pipeline_interface(bindings, color_attachments, depth_texture);
     }
 
-    ntl::Result<NovaRenderer::PipelineReturn> NovaRenderer::create_graphics_pipeline(
-        rhi::PipelineInterface* pipeline_interface, const shaderpack::PipelineCreateInfo& pipeline_create_info) const {
+    ntl::Result<NovaRenderer::CachedPipeline> NovaRenderer::get_or_create_pipeline(
+        const shaderpack::PipelineCreateInfo& pipeline_create_info, const shaderpack::RenderPassCreateInfo& pass_create_info) {
+        const glm::uvec2 viewport_size = {render_settings.settings.window.width, render_settings.settings.window.height};
+        const std::string key = shaderpack::make_pipeline_cache_key(pipeline_create_info,
+                                                                    pass_create_info.texture_outputs,
+                                                                    pass_create_info.depth_texture,
+                                                                    viewport_size)
+                                    .to_string();
+
+        if(const auto itr = pipeline_cache.find(key); itr != pipeline_cache.end()) {
+            NOVA_LOG(TRACE) << "Pipeline " << pipeline_create_info.name << " hasn't changed, so it won't be created again";
+            return ntl::Result(itr->second);
+        }
+
+        ntl::Result<rhi::PipelineInterface*> pipeline_interface = create_pipeline_interface(pipeline_create_info,
+                                                                                            pass_create_info.texture_outputs,
+                                                                                            pass_create_info.depth_texture);
+        if(!pipeline_interface) {
+            return ntl::Result<CachedPipeline>(ntl::NovaError("Invalid pipeline interface", std::move(pipeline_interface.error)));
+        }
+
+        ntl::Result<rhi::Pipeline*> rhi_pipeline = rhi->create_pipeline(*pipeline_interface, pipeline_create_info);
+        if(!rhi_pipeline) {
+            rhi->destroy_pipeline_interface(*pipeline_interface);
+            return ntl::Result<CachedPipeline>(std::move(rhi_pipeline.error));
+        }
+
+        const CachedPipeline cached_pipeline = {*pipeline_interface, *rhi_pipeline};
+        pipeline_cache.emplace(key, cached_pipeline);
+
+        return ntl::Result(cached_pipeline);
+    }
+
+    NovaRenderer::PipelineReturn NovaRenderer::create_graphics_pipeline(rhi::Pipeline* rhi_pipeline,
+                                                                        const shaderpack::PipelineCreateInfo& pipeline_create_info) {
         Pipeline pipeline;
         PipelineMetadata metadata;
 
         metadata.data = pipeline_create_info;
 
-        ntl::Result<rhi::Pipeline*> rhi_pipeline = rhi->create_pipeline(pipeline_interface, pipeline_create_info);
-        if(rhi_pipeline) {
-            pipeline.pipeline = *rhi_pipeline;
-
-        } else {
-            ntl::NovaError error = ntl::NovaError(fmt::format(fmt("Could not create pipeline {:s}"), pipeline_create_info.name.c_str())
-                                                      .c_str(),
-                                                  std::move(rhi_pipeline.error));
-            return ntl::Result<PipelineReturn>(std::move(error));
-        }
+        pipeline.pipeline = rhi_pipeline;
+        pipeline.render_queue = pipeline_create_info.render_queue;
+        pipeline.reads_instance_data = std::any_of(pipeline_create_info.vertex_fields.begin(),
+                                                   pipeline_create_info.vertex_fields.end(),
+                                                   [](const shaderpack::VertexFieldData& field) {
+                                                       return shaderpack::is_per_instance_field(field.field);
+                                                   });
 
-        return ntl::Result(PipelineReturn{pipeline, metadata});
+        return {pipeline, metadata};
     }
 
-    void NovaRenderer::get_shader_module_descriptors(const std::vector<uint32_t>& spirv,
-                                                     const rhi::ShaderStageFlags shader_stage,
-                                                     std::unordered_map<std::string, rhi::ResourceBindingDescription>& bindings) {
-        std::vector<uint32_t> spirv_std(spirv.begin(), spirv.end());
-        const spirv_cross::CompilerGLSL shader_compiler(spirv_std);
-        const spirv_cross::ShaderResources resources = shader_compiler.get_shader_resources();
+    rhi::DescriptorType to_descriptor_type(const shaderpack::ShaderResourceTypeEnum type) {
+        switch(type) {
+            case shaderpack::ShaderResourceTypeEnum::SampledImage:
+                return rhi::DescriptorType::CombinedImageSampler;
 
-        for(const spirv_cross::Resource& resource : resources.sampled_images) {
-            NOVA_LOG(TRACE) << "Found a texture resource named " << resource.name;
-            add_resource_to_bindings(bindings, shader_stage, shader_compiler, resource, rhi::DescriptorType::CombinedImageSampler);
-        }
+            case shaderpack::ShaderResourceTypeEnum::UniformBuffer:
+                return rhi::DescriptorType::UniformBuffer;
 
-        for(const spirv_cross::Resource& resource : resources.uniform_buffers) {
-            NOVA_LOG(TRACE) << "Found a UBO resource named " << resource.name;
-            add_resource_to_bindings(bindings, shader_stage, shader_compiler, resource, rhi::DescriptorType::UniformBuffer);
+            case shaderpack::ShaderResourceTypeEnum::StorageBuffer:
+                return rhi::DescriptorType::StorageBuffer;
         }
 
-        for(const spirv_cross::Resource& resource : resources.storage_buffers) {
-            NOVA_LOG(TRACE) << "Found a SSBO resource named " << resource.name;
-            add_resource_to_bindings(bindings, shader_stage, shader_compiler, resource, rhi::DescriptorType::StorageBuffer);
+        return rhi::DescriptorType::UniformBuffer;
+    }
+
+    void NovaRenderer::get_shader_module_descriptors(const shaderpack::ShaderReflection& reflection,
+                                                     const rhi::ShaderStageFlags shader_stage,
+                                                     std::unordered_map<std::string, rhi::ResourceBindingDescription>& bindings) {
+        for(const shaderpack::ShaderResourceReflection& resource : reflection.resources) {
+            NOVA_LOG(TRACE) << "Found a resource named " << resource.name;
+            add_resource_to_bindings(bindings, shader_stage, resource);
         }
     }
 
     void NovaRenderer::add_resource_to_bindings(std::unordered_map<std::string, rhi::ResourceBindingDescription>& bindings,
                                                 const rhi::ShaderStageFlags shader_stage,
-                                                const spirv_cross::CompilerGLSL& shader_compiler,
-                                                const spirv_cross::Resource& resource,
-                                                const rhi::DescriptorType type) {
-        const uint32_t set = shader_compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
-        const uint32_t binding = shader_compiler.get_decoration(resource.id, spv::DecorationBinding);
-
+                                                const shaderpack::ShaderResourceReflection& resource) {
         rhi::ResourceBindingDescription new_binding = {};
-        new_binding.set = set;
-        new_binding.binding = binding;
-        new_binding.type = type;
-        new_binding.count = 1;
+        new_binding.set = resource.set;
+        new_binding.binding = resource.binding;
+        new_binding.type = to_descriptor_type(resource.type);
+        new_binding.count = resource.count;
         new_binding.stages = shader_stage;
 
-        const std::string resource_name = resource.name.c_str();
+        const std::string& resource_name = resource.name;
 
         if(bindings.find(resource_name) == bindings.end()) {
             // Totally new binding!
@@ -640,16 +1455,25 @@ namespace nova::renderer {
         }
     }
 
-    void NovaRenderer::destroy_render_passes() {
+    std::unordered_map<std::string, NovaRenderer::OldRenderpass> NovaRenderer::destroy_render_passes() {
+        std::unordered_map<std::string, OldRenderpass> old_renderpasses;
+        old_renderpasses.reserve(renderpasses.size());
+
         for(Renderpass& renderpass : renderpasses) {
-            rhi->destroy_renderpass(renderpass.renderpass);
-            rhi->destroy_framebuffer(renderpass.framebuffer);
+            // The API renderpasses and framebuffers are destroyed when the next shaderpack is loaded, unless it reuses them
+            RenderpassMetadata& metadata = renderpass_metadatas.at(renderpass.id);
+            old_renderpasses.emplace(metadata.data.name,
+                                     OldRenderpass{renderpass.renderpass, renderpass.framebuffer, metadata.data, metadata.attachments});
 
+            // The API pipelines stay in the pipeline cache, so that the next shaderpack can reuse them
             for(Pipeline& pipeline : renderpass.pipelines) {
-                rhi->destroy_pipeline(pipeline.pipeline);
-
                 for(MaterialPass& material_pass : pipeline.passes) {
-                    (void) material_pass;
+                    for(const MeshBatch& batch : material_pass.static_mesh_draws) {
+                        for(const TransformId transform : batch.transforms) {
+                            transforms->remove(transform);
+                        }
+                    }
+
                     // TODO: Destroy descriptors for material
                     // TODO: Have a way to save mesh data somewhere outside of the render graph, then process it cleanly here
                 }
@@ -657,16 +1481,42 @@ namespace nova::renderer {
         }
 
         renderpasses.clear();
+        renderpass_metadatas.clear();
+
+        // The renderables lived in the render graph, so they're gone now
+        renderable_registry->clear();
+        static_renderable_index->clear();
+        if(gpu_culling) {
+            gpu_culling->clear();
+        }
+        cpu_culled_static_renderables.clear();
+
+        return old_renderpasses;
     }
 
-    void NovaRenderer::destroy_dynamic_resources() {
-        for(auto& [name, image] : dynamic_textures) {
-            rhi->destroy_texture(image);
+    void NovaRenderer::destroy_unused_pipelines() {
+        std::unordered_set<rhi::Pipeline*> used_pipelines;
+        for(const Renderpass& renderpass : renderpasses) {
+            for(const Pipeline& pipeline : renderpass.pipelines) {
+                used_pipelines.insert(pipeline.pipeline);
+            }
         }
 
-        dynamic_textures.clear();
+        uint32_t num_destroyed_pipelines = 0;
+        for(auto itr = pipeline_cache.begin(); itr != pipeline_cache.end();) {
+            if(used_pipelines.find(itr->second.pipeline) != used_pipelines.end()) {
+                ++itr;
+                continue;
+            }
 
-        // TODO: Also destroy dynamic buffers, when we have support for those
+            rhi->destroy_pipeline_deferred(itr->second.pipeline);
+            rhi->destroy_pipeline_interface_deferred(itr->second.pipeline_interface);
+            itr = pipeline_cache.erase(itr);
+            num_destroyed_pipelines++;
+        }
+
+        NOVA_LOG(DEBUG) << "Destroyed " << num_destroyed_pipelines << " pipelines that the shaderpack doesn't use anymore. "
+                        << pipeline_cache.size() << " pipelines are in use";
     }
 
     void NovaRenderer::record_renderpass(Renderpass& renderpass, rhi::CommandList* cmds) {
@@ -719,11 +1569,11 @@ namespace nova::renderer {
             }
         }();
 
+        sort_draws(renderpass);
+
         cmds->begin_renderpass(renderpass.renderpass, framebuffer);
 
-        for(Pipeline& pipeline : renderpass.pipelines) {
-            record_pipeline(pipeline, cmds);
-        }
+        record_sorted_draws(renderpass, cmds);
 
         NOVA_LOG(TRACE) << "Ending renderpass " << renderpass_metadata.data.name;
         cmds->end_renderpass();
@@ -747,92 +1597,798 @@ namespace nova::renderer {
         }
     }
 
-    void NovaRenderer::record_pipeline(Pipeline& pipeline, rhi::CommandList* cmds) {
-        cmds->bind_pipeline(pipeline.pipeline);
+    DrawQueue to_draw_queue(const shaderpack::RenderQueueEnum render_queue) {
+        switch(render_queue) {
+            case shaderpack::RenderQueueEnum::Transparent:
+                return DrawQueue::Transparent;
+
+            case shaderpack::RenderQueueEnum::Cutout:
+                return DrawQueue::Cutout;
+
+            case shaderpack::RenderQueueEnum::Opaque:
+            default:
+                return DrawQueue::Opaque;
+        }
+    }
+
+    void NovaRenderer::sort_draws(const Renderpass& renderpass) {
+        MTR_SCOPE("RenderLoop", "sort_draws");
+
+        draw_keys.clear();
+        unsorted_draws.clear();
+
+        for(uint32_t pipeline_index = 0; pipeline_index < renderpass.pipelines.size(); pipeline_index++) {
+            const Pipeline& pipeline = renderpass.pipelines[pipeline_index];
+            const DrawQueue queue = to_draw_queue(pipeline.render_queue);
+
+            for(uint32_t pass_index = 0; pass_index < pipeline.passes.size(); pass_index++) {
+                const MaterialPass& pass = pipeline.passes[pass_index];
+
+                const auto num_batches = static_cast<uint32_t>(pass.static_mesh_draws.size());
+                for(uint32_t batch_index = 0; batch_index < num_batches; batch_index++) {
+                    const MeshBatch& batch = pass.static_mesh_draws[batch_index];
+                    if(!has_draws(batch)) {
+                        continue;
+                    }
+
+                    // A material pass with more than a million meshes would need a wider key, so the rest of its batches are still drawn
+                    // but aren't sorted
+                    if(batch_index >= MAX_MESH_BATCH) {
+                        unsorted_draws.push_back({pipeline_index, pass_index, batch_index});
+                        continue;
+                    }
 
-        for(MaterialPass& pass : pipeline.passes) {
-            record_material_pass(pass, cmds);
+                    DrawKeyFields fields;
+                    fields.queue = queue;
+                    fields.pipeline = pipeline_index;
+                    fields.material_pass = pass_index;
+                    fields.mesh_batch = batch_index;
+                    fields.depth = quantize_depth(get_batch_depth(batch, queue == DrawQueue::Transparent));
+
+                    draw_keys.push_back(make_draw_key(fields));
+                }
+            }
         }
+
+        sort_draw_keys(draw_keys, draw_key_scratch, culling_scheduler.get());
     }
 
-    void NovaRenderer::record_material_pass(MaterialPass& pass, rhi::CommandList* cmds) {
-        cmds->bind_descriptor_sets(pass.descriptor_sets, pass.pipeline_interface);
+    void NovaRenderer::record_sorted_draws(Renderpass& renderpass, rhi::CommandList* cmds) {
+        for(const DrawKey key : draw_keys) {
+            const DrawKeyFields fields = decode_draw_key(key);
+
+            // The sort put draws with the same state next to each other, and the command list drops the binds that don't change anything
+            Pipeline& pipeline = renderpass.pipelines[fields.pipeline];
+            cmds->bind_pipeline(pipeline.pipeline);
+
+            MaterialPass& pass = pipeline.passes[fields.material_pass];
+            cmds->bind_descriptor_sets(pass.descriptor_sets, pass.pipeline_interface);
 
-        for(MeshBatch<StaticMeshRenderCommand>& batch : pass.static_mesh_draws) {
-            record_rendering_static_mesh_batch(batch, cmds);
+            record_rendering_static_mesh_batch(pass.static_mesh_draws[fields.mesh_batch], pipeline.reads_instance_data, cmds);
+        }
+
+        for(const UnsortedDraw& draw : unsorted_draws) {
+            Pipeline& pipeline = renderpass.pipelines[draw.pipeline];
+            cmds->bind_pipeline(pipeline.pipeline);
+
+            MaterialPass& pass = pipeline.passes[draw.material_pass];
+            cmds->bind_descriptor_sets(pass.descriptor_sets, pass.pipeline_interface);
+
+            record_rendering_static_mesh_batch(pass.static_mesh_draws[draw.mesh_batch], pipeline.reads_instance_data, cmds);
         }
     }
 
-    void NovaRenderer::record_rendering_static_mesh_batch(MeshBatch<StaticMeshRenderCommand>& batch, rhi::CommandList* cmds) {
-        const uint32_t start_index = cur_model_matrix_index;
+    bool NovaRenderer::has_draws(const MeshBatch& batch) const {
+        if(batch.renderable_ids.empty() || !meshes.at(batch.mesh).is_ready) {
+            return false;
+        }
+
+        if(gpu_culling && batch.num_static > 0 && batch.gpu_draw != GpuCulling::NO_DRAW) {
+            return true;
+        }
 
-        for(const StaticMeshRenderCommand& command : batch.renderables) {
-            if(command.is_visible) {
-                rhi->write_data_to_buffer(&command.model_matrix,
-                                          sizeof(glm::mat4),
-                                          cur_model_matrix_index * sizeof(glm::mat4),
-                                          model_matrix_buffer);
-                cur_model_matrix_index++;
+        if(batch.num_visible_static > 0) {
+            return true;
+        }
+
+        return std::any_of(batch.num_visible_per_chunk.begin(), batch.num_visible_per_chunk.end(), [](const uint32_t num_visible) {
+            return num_visible > 0;
+        });
+    }
+
+    float NovaRenderer::get_batch_depth(const MeshBatch& batch, const bool use_furthest) const {
+        // The clip-space W of a point is its distance along the camera's view direction
+        const glm::vec4 depth_row(culling_view_projection[0][3],
+                                  culling_view_projection[1][3],
+                                  culling_view_projection[2][3],
+                                  culling_view_projection[3][3]);
+
+        bool has_depth = false;
+        float batch_depth = 0;
+        const auto add_renderables = [&](const uint32_t first_renderable, const uint32_t num_renderables) {
+            for(uint32_t i = first_renderable; i < first_renderable + num_renderables; i++) {
+                const float depth = glm::dot(depth_row, batch.visible_model_matrices[i][3]);
+                if(!has_depth || (use_furthest ? depth > batch_depth : depth < batch_depth)) {
+                    batch_depth = depth;
+                    has_depth = true;
+                }
+            }
+        };
+
+        add_renderables(0, batch.num_visible_static);
+        for(uint32_t chunk_index = 0; chunk_index < batch.num_visible_per_chunk.size(); chunk_index++) {
+            add_renderables(batch.num_static + chunk_index * MeshBatch::CULLING_CHUNK_SIZE, batch.num_visible_per_chunk[chunk_index]);
+        }
+
+        return batch_depth;
+    }
+
+    void NovaRenderer::record_rendering_static_mesh_batch(MeshBatch& batch, const bool needs_instance_data, rhi::CommandList* cmds) {
+        if(batch.renderable_ids.empty()) {
+            // Every renderable was removed from this batch, and its mesh might be gone too
+            return;
+        }
+
+        const Mesh& mesh = meshes.at(batch.mesh);
+        if(!mesh.is_ready) {
+            // The mesh's data is still on its way to the GPU
+            return;
+        }
+
+        // Most meshes share a geometry arena page, so we only have to bind buffers when we move to a mesh in a different page
+        const auto bind_geometry = [&] {
+            if(mesh.page != cur_bound_geometry_page) {
+                geometry_arena->bind_page(mesh.page, cmds);
+                cur_bound_geometry_page = mesh.page;
+            }
+        };
+
+        // The GPU culling pass decides how many static renderables are drawn, so their draw is always recorded
+        if(gpu_culling && batch.num_static > 0 && batch.gpu_draw != GpuCulling::NO_DRAW) {
+            bind_geometry();
+            cmds->draw_indexed_indirect(gpu_culling->get_draw_buffer(), GpuCulling::get_draw_offset(batch.gpu_draw), 1);
+        }
+
+        // Culling packed the visible static renderables together, and each chunk's visible dynamic renderables together, ordered by LOD,
+        // so each LOD of each group is written with a single copy
+        const auto write_group = [&](const uint32_t group, const uint32_t group_start, const uint32_t lod) {
+            const std::array<uint32_t, MAX_MESH_LODS>& lod_counts = batch.visible_lod_counts[group];
+
+            uint32_t lod_start = group_start;
+            for(uint32_t i = 0; i < lod; i++) {
+                lod_start += lod_counts[i];
+            }
+
+            const uint32_t first_instance = cur_model_matrix_index;
+            const bool has_space = write_model_matrices(&batch.visible_model_matrices[lod_start], lod_counts[lod]);
+            if(needs_instance_data) {
+                write_instance_data(batch, lod_start, cur_model_matrix_index - first_instance, first_instance);
+            }
+
+            return has_space;
+        };
+
+        const uint32_t num_lods = get_num_lods(mesh);
+        bool has_space = true;
+        for(uint32_t lod = 0; has_space && lod < num_lods; lod++) {
+            const uint32_t start_index = cur_model_matrix_index;
+
+            has_space = write_group(0, 0, lod);
+            for(uint32_t chunk_index = 0; has_space && chunk_index < batch.num_visible_per_chunk.size(); chunk_index++) {
+                has_space = write_group(chunk_index + 1, batch.num_static + chunk_index * MeshBatch::CULLING_CHUNK_SIZE, lod);
             }
+
+            if(start_index != cur_model_matrix_index) {
+                bind_geometry();
+
+                const MeshLod lod_indices = get_mesh_lod(mesh, lod);
+                cmds->draw_indexed_mesh(lod_indices.num_indices,
+                                        cur_model_matrix_index - start_index,
+                                        mesh.first_index + lod_indices.first_index,
+                                        mesh.vertex_offset,
+                                        start_index);
+            }
+        }
+    }
+
+    bool NovaRenderer::write_model_matrices(const glm::mat4* model_matrices, uint32_t num_model_matrices) {
+        if(num_model_matrices == 0) {
+            return true;
+        }
+
+        const bool is_too_many = cur_model_matrix_index + num_model_matrices > MAX_NUM_MODEL_MATRICES;
+        if(is_too_many) {
+            NOVA_LOG(ERROR) << "Too many renderables this frame, only the first " << MAX_NUM_MODEL_MATRICES << " will be drawn";
+            num_model_matrices = MAX_NUM_MODEL_MATRICES - cur_model_matrix_index;
         }
 
-        if(start_index != cur_model_matrix_index) {
-            const std::vector<rhi::Buffer*> vertex_buffers = {batch.vertex_buffer,
-                                                              batch.vertex_buffer,
-                                                              batch.vertex_buffer,
-                                                              batch.vertex_buffer,
-                                                              batch.vertex_buffer,
-                                                              batch.vertex_buffer,
-                                                              batch.vertex_buffer};
-            cmds->bind_vertex_buffers(vertex_buffers);
-            cmds->bind_index_buffer(batch.index_buffer);
+        rhi->write_data_to_buffer(model_matrices,
+                                  num_model_matrices * sizeof(glm::mat4),
+                                  cur_model_matrix_index * sizeof(glm::mat4),
+                                  model_matrix_buffer);
+        cur_model_matrix_index += num_model_matrices;
 
-            cmds->draw_indexed_mesh(static_cast<uint32_t>(batch.index_buffer->size / sizeof(uint32_t)),
-                                    cur_model_matrix_index - start_index);
+        return !is_too_many;
+    }
+
+    void NovaRenderer::write_instance_data(const MeshBatch& batch,
+                                           const uint32_t first_visible,
+                                           const uint32_t num_instances,
+                                           const uint32_t first_instance) {
+        if(num_instances == 0) {
+            return;
         }
+
+        instance_data_scratch.resize(num_instances);
+        for(uint32_t i = 0; i < num_instances; i++) {
+            instance_data_scratch[i] = batch.instance_data[batch.visible_indices[first_visible + i]];
+        }
+
+        rhi->write_data_to_buffer(instance_data_scratch.data(),
+                                  num_instances * sizeof(InstanceData),
+                                  first_instance * sizeof(InstanceData),
+                                  instance_data_buffer);
     }
 
     RenderableId NovaRenderer::add_renderable_for_material(const FullMaterialPassName& material_name,
                                                            const StaticMeshRenderableData& renderable) {
-        const RenderableId id = next_renderable_id.load();
-        next_renderable_id.fetch_add(1);
-
-        auto pos = material_pass_keys.find(material_name);
+        const auto pos = material_pass_keys.find(material_name);
         if(pos == material_pass_keys.end()) {
             NOVA_LOG(ERROR) << "No material named " << material_name.material_name << " for pass " << material_name.pass_name;
-            return std::numeric_limits<uint64_t>::max();
+            return RenderableRegistry::INVALID_ID;
         }
 
-        // Figure out where to put the renderable
-        const MaterialPassKey& pass_key = material_pass_keys.at(material_name);
+        if(meshes.find(renderable.mesh) == meshes.end()) {
+            NOVA_LOG(ERROR) << "No mesh with ID " << renderable.mesh;
+            return RenderableRegistry::INVALID_ID;
+        }
 
-        Renderpass& renderpass = renderpasses.at(pass_key.renderpass_index);
-        Pipeline& pipeline = renderpass.pipelines.at(pass_key.pipeline_index);
-        MaterialPass& material = pipeline.passes.at(pass_key.material_pass_index);
+        if(renderable.parent != NO_TRANSFORM && !transforms->contains(renderable.parent)) {
+            NOVA_LOG(ERROR) << "No transform with ID " << renderable.parent;
+            return RenderableRegistry::INVALID_ID;
+        }
 
-        const Mesh& mesh = meshes.at(renderable.mesh);
+        // The renderable's location depends on its ID, since the batch stores the ID, so the location is filled in after adding it
+        const RenderableId id = renderable_registry->add({});
+        const TransformId transform = transforms->add(renderable, id);
+        const RenderableLocation location = add_to_mesh_batch(pos->second,
+                                                              renderable.mesh,
+                                                              id,
+                                                              transform,
+                                                              *transforms->get_world_matrix(transform),
+                                                              renderable.instance_data,
+                                                              true,
+                                                              renderable.is_static);
+        *renderable_registry->find(id) = location;
+
+        compile_pipeline_variant_for(pos->second);
 
         if(renderable.is_static) {
-            for(MeshBatch<StaticMeshRenderCommand>& batch : material.static_mesh_draws) {
-                if(batch.vertex_buffer == mesh.vertex_buffer) {
-                    StaticMeshRenderCommand command = {};
-                    command.id = id;
-                    command.is_visible = true;
-                    // TODO: Make sure this is accurate
-                    command.model_matrix = glm::translate(command.model_matrix, renderable.initial_position);
-                    command.model_matrix = glm::rotate(command.model_matrix, renderable.initial_rotation.x, {1, 0, 0});
-                    command.model_matrix = glm::rotate(command.model_matrix, renderable.initial_rotation.y, {0, 1, 0});
-                    command.model_matrix = glm::rotate(command.model_matrix, renderable.initial_rotation.z, {0, 0, 1});
-                    command.model_matrix = glm::scale(command.model_matrix, renderable.initial_scale);
-
-                    batch.renderables.emplace_back(command);
-                }
+            MeshBatch& batch = get_material_pass(location.material_pass).static_mesh_draws[location.batch_index];
+            static_renderable_index->insert(id, batch.world_bounds.get(location.index_in_batch));
+
+            if(gpu_culling) {
+                add_to_gpu_culling(id, batch, location.index_in_batch);
             }
         }
 
         return id;
     }
 
+    void NovaRenderer::update_renderable(const RenderableId renderable, const StaticMeshRenderableUpdateData& update_data) {
+        RenderableLocation* location = renderable_registry->find(renderable);
+        if(location == nullptr) {
+            NOVA_LOG(ERROR) << "Can't update renderable " << renderable << " because it doesn't exist";
+            return;
+        }
+
+        const auto mesh_itr = meshes.find(update_data.mesh);
+        if(mesh_itr == meshes.end()) {
+            NOVA_LOG(ERROR) << "Can't update renderable " << renderable << " to use mesh " << update_data.mesh
+                            << " because the mesh doesn't exist";
+            return;
+        }
+
+        // The renderable's model matrix and bounds change when the transform hierarchy is updated
+        MeshBatch& batch = get_material_pass(location->material_pass).static_mesh_draws[location->batch_index];
+        const TransformId transform = batch.transforms[location->index_in_batch];
+        if(!transforms->set_local_transform(transform, update_data)) {
+            return;
+        }
+
+        if(batch.mesh == update_data.mesh) {
+            batch.instance_data[location->index_in_batch] = update_data.instance_data;
+            if(gpu_culling && location->index_in_batch < batch.num_static) {
+                gpu_culling->update(renderable,
+                                    batch.gpu_draw,
+                                    batch.model_matrices[location->index_in_batch],
+                                    update_data.instance_data,
+                                    batch.world_bounds.get(location->index_in_batch));
+            }
+            return;
+        }
+
+        // The renderable draws a different mesh now, so it moves to that mesh's batch
+        const bool is_visible = batch.visibilities[location->index_in_batch] != 0;
+        const bool is_static = location->index_in_batch < batch.num_static;
+        const RenderableLocation old_location = *location;
+        remove_from_mesh_batch(old_location);
+
+        const RenderableLocation new_location = add_to_mesh_batch(old_location.material_pass,
+                                                                  update_data.mesh,
+                                                                  renderable,
+                                                                  transform,
+                                                                  *transforms->get_world_matrix(transform),
+                                                                  update_data.instance_data,
+                                                                  is_visible,
+                                                                  is_static);
+        *renderable_registry->find(renderable) = new_location;
+
+        if(is_static) {
+            MeshBatch& new_batch = get_material_pass(new_location.material_pass).static_mesh_draws[new_location.batch_index];
+            static_renderable_index->update(renderable, new_batch.world_bounds.get(new_location.index_in_batch));
+
+            // The new batch's draw might be different, or GPU culling might not have room for it
+            if(gpu_culling) {
+                gpu_culling->remove(renderable);
+                add_to_gpu_culling(renderable, new_batch, new_location.index_in_batch);
+            }
+        }
+    }
+
+    void NovaRenderer::set_visibility(const RenderableId renderable, const bool is_visible) {
+        const RenderableLocation* location = renderable_registry->find(renderable);
+        if(location == nullptr) {
+            NOVA_LOG(ERROR) << "Can't set the visibility of renderable " << renderable << " because it doesn't exist";
+            return;
+        }
+
+        MeshBatch& batch = get_material_pass(location->material_pass).static_mesh_draws[location->batch_index];
+        batch.visibilities[location->index_in_batch] = is_visible ? 1 : 0;
+
+        if(gpu_culling && location->index_in_batch < batch.num_static) {
+            gpu_culling->set_visibility(renderable, is_visible);
+        }
+    }
+
+    void NovaRenderer::remove_renderable(const RenderableId renderable) {
+        const RenderableLocation* location = renderable_registry->find(renderable);
+        if(location == nullptr) {
+            NOVA_LOG(ERROR) << "Can't remove renderable " << renderable << " because it doesn't exist";
+            return;
+        }
+
+        const MeshBatch& batch = get_material_pass(location->material_pass).static_mesh_draws[location->batch_index];
+        transforms->remove(batch.transforms[location->index_in_batch]);
+
+        remove_from_mesh_batch(*location);
+        renderable_registry->remove(renderable);
+        static_renderable_index->remove(renderable);
+        if(gpu_culling) {
+            gpu_culling->remove(renderable);
+            cpu_culled_static_renderables.erase(renderable);
+        }
+    }
+
+    TransformId NovaRenderer::get_renderable_transform(const RenderableId renderable) {
+        const RenderableLocation* location = renderable_registry->find(renderable);
+        if(location == nullptr) {
+            NOVA_LOG(ERROR) << "Can't get the transform of renderable " << renderable << " because it doesn't exist";
+            return NO_TRANSFORM;
+        }
+
+        const MeshBatch& batch = get_material_pass(location->material_pass).static_mesh_draws[location->batch_index];
+        return batch.transforms[location->index_in_batch];
+    }
+
+    TransformId NovaRenderer::create_transform(const TransformData& transform) { return transforms->add(transform); }
+
+    void NovaRenderer::update_transform(const TransformId transform, const TransformData& data) {
+        (void) transforms->set_local_transform(transform, data);
+    }
+
+    void NovaRenderer::destroy_transform(const TransformId transform) {
+        if(!transforms->remove(transform)) {
+            NOVA_LOG(ERROR) << "Can't destroy transform " << transform << " because it doesn't exist";
+        }
+    }
+
+    void NovaRenderer::update_transforms() {
+        MTR_SCOPE("RenderLoop", "update_transforms");
+
+        const uint32_t num_recomputed = transforms->update(culling_scheduler.get());
+        NOVA_LOG(DEBUG) << "Recomputed " << num_recomputed << " world matrices";
+
+        for(const RenderableId renderable : transforms->get_moved_renderables()) {
+            const RenderableLocation* location = renderable_registry->find(renderable);
+            MeshBatch& batch = get_material_pass(location->material_pass).static_mesh_draws[location->batch_index];
+            const uint32_t index = location->index_in_batch;
+
+            const glm::mat4& model_matrix = *transforms->get_world_matrix(batch.transforms[index]);
+            batch.model_matrices[index] = model_matrix;
+            const Aabb world_bounds = transform_aabb(meshes.at(batch.mesh).bounds, model_matrix);
+            batch.world_bounds.set(index, world_bounds);
+
+            if(index < batch.num_static) {
+                static_renderable_index->update(renderable, world_bounds);
+                if(gpu_culling) {
+                    gpu_culling->update(renderable, batch.gpu_draw, model_matrix, batch.instance_data[index], world_bounds);
+                }
+            }
+        }
+    }
+
+    void NovaRenderer::set_culling_camera(const glm::mat4& view_projection) {
+        culling_frustum = make_frustum(view_projection);
+        culling_view_projection = view_projection;
+        lod_selector = make_lod_selector(view_projection, render_settings.settings.lod_hysteresis);
+    }
+
+    MaterialPass& NovaRenderer::get_material_pass(const MaterialPassKey& key) {
+        return renderpasses[key.renderpass_index].pipelines[key.pipeline_index].passes[key.material_pass_index];
+    }
+
+    uint32_t NovaRenderer::get_or_create_mesh_batch(MaterialPass& material_pass, const MeshId mesh) {
+        const auto [batch_itr, is_new] = material_pass.static_mesh_batch_indices.emplace(mesh,
+                                                                                          static_cast<uint32_t>(
+                                                                                              material_pass.static_mesh_draws.size()));
+        if(is_new) {
+            if(material_pass.static_mesh_draws.size() == MAX_MESH_BATCH) {
+                NOVA_LOG(WARN) << "A material pass has more than " << MAX_MESH_BATCH
+                               << " meshes, so the draws for any more meshes will not be sorted by state or depth";
+            }
+
+            MeshBatch batch = {};
+            batch.mesh = mesh;
+            material_pass.static_mesh_draws.push_back(std::move(batch));
+        }
+
+        return batch_itr->second;
+    }
+
+    RenderableLocation NovaRenderer::add_to_mesh_batch(const MaterialPassKey& key,
+                                                       const MeshId mesh,
+                                                       const RenderableId id,
+                                                       const TransformId transform,
+                                                       const glm::mat4& model_matrix,
+                                                       const InstanceData& instance_data,
+                                                       const bool is_visible,
+                                                       const bool is_static) {
+        MaterialPass& material_pass = get_material_pass(key);
+
+        RenderableLocation location;
+        location.material_pass = key;
+        location.batch_index = get_or_create_mesh_batch(material_pass, mesh);
+
+        MeshBatch& batch = material_pass.static_mesh_draws[location.batch_index];
+        location.index_in_batch = static_cast<uint32_t>(batch.renderable_ids.size());
+
+        batch.renderable_ids.push_back(id);
+        batch.model_matrices.push_back(model_matrix);
+        batch.transforms.push_back(transform);
+        batch.instance_data.push_back(instance_data);
+        batch.visibilities.push_back(is_visible ? 1 : 0);
+        batch.lods.push_back(0);
+        batch.world_bounds.push_back(transform_aabb(meshes.at(mesh).bounds, model_matrix));
+
+        if(is_static) {
+            // The first dynamic renderable moves to the end to make room
+            if(location.index_in_batch != batch.num_static) {
+                swap_in_mesh_batch(batch, location.index_in_batch, batch.num_static);
+                location.index_in_batch = batch.num_static;
+            }
+
+            batch.num_static++;
+        }
+
+        return location;
+    }
+
+    void NovaRenderer::remove_from_mesh_batch(const RenderableLocation& location) {
+        MeshBatch& batch = get_material_pass(location.material_pass).static_mesh_draws[location.batch_index];
+
+        uint32_t index = location.index_in_batch;
+        if(index < batch.num_static) {
+            // Move the renderable to the end of the static renderables first, so the static renderables stay together
+            batch.num_static--;
+            swap_in_mesh_batch(batch, index, batch.num_static);
+            index = batch.num_static;
+        }
+
+        const uint32_t last_index = static_cast<uint32_t>(batch.renderable_ids.size()) - 1;
+        if(index != last_index) {
+            swap_in_mesh_batch(batch, index, last_index);
+        }
+
+        batch.renderable_ids.pop_back();
+        batch.model_matrices.pop_back();
+        batch.transforms.pop_back();
+        batch.instance_data.pop_back();
+        batch.visibilities.pop_back();
+        batch.lods.pop_back();
+        batch.world_bounds.swap_remove(last_index);
+    }
+
+    void NovaRenderer::swap_in_mesh_batch(MeshBatch& batch, const uint32_t first_index, const uint32_t second_index) {
+        if(first_index == second_index) {
+            return;
+        }
+
+        std::swap(batch.renderable_ids[first_index], batch.renderable_ids[second_index]);
+        std::swap(batch.model_matrices[first_index], batch.model_matrices[second_index]);
+        std::swap(batch.transforms[first_index], batch.transforms[second_index]);
+        std::swap(batch.instance_data[first_index], batch.instance_data[second_index]);
+        std::swap(batch.visibilities[first_index], batch.visibilities[second_index]);
+        std::swap(batch.lods[first_index], batch.lods[second_index]);
+
+        const Aabb first_bounds = batch.world_bounds.get(first_index);
+        batch.world_bounds.set(first_index, batch.world_bounds.get(second_index));
+        batch.world_bounds.set(second_index, first_bounds);
+
+        renderable_registry->find(batch.renderable_ids[first_index])->index_in_batch = first_index;
+        renderable_registry->find(batch.renderable_ids[second_index])->index_in_batch = second_index;
+    }
+
+    void NovaRenderer::update_world_bounds_for_mesh(const MeshId mesh) {
+        const Mesh& mesh_data = meshes.at(mesh);
+        const Aabb& bounds = mesh_data.bounds;
+
+        for(Renderpass& renderpass : renderpasses) {
+            for(Pipeline& pipeline : renderpass.pipelines) {
+                for(MaterialPass& pass : pipeline.passes) {
+                    const auto batch_itr = pass.static_mesh_batch_indices.find(mesh);
+                    if(batch_itr == pass.static_mesh_batch_indices.end()) {
+                        continue;
+                    }
+
+                    MeshBatch& batch = pass.static_mesh_draws[batch_itr->second];
+                    for(uint32_t i = 0; i < batch.model_matrices.size(); i++) {
+                        const Aabb world_bounds = transform_aabb(bounds, batch.model_matrices[i]);
+                        batch.world_bounds.set(i, world_bounds);
+                        if(i < batch.num_static) {
+                            static_renderable_index->update(batch.renderable_ids[i], world_bounds);
+                            if(gpu_culling) {
+                                gpu_culling->update(batch.renderable_ids[i],
+                                                    batch.gpu_draw,
+                                                    batch.model_matrices[i],
+                                                    batch.instance_data[i],
+                                                    world_bounds);
+                            }
+                        }
+                    }
+
+                    // The mesh may have moved in the geometry arena, or gained or lost indices
+                    // LODs aren't selected on the GPU, so GPU-culled renderables always draw the most detailed LOD
+                    if(gpu_culling && batch.gpu_draw != GpuCulling::NO_DRAW) {
+                        const MeshLod lod = get_mesh_lod(mesh_data, 0);
+                        gpu_culling->set_draw_geometry(batch.gpu_draw,
+                                                       lod.num_indices,
+                                                       mesh_data.first_index + lod.first_index,
+                                                       mesh_data.vertex_offset);
+                    }
+                }
+            }
+        }
+    }
+
+    void NovaRenderer::create_gpu_draw_for_batch(MeshBatch& batch) {
+        if(batch.gpu_draw != GpuCulling::NO_DRAW) {
+            return;
+        }
+
+        batch.gpu_draw = gpu_culling->add_draw();
+        if(batch.gpu_draw != GpuCulling::NO_DRAW) {
+            const Mesh& mesh = meshes.at(batch.mesh);
+            const MeshLod lod = get_mesh_lod(mesh, 0);
+            gpu_culling->set_draw_geometry(batch.gpu_draw, lod.num_indices, mesh.first_index + lod.first_index, mesh.vertex_offset);
+        }
+    }
+
+    void NovaRenderer::add_to_gpu_culling(const RenderableId renderable, MeshBatch& batch, const uint32_t index_in_batch) {
+        create_gpu_draw_for_batch(batch);
+        if(batch.gpu_draw != GpuCulling::NO_DRAW && gpu_culling->insert(renderable,
+                                                                          batch.gpu_draw,
+                                                                          batch.model_matrices[index_in_batch],
+                                                                          batch.instance_data[index_in_batch],
+                                                                          batch.world_bounds.get(index_in_batch),
+                                                                          batch.visibilities[index_in_batch] != 0)) {
+            cpu_culled_static_renderables.erase(renderable);
+            return;
+        }
+
+        NOVA_LOG(DEBUG) << "GPU culling is full, so static renderable " << renderable << " will be culled on the CPU";
+        cpu_culled_static_renderables.insert(renderable);
+    }
+
+    /*!
+     * \brief One chunk of one mesh batch to cull
+     */
+    struct CullingJob {
+        const Mesh* mesh;
+        MeshBatch* batch;
+        uint32_t chunk_index;
+        uint32_t num_renderables;
+    };
+
+    void NovaRenderer::cull_renderables() {
+        MTR_SCOPE("RenderLoop", "cull_renderables");
+
+        std::vector<CullingJob> jobs;
+        for(Renderpass& renderpass : renderpasses) {
+            for(Pipeline& pipeline : renderpass.pipelines) {
+                for(MaterialPass& pass : pipeline.passes) {
+                    for(MeshBatch& batch : pass.static_mesh_draws) {
+                        batch.num_visible_static = 0;
+                        batch.visible_lod_counts.resize(1);
+                        batch.visible_lod_counts[0].fill(0);
+
+                        // Batches that won't be drawn don't need to be culled. Empty batches might not have a mesh anymore
+                        const auto mesh_itr = batch.renderable_ids.empty() ? meshes.end() : meshes.find(batch.mesh);
+                        if(mesh_itr == meshes.end() || !mesh_itr->second.is_ready) {
+                            batch.num_visible_per_chunk.clear();
+                            continue;
+                        }
+                        const Mesh& mesh = mesh_itr->second;
+
+                        const auto num_renderables = static_cast<uint32_t>(batch.renderable_ids.size());
+                        const uint32_t num_dynamic = num_renderables - batch.num_static;
+                        const uint32_t num_chunks = (num_dynamic + MeshBatch::CULLING_CHUNK_SIZE - 1) / MeshBatch::CULLING_CHUNK_SIZE;
+                        batch.visible_indices.resize(num_renderables);
+                        batch.visible_model_matrices.resize(num_renderables);
+                        batch.num_visible_per_chunk.resize(num_chunks);
+                        batch.visible_lod_counts.resize(num_chunks + 1);
+                        batch.lod_sort_scratch.resize(num_renderables);
+
+                        for(uint32_t chunk_index = 0; chunk_index < num_chunks; chunk_index++) {
+                            const uint32_t chunk_start = chunk_index * MeshBatch::CULLING_CHUNK_SIZE;
+                            jobs.push_back(
+                                {&mesh, &batch, chunk_index, std::min(MeshBatch::CULLING_CHUNK_SIZE, num_dynamic - chunk_start)});
+                        }
+                    }
+                }
+            }
+        }
+
+        // Most batches are much smaller than a chunk, so each task culls about a chunk's worth of renderables from however many jobs that
+        // takes
+        const auto cull_jobs = [&jobs, &frustum = culling_frustum, &selector = lod_selector](const size_t first_job, const size_t end_job) {
+            for(size_t i = first_job; i < end_job; i++) {
+                cull_mesh_batch_chunk(frustum, selector, *jobs[i].mesh, *jobs[i].batch, jobs[i].chunk_index);
+            }
+        };
+
+        ttl::condition_counter tasks_remaining;
+        size_t first_job = 0;
+        uint32_t num_renderables_in_task = 0;
+        for(size_t i = 0; i < jobs.size(); i++) {
+            num_renderables_in_task += jobs[i].num_renderables;
+            const bool is_last_job = i + 1 == jobs.size();
+            if(num_renderables_in_task < MeshBatch::CULLING_CHUNK_SIZE && !is_last_job) {
+                continue;
+            }
+
+            if(first_job == 0 && is_last_job) {
+                // There's only enough work for one task, so it's faster to do it here than to hand it off
+                cull_jobs(first_job, i + 1);
+
+            } else {
+                culling_scheduler->add_task(&tasks_remaining,
+                                            [&cull_jobs, first_job, end_job = i + 1](ttl::task_scheduler* /* scheduler */) {
+                                                cull_jobs(first_job, end_job);
+                                            });
+            }
+
+            first_job = i + 1;
+            num_renderables_in_task = 0;
+        }
+
+        // The static renderables are packed in front of the dynamic renderables' chunks, so they can be gathered while the chunks are
+        // culled. When they're culled on the GPU, only the ones that GPU culling didn't have room for are gathered
+        visible_static_renderables.clear();
+        if(!gpu_culling) {
+            static_renderable_index->query_frustum(culling_frustum, visible_static_renderables);
+
+        } else if(!cpu_culled_static_renderables.empty()) {
+            static_renderable_index->query_frustum(culling_frustum, visible_static_renderables);
+            visible_static_renderables.erase(std::remove_if(visible_static_renderables.begin(),
+                                                            visible_static_renderables.end(),
+                                                            [&](const RenderableId id) {
+                                                                return cpu_culled_static_renderables.find(id) ==
+                                                                       cpu_culled_static_renderables.end();
+                                                            }),
+                                             visible_static_renderables.end());
+        }
+        std::vector<MeshBatch*> batches_with_visible_statics;
+        for(const RenderableId id : visible_static_renderables) {
+            const RenderableLocation* location = renderable_registry->find(id);
+            MeshBatch& batch = get_material_pass(location->material_pass).static_mesh_draws[location->batch_index];
+            if(batch.visibilities[location->index_in_batch] == 0 || !meshes.at(batch.mesh).is_ready) {
+                continue;
+            }
+
+            if(batch.num_visible_static == 0) {
+                batches_with_visible_statics.push_back(&batch);
+            }
+
+            batch.visible_indices[batch.num_visible_static] = location->index_in_batch;
+            batch.num_visible_static++;
+        }
+
+        for(MeshBatch* batch : batches_with_visible_statics) {
+            sort_visible_renderables_by_lod(lod_selector, meshes.at(batch->mesh), *batch, 0, 0, batch->num_visible_static);
+
+            for(uint32_t i = 0; i < batch->num_visible_static; i++) {
+                batch->visible_model_matrices[i] = batch->model_matrices[batch->visible_indices[i]];
+            }
+        }
+
+        tasks_remaining.wait_for_value(0);
+    }
+
+    void NovaRenderer::cull_mesh_batch_chunk(
+        const Frustum& frustum, const LodSelector& selector, const Mesh& mesh, MeshBatch& batch, const uint32_t chunk_index) {
+        const auto num_renderables = static_cast<uint32_t>(batch.renderable_ids.size());
+        const uint32_t chunk_start = batch.num_static + chunk_index * MeshBatch::CULLING_CHUNK_SIZE;
+        const uint32_t chunk_end = std::min(chunk_start + MeshBatch::CULLING_CHUNK_SIZE, num_renderables);
+
+        uint32_t* visible_indices = &batch.visible_indices[chunk_start];
+        const uint32_t num_visible = cull_aabbs(frustum,
+                                                batch.world_bounds,
+                                                chunk_start,
+                                                chunk_end,
+                                                batch.visibilities.data(),
+                                                visible_indices);
+
+        sort_visible_renderables_by_lod(selector, mesh, batch, chunk_index + 1, chunk_start, num_visible);
+
+        glm::mat4* visible_model_matrices = &batch.visible_model_matrices[chunk_start];
+        for(uint32_t i = 0; i < num_visible; i++) {
+            visible_model_matrices[i] = batch.model_matrices[visible_indices[i]];
+        }
+
+        batch.num_visible_per_chunk[chunk_index] = num_visible;
+    }
+
+    void NovaRenderer::sort_visible_renderables_by_lod(const LodSelector& selector,
+                                                       const Mesh& mesh,
+                                                       MeshBatch& batch,
+                                                       const uint32_t group,
+                                                       const uint32_t group_start,
+                                                       const uint32_t num_visible) {
+        std::array<uint32_t, MAX_MESH_LODS>& lod_counts = batch.visible_lod_counts[group];
+        lod_counts.fill(0);
+
+        const uint32_t num_lods = get_num_lods(mesh);
+        if(num_lods == 1) {
+            lod_counts[0] = num_visible;
+            return;
+        }
+
+        uint32_t* visible_indices = &batch.visible_indices[group_start];
+        for(uint32_t i = 0; i < num_visible; i++) {
+            const uint32_t renderable = visible_indices[i];
+            const float screen_size = selector.get_screen_size(batch.world_bounds.get(renderable));
+            const uint32_t lod = selector.select_lod(screen_size, batch.lods[renderable], mesh.lods.data(), num_lods);
+
+            batch.lods[renderable] = static_cast<uint8_t>(lod);
+            lod_counts[lod]++;
+        }
+
+        // Counting sort, so that each LOD's renderables end up together
+        std::array<uint32_t, MAX_MESH_LODS> lod_offsets{};
+        for(uint32_t lod = 1; lod < num_lods; lod++) {
+            lod_offsets[lod] = lod_offsets[lod - 1] + lod_counts[lod - 1];
+        }
+
+        uint32_t* sorted_indices = &batch.lod_sort_scratch[group_start];
+        for(uint32_t i = 0; i < num_visible; i++) {
+            const uint32_t renderable = visible_indices[i];
+            sorted_indices[lod_offsets[batch.lods[renderable]]++] = renderable;
+        }
+
+        std::copy(sorted_indices, sorted_indices + num_visible, visible_indices);
+    }
+
     rhi::RenderEngine* NovaRenderer::get_engine() const { return rhi.get(); }
 
     NovaRenderer* NovaRenderer::get_instance() { return instance.get(); }
@@ -866,12 +2422,18 @@ namespace nova::renderer {
         if(mesh_memory_result) {
             mesh_memory = std::make_unique<DeviceMemoryResource>(*mesh_memory_result.value);
 
+            geometry_arena = std::make_unique<GeometryArena>(*rhi,
+                                                             *mesh_memory,
+                                                             *global_allocator,
+                                                             render_settings.settings.vertex_memory_settings,
+                                                             render_settings.settings.index_memory_settings);
+
         } else {
             NOVA_LOG(ERROR) << "Could not create mesh memory pool: " << mesh_memory_result.error.to_string().c_str();
         }
 
-        // Assume 65k things, plus we need space for the builtin ubos
-        const uint64_t ubo_memory_size = sizeof(PerFrameUniforms) + sizeof(glm::mat4) * 0xFFFF;
+        // Assume 262k things, plus we need space for the builtin ubos
+        const uint64_t ubo_memory_size = sizeof(PerFrameUniforms) + (sizeof(glm::mat4) + sizeof(InstanceData)) * MAX_NUM_MODEL_MATRICES;
         const ntl::Result<DeviceMemoryResource*>
             ubo_memory_result = rhi->allocate_device_memory(ubo_memory_size, rhi::MemoryUsage::DeviceOnly, rhi::ObjectType::Buffer)
                                     .map([&](rhi::DeviceMemory* memory) {
@@ -886,8 +2448,8 @@ namespace nova::renderer {
             NOVA_LOG(ERROR) << "Could not create mesh memory pool: " << ubo_memory_result.error.to_string().c_str();
         }
 
-        // Staging buffers will be pooled, so we don't need a _ton_ of memory for them
-        const Bytes staging_memory_size = 256_kb;
+        // All mesh data is staged through a single ring buffer that's reused every few frames
+        const Bytes staging_memory_size(render_settings.settings.mesh_staging_buffer_size);
         const ntl::Result<DeviceMemoryResource*>
             staging_memory_result = rhi->allocate_device_memory(staging_memory_size.b_count(),
                                                                 rhi::MemoryUsage::StagingBuffer,
@@ -900,6 +2462,8 @@ namespace nova::renderer {
         if(staging_memory_result) {
             staging_buffer_memory = std::make_unique<DeviceMemoryResource>(*staging_memory_result.value);
 
+            mesh_upload_manager = std::make_unique<MeshUploadManager>(*rhi, *staging_buffer_memory, staging_memory_size.b_count());
+
         } else {
             NOVA_LOG(ERROR) << "Could not create staging buffer memory pool: " << staging_memory_result.error.to_string().c_str();
         }
@@ -922,9 +2486,50 @@ namespace nova::renderer {
 
         // Buffer for each drawcall's model matrix
         rhi::BufferCreateInfo model_matrix_buffer_create_info = {};
-        model_matrix_buffer_create_info.size = sizeof(glm::mat4) * 0xFFFF;
-        model_matrix_buffer_create_info.buffer_usage = rhi::BufferUsage::UniformBuffer;
+        model_matrix_buffer_create_info.size = sizeof(glm::mat4) * MAX_NUM_MODEL_MATRICES;
+        model_matrix_buffer_create_info.buffer_usage = rhi::BufferUsage::StorageBuffer;
 
         model_matrix_buffer = rhi->create_buffer(model_matrix_buffer_create_info, *ubo_memory);
+
+        // Buffer for each drawcall's instance data, which has the same layout as the model matrices
+        rhi::BufferCreateInfo instance_data_buffer_create_info = {};
+        instance_data_buffer_create_info.size = sizeof(InstanceData) * MAX_NUM_MODEL_MATRICES;
+        instance_data_buffer_create_info.buffer_usage = rhi::BufferUsage::StorageBuffer;
+
+        instance_data_buffer = rhi->create_buffer(instance_data_buffer_create_info, *ubo_memory);
+    }
+
+    void NovaRenderer::create_gpu_culling() {
+        if(!render_settings.settings.use_gpu_culling || !rhi->supports_gpu_driven_rendering()) {
+            return;
+        }
+
+        const uint64_t memory_size = GpuCulling::get_memory_size(MAX_NUM_GPU_CULLED_RENDERABLES, MAX_NUM_GPU_CULLED_DRAWS);
+        const ntl::Result<DeviceMemoryResource*>
+            memory_result = rhi->allocate_device_memory(memory_size, rhi::MemoryUsage::LowFrequencyUpload, rhi::ObjectType::Buffer)
+                                .map([&](rhi::DeviceMemory* memory) {
+                                    auto* allocator = new BumpPointAllocationStrategy(Bytes(memory_size), 256_b);
+                                    return new DeviceMemoryResource(memory, allocator);
+                                });
+
+        if(!memory_result) {
+            NOVA_LOG(ERROR) << "Could not create GPU culling memory pool: " << memory_result.error.to_string().c_str();
+            return;
+        }
+
+        gpu_culling_memory = std::make_unique<DeviceMemoryResource>(*memory_result.value);
+
+        // The culling shader is compiled from GLSL, which needs glslang
+        shaderpack::initialize_glslang();
+
+        gpu_culling = std::make_unique<GpuCulling>(*rhi,
+                                                   *gpu_culling_memory,
+                                                   model_matrix_buffer,
+                                                   instance_data_buffer,
+                                                   MAX_NUM_GPU_CULLED_RENDERABLES,
+                                                   MAX_NUM_GPU_CULLED_DRAWS);
+        if(!gpu_culling->is_valid()) {
+            gpu_culling.reset();
+        }
     }
 } // namespace nova::renderer
@@ -0,0 +1,63 @@
+#include "command_list_state_cache.hpp"
+
+namespace nova::renderer::rhi {
+    bool CommandListStateCache::should_bind_pipeline(const Pipeline* pipeline) {
+        if(pipeline == bound_pipeline) {
+            eliminated_commands.pipeline_binds++;
+            return false;
+        }
+
+        bound_pipeline = pipeline;
+        bound_pipeline_interface = nullptr;
+        bound_descriptor_sets.clear();
+
+        return true;
+    }
+
+    bool CommandListStateCache::should_bind_descriptor_sets(const std::vector<DescriptorSet*>& descriptor_sets,
+                                                            const PipelineInterface* pipeline_interface) {
+        if(pipeline_interface != nullptr && pipeline_interface == bound_pipeline_interface && descriptor_sets == bound_descriptor_sets) {
+            eliminated_commands.descriptor_set_binds++;
+            return false;
+        }
+
+        bound_pipeline_interface = pipeline_interface;
+        bound_descriptor_sets = descriptor_sets;
+
+        return true;
+    }
+
+    bool CommandListStateCache::should_bind_vertex_buffers(const std::vector<Buffer*>& buffers) {
+        if(are_vertex_buffers_bound && buffers == bound_vertex_buffers) {
+            eliminated_commands.vertex_buffer_binds++;
+            return false;
+        }
+
+        are_vertex_buffers_bound = true;
+        bound_vertex_buffers = buffers;
+
+        return true;
+    }
+
+    bool CommandListStateCache::should_bind_index_buffer(const Buffer* buffer) {
+        if(buffer != nullptr && buffer == bound_index_buffer) {
+            eliminated_commands.index_buffer_binds++;
+            return false;
+        }
+
+        bound_index_buffer = buffer;
+
+        return true;
+    }
+
+    void CommandListStateCache::invalidate() {
+        bound_pipeline = nullptr;
+        bound_pipeline_interface = nullptr;
+        bound_descriptor_sets.clear();
+        are_vertex_buffers_bound = false;
+        bound_vertex_buffers.clear();
+        bound_index_buffer = nullptr;
+    }
+
+    const EliminatedCommandCounts& CommandListStateCache::get_eliminated_command_counts() const { return eliminated_commands; }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "nova_renderer/command_list.hpp"
+
+namespace nova::renderer::rhi {
+    /*!
+     * \brief Remembers what a command list has bound, so that binds of things which are already bound can be dropped before they're
+     * recorded
+     *
+     * Each command list starts with nothing bound. Anything that might change bound state behind the cache's back, like beginning a
+     * renderpass or executing another command list, must call `invalidate`
+     */
+    class CommandListStateCache {
+    public:
+        /*!
+         * \brief Checks if the pipeline needs to be bound, and remembers it as bound
+         *
+         * Binding a different pipeline forgets the bound descriptor sets, since the new pipeline may have a different layout, and since
+         * OpenGL keeps uniform bindings in the program
+         */
+        [[nodiscard]] bool should_bind_pipeline(const Pipeline* pipeline);
+
+        [[nodiscard]] bool should_bind_descriptor_sets(const std::vector<DescriptorSet*>& descriptor_sets,
+                                                       const PipelineInterface* pipeline_interface);
+
+        [[nodiscard]] bool should_bind_vertex_buffers(const std::vector<Buffer*>& buffers);
+
+        [[nodiscard]] bool should_bind_index_buffer(const Buffer* buffer);
+
+        /*!
+         * \brief Forgets everything that's bound, so the next bind of each kind is always recorded
+         */
+        void invalidate();
+
+        [[nodiscard]] const EliminatedCommandCounts& get_eliminated_command_counts() const;
+
+    private:
+        const Pipeline* bound_pipeline = nullptr;
+
+        const PipelineInterface* bound_pipeline_interface = nullptr;
+        std::vector<DescriptorSet*> bound_descriptor_sets;
+
+        /*!
+         * \brief Whether `bound_vertex_buffers` holds what's actually bound. An empty list of buffers is a valid bind
+         */
+        bool are_vertex_buffers_bound = false;
+        std::vector<Buffer*> bound_vertex_buffers;
+
+        const Buffer* bound_index_buffer = nullptr;
+
+        EliminatedCommandCounts eliminated_commands;
+    };
+} // namespace nova::renderer::rhi
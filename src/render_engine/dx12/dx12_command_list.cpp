@@ -126,6 +126,23 @@ namespace nova::renderer::rhi {
     }
 
     void Dx12CommandList::draw_indexed_mesh(const uint32_t num_indices, const uint32_t num_instances) {
-        cmds->DrawInstanced(num_indices, num_instances, 0, 0);
+        draw_indexed_mesh(num_indices, num_instances, 0, 0, 0);
+    }
+
+    void Dx12CommandList::draw_indexed_mesh(const uint32_t num_indices,
+                                            const uint32_t num_instances,
+                                            const uint32_t first_index,
+                                            const int32_t vertex_offset,
+                                            const uint32_t first_instance) {
+        cmds->DrawIndexedInstanced(num_indices, num_instances, first_index, vertex_offset, first_instance);
+    }
+
+    void Dx12CommandList::draw_indexed_indirect(const Buffer* /* buffer */, uint64_t /* offset */, uint32_t /* num_draws */) {
+        // TODO: Create a command signature for indexed draws, and use ExecuteIndirect
+        NOVA_LOG(ERROR) << "Indirect draws are not supported by the D3D12 backend yet";
+    }
+
+    void Dx12CommandList::dispatch(const uint32_t num_groups_x, const uint32_t num_groups_y, const uint32_t num_groups_z) {
+        cmds->Dispatch(num_groups_x, num_groups_y, num_groups_z);
     }
 } // namespace nova::renderer::rhi
@@ -52,6 +52,13 @@ namespace nova::renderer::rhi {
         
 		void draw_indexed_mesh(uint32_t num_indices, uint32_t num_instances) override;
 
+		void draw_indexed_mesh(
+			uint32_t num_indices, uint32_t num_instances, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) override;
+
+        void draw_indexed_indirect(const Buffer* buffer, uint64_t offset, uint32_t num_draws) override;
+
+        void dispatch(uint32_t num_groups_x, uint32_t num_groups_y, uint32_t num_groups_z) override;
+
     private:
         Microsoft::WRL::ComPtr<ID3D12Device> device;
     };
@@ -262,7 +262,8 @@ namespace nova::renderer::rhi {
 
     DescriptorPool* D3D12RenderEngine::create_descriptor_pool(uint32_t /* num_sampled_images */,
                                                               uint32_t /* num_samplers */,
-                                                              uint32_t /* num_uniform_buffers */) {
+                                                              uint32_t /* num_uniform_buffers */,
+                                                              uint32_t /* num_storage_buffers */) {
         auto* pool = new DX12DescriptorPool; // This seems wrong
         return pool;
     }
@@ -334,6 +335,18 @@ namespace nova::renderer::rhi {
         }
     }
 
+    bool D3D12RenderEngine::supports_gpu_driven_rendering() const { return false; }
+
+    ntl::Result<PipelineInterface*> D3D12RenderEngine::create_compute_pipeline_interface(
+        const std::unordered_map<std::string, ResourceBindingDescription>& /* bindings */) {
+        return ntl::Result<PipelineInterface*>(ntl::NovaError("Compute pipelines are not supported by the D3D12 backend yet"));
+    }
+
+    ntl::Result<Pipeline*> D3D12RenderEngine::create_compute_pipeline(PipelineInterface* /* pipeline_interface */,
+                                                                      const shaderpack::ShaderSource& /* compute_shader */) {
+        return ntl::Result<Pipeline*>(ntl::NovaError("Compute pipelines are not supported by the D3D12 backend yet"));
+    }
+
     ntl::Result<Pipeline*> D3D12RenderEngine::create_pipeline(PipelineInterface* pipeline_interface,
                                                               const shaderpack::PipelineCreateInfo& data) {
         const auto* dx12_pipeline_interface = static_cast<const DX12PipelineInterface*>(pipeline_interface);
@@ -705,6 +718,11 @@ namespace nova::renderer::rhi {
         }
     }
 
+    void D3D12RenderEngine::destroy_buffer(Buffer* buffer) {
+        auto* dx_buffer = static_cast<DX12Buffer*>(buffer);
+        dx_buffer->resource = nullptr;
+    }
+
     void D3D12RenderEngine::destroy_renderpass(Renderpass* /* pass */) { // No work needed, DX12Renderpasses don't own any GPU objects
     }
 
@@ -721,6 +739,11 @@ namespace nova::renderer::rhi {
         dx12_interface->root_sig = nullptr;
     }
 
+    void D3D12RenderEngine::destroy_descriptor_pool(DescriptorPool* pool) {
+        // Each descriptor set owns its own heap, so the pool is just a handle
+        delete static_cast<DX12DescriptorPool*>(pool);
+    }
+
     void D3D12RenderEngine::destroy_pipeline(Pipeline* pipeline) {
         auto* dx_pipeline = static_cast<DX12Pipeline*>(pipeline);
         dx_pipeline->pso = nullptr;
@@ -965,19 +988,11 @@ namespace nova::renderer::rhi {
         auto* shader_compiler = new spirv_cross::CompilerHLSL(shader.source);
         shader_compiler->set_hlsl_options(options);
 
-        const spirv_cross::ShaderResources resources = shader_compiler->get_shader_resources();
-
-        // Make maps of all the types of things we care about
-        std::unordered_map<std::string, spirv_cross::Resource> spirv_sampled_images;
-        spirv_sampled_images.reserve(resources.sampled_images.size());
-        for(const spirv_cross::Resource& sampled_image : resources.sampled_images) {
-            spirv_sampled_images[sampled_image.name] = sampled_image;
-        }
-
-        std::unordered_map<std::string, spirv_cross::Resource> spirv_uniform_buffers;
-        spirv_uniform_buffers.reserve(resources.uniform_buffers.size());
-        for(const spirv_cross::Resource& uniform_buffer : resources.uniform_buffers) {
-            spirv_uniform_buffers[uniform_buffer.name] = uniform_buffer;
+        // The sets come from the shader's reflection record, so the SPIR-V doesn't have to be reflected again
+        std::unordered_map<std::string, uint32_t> sets_by_name;
+        sets_by_name.reserve(shader.reflection.resources.size());
+        for(const shaderpack::ShaderResourceReflection& resource : shader.reflection.resources) {
+            sets_by_name[resource.name] = resource.set;
         }
 
         const auto& shader_hlsl = shader_compiler->compile();
@@ -1036,22 +1051,19 @@ namespace nova::renderer::rhi {
             }
 
             D3D12_DESCRIPTOR_RANGE_TYPE descriptor_type = {};
-            spirv_cross::Resource spirv_resource = {};
             uint32_t set = 0;
 
             switch(bind_desc.Type) {
                 case D3D_SIT_CBUFFER:
                     descriptor_type = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
-                    spirv_resource = spirv_uniform_buffers.at(bind_desc.Name);
-                    set = shader_compiler->get_decoration(spirv_resource.id, spv::DecorationDescriptorSet);
+                    set = sets_by_name.at(bind_desc.Name);
                     add_resource_to_descriptor_table(descriptor_type, bind_desc, set, tables);
                     break;
 
                 case D3D_SIT_TEXTURE:
                 case D3D_SIT_TBUFFER:
                     descriptor_type = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-                    spirv_resource = spirv_sampled_images.at(bind_desc.Name);
-                    set = shader_compiler->get_decoration(spirv_resource.id, spv::DecorationDescriptorSet);
+                    set = sets_by_name.at(bind_desc.Name);
                     add_resource_to_descriptor_table(descriptor_type, bind_desc, set, tables);
 
                     // Also add a descriptor table entry for the sampler
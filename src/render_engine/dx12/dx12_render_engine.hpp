@@ -56,7 +56,10 @@ namespace nova::renderer::rhi {
             const std::vector<shaderpack::TextureAttachmentInfo>& color_attachments,
             const std::optional<shaderpack::TextureAttachmentInfo>& depth_texture) override;
 
-        DescriptorPool* create_descriptor_pool(uint32_t num_sampled_images, uint32_t num_samplers, uint32_t num_uniform_buffers) override;
+        DescriptorPool* create_descriptor_pool(uint32_t num_sampled_images,
+                                               uint32_t num_samplers,
+                                               uint32_t num_uniform_buffers,
+                                               uint32_t num_storage_buffers = 0) override;
 
         /*!
          * \brief Creates all the descriptor sets that are needed for this pipeline interface
@@ -72,6 +75,19 @@ namespace nova::renderer::rhi {
 
         ntl::Result<Pipeline*> create_pipeline(PipelineInterface* pipeline_interface, const shaderpack::PipelineCreateInfo& data) override;
 
+        /*!
+         * \inheritdoc
+         *
+         * Compute pipelines and indirect draws aren't implemented for D3D12 yet, so this is always false
+         */
+        [[nodiscard]] bool supports_gpu_driven_rendering() const override;
+
+        ntl::Result<PipelineInterface*> create_compute_pipeline_interface(
+            const std::unordered_map<std::string, ResourceBindingDescription>& bindings) override;
+
+        ntl::Result<Pipeline*> create_compute_pipeline(PipelineInterface* pipeline_interface,
+                                                       const shaderpack::ShaderSource& compute_shader) override;
+
         Buffer* create_buffer(const BufferCreateInfo& info, DeviceMemoryResource& memory) override;
 
         void write_data_to_buffer(const void* data, uint64_t num_bytes, uint64_t offset, const Buffer* buffer) override;
@@ -90,12 +106,16 @@ namespace nova::renderer::rhi {
 
         void reset_fences(const std::vector<Fence*>& fences) override;
 
+        void destroy_buffer(Buffer* buffer) override;
+
         void destroy_renderpass(Renderpass* pass) override;
 
         void destroy_framebuffer(Framebuffer* framebuffer) override;
 
         void destroy_pipeline_interface(PipelineInterface* pipeline_interface) override;
 
+        void destroy_descriptor_pool(DescriptorPool* pool) override;
+
         void destroy_pipeline(Pipeline* pipeline) override;
 
         void destroy_texture(Image* resource) override;
@@ -50,6 +50,14 @@ namespace nova::renderer::rhi {
                 draw_indexed_mesh = old.draw_indexed_mesh;
                 break;
 
+            case Gl3CommandType::DrawIndexedIndirect:
+                draw_indexed_indirect = old.draw_indexed_indirect;
+                break;
+
+            case Gl3CommandType::Dispatch:
+                dispatch = old.dispatch;
+                break;
+
             default:;
         }
 
@@ -98,6 +106,14 @@ namespace nova::renderer::rhi {
                 draw_indexed_mesh = old.draw_indexed_mesh;
                 break;
 
+            case Gl3CommandType::DrawIndexedIndirect:
+                draw_indexed_indirect = old.draw_indexed_indirect;
+                break;
+
+            case Gl3CommandType::Dispatch:
+                dispatch = old.dispatch;
+                break;
+
             default:;
         }
 
@@ -146,6 +162,14 @@ namespace nova::renderer::rhi {
                 draw_indexed_mesh = other.draw_indexed_mesh;
                 break;
 
+            case Gl3CommandType::DrawIndexedIndirect:
+                draw_indexed_indirect = other.draw_indexed_indirect;
+                break;
+
+            case Gl3CommandType::Dispatch:
+                dispatch = other.dispatch;
+                break;
+
             default:;
         }
     }
@@ -192,6 +216,14 @@ namespace nova::renderer::rhi {
                 draw_indexed_mesh = other.draw_indexed_mesh;
                 break;
 
+            case Gl3CommandType::DrawIndexedIndirect:
+                draw_indexed_indirect = other.draw_indexed_indirect;
+                break;
+
+            case Gl3CommandType::Dispatch:
+                dispatch = other.dispatch;
+                break;
+
             default:;
         }
 
@@ -234,6 +266,14 @@ namespace nova::renderer::rhi {
                 draw_indexed_mesh.~Gl3DrawIndexedMeshCommand();
                 break;
 
+            case Gl3CommandType::DrawIndexedIndirect:
+                draw_indexed_indirect.~Gl3DrawIndexedIndirectCommand();
+                break;
+
+            case Gl3CommandType::Dispatch:
+                dispatch.~Gl3DispatchCommand();
+                break;
+
             case Gl3CommandType::None:
                 // TODO
                 break;
@@ -256,7 +296,7 @@ namespace nova::renderer::rhi {
 
         commands.emplace_back();
 
-        Gl3Command& copy_command = commands.front();
+        Gl3Command& copy_command = commands.back();
         copy_command.type = Gl3CommandType::BufferCopy;
         copy_command.buffer_copy.destination_buffer = dst_buf->id;
         copy_command.buffer_copy.destination_offset = destination_offset;
@@ -268,16 +308,20 @@ namespace nova::renderer::rhi {
     void Gl3CommandList::execute_command_lists(const std::vector<CommandList*>& lists) {
         commands.emplace_back();
 
-        Gl3Command& execute_lists_command = commands.front();
+        Gl3Command& execute_lists_command = commands.back();
         execute_lists_command.execute_command_lists.lists_to_execute = lists;
+
+        state_cache.invalidate();
     }
 
     void Gl3CommandList::begin_renderpass(Renderpass* /* renderpass */, Framebuffer* framebuffer) {
         auto* gl_framebuffer = reinterpret_cast<Gl3Framebuffer*>(framebuffer);
 
+        state_cache.invalidate();
+
         commands.emplace_back();
 
-        Gl3Command& renderpass_command = commands.front();
+        Gl3Command& renderpass_command = commands.back();
         renderpass_command.type = Gl3CommandType::BeginRenderpass;
         renderpass_command.begin_renderpass.framebuffer = gl_framebuffer->id;
     }
@@ -285,17 +329,27 @@ namespace nova::renderer::rhi {
     void Gl3CommandList::end_renderpass() {}
 
     void Gl3CommandList::bind_pipeline(const Pipeline* pipeline) {
+        if(!state_cache.should_bind_pipeline(pipeline)) {
+            return;
+        }
+
         const auto* gl_pipeline = static_cast<const Gl3Pipeline*>(pipeline);
 
         commands.emplace_back();
 
-        Gl3Command& command = commands.front();
+        Gl3Command& command = commands.back();
         command.type = Gl3CommandType::BindPipeline;
         command.bind_pipeline.program = gl_pipeline->id;
+
+        bound_base_instance_location = gl_pipeline->base_instance_location;
     }
 
     void Gl3CommandList::bind_descriptor_sets(const std::vector<DescriptorSet*>& descriptor_sets,
                                               const PipelineInterface* pipeline_interface) {
+        if(!state_cache.should_bind_descriptor_sets(descriptor_sets, pipeline_interface)) {
+            return;
+        }
+
         // Alrighty here's where the fun happens
         // For each descriptor, get its uniform binding from the pipeline interface
         // Record a command to bind it
@@ -304,7 +358,7 @@ namespace nova::renderer::rhi {
 
         commands.emplace_back();
 
-        Gl3Command& command = commands.front();
+        Gl3Command& command = commands.back();
         command.type = Gl3CommandType::BindDescriptorSets;
         command.bind_descriptor_sets.pipeline_bindings = gl_interface->bindings;
         command.bind_descriptor_sets.uniform_cache = gl_interface->uniform_cache;
@@ -317,9 +371,13 @@ namespace nova::renderer::rhi {
     }
 
     void Gl3CommandList::bind_vertex_buffers(const std::vector<Buffer*>& buffers) {
+        if(!state_cache.should_bind_vertex_buffers(buffers)) {
+            return;
+        }
+
         commands.emplace_back();
 
-        Gl3Command& command = commands.front();
+        Gl3Command& command = commands.back();
 
         command.type = Gl3CommandType::BindVertexBuffers;
         command.bind_vertex_buffers.buffers.reserve(buffers.size());
@@ -332,24 +390,66 @@ namespace nova::renderer::rhi {
     }
 
     void Gl3CommandList::bind_index_buffer(const Buffer* buffer) {
+        if(!state_cache.should_bind_index_buffer(buffer)) {
+            return;
+        }
+
         const auto* gl_buffer = static_cast<const Gl3Buffer*>(buffer);
 
         commands.emplace_back();
-        Gl3Command& command = commands.front();
+        Gl3Command& command = commands.back();
 
         command.type = Gl3CommandType::BindIndexBuffer;
         command.bind_index_buffer.buffer = gl_buffer->id;
     }
 
     void Gl3CommandList::draw_indexed_mesh(const uint32_t num_indices, const uint32_t num_instances) {
+        draw_indexed_mesh(num_indices, num_instances, 0, 0, 0);
+    }
+
+    void Gl3CommandList::draw_indexed_mesh(const uint32_t num_indices,
+                                           const uint32_t num_instances,
+                                           const uint32_t first_index,
+                                           const int32_t vertex_offset,
+                                           const uint32_t first_instance) {
         commands.emplace_back();
 
-        Gl3Command& command = commands.front();
+        Gl3Command& command = commands.back();
 
         command.type = Gl3CommandType::DrawIndexedMesh;
         command.draw_indexed_mesh.num_indices = num_indices;
         command.draw_indexed_mesh.num_instances = num_instances;
+        command.draw_indexed_mesh.first_index = first_index;
+        command.draw_indexed_mesh.vertex_offset = vertex_offset;
+        command.draw_indexed_mesh.first_instance = first_instance;
+        command.draw_indexed_mesh.base_instance_location = bound_base_instance_location;
     }
 
+    void Gl3CommandList::draw_indexed_indirect(const Buffer* buffer, const uint64_t offset, const uint32_t num_draws) {
+        const auto* gl_buffer = static_cast<const Gl3Buffer*>(buffer);
+
+        commands.emplace_back();
+
+        Gl3Command& command = commands.back();
+
+        command.type = Gl3CommandType::DrawIndexedIndirect;
+        command.draw_indexed_indirect.buffer = gl_buffer->id;
+        command.draw_indexed_indirect.offset = offset;
+        command.draw_indexed_indirect.num_draws = num_draws;
+    }
+
+    void Gl3CommandList::dispatch(const uint32_t num_groups_x, const uint32_t num_groups_y, const uint32_t num_groups_z) {
+        commands.emplace_back();
+
+        Gl3Command& command = commands.back();
+
+        command.type = Gl3CommandType::Dispatch;
+        command.dispatch.num_groups_x = num_groups_x;
+        command.dispatch.num_groups_y = num_groups_y;
+        command.dispatch.num_groups_z = num_groups_z;
+    }
+
+    EliminatedCommandCounts Gl3CommandList::get_eliminated_command_counts() const { return state_cache.get_eliminated_command_counts(); }
+
     std::vector<Gl3Command> Gl3CommandList::get_commands() const { return commands; }
 } // namespace nova::renderer::rhi
@@ -7,6 +7,7 @@
 #define NOVA_RENDERER_GL_2_COMMAND_LIST_HPP
 #include "nova_renderer/command_list.hpp"
 
+#include "../command_list_state_cache.hpp"
 #include "gl3_structs.hpp"
 #include "glad/glad.h"
 
@@ -22,6 +23,8 @@ namespace nova::renderer::rhi {
         BindVertexBuffers,
         BindIndexBuffer,
         DrawIndexedMesh,
+        DrawIndexedIndirect,
+        Dispatch,
     };
 
     struct Gl3BufferCopyCommand {
@@ -65,6 +68,26 @@ namespace nova::renderer::rhi {
     struct Gl3DrawIndexedMeshCommand {
         uint32_t num_indices;
         uint32_t num_instances;
+        uint32_t first_index;
+        int32_t vertex_offset;
+        uint32_t first_instance;
+
+        /*!
+         * \brief The bound pipeline's base instance uniform, which the first instance is written to before drawing
+         */
+        GLint base_instance_location;
+    };
+
+    struct Gl3DrawIndexedIndirectCommand {
+        GLuint buffer;
+        uint64_t offset;
+        uint32_t num_draws;
+    };
+
+    struct Gl3DispatchCommand {
+        uint32_t num_groups_x;
+        uint32_t num_groups_y;
+        uint32_t num_groups_z;
     };
 
     struct Gl3Command {
@@ -79,6 +102,8 @@ namespace nova::renderer::rhi {
             Gl3BindVertexBuffersCommand bind_vertex_buffers;
             Gl3BindIndexBufferCommand bind_index_buffer;
             Gl3DrawIndexedMeshCommand draw_indexed_mesh;
+            Gl3DrawIndexedIndirectCommand draw_indexed_indirect;
+            Gl3DispatchCommand dispatch;
         };
 
         Gl3Command();
@@ -144,6 +169,15 @@ namespace nova::renderer::rhi {
 
         void draw_indexed_mesh(uint32_t num_indices, uint32_t num_instances) override;
 
+        void draw_indexed_mesh(
+            uint32_t num_indices, uint32_t num_instances, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) override;
+
+        void draw_indexed_indirect(const Buffer* buffer, uint64_t offset, uint32_t num_draws) override;
+
+        void dispatch(uint32_t num_groups_x, uint32_t num_groups_y, uint32_t num_groups_z) override;
+
+        [[nodiscard]] EliminatedCommandCounts get_eliminated_command_counts() const override;
+
         /*!
          * \brief Provides access to the actual command list, so that the GL3 render engine can process the commands
          */
@@ -151,6 +185,17 @@ namespace nova::renderer::rhi {
 
     private:
         std::vector<Gl3Command> commands;
+
+        /*!
+         * \brief Every bind becomes at least one driver call when the commands are replayed, so redundant binds are dropped while
+         * recording
+         */
+        CommandListStateCache state_cache;
+
+        /*!
+         * \brief The base instance uniform of the most recently bound pipeline
+         */
+        GLint bound_base_instance_location = -1;
     };
 } // namespace nova::renderer::rhi
 
@@ -1,8 +1,12 @@
 #include "gl3_render_engine.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #include <spirv_glsl.hpp>
 
 #include "nova_renderer/renderables.hpp"
+#include "nova_renderer/vertex_formats.hpp"
 
 #include "../../util/logger.hpp"
 #include "gl3_command_list.hpp"
@@ -10,12 +14,91 @@
 #include "gl3_swapchain.hpp"
 
 namespace nova::renderer::rhi {
+    /*!
+     * \brief How GL should read a vertex attribute of a given format
+     */
+    struct Gl3VertexAttributeFormat {
+        GLint num_components;
+        GLenum type;
+        GLboolean normalized;
+
+        /*!
+         * \brief If true, the attribute is read as an integer with `glVertexAttribIPointer`
+         */
+        bool is_integer;
+    };
+
+    Gl3VertexAttributeFormat to_gl_vertex_attribute_format(const VertexAttributeFormat format) {
+        switch(format) {
+            case VertexAttributeFormat::Float3:
+                return {3, GL_FLOAT, GL_FALSE, false};
+
+            case VertexAttributeFormat::Float4:
+                return {4, GL_FLOAT, GL_FALSE, false};
+
+            case VertexAttributeFormat::UNorm8x2:
+                return {2, GL_UNSIGNED_BYTE, GL_TRUE, false};
+
+            case VertexAttributeFormat::UNorm8x4:
+                return {4, GL_UNSIGNED_BYTE, GL_TRUE, false};
+
+            case VertexAttributeFormat::UNorm16x2:
+                return {2, GL_UNSIGNED_SHORT, GL_TRUE, false};
+
+            case VertexAttributeFormat::UNorm16x4:
+                return {4, GL_UNSIGNED_SHORT, GL_TRUE, false};
+
+            case VertexAttributeFormat::SNorm16x2:
+                return {2, GL_SHORT, GL_TRUE, false};
+
+            case VertexAttributeFormat::UInt32:
+                return {1, GL_UNSIGNED_INT, GL_FALSE, true};
+
+            default:
+                NOVA_LOG(ERROR) << "Unknown vertex attribute format " << static_cast<uint32_t>(format);
+                return {4, GL_FLOAT, GL_FALSE, false};
+        }
+    }
+
+    /*!
+     * \brief Points each vertex attribute at its buffer, using the layout of `VertexType`
+     *
+     * \param buffers One buffer per attribute, in location order
+     */
+    template <typename VertexType>
+    void bind_vertex_attributes(const std::vector<GLuint>& buffers) {
+        assert(buffers.size() == VertexLayout<VertexType>::attributes.size());
+
+        for(GLuint location = 0; location < VertexLayout<VertexType>::attributes.size(); location++) {
+            const VertexAttribute& attribute = VertexLayout<VertexType>::attributes[location];
+            const Gl3VertexAttributeFormat format = to_gl_vertex_attribute_format(attribute.format);
+            const auto* offset = reinterpret_cast<void*>(static_cast<uintptr_t>(attribute.offset));
+
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.at(location));
+            if(format.is_integer) {
+                glVertexAttribIPointer(location, format.num_components, format.type, sizeof(VertexType), offset);
+            } else {
+                glVertexAttribPointer(location, format.num_components, format.type, format.normalized, sizeof(VertexType), offset);
+            }
+        }
+    }
+
     Gl4NvRenderEngine::Gl4NvRenderEngine(NovaSettingsAccessManager& settings) : RenderEngine(&mallocator, settings) {
 
         window = std::make_unique<GlfwWindow>(settings.settings);
 
         gladLoadGLLoader(GlfwWindow::get_gl_proc_address);
 
+        GLint num_extensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+        for(GLint i = 0; i < num_extensions; i++) {
+            const auto* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if(std::strcmp(extension, "GL_ARB_shader_draw_parameters") == 0) {
+                supports_shader_draw_parameters = true;
+                break;
+            }
+        }
+
         swapchain = new Gl3Swapchain(settings.settings.max_in_flight_frames, window->get_window_size());
 
         set_initial_state();
@@ -79,9 +162,10 @@ namespace nova::renderer::rhi {
 
     DescriptorPool* Gl4NvRenderEngine::create_descriptor_pool(const uint32_t num_sampled_images,
                                                               const uint32_t num_samplers,
-                                                              const uint32_t num_uniform_buffers) {
+                                                              const uint32_t num_uniform_buffers,
+                                                              const uint32_t num_storage_buffers) {
         auto* pool = new Gl3DescriptorPool(shaderpack_allocator);
-        pool->descriptors.resize(static_cast<std::size_t>(num_sampled_images + num_uniform_buffers));
+        pool->descriptors.resize(static_cast<std::size_t>(num_sampled_images + num_uniform_buffers + num_storage_buffers));
         pool->sampler_sets.resize(num_samplers);
 
         return pool;
@@ -92,12 +176,21 @@ namespace nova::renderer::rhi {
         auto* gl_descriptor_pool = static_cast<Gl3DescriptorPool*>(pool);
         std::vector<DescriptorSet*> sets;
 
+        // One set for each set index that the bindings use, with a descriptor for each binding in that set
+        std::vector<uint32_t> num_descriptors_per_set;
         for(const auto& [name, desc] : pipeline_interface->bindings) {
+            if(desc.set >= num_descriptors_per_set.size()) {
+                num_descriptors_per_set.resize(desc.set + 1);
+            }
+            num_descriptors_per_set[desc.set] = std::max(num_descriptors_per_set[desc.set], desc.binding + desc.count);
+        }
+
+        for(const uint32_t num_descriptors : num_descriptors_per_set) {
             void* new_set_mem = gl_descriptor_pool->descriptor_allocator.allocate(sizeof(Gl3DescriptorSet));
             auto* new_set = new(new_set_mem) Gl3DescriptorSet;
             sets.push_back(new_set);
 
-            new_set->descriptors.resize(desc.count);
+            new_set->descriptors.resize(num_descriptors);
         }
 
         return sets;
@@ -118,12 +211,11 @@ namespace nova::renderer::rhi {
                     descriptor.resource = image;
                 } break;
 
-                case DescriptorType::UniformBuffer: {
-                    NOVA_LOG(WARN) << __FILE__ << "(" << __LINE__ << "): Unimplemented";
-                } break;
-
+                case DescriptorType::UniformBuffer:
                 case DescriptorType::StorageBuffer: {
-                    NOVA_LOG(WARN) << __FILE__ << "(" << __LINE__ << "): Unimplemented";
+                    // GL binds whole buffers, so the offset and size of the update are ignored
+                    const auto* cbuffer = static_cast<const Gl3Buffer*>(write.buffer_info->buffer);
+                    descriptor.resource = const_cast<Gl3Buffer*>(cbuffer);
                 } break;
 
                 default:;
@@ -200,6 +292,52 @@ namespace nova::renderer::rhi {
             gl3_pipeline_interface->uniform_cache.emplace(binding.first, uniform_location);
         }
 
+        pipeline->base_instance_location = glGetUniformLocation(pipeline->id, "SPIRV_Cross_BaseInstance");
+
+        return ntl::Result(static_cast<Pipeline*>(pipeline));
+    }
+
+    bool Gl4NvRenderEngine::supports_gpu_driven_rendering() const {
+        return GLAD_GL_VERSION_4_3 != 0 && supports_shader_draw_parameters;
+    }
+
+    ntl::Result<PipelineInterface*> Gl4NvRenderEngine::create_compute_pipeline_interface(
+        const std::unordered_map<std::string, ResourceBindingDescription>& bindings) {
+        auto* pipeline_interface = new Gl3PipelineInterface;
+        pipeline_interface->bindings = bindings;
+
+        return ntl::Result(static_cast<PipelineInterface*>(pipeline_interface));
+    }
+
+    ntl::Result<Pipeline*> Gl4NvRenderEngine::create_compute_pipeline(PipelineInterface* /* pipeline_interface */,
+                                                                      const shaderpack::ShaderSource& compute_shader) {
+        ntl::Result<GLuint> shader = compile_shader(compute_shader.source, GL_COMPUTE_SHADER);
+        if(!shader) {
+            return ntl::Result<Pipeline*>(std::move(shader.error));
+        }
+
+        auto* pipeline = new Gl3Pipeline;
+        pipeline->id = glCreateProgram();
+        glAttachShader(pipeline->id, shader.value);
+        glLinkProgram(pipeline->id);
+        glDeleteShader(shader.value);
+
+        GLint link_status;
+        glGetProgramiv(pipeline->id, GL_LINK_STATUS, &link_status);
+        if(link_status != GL_TRUE) {
+            GLint link_log_length;
+            glGetProgramiv(pipeline->id, GL_INFO_LOG_LENGTH, &link_log_length);
+
+            std::string link_log;
+            link_log.resize(static_cast<std::size_t>(link_log_length));
+            glGetProgramInfoLog(pipeline->id, link_log_length, nullptr, link_log.data());
+
+            glDeleteProgram(pipeline->id);
+            delete pipeline;
+
+            return ntl::Result<Pipeline*>(ntl::NovaError(link_log));
+        }
+
         return ntl::Result(static_cast<Pipeline*>(pipeline));
     }
 
@@ -223,6 +361,18 @@ namespace nova::renderer::rhi {
                 buffer_bind_target = GL_ARRAY_BUFFER;
             } break;
 
+            case BufferUsage::StagingBuffer: {
+                buffer_bind_target = GL_COPY_READ_BUFFER;
+            } break;
+
+            case BufferUsage::StorageBuffer: {
+                buffer_bind_target = GL_SHADER_STORAGE_BUFFER;
+            } break;
+
+            case BufferUsage::IndirectBuffer: {
+                buffer_bind_target = GL_DRAW_INDIRECT_BUFFER;
+            } break;
+
             default:;
         }
 
@@ -338,6 +488,13 @@ namespace nova::renderer::rhi {
         }
     }
 
+    void Gl4NvRenderEngine::destroy_buffer(Buffer* buffer) {
+        auto* gl_buffer = static_cast<Gl3Buffer*>(buffer);
+        glDeleteBuffers(1, &gl_buffer->id);
+
+        delete gl_buffer;
+    }
+
     void Gl4NvRenderEngine::destroy_renderpass(Renderpass* pass) { delete pass; }
 
     void Gl4NvRenderEngine::destroy_framebuffer(Framebuffer* framebuffer) { delete framebuffer; }
@@ -346,6 +503,8 @@ namespace nova::renderer::rhi {
         // No work needed, no GPU objects in Gl3PipelineInterface;
     }
 
+    void Gl4NvRenderEngine::destroy_descriptor_pool(DescriptorPool* pool) { delete static_cast<Gl3DescriptorPool*>(pool); }
+
     void Gl4NvRenderEngine::destroy_pipeline(Pipeline* pipeline) {}
 
     void Gl4NvRenderEngine::destroy_texture(Image* resource) {
@@ -383,6 +542,9 @@ namespace nova::renderer::rhi {
             auto* gl_semaphore = static_cast<Gl3Semaphore*>(semaphore);
             std::unique_lock lck(gl_semaphore->mutex);
             gl_semaphore->cv.wait(lck, [&gl_semaphore] { return gl_semaphore->signaled; });
+
+            // Waiting on a semaphore consumes its signal, just like a Vulkan binary semaphore
+            gl_semaphore->signaled = false;
         }
         auto* gl_cmds = static_cast<Gl3CommandList*>(cmds);
         const std::vector<Gl3Command>& commands = gl_cmds->get_commands();
@@ -423,6 +585,14 @@ namespace nova::renderer::rhi {
                     draw_indexed_mesh_impl(command.draw_indexed_mesh);
                     break;
 
+                case Gl3CommandType::DrawIndexedIndirect:
+                    draw_indexed_indirect_impl(command.draw_indexed_indirect);
+                    break;
+
+                case Gl3CommandType::Dispatch:
+                    dispatch_impl(command.dispatch);
+                    break;
+
                 case Gl3CommandType::None:
                     NOVA_LOG(FATAL) << "Unimplemented: tried to submit none command buffer";
                     break;
@@ -477,12 +647,16 @@ namespace nova::renderer::rhi {
                             } break;
 
                             case DescriptorType::UniformBuffer: {
-                                const GLuint block_index = bind_descriptor_sets.uniform_block_indices.at(binding_name);
+                                // Shaders that were compiled from SPIR-V keep their explicit bindings
+                                const auto block_index_itr = bind_descriptor_sets.uniform_block_indices.find(binding_name);
+                                const GLuint block_index = block_index_itr != bind_descriptor_sets.uniform_block_indices.end() ?
+                                                               block_index_itr->second :
+                                                               binding_desc.binding;
                                 glBindBufferBase(GL_UNIFORM_BUFFER, block_index, descriptor.resource->id);
                             } break;
 
                             case DescriptorType::StorageBuffer: {
-                                // I don't know how to emulate this in GL3
+                                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_desc.binding, descriptor.resource->id);
                             } break;
                         }
                     }
@@ -492,48 +666,7 @@ namespace nova::renderer::rhi {
     }
 
     void Gl4NvRenderEngine::bind_vertex_buffers_impl(const Gl3BindVertexBuffersCommand& bind_vertex_buffers) {
-        // TODO: use std::array or something where this is implicitly true
-        assert(bind_vertex_buffers.buffers.size() == 7);
-
-        // All the bindings because there is no god
-
-        // Positions
-        glBindBuffer(GL_ARRAY_BUFFER, bind_vertex_buffers.buffers.at(0));
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(FullVertex), reinterpret_cast<void*>(offsetof(FullVertex, position)));
-
-        // Normals
-        glBindBuffer(GL_ARRAY_BUFFER, bind_vertex_buffers.buffers.at(1));
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(FullVertex), reinterpret_cast<void*>(offsetof(FullVertex, normal)));
-
-        // Tangents
-        glBindBuffer(GL_ARRAY_BUFFER, bind_vertex_buffers.buffers.at(2));
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(FullVertex), reinterpret_cast<void*>(offsetof(FullVertex, tangent)));
-
-        // Main UVs
-        glBindBuffer(GL_ARRAY_BUFFER, bind_vertex_buffers.buffers.at(3));
-        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(FullVertex), reinterpret_cast<void*>(offsetof(FullVertex, main_uv)));
-
-        // Secondary UVs
-        glBindBuffer(GL_ARRAY_BUFFER, bind_vertex_buffers.buffers.at(4));
-        glVertexAttribPointer(4, 2, GL_SHORT, GL_FALSE, sizeof(FullVertex), reinterpret_cast<void*>(offsetof(FullVertex, secondary_uv)));
-
-        // Virtual texture ID
-        glBindBuffer(GL_ARRAY_BUFFER, bind_vertex_buffers.buffers.at(5));
-        glVertexAttribPointer(5,
-                              1,
-                              GL_INT,
-                              GL_FALSE,
-                              sizeof(FullVertex),
-                              reinterpret_cast<void*>(offsetof(FullVertex, virtual_texture_id)));
-
-        // Additional data
-        glBindBuffer(GL_ARRAY_BUFFER, bind_vertex_buffers.buffers.at(6));
-        glVertexAttribPointer(6,
-                              4,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(FullVertex),
-                              reinterpret_cast<void*>(offsetof(FullVertex, additional_stuff)));
+        bind_vertex_attributes<FullVertex>(bind_vertex_buffers.buffers);
     }
 
     void Gl4NvRenderEngine::bind_index_buffer_impl(const Gl3BindIndexBufferCommand& bind_index_buffer) {
@@ -541,14 +674,50 @@ namespace nova::renderer::rhi {
     }
 
     void Gl4NvRenderEngine::draw_indexed_mesh_impl(const Gl3DrawIndexedMeshCommand& draw_indexed_mesh) {
-        glDrawArraysInstanced(GL_TRIANGLES, 0, draw_indexed_mesh.num_instances, draw_indexed_mesh.num_indices);
+        // gl_InstanceID doesn't include the first instance, so shaders without gl_BaseInstanceARB have to be told what it is
+        if(draw_indexed_mesh.base_instance_location != -1) {
+            glUniform1i(draw_indexed_mesh.base_instance_location, static_cast<GLint>(draw_indexed_mesh.first_instance));
+        }
+
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES,
+                                                      draw_indexed_mesh.num_indices,
+                                                      GL_UNSIGNED_INT,
+                                                      reinterpret_cast<void*>(draw_indexed_mesh.first_index * sizeof(uint32_t)),
+                                                      draw_indexed_mesh.num_instances,
+                                                      draw_indexed_mesh.vertex_offset,
+                                                      draw_indexed_mesh.first_instance);
+    }
+
+    void Gl4NvRenderEngine::draw_indexed_indirect_impl(const Gl3DrawIndexedIndirectCommand& draw_indexed_indirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, draw_indexed_indirect.buffer);
+        glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                    GL_UNSIGNED_INT,
+                                    reinterpret_cast<void*>(draw_indexed_indirect.offset),
+                                    static_cast<GLsizei>(draw_indexed_indirect.num_draws),
+                                    sizeof(IndexedIndirectDrawCommand));
+    }
+
+    void Gl4NvRenderEngine::dispatch_impl(const Gl3DispatchCommand& dispatch) {
+        glDispatchCompute(dispatch.num_groups_x, dispatch.num_groups_y, dispatch.num_groups_z);
+
+        // GL has no resource barriers, so make the results of every dispatch visible to whatever reads them next
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT);
     }
 
     void Gl4NvRenderEngine::execute_command_lists_impl(const Gl3ExecuteCommandListsCommand& execute_command_lists) {}
 
-    ntl::Result<GLuint> compile_shader(const std::vector<uint32_t>& spirv, const GLenum shader_type) {
+    std::string translate_spirv_to_glsl(const std::vector<uint32_t>& spirv) {
         spirv_cross::CompilerGLSL compiler(spirv);
-        const std::string glsl = compiler.compile();
+
+        spirv_cross::CompilerGLSL::Options options = compiler.get_common_options();
+        options.vertex.support_nonzero_base_instance = true;
+        compiler.set_common_options(options);
+
+        return compiler.compile();
+    }
+
+    ntl::Result<GLuint> compile_shader(const std::vector<uint32_t>& spirv, const GLenum shader_type) {
+        const std::string glsl = translate_spirv_to_glsl(spirv);
         const char* glsl_c = glsl.c_str();
         const auto len = static_cast<GLint>(glsl.size());
 
@@ -40,7 +40,10 @@ namespace nova::renderer::rhi {
                                         const std::optional<Image*> depth_attachment,
                                         const glm::uvec2& framebuffer_size) override;
 
-        DescriptorPool* create_descriptor_pool(uint32_t num_sampled_images, uint32_t num_samplers, uint32_t num_uniform_buffers) override;
+        DescriptorPool* create_descriptor_pool(uint32_t num_sampled_images,
+                                               uint32_t num_samplers,
+                                               uint32_t num_uniform_buffers,
+                                               uint32_t num_storage_buffers = 0) override;
 
         std::vector<DescriptorSet*> create_descriptor_sets(const PipelineInterface* pipeline_interface, DescriptorPool* pool) override;
 
@@ -53,6 +56,20 @@ namespace nova::renderer::rhi {
 
         ntl::Result<Pipeline*> create_pipeline(PipelineInterface* pipeline_interface, const shaderpack::PipelineCreateInfo& data) override;
 
+        /*!
+         * \inheritdoc
+         *
+         * Compute shaders, shader storage buffers, and indirect draws all need OpenGL 4.3. Indirect draws also need
+         * `GL_ARB_shader_draw_parameters`, since without it shaders can't see each draw's first instance
+         */
+        [[nodiscard]] bool supports_gpu_driven_rendering() const override;
+
+        ntl::Result<PipelineInterface*> create_compute_pipeline_interface(
+            const std::unordered_map<std::string, ResourceBindingDescription>& bindings) override;
+
+        ntl::Result<Pipeline*> create_compute_pipeline(PipelineInterface* pipeline_interface,
+                                                       const shaderpack::ShaderSource& compute_shader) override;
+
         Buffer* create_buffer(const BufferCreateInfo& info, DeviceMemoryResource& memory) override;
 
         /*!
@@ -75,12 +92,16 @@ namespace nova::renderer::rhi {
 
         void reset_fences(const std::vector<Fence*>& fences) override;
 
+        void destroy_buffer(Buffer* buffer) override;
+
         void destroy_renderpass(Renderpass* pass) override;
 
         void destroy_framebuffer(Framebuffer* framebuffer) override;
 
         void destroy_pipeline_interface(PipelineInterface* pipeline_interface) override;
 
+        void destroy_descriptor_pool(DescriptorPool* pool) override;
+
         void destroy_pipeline(Pipeline* pipeline) override;
         void destroy_texture(Image* resource) override;
         void destroy_semaphores(std::vector<Semaphore*>& semaphores) override;
@@ -100,6 +121,11 @@ namespace nova::renderer::rhi {
 
         bool supports_geometry_shaders = false;
 
+        /*!
+         * \brief Whether shaders can read the first instance of the draw from `gl_BaseInstanceARB`
+         */
+        bool supports_shader_draw_parameters = false;
+
         std::unordered_map<std::string, shaderpack::SamplerCreateInfo> samplers;
 
         static void set_initial_state();
@@ -119,9 +145,21 @@ namespace nova::renderer::rhi {
 
         static void draw_indexed_mesh_impl(const Gl3DrawIndexedMeshCommand& draw_indexed_mesh);
 
+        static void draw_indexed_indirect_impl(const Gl3DrawIndexedIndirectCommand& draw_indexed_indirect);
+
+        static void dispatch_impl(const Gl3DispatchCommand& dispatch);
+
         static void execute_command_lists_impl(const Gl3ExecuteCommandListsCommand& execute_command_lists);
 #pragma endregion
     };
 
+    /*!
+     * \brief Translates SPIR-V to GLSL that OpenGL can compile
+     *
+     * `gl_InstanceIndex` becomes `gl_InstanceID` plus the draw's first instance, which comes from `gl_BaseInstanceARB` if the driver
+     * has `GL_ARB_shader_draw_parameters` and from the `SPIRV_Cross_BaseInstance` uniform if it doesn't
+     */
+    [[nodiscard]] std::string translate_spirv_to_glsl(const std::vector<uint32_t>& spirv);
+
     ntl::Result<GLuint> compile_shader(const std::vector<uint32_t>& spirv, GLenum shader_type);
 } // namespace nova::renderer::rhi
@@ -67,6 +67,14 @@ namespace nova::renderer::rhi {
 
     struct Gl3Pipeline : Pipeline {
         GLuint id = 0;
+
+        /*!
+         * \brief Where the pipeline's `SPIRV_Cross_BaseInstance` uniform is, or -1 if it doesn't have one
+         *
+         * SPIRV-Cross reads the base instance from `gl_BaseInstanceARB` when the driver has `GL_ARB_shader_draw_parameters`, and from
+         * this uniform when it doesn't. Direct draws set the uniform to their first instance
+         */
+        GLint base_instance_location = -1;
     };
 
     struct Gl3PipelineInterface : PipelineInterface {
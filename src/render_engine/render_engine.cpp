@@ -7,5 +7,58 @@ namespace nova::renderer::rhi {
         shaderpack_allocator = allocator_handle;
     }
 
+    void RenderEngine::begin_frame(const uint32_t frame_idx) {
+        cur_frame_idx = frame_idx;
+
+        std::vector<std::function<void()>>& destructions = deferred_destructions.at(frame_idx);
+        for(const std::function<void()>& destroy_func : destructions) {
+            destroy_func();
+        }
+
+        destructions.clear();
+    }
+
+    void RenderEngine::defer_destruction(std::function<void()> destroy_func) {
+        deferred_destructions.at(cur_frame_idx).push_back(std::move(destroy_func));
+    }
+
+    void RenderEngine::destroy_buffer_deferred(Buffer* buffer) {
+        defer_destruction([this, buffer] { destroy_buffer(buffer); });
+    }
+
+    void RenderEngine::destroy_renderpass_deferred(Renderpass* pass) {
+        defer_destruction([this, pass] { destroy_renderpass(pass); });
+    }
+
+    void RenderEngine::destroy_framebuffer_deferred(Framebuffer* framebuffer) {
+        defer_destruction([this, framebuffer] { destroy_framebuffer(framebuffer); });
+    }
+
+    void RenderEngine::destroy_pipeline_interface_deferred(PipelineInterface* pipeline_interface) {
+        defer_destruction([this, pipeline_interface] { destroy_pipeline_interface(pipeline_interface); });
+    }
+
+    void RenderEngine::destroy_descriptor_pool_deferred(DescriptorPool* pool) {
+        defer_destruction([this, pool] { destroy_descriptor_pool(pool); });
+    }
+
+    void RenderEngine::destroy_pipeline_deferred(Pipeline* pipeline) {
+        defer_destruction([this, pipeline] { destroy_pipeline(pipeline); });
+    }
+
+    void RenderEngine::destroy_texture_deferred(Image* resource) {
+        defer_destruction([this, resource] { destroy_texture(resource); });
+    }
+
+    void RenderEngine::flush_deferred_destructions() {
+        for(std::vector<std::function<void()>>& destructions : deferred_destructions) {
+            for(const std::function<void()>& destroy_func : destructions) {
+                destroy_func();
+            }
+
+            destructions.clear();
+        }
+    }
+
     Swapchain* RenderEngine::get_swapchain() const { return swapchain; }
 } // namespace nova::renderer::rhi
@@ -26,6 +26,11 @@ namespace nova::renderer::rhi {
     struct VulkanBuffer : Buffer {
         VkBuffer buffer = VK_NULL_HANDLE;
         DeviceMemoryAllocation memory{};
+
+        /*!
+         * \brief The resource that `memory` was allocated from, so the memory can be given back when the buffer is destroyed
+         */
+        const DeviceMemoryResource* memory_resource = nullptr;
     };
 
     struct VulkanRenderpass : Renderpass {
@@ -46,6 +51,11 @@ namespace nova::renderer::rhi {
 
         VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
 
+        /*!
+         * \brief Whether the descriptor sets for this interface are bound for graphics or compute pipelines
+         */
+        VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
         /*!
          * \brief All the descriptor set layouts that this pipeline interface needs to create descriptor sets
          *
@@ -56,6 +66,8 @@ namespace nova::renderer::rhi {
 
     struct VulkanPipeline : Pipeline {
         VkPipeline pipeline = VK_NULL_HANDLE;
+
+        VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
     };
 
     struct VulkanDescriptorPool : DescriptorPool {
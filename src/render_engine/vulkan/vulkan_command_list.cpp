@@ -105,9 +105,14 @@ namespace nova::renderer::rhi {
         }
 
         vkCmdExecuteCommands(cmds, static_cast<uint32_t>(buffers.size()), buffers.data());
+
+        // Bound state is undefined after executing secondary command buffers
+        state_cache.invalidate();
     }
 
     void VulkanCommandList::begin_renderpass(Renderpass* renderpass, Framebuffer* framebuffer) {
+        state_cache.invalidate();
+
         // TODO: Store this somewhere better
         // TODO: Get max framebuffer attachments from GPU
         const static std::vector<VkClearValue> CLEAR_VALUES(9);
@@ -142,18 +147,26 @@ namespace nova::renderer::rhi {
     void VulkanCommandList::end_renderpass() { vkCmdEndRenderPass(cmds); }
 
     void VulkanCommandList::bind_pipeline(const Pipeline* pipeline) {
+        if(!state_cache.should_bind_pipeline(pipeline)) {
+            return;
+        }
+
         const auto* vk_pipeline = static_cast<const VulkanPipeline*>(pipeline);
-        vkCmdBindPipeline(cmds, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_pipeline->pipeline);
+        vkCmdBindPipeline(cmds, vk_pipeline->bind_point, vk_pipeline->pipeline);
     }
 
     void VulkanCommandList::bind_descriptor_sets(const std::vector<DescriptorSet*>& descriptor_sets,
                                                  const PipelineInterface* pipeline_interface) {
+        if(!state_cache.should_bind_descriptor_sets(descriptor_sets, pipeline_interface)) {
+            return;
+        }
+
         const auto* vk_interface = static_cast<const VulkanPipelineInterface*>(pipeline_interface);
 
         for(uint32_t i = 0; i < descriptor_sets.size(); i++) {
             const auto* vk_set = static_cast<const VulkanDescriptorSet*>(descriptor_sets.at(i));
             vkCmdBindDescriptorSets(cmds,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    vk_interface->bind_point,
                                     vk_interface->pipeline_layout,
                                     i,
                                     1,
@@ -164,13 +177,17 @@ namespace nova::renderer::rhi {
     }
 
     void VulkanCommandList::bind_vertex_buffers(const std::vector<Buffer*>& buffers) {
+        if(!state_cache.should_bind_vertex_buffers(buffers)) {
+            return;
+        }
+
         std::vector<VkBuffer> vk_buffers;
         vk_buffers.reserve(buffers.size());
 
         std::vector<VkDeviceSize> offsets;
         offsets.reserve(buffers.size());
         for(uint32_t i = 0; i < buffers.size(); i++) {
-            offsets.push_back(i);
+            offsets.push_back(0);
             const auto* vk_buffer = static_cast<const VulkanBuffer*>(buffers.at(i));
             vk_buffers.push_back(vk_buffer->buffer);
         }
@@ -179,12 +196,35 @@ namespace nova::renderer::rhi {
     }
 
     void VulkanCommandList::bind_index_buffer(const Buffer* buffer) {
+        if(!state_cache.should_bind_index_buffer(buffer)) {
+            return;
+        }
+
         const auto* vk_buffer = static_cast<const VulkanBuffer*>(buffer);
 
         vkCmdBindIndexBuffer(cmds, vk_buffer->buffer, 0, VK_INDEX_TYPE_UINT32);
     }
 
     void VulkanCommandList::draw_indexed_mesh(const uint32_t num_indices, const uint32_t num_instances) {
-        vkCmdDrawIndexed(cmds, num_indices, num_instances, 0, 0, 0);
+        draw_indexed_mesh(num_indices, num_instances, 0, 0, 0);
+    }
+
+    void VulkanCommandList::draw_indexed_mesh(const uint32_t num_indices,
+                                              const uint32_t num_instances,
+                                              const uint32_t first_index,
+                                              const int32_t vertex_offset,
+                                              const uint32_t first_instance) {
+        vkCmdDrawIndexed(cmds, num_indices, num_instances, first_index, vertex_offset, first_instance);
     }
+
+    void VulkanCommandList::draw_indexed_indirect(const Buffer* buffer, const uint64_t offset, const uint32_t num_draws) {
+        const auto* vk_buffer = static_cast<const VulkanBuffer*>(buffer);
+        vkCmdDrawIndexedIndirect(cmds, vk_buffer->buffer, offset, num_draws, sizeof(IndexedIndirectDrawCommand));
+    }
+
+    void VulkanCommandList::dispatch(const uint32_t num_groups_x, const uint32_t num_groups_y, const uint32_t num_groups_z) {
+        vkCmdDispatch(cmds, num_groups_x, num_groups_y, num_groups_z);
+    }
+
+    EliminatedCommandCounts VulkanCommandList::get_eliminated_command_counts() const { return state_cache.get_eliminated_command_counts(); }
 } // namespace nova::renderer::rhi
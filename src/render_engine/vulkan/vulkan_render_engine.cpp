@@ -1,6 +1,8 @@
 #include "vulkan_render_engine.hpp"
 
 #include <csignal>
+#include <cstring>
+#include <fstream>
 #include <set>
 
 #include "nova_renderer/allocation_structs.hpp"
@@ -48,6 +50,17 @@ namespace nova::renderer::rhi {
         create_swapchain();
 
         create_per_thread_command_pools();
+
+        if(settings.settings.pipeline_cache.enabled) {
+            create_pipeline_cache();
+        }
+    }
+
+    VulkanRenderEngine::~VulkanRenderEngine() {
+        if(pipeline_cache != VK_NULL_HANDLE) {
+            save_pipeline_cache();
+            vkDestroyPipelineCache(device, pipeline_cache, nullptr);
+        }
     }
 
     void VulkanRenderEngine::set_num_renderpasses(uint32_t /* num_renderpasses */) {
@@ -447,15 +460,23 @@ namespace nova::renderer::rhi {
 
     DescriptorPool* VulkanRenderEngine::create_descriptor_pool(const uint32_t num_sampled_images,
                                                                const uint32_t num_samplers,
-                                                               const uint32_t num_uniform_buffers) {
+                                                               const uint32_t num_uniform_buffers,
+                                                               const uint32_t num_storage_buffers) {
+        // Pool sizes with no descriptors aren't allowed
         std::vector<VkDescriptorPoolSize> pool_sizes;
-        pool_sizes.emplace_back(VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, num_sampled_images});
-        pool_sizes.emplace_back(VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER, num_samplers});
-        pool_sizes.emplace_back(VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, num_uniform_buffers});
+        const auto add_pool_size = [&](const VkDescriptorType type, const uint32_t count) {
+            if(count > 0) {
+                pool_sizes.emplace_back(VkDescriptorPoolSize{type, count});
+            }
+        };
+        add_pool_size(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, num_sampled_images);
+        add_pool_size(VK_DESCRIPTOR_TYPE_SAMPLER, num_samplers);
+        add_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, num_uniform_buffers);
+        add_pool_size(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, num_storage_buffers);
 
         VkDescriptorPoolCreateInfo pool_create_info = {};
         pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        pool_create_info.maxSets = num_sampled_images + num_samplers + num_uniform_buffers;
+        pool_create_info.maxSets = num_sampled_images + num_samplers + num_uniform_buffers + num_storage_buffers;
         pool_create_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
         pool_create_info.pPoolSizes = pool_sizes.data();
         auto* pool = new_object<VulkanDescriptorPool>();
@@ -497,6 +518,9 @@ namespace nova::renderer::rhi {
         std::vector<VkDescriptorImageInfo> image_infos;
         image_infos.reserve(writes.size());
 
+        std::vector<VkDescriptorBufferInfo> buffer_infos;
+        buffer_infos.reserve(writes.size());
+
         for(const DescriptorSetWrite& write : writes) {
             VkWriteDescriptorSet vk_write = {};
             vk_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -520,10 +544,20 @@ namespace nova::renderer::rhi {
                     vk_writes.push_back(vk_write);
                 } break;
 
-                case DescriptorType::UniformBuffer: {
-                } break;
-
+                case DescriptorType::UniformBuffer:
+                    [[fallthrough]];
                 case DescriptorType::StorageBuffer: {
+                    VkDescriptorBufferInfo vk_buffer_info = {};
+                    vk_buffer_info.buffer = static_cast<const VulkanBuffer*>(write.buffer_info->buffer)->buffer;
+                    vk_buffer_info.offset = write.buffer_info->offset;
+                    vk_buffer_info.range = write.buffer_info->size == 0 ? VK_WHOLE_SIZE : write.buffer_info->size;
+
+                    buffer_infos.push_back(vk_buffer_info);
+
+                    vk_write.descriptorType = to_vk_descriptor_type(write.type);
+                    vk_write.pBufferInfo = &buffer_infos.at(buffer_infos.size() - 1);
+
+                    vk_writes.push_back(vk_write);
                 } break;
 
                 default:;
@@ -579,8 +613,9 @@ namespace nova::renderer::rhi {
             shader_stages.push_back(shader_stage_create_info);
         }
 
-        const std::vector<VkVertexInputBindingDescription>& vertex_binding_descriptions = get_vertex_input_binding_descriptions();
-        const std::vector<VkVertexInputAttributeDescription>& vertex_attribute_descriptions = get_vertex_input_attribute_descriptions();
+        const std::vector<VkVertexInputBindingDescription>& vertex_binding_descriptions = get_vertex_input_binding_descriptions<FullVertex>();
+        const std::vector<VkVertexInputAttributeDescription>& vertex_attribute_descriptions = get_vertex_input_attribute_descriptions<
+            FullVertex>();
 
         VkPipelineVertexInputStateCreateInfo vertex_input_state_create_info;
         vertex_input_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -724,7 +759,7 @@ namespace nova::renderer::rhi {
         pipeline_create_info.subpass = 0;
         pipeline_create_info.basePipelineIndex = -1;
 
-        VkResult result = vkCreateGraphicsPipelines(device, nullptr, 1, &pipeline_create_info, nullptr, &vk_pipeline->pipeline);
+        VkResult result = vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipeline_create_info, nullptr, &vk_pipeline->pipeline);
         if(result != VK_SUCCESS) {
             return ntl::Result<Pipeline*>(MAKE_ERROR("Could not compile pipeline {:s}", data.name.c_str()));
         }
@@ -742,6 +777,65 @@ namespace nova::renderer::rhi {
         return ntl::Result(static_cast<Pipeline*>(vk_pipeline));
     }
 
+    bool VulkanRenderEngine::supports_gpu_driven_rendering() const { return gpu.supported_features.drawIndirectFirstInstance == VK_TRUE; }
+
+    ntl::Result<PipelineInterface*> VulkanRenderEngine::create_compute_pipeline_interface(
+        const std::unordered_map<std::string, ResourceBindingDescription>& bindings) {
+        auto* pipeline_interface = new_object<VulkanPipelineInterface>();
+        pipeline_interface->bindings = bindings;
+        pipeline_interface->bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+
+        pipeline_interface->layouts_by_set = create_descriptor_set_layouts(bindings);
+
+        VkPipelineLayoutCreateInfo pipeline_layout_create_info = {};
+        pipeline_layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipeline_layout_create_info.setLayoutCount = static_cast<uint32_t>(pipeline_interface->layouts_by_set.size());
+        pipeline_layout_create_info.pSetLayouts = pipeline_interface->layouts_by_set.data();
+
+        NOVA_CHECK_RESULT(vkCreatePipelineLayout(device, &pipeline_layout_create_info, nullptr, &pipeline_interface->pipeline_layout));
+
+        return ntl::Result(static_cast<PipelineInterface*>(pipeline_interface));
+    }
+
+    ntl::Result<Pipeline*> VulkanRenderEngine::create_compute_pipeline(PipelineInterface* pipeline_interface,
+                                                                       const shaderpack::ShaderSource& compute_shader) {
+        NOVA_LOG(TRACE) << "Creating a compute VkPipeline for shader " << compute_shader.filename.string();
+
+        const auto* vk_interface = static_cast<const VulkanPipelineInterface*>(pipeline_interface);
+        auto* vk_pipeline = new_object<VulkanPipeline>();
+        vk_pipeline->bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+
+        VkComputePipelineCreateInfo pipeline_create_info = {};
+        pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeline_create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipeline_create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipeline_create_info.stage.module = create_shader_module(compute_shader.source);
+        pipeline_create_info.stage.pName = "main";
+        pipeline_create_info.layout = vk_interface->pipeline_layout;
+        pipeline_create_info.basePipelineIndex = -1;
+
+        const VkResult result = vkCreateComputePipelines(device, pipeline_cache, 1, &pipeline_create_info, nullptr, &vk_pipeline->pipeline);
+
+        // The pipeline keeps everything it needs from the module
+        vkDestroyShaderModule(device, pipeline_create_info.stage.module, nullptr);
+
+        if(result != VK_SUCCESS) {
+            return ntl::Result<Pipeline*>(MAKE_ERROR("Could not compile compute pipeline {:s}", compute_shader.filename.string()));
+        }
+
+        if(settings.settings.debug.enabled) {
+            VkDebugUtilsObjectNameInfoEXT object_name = {};
+            object_name.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+            object_name.objectType = VK_OBJECT_TYPE_PIPELINE;
+            object_name.objectHandle = reinterpret_cast<uint64_t>(vk_pipeline->pipeline);
+            const std::string name = compute_shader.filename.string();
+            object_name.pObjectName = name.c_str();
+            NOVA_CHECK_RESULT(vkSetDebugUtilsObjectNameEXT(device, &object_name));
+        }
+
+        return ntl::Result(static_cast<Pipeline*>(vk_pipeline));
+    }
+
     Buffer* VulkanRenderEngine::create_buffer(const BufferCreateInfo& info, DeviceMemoryResource& memory) {
         auto* buffer = new_object<VulkanBuffer>();
 
@@ -771,6 +865,16 @@ namespace nova::renderer::rhi {
             case BufferUsage::StagingBuffer: {
                 vk_create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
             } break;
+
+            case BufferUsage::StorageBuffer: {
+                vk_create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            } break;
+
+            case BufferUsage::IndirectBuffer: {
+                vk_create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+            } break;
         }
 
         vkCreateBuffer(device, &vk_create_info, nullptr, &buffer->buffer);
@@ -782,8 +886,12 @@ namespace nova::renderer::rhi {
 
         auto* vulkan_heap = static_cast<VulkanDeviceMemory*>(allocation.memory);
         buffer->memory = allocation;
+        buffer->memory_resource = &memory;
+        buffer->type = ResourceType::Buffer;
+        buffer->size = static_cast<uint32_t>(info.size);
 
-        vkBindBufferMemory(device, buffer->buffer, vulkan_heap->memory, 0);
+        // Buffers are sub-allocated from larger memory objects, so they must be bound at their own offset
+        vkBindBufferMemory(device, buffer->buffer, vulkan_heap->memory, allocation.allocation_info.offset.b_count());
 
         return buffer;
     }
@@ -882,13 +990,25 @@ namespace nova::renderer::rhi {
     }
 
     Semaphore* VulkanRenderEngine::create_semaphore() {
-        // TODO
-        return nullptr;
+        auto* semaphore = new_object<VulkanSemaphore>();
+
+        VkSemaphoreCreateInfo semaphore_create_info = {};
+        semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        vkCreateSemaphore(device, &semaphore_create_info, nullptr, &semaphore->semaphore);
+
+        return semaphore;
     }
 
-    std::vector<Semaphore*> VulkanRenderEngine::create_semaphores(uint32_t num_semaphores) {
-        // TODO
-        return std::vector<Semaphore*>();
+    std::vector<Semaphore*> VulkanRenderEngine::create_semaphores(const uint32_t num_semaphores) {
+        std::vector<Semaphore*> semaphores;
+        semaphores.reserve(num_semaphores);
+
+        for(uint32_t i = 0; i < num_semaphores; i++) {
+            semaphores.push_back(create_semaphore());
+        }
+
+        return semaphores;
     }
 
     Fence* VulkanRenderEngine::create_fence(const bool signaled) {
@@ -926,9 +1046,16 @@ namespace nova::renderer::rhi {
     }
 
     void VulkanRenderEngine::wait_for_fences(const std::vector<Fence*> fences) {
+        std::vector<VkFence> vk_fences;
+        vk_fences.reserve(fences.size());
+        for(const auto* fence : fences) {
+            const auto* vk_fence = static_cast<const VulkanFence*>(fence);
+            vk_fences.push_back(vk_fence->fence);
+        }
+
         vkWaitForFences(device,
-                        static_cast<uint32_t>(fences.size()),
-                        &(static_cast<VulkanFence*>(fences[0])->fence),
+                        static_cast<uint32_t>(vk_fences.size()),
+                        vk_fences.data(),
                         VK_TRUE,
                         std::numeric_limits<uint64_t>::max());
     }
@@ -944,6 +1071,14 @@ namespace nova::renderer::rhi {
         vkResetFences(device, static_cast<uint32_t>(fences.size()), vk_fences.data());
     }
 
+    void VulkanRenderEngine::destroy_buffer(Buffer* buffer) {
+        auto* vk_buffer = static_cast<VulkanBuffer*>(buffer);
+        vkDestroyBuffer(device, vk_buffer->buffer, nullptr);
+        vk_buffer->memory_resource->free(vk_buffer->memory);
+
+        delete vk_buffer;
+    }
+
     void VulkanRenderEngine::destroy_renderpass(Renderpass* pass) {
         auto* vk_renderpass = static_cast<VulkanRenderpass*>(pass);
         vkDestroyRenderPass(device, vk_renderpass->pass, nullptr);
@@ -962,6 +1097,13 @@ namespace nova::renderer::rhi {
         vkDestroyPipelineLayout(device, vk_interface->pipeline_layout, nullptr);
     }
 
+    void VulkanRenderEngine::destroy_descriptor_pool(DescriptorPool* pool) {
+        const auto* vk_pool = static_cast<const VulkanDescriptorPool*>(pool);
+        vkDestroyDescriptorPool(device, vk_pool->descriptor_pool, nullptr);
+
+        delete vk_pool;
+    }
+
     void VulkanRenderEngine::destroy_pipeline(Pipeline* pipeline) {
         auto* vk_pipeline = static_cast<VulkanPipeline*>(pipeline);
         vkDestroyPipeline(device, vk_pipeline->pipeline, nullptr);
@@ -1043,6 +1185,9 @@ namespace nova::renderer::rhi {
             vk_wait_semaphores.push_back(vk_semaphore->semaphore);
         }
 
+        // Semaphores are mostly used to wait on uploads from the transfer queue, so we wait on them before anything else happens
+        const std::vector<VkPipelineStageFlags> wait_stages(vk_wait_semaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
         std::vector<VkSemaphore> vk_signal_semaphores;
         vk_signal_semaphores.reserve(signal_semaphores.size());
         for(const Semaphore* semaphore : signal_semaphores) {
@@ -1054,6 +1199,7 @@ namespace nova::renderer::rhi {
         submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submit_info.waitSemaphoreCount = static_cast<uint32_t>(vk_wait_semaphores.size());
         submit_info.pWaitSemaphores = vk_wait_semaphores.data();
+        submit_info.pWaitDstStageMask = wait_stages.data();
         submit_info.commandBufferCount = 1;
         submit_info.pCommandBuffers = &vk_list->cmds;
         submit_info.signalSemaphoreCount = static_cast<uint32_t>(vk_signal_semaphores.size());
@@ -1277,6 +1423,10 @@ namespace nova::renderer::rhi {
         physical_device_features.tessellationShader = VK_TRUE;
         physical_device_features.samplerAnisotropy = VK_TRUE;
 
+        // GPU-driven rendering draws from indirect buffers, and uses each draw's first instance to find its per-instance data
+        physical_device_features.multiDrawIndirect = gpu.supported_features.multiDrawIndirect;
+        physical_device_features.drawIndirectFirstInstance = gpu.supported_features.drawIndirectFirstInstance;
+
         VkDeviceCreateInfo device_create_info{};
         device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         device_create_info.pNext = nullptr;
@@ -1345,6 +1495,85 @@ namespace nova::renderer::rhi {
         }
     }
 
+    void VulkanRenderEngine::create_pipeline_cache() {
+        std::vector<uint8_t> cache_data;
+
+        const fs::path cache_path = get_pipeline_cache_path();
+        if(std::ifstream file(cache_path, std::ios::binary | std::ios::ate); file.good()) {
+            cache_data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(cache_data.data()), static_cast<std::streamsize>(cache_data.size()));
+
+            if(!file.good() || !is_pipeline_cache_data_compatible(cache_data)) {
+                NOVA_LOG(WARN) << "Pipeline cache " << cache_path.string()
+                               << " was made by a different GPU or driver, or is corrupt. Starting with an empty pipeline cache";
+                cache_data.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo cache_create_info = {};
+        cache_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cache_create_info.initialDataSize = cache_data.size();
+        cache_create_info.pInitialData = cache_data.empty() ? nullptr : cache_data.data();
+
+        NOVA_CHECK_RESULT(vkCreatePipelineCache(device, &cache_create_info, nullptr, &pipeline_cache));
+
+        NOVA_LOG(INFO) << "Created pipeline cache with " << cache_data.size() << " bytes of data from " << cache_path.string();
+    }
+
+    void VulkanRenderEngine::save_pipeline_cache() const {
+        size_t data_size = 0;
+        NOVA_CHECK_RESULT(vkGetPipelineCacheData(device, pipeline_cache, &data_size, nullptr));
+
+        std::vector<uint8_t> cache_data(data_size);
+        NOVA_CHECK_RESULT(vkGetPipelineCacheData(device, pipeline_cache, &data_size, cache_data.data()));
+        cache_data.resize(data_size);
+
+        const fs::path cache_path = get_pipeline_cache_path();
+
+        std::error_code error;
+        fs::create_directories(cache_path.parent_path(), error);
+
+        // Writing to a temporary file and renaming it means that a crash while saving can't leave half a cache behind
+        fs::path temp_path = cache_path;
+        temp_path += ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(cache_data.data()), static_cast<std::streamsize>(cache_data.size()));
+            if(!file.good()) {
+                NOVA_LOG(WARN) << "Could not write pipeline cache " << temp_path.string();
+                return;
+            }
+        }
+
+        fs::rename(temp_path, cache_path, error);
+        if(error) {
+            NOVA_LOG(WARN) << "Could not move pipeline cache into place at " << cache_path.string() << ": " << error.message();
+            fs::remove(temp_path, error);
+        }
+    }
+
+    fs::path VulkanRenderEngine::get_pipeline_cache_path() const {
+        const std::string file_name = "vulkan_" + std::to_string(gpu.props.vendorID) + "_" + std::to_string(gpu.props.deviceID) + ".bin";
+        return fs::path(settings.settings.pipeline_cache.folder) / file_name;
+    }
+
+    bool VulkanRenderEngine::is_pipeline_cache_data_compatible(const std::vector<uint8_t>& data) const {
+        // The header's layout is in the Vulkan spec's description of vkGetPipelineCacheData: the header's size, its version, the vendor
+        // ID, the device ID, then the pipeline cache UUID
+        constexpr size_t HEADER_SIZE = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+        if(data.size() < HEADER_SIZE) {
+            return false;
+        }
+
+        uint32_t header[4];
+        std::memcpy(header, data.data(), sizeof(header));
+
+        return header[0] >= HEADER_SIZE && header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && header[2] == gpu.props.vendorID &&
+               header[3] == gpu.props.deviceID &&
+               std::memcmp(data.data() + sizeof(header), gpu.props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
     std::unordered_map<uint32_t, VkCommandPool> VulkanRenderEngine::make_new_command_pools() const {
         std::vector<uint32_t> queue_indices;
         queue_indices.push_back(graphics_family_index);
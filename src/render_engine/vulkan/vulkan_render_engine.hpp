@@ -49,7 +49,7 @@ namespace nova::renderer::rhi {
         VulkanRenderEngine(const VulkanRenderEngine& other) = delete;
         VulkanRenderEngine& operator=(const VulkanRenderEngine& other) = delete;
 
-        ~VulkanRenderEngine() = default;
+        ~VulkanRenderEngine() override;
 
 #pragma region Render engine interface
         void set_num_renderpasses(uint32_t num_renderpasses) override;
@@ -69,7 +69,10 @@ namespace nova::renderer::rhi {
             const std::vector<shaderpack::TextureAttachmentInfo>& color_attachments,
             const std::optional<shaderpack::TextureAttachmentInfo>& depth_texture) override;
 
-        DescriptorPool* create_descriptor_pool(uint32_t num_sampled_images, uint32_t num_samplers, uint32_t num_uniform_buffers) override;
+        DescriptorPool* create_descriptor_pool(uint32_t num_sampled_images,
+                                               uint32_t num_samplers,
+                                               uint32_t num_uniform_buffers,
+                                               uint32_t num_storage_buffers = 0) override;
 
         std::vector<DescriptorSet*> create_descriptor_sets(const PipelineInterface* pipeline_interface, DescriptorPool* pool) override;
 
@@ -77,6 +80,14 @@ namespace nova::renderer::rhi {
 
         ntl::Result<Pipeline*> create_pipeline(PipelineInterface* pipeline_interface, const shaderpack::PipelineCreateInfo& data) override;
 
+        [[nodiscard]] bool supports_gpu_driven_rendering() const override;
+
+        ntl::Result<PipelineInterface*> create_compute_pipeline_interface(
+            const std::unordered_map<std::string, ResourceBindingDescription>& bindings) override;
+
+        ntl::Result<Pipeline*> create_compute_pipeline(PipelineInterface* pipeline_interface,
+                                                       const shaderpack::ShaderSource& compute_shader) override;
+
         Buffer* create_buffer(const BufferCreateInfo& info, DeviceMemoryResource& memory) override;
 
         void write_data_to_buffer(const void* data, uint64_t num_bytes, uint64_t offset, const Buffer* buffer) override;
@@ -93,12 +104,16 @@ namespace nova::renderer::rhi {
 
         void reset_fences(const std::vector<Fence*>& fences) override;
 
+        void destroy_buffer(Buffer* buffer) override;
+
         void destroy_renderpass(Renderpass* pass) override;
 
         void destroy_framebuffer(Framebuffer* framebuffer) override;
 
         void destroy_pipeline_interface(PipelineInterface* pipeline_interface) override;
 
+        void destroy_descriptor_pool(DescriptorPool* pool) override;
+
         void destroy_pipeline(Pipeline* pipeline) override;
 
         void destroy_texture(Image* resource) override;
@@ -160,6 +175,30 @@ namespace nova::renderer::rhi {
 
         void create_per_thread_command_pools();
 
+        /*!
+         * \brief The driver's cache of compiled pipelines, or VK_NULL_HANDLE if the pipeline cache is disabled
+         */
+        VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+
+        /*!
+         * \brief Creates the pipeline cache, with the data that was saved the last time Nova ran on this GPU
+         */
+        void create_pipeline_cache();
+
+        /*!
+         * \brief Writes the pipeline cache's data to disk, so the next run can use it
+         */
+        void save_pipeline_cache() const;
+
+        [[nodiscard]] fs::path get_pipeline_cache_path() const;
+
+        /*!
+         * \brief Checks that saved pipeline cache data was made by this GPU and driver
+         *
+         * Drivers are supposed to ignore data from other GPUs, but some crash instead
+         */
+        [[nodiscard]] bool is_pipeline_cache_data_compatible(const std::vector<uint8_t>& data) const;
+
         [[nodiscard]] std::unordered_map<uint32_t, VkCommandPool> make_new_command_pools() const;
 #pragma endregion
 
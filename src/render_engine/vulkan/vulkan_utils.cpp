@@ -1,7 +1,6 @@
 #include "vulkan_utils.hpp"
 
 #include "nova_renderer/render_engine.hpp"
-#include "nova_renderer/renderables.hpp"
 
 #include "../../util/logger.hpp"
 
@@ -448,108 +447,36 @@ namespace nova::renderer::rhi {
         }
     }
 
-    std::vector<VkVertexInputBindingDescription>& get_vertex_input_binding_descriptions() {
-        static std::vector<VkVertexInputBindingDescription> input_descriptions = {
-            VkVertexInputBindingDescription{
-                0,                          // binding
-                sizeof(FullVertex),         // stride
-                VK_VERTEX_INPUT_RATE_VERTEX // input rate
-            },
-            VkVertexInputBindingDescription{
-                1,                          // binding
-                sizeof(FullVertex),         // stride
-                VK_VERTEX_INPUT_RATE_VERTEX // input rate
-            },
-            VkVertexInputBindingDescription{
-                2,                          // binding
-                sizeof(FullVertex),         // stride
-                VK_VERTEX_INPUT_RATE_VERTEX // input rate
-            },
-            VkVertexInputBindingDescription{
-                3,                          // binding
-                sizeof(FullVertex),         // stride
-                VK_VERTEX_INPUT_RATE_VERTEX // input rate
-            },
-            VkVertexInputBindingDescription{
-                4,                          // binding
-                sizeof(FullVertex),         // stride
-                VK_VERTEX_INPUT_RATE_VERTEX // input rate
-            },
-            VkVertexInputBindingDescription{
-                5,                          // binding
-                sizeof(FullVertex),         // stride
-                VK_VERTEX_INPUT_RATE_VERTEX // input rate
-            },
-            VkVertexInputBindingDescription{
-                6,                          // binding
-                sizeof(FullVertex),         // stride
-                VK_VERTEX_INPUT_RATE_VERTEX // input rate
-            },
-        };
-
-        return input_descriptions;
-    }
+    VkFormat to_vk_vertex_format(const VertexAttributeFormat format) {
+        switch(format) {
+            case VertexAttributeFormat::Float3:
+                return VK_FORMAT_R32G32B32_SFLOAT;
+
+            case VertexAttributeFormat::Float4:
+                return VK_FORMAT_R32G32B32A32_SFLOAT;
+
+            case VertexAttributeFormat::UNorm8x2:
+                return VK_FORMAT_R8G8_UNORM;
+
+            case VertexAttributeFormat::UNorm8x4:
+                return VK_FORMAT_R8G8B8A8_UNORM;
 
-    std::vector<VkVertexInputAttributeDescription>& get_vertex_input_attribute_descriptions() {
-        static std::vector<VkVertexInputAttributeDescription> attribute_descriptions = {
-            // Position
-            VkVertexInputAttributeDescription{
-                0,                          // location
-                0,                          // binding
-                VK_FORMAT_R32G32B32_SFLOAT, // format
-                0,                          // offset
-            },
-
-            // Normal
-            VkVertexInputAttributeDescription{
-                1,                          // location
-                0,                          // binding
-                VK_FORMAT_R32G32B32_SFLOAT, // format
-                0,                          // offset
-            },
-
-            // Tangent
-            VkVertexInputAttributeDescription{
-                2,                          // location
-                0,                          // binding
-                VK_FORMAT_R32G32B32_SFLOAT, // format
-                0,                          // offset
-            },
-
-            // Main UV
-            VkVertexInputAttributeDescription{
-                3,                      // location
-                0,                      // binding
-                VK_FORMAT_R16G16_UNORM, // format
-                0,                      // offset
-            },
-
-            // Secondary UV
-            VkVertexInputAttributeDescription{
-                4,                    // location
-                0,                    // binding
-                VK_FORMAT_R8G8_UNORM, // format
-                0,                    // offset
-            },
-
-            // Virtual texture ID
-            VkVertexInputAttributeDescription{
-                5,                  // location
-                0,                  // binding
-                VK_FORMAT_R32_UINT, // format
-                0,                  // offset
-            },
-
-            // Other data
-            VkVertexInputAttributeDescription{
-                6,                             // location
-                0,                             // binding
-                VK_FORMAT_R32G32B32A32_SFLOAT, // format
-                0,                             // offset
-            },
-        };
-
-        return attribute_descriptions;
+            case VertexAttributeFormat::UNorm16x2:
+                return VK_FORMAT_R16G16_UNORM;
+
+            case VertexAttributeFormat::UNorm16x4:
+                return VK_FORMAT_R16G16B16A16_UNORM;
+
+            case VertexAttributeFormat::SNorm16x2:
+                return VK_FORMAT_R16G16_SNORM;
+
+            case VertexAttributeFormat::UInt32:
+                return VK_FORMAT_R32_UINT;
+
+            default:
+                NOVA_LOG(ERROR) << "Unknown vertex attribute format " << static_cast<uint32_t>(format);
+                return VK_FORMAT_R32G32B32A32_SFLOAT;
+        }
     }
 
     bool operator&(const ShaderStageFlags& lhs, const ShaderStageFlags& rhs) {
@@ -5,6 +5,7 @@
 
 #include "nova_renderer/command_list.hpp"
 #include "nova_renderer/shaderpack_data.hpp"
+#include "nova_renderer/vertex_formats.hpp"
 
 // idk maybe this header is included in places that already include Vulkan? Either way I want this include here and not anywhere else
 // ReSharper disable once CppUnusedIncludeDirective
@@ -33,9 +34,55 @@ namespace nova::renderer::rhi {
 
     std::string to_string(VkObjectType obj_type);
 
-    std::vector<VkVertexInputBindingDescription>& get_vertex_input_binding_descriptions();
+    VkFormat to_vk_vertex_format(VertexAttributeFormat format);
+
+    /*!
+     * \brief Gets one binding per attribute of the vertex type, all of which read from a buffer of `VertexType`s
+     *
+     * Binding `i` is meant to be bound to the same vertex buffer as every other binding. The attribute at location `i` reads from it
+     */
+    template <typename VertexType>
+    std::vector<VkVertexInputBindingDescription>& get_vertex_input_binding_descriptions() {
+        static std::vector<VkVertexInputBindingDescription> input_descriptions = [] {
+            std::vector<VkVertexInputBindingDescription> descriptions;
+            descriptions.reserve(VertexLayout<VertexType>::attributes.size());
+
+            for(uint32_t binding = 0; binding < VertexLayout<VertexType>::attributes.size(); binding++) {
+                descriptions.push_back(VkVertexInputBindingDescription{
+                    binding,                    // binding
+                    sizeof(VertexType),         // stride
+                    VK_VERTEX_INPUT_RATE_VERTEX // input rate
+                });
+            }
+
+            return descriptions;
+        }();
+
+        return input_descriptions;
+    }
 
-    std::vector<VkVertexInputAttributeDescription>& get_vertex_input_attribute_descriptions();
+    template <typename VertexType>
+    std::vector<VkVertexInputAttributeDescription>& get_vertex_input_attribute_descriptions() {
+        static std::vector<VkVertexInputAttributeDescription> attribute_descriptions = [] {
+            std::vector<VkVertexInputAttributeDescription> descriptions;
+            descriptions.reserve(VertexLayout<VertexType>::attributes.size());
+
+            uint32_t location = 0;
+            for(const VertexAttribute& attribute : VertexLayout<VertexType>::attributes) {
+                descriptions.push_back(VkVertexInputAttributeDescription{
+                    location,                              // location
+                    location,                              // binding
+                    to_vk_vertex_format(attribute.format), // format
+                    attribute.offset,                      // offset
+                });
+                location++;
+            }
+
+            return descriptions;
+        }();
+
+        return attribute_descriptions;
+    }
 
     bool operator&(const ShaderStageFlags& lhs, const ShaderStageFlags& rhs);
 } // namespace nova::renderer::rhi
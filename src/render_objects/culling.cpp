@@ -0,0 +1,360 @@
+#include "nova_renderer/culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOVA_CULLING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define NOVA_CULLING_AVX 1
+#include <immintrin.h>
+#endif
+
+namespace nova::renderer {
+    /*!
+     * \brief How many extra floats every AabbList array has, so that the widest SIMD load never reads past the end of an array
+     */
+    constexpr uint32_t AABB_LIST_PADDING = 8;
+
+    void AabbList::push_back(const Aabb& aabb) {
+        num_aabbs++;
+        resize_arrays();
+        set(num_aabbs - 1, aabb);
+    }
+
+    void AabbList::set(const uint32_t index, const Aabb& aabb) {
+        min_x[index] = aabb.min.x;
+        min_y[index] = aabb.min.y;
+        min_z[index] = aabb.min.z;
+        max_x[index] = aabb.max.x;
+        max_y[index] = aabb.max.y;
+        max_z[index] = aabb.max.z;
+    }
+
+    Aabb AabbList::get(const uint32_t index) const {
+        return {glm::vec3(min_x[index], min_y[index], min_z[index]), glm::vec3(max_x[index], max_y[index], max_z[index])};
+    }
+
+    void AabbList::swap_remove(const uint32_t index) {
+        const uint32_t last_index = num_aabbs - 1;
+        if(index != last_index) {
+            set(index, get(last_index));
+        }
+
+        num_aabbs--;
+        resize_arrays();
+    }
+
+    void AabbList::clear() {
+        num_aabbs = 0;
+        resize_arrays();
+    }
+
+    uint32_t AabbList::size() const { return num_aabbs; }
+
+    void AabbList::resize_arrays() {
+        const uint32_t padded_size = num_aabbs + AABB_LIST_PADDING;
+        min_x.resize(padded_size);
+        min_y.resize(padded_size);
+        min_z.resize(padded_size);
+        max_x.resize(padded_size);
+        max_y.resize(padded_size);
+        max_z.resize(padded_size);
+    }
+
+    Frustum make_frustum(const glm::mat4& view_projection) {
+        // Gribb and Hartmann's method. glm matrices are column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        const auto row = [&](const int i) {
+            return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+        };
+        const auto add = [](const glm::vec4& a, const glm::vec4& b) { return glm::vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); };
+        const auto sub = [](const glm::vec4& a, const glm::vec4& b) { return glm::vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); };
+
+        const glm::vec4 row0 = row(0);
+        const glm::vec4 row1 = row(1);
+        const glm::vec4 row2 = row(2);
+        const glm::vec4 row3 = row(3);
+
+        Frustum frustum;
+        frustum.planes = {
+            add(row3, row0), // Left
+            sub(row3, row0), // Right
+            add(row3, row1), // Bottom
+            sub(row3, row1), // Top
+            row2,            // Near
+            sub(row3, row2), // Far
+        };
+
+        return frustum;
+    }
+
+    Frustum make_infinite_frustum() {
+        Frustum frustum;
+        frustum.planes.fill(glm::vec4(0, 0, 0, 1));
+        return frustum;
+    }
+
+    Aabb compute_bounds(const FullVertex* vertices, const size_t num_vertices) {
+        if(num_vertices == 0) {
+            return {glm::vec3(0), glm::vec3(0)};
+        }
+
+        Aabb bounds = {vertices[0].position, vertices[0].position};
+        for(size_t i = 1; i < num_vertices; i++) {
+            const glm::vec3& position = vertices[i].position;
+            bounds.min = glm::vec3(std::min(bounds.min.x, position.x),
+                                   std::min(bounds.min.y, position.y),
+                                   std::min(bounds.min.z, position.z));
+            bounds.max = glm::vec3(std::max(bounds.max.x, position.x),
+                                   std::max(bounds.max.y, position.y),
+                                   std::max(bounds.max.z, position.z));
+        }
+
+        return bounds;
+    }
+
+    Aabb merge_aabbs(const Aabb& a, const Aabb& b) {
+        return {glm::vec3(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z)),
+                glm::vec3(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z))};
+    }
+
+    Aabb transform_aabb(const Aabb& aabb, const glm::mat4& transform) {
+        // Transform the center, then find how far the transformed box extends along each axis. See Arvo, "Transforming Axis-Aligned
+        // Bounding Boxes", Graphics Gems 1990
+        const glm::vec3 center((aabb.min.x + aabb.max.x) * 0.5F, (aabb.min.y + aabb.max.y) * 0.5F, (aabb.min.z + aabb.max.z) * 0.5F);
+        const glm::vec3 extent((aabb.max.x - aabb.min.x) * 0.5F, (aabb.max.y - aabb.min.y) * 0.5F, (aabb.max.z - aabb.min.z) * 0.5F);
+
+        float new_center[3];
+        float new_extent[3];
+        for(int i = 0; i < 3; i++) {
+            new_center[i] = transform[0][i] * center.x + transform[1][i] * center.y + transform[2][i] * center.z + transform[3][i];
+            new_extent[i] = std::abs(transform[0][i]) * extent.x + std::abs(transform[1][i]) * extent.y +
+                            std::abs(transform[2][i]) * extent.z;
+        }
+
+        return {glm::vec3(new_center[0] - new_extent[0], new_center[1] - new_extent[1], new_center[2] - new_extent[2]),
+                glm::vec3(new_center[0] + new_extent[0], new_center[1] + new_extent[1], new_center[2] + new_extent[2])};
+    }
+
+    float LodSelector::get_screen_size(const Aabb& bounds) const {
+        const glm::vec3 center = (bounds.min + bounds.max) * 0.5F;
+        const float radius = glm::length(bounds.max - bounds.min) * 0.5F;
+
+        const float distance = glm::dot(depth_row, glm::vec4(center, 1.0F));
+        if(distance <= radius) {
+            return std::numeric_limits<float>::infinity();
+        }
+
+        // The sphere's projected diameter is `2 * radius * screen_scale / distance` in NDC, and the screen is two NDC units tall
+        return radius * screen_scale / distance;
+    }
+
+    uint32_t LodSelector::select_lod(const float screen_size, const uint32_t current_lod, const MeshLod* lods, const uint32_t num_lods) const {
+        if(screen_scale == 0 || num_lods <= 1) {
+            return 0;
+        }
+
+        uint32_t lod = std::min(current_lod, num_lods - 1);
+
+        // A renderable has to get a bit smaller than a LOD's threshold to leave it, and a bit larger than the threshold to come back
+        while(lod + 1 < num_lods && screen_size < lods[lod].min_screen_size * (1.0F - hysteresis)) {
+            lod++;
+        }
+
+        while(lod > 0 && screen_size >= lods[lod - 1].min_screen_size * (1.0F + hysteresis)) {
+            lod--;
+        }
+
+        return lod;
+    }
+
+    LodSelector make_lod_selector(const glm::mat4& view_projection, const float hysteresis) {
+        LodSelector selector;
+        selector.depth_row = glm::vec4(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+
+        // The view matrix doesn't scale, so the projection's vertical scale is the length of the view-projection's Y row
+        selector.screen_scale = glm::length(glm::vec3(view_projection[0][1], view_projection[1][1], view_projection[2][1]));
+        selector.hysteresis = hysteresis;
+
+        return selector;
+    }
+
+    /*!
+     * \brief For each plane, the arrays that hold the corner of each box that's furthest along the plane's normal
+     *
+     * If that corner is behind the plane, the whole box is
+     */
+    struct PlaneCorners {
+        const float* x;
+        const float* y;
+        const float* z;
+    };
+
+    std::array<PlaneCorners, 6> get_plane_corners(const Frustum& frustum, const AabbList& aabbs) {
+        std::array<PlaneCorners, 6> corners{};
+        for(size_t i = 0; i < frustum.planes.size(); i++) {
+            const glm::vec4& plane = frustum.planes[i];
+            corners[i].x = plane.x >= 0 ? aabbs.max_x.data() : aabbs.min_x.data();
+            corners[i].y = plane.y >= 0 ? aabbs.max_y.data() : aabbs.min_y.data();
+            corners[i].z = plane.z >= 0 ? aabbs.max_z.data() : aabbs.min_z.data();
+        }
+
+        return corners;
+    }
+
+    uint32_t cull_aabbs_scalar(const Frustum& frustum,
+                               const AabbList& aabbs,
+                               const uint32_t begin,
+                               const uint32_t end,
+                               const uint8_t* enabled,
+                               uint32_t* visible_indices) {
+        const std::array<PlaneCorners, 6> corners = get_plane_corners(frustum, aabbs);
+
+        uint32_t num_visible = 0;
+        for(uint32_t i = begin; i < end; i++) {
+            if(enabled != nullptr && enabled[i] == 0) {
+                continue;
+            }
+
+            bool is_visible = true;
+            for(size_t plane_idx = 0; plane_idx < frustum.planes.size(); plane_idx++) {
+                const glm::vec4& plane = frustum.planes[plane_idx];
+                const PlaneCorners& corner = corners[plane_idx];
+                // Same order of operations as the SIMD version, so both give the same answer for boxes that touch a plane
+                const float distance = plane.x * corner.x[i] + (plane.y * corner.y[i] + (plane.z * corner.z[i] + plane.w));
+                if(distance < 0) {
+                    is_visible = false;
+                    break;
+                }
+            }
+
+            if(is_visible) {
+                visible_indices[num_visible] = i;
+                num_visible++;
+            }
+        }
+
+        return num_visible;
+    }
+
+#ifdef NOVA_CULLING_SSE2
+    struct Sse2 {
+        using Float = __m128;
+
+        static constexpr uint32_t WIDTH = 4;
+
+        static Float load(const float* ptr) { return _mm_loadu_ps(ptr); }
+
+        static Float broadcast(const float value) { return _mm_set1_ps(value); }
+
+        static Float multiply_add(const Float a, const Float b, const Float c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+        static Float is_not_negative(const Float value) { return _mm_cmpge_ps(value, _mm_setzero_ps()); }
+
+        static Float logical_and(const Float a, const Float b) { return _mm_and_ps(a, b); }
+
+        static Float all_true() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+
+        static uint32_t to_bitmask(const Float value) { return static_cast<uint32_t>(_mm_movemask_ps(value)); }
+    };
+#endif
+
+#ifdef NOVA_CULLING_AVX
+    struct Avx {
+        using Float = __m256;
+
+        static constexpr uint32_t WIDTH = 8;
+
+        static Float load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+
+        static Float broadcast(const float value) { return _mm256_set1_ps(value); }
+
+        static Float multiply_add(const Float a, const Float b, const Float c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+
+        static Float is_not_negative(const Float value) { return _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_GE_OQ); }
+
+        static Float logical_and(const Float a, const Float b) { return _mm256_and_ps(a, b); }
+
+        static Float all_true() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+
+        static uint32_t to_bitmask(const Float value) { return static_cast<uint32_t>(_mm256_movemask_ps(value)); }
+    };
+#endif
+
+    /*!
+     * \brief Culls `Simd::WIDTH` boxes at a time
+     */
+    template <typename Simd>
+    uint32_t cull_aabbs_simd(const Frustum& frustum,
+                             const AabbList& aabbs,
+                             const uint32_t begin,
+                             const uint32_t end,
+                             const uint8_t* enabled,
+                             uint32_t* visible_indices) {
+        using Float = typename Simd::Float;
+
+        const std::array<PlaneCorners, 6> corners = get_plane_corners(frustum, aabbs);
+
+        Float plane_x[6];
+        Float plane_y[6];
+        Float plane_z[6];
+        Float plane_w[6];
+        for(size_t plane_idx = 0; plane_idx < frustum.planes.size(); plane_idx++) {
+            plane_x[plane_idx] = Simd::broadcast(frustum.planes[plane_idx].x);
+            plane_y[plane_idx] = Simd::broadcast(frustum.planes[plane_idx].y);
+            plane_z[plane_idx] = Simd::broadcast(frustum.planes[plane_idx].z);
+            plane_w[plane_idx] = Simd::broadcast(frustum.planes[plane_idx].w);
+        }
+
+        uint32_t num_visible = 0;
+
+        // The lists are padded, so the last group of boxes can be loaded even if it's not full. Lanes past `end` are ignored
+        for(uint32_t i = begin; i < end; i += Simd::WIDTH) {
+            Float inside = Simd::all_true();
+            for(size_t plane_idx = 0; plane_idx < corners.size(); plane_idx++) {
+                const PlaneCorners& corner = corners[plane_idx];
+
+                Float distance = Simd::multiply_add(plane_z[plane_idx], Simd::load(corner.z + i), plane_w[plane_idx]);
+                distance = Simd::multiply_add(plane_y[plane_idx], Simd::load(corner.y + i), distance);
+                distance = Simd::multiply_add(plane_x[plane_idx], Simd::load(corner.x + i), distance);
+
+                inside = Simd::logical_and(inside, Simd::is_not_negative(distance));
+            }
+
+            const uint32_t mask = Simd::to_bitmask(inside);
+            if(mask == 0) {
+                continue;
+            }
+
+            const uint32_t num_lanes = std::min(Simd::WIDTH, end - i);
+            for(uint32_t lane = 0; lane < num_lanes; lane++) {
+                const uint32_t index = i + lane;
+                if((mask & (1U << lane)) != 0 && (enabled == nullptr || enabled[index] != 0)) {
+                    visible_indices[num_visible] = index;
+                    num_visible++;
+                }
+            }
+        }
+
+        return num_visible;
+    }
+
+    uint32_t cull_aabbs(const Frustum& frustum,
+                        const AabbList& aabbs,
+                        const uint32_t begin,
+                        const uint32_t end,
+                        const uint8_t* enabled,
+                        uint32_t* visible_indices) {
+#if defined(NOVA_CULLING_AVX)
+        return cull_aabbs_simd<Avx>(frustum, aabbs, begin, end, enabled, visible_indices);
+#elif defined(NOVA_CULLING_SSE2)
+        return cull_aabbs_simd<Sse2>(frustum, aabbs, begin, end, enabled, visible_indices);
+#else
+        return cull_aabbs_scalar(frustum, aabbs, begin, end, enabled, visible_indices);
+#endif
+    }
+} // namespace nova::renderer
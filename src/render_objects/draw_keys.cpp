@@ -0,0 +1,192 @@
+#include "draw_keys.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "../tasks/task_scheduler.hpp"
+
+namespace nova::renderer {
+    constexpr uint32_t DRAW_KEY_QUEUE_SHIFT = 62;
+
+    constexpr DrawKey get_field_mask(const uint32_t num_bits) { return (DrawKey(1) << num_bits) - 1; }
+
+    /*!
+     * \brief Sorts with `std::sort` instead of a radix sort below this many keys, since a radix sort has to touch every bucket each pass
+     */
+    constexpr size_t MIN_KEYS_FOR_RADIX_SORT = 256;
+
+    /*!
+     * \brief Each task of a parallel sort gets at least this many keys, so that the tasks are worth handing off
+     */
+    constexpr size_t MIN_KEYS_PER_BLOCK = 0x10000;
+
+    constexpr uint32_t NUM_BUCKETS = 256;
+    constexpr uint32_t NUM_PASSES = sizeof(DrawKey);
+
+    using Histogram = std::array<uint32_t, NUM_BUCKETS>;
+
+    DrawKey make_draw_key(const DrawKeyFields& fields) {
+        DrawKey key = static_cast<DrawKey>(fields.queue) << DRAW_KEY_QUEUE_SHIFT;
+        key |= fields.mesh_batch & get_field_mask(DRAW_KEY_MESH_BATCH_BITS);
+
+        if(fields.queue == DrawQueue::Transparent) {
+            // Back-to-front, so the depth is flipped and goes above everything else
+            const auto inverted_depth = static_cast<uint16_t>(~fields.depth);
+            key |= static_cast<DrawKey>(inverted_depth) << 46;
+            key |= (fields.pipeline & get_field_mask(DRAW_KEY_PIPELINE_BITS)) << 34;
+            key |= (fields.material_pass & get_field_mask(DRAW_KEY_MATERIAL_PASS_BITS)) << 20;
+
+        } else {
+            key |= (fields.pipeline & get_field_mask(DRAW_KEY_PIPELINE_BITS)) << 50;
+            key |= (fields.material_pass & get_field_mask(DRAW_KEY_MATERIAL_PASS_BITS)) << 36;
+            key |= static_cast<DrawKey>(fields.depth) << 20;
+        }
+
+        return key;
+    }
+
+    DrawKeyFields decode_draw_key(const DrawKey key) {
+        DrawKeyFields fields;
+        fields.queue = static_cast<DrawQueue>(key >> DRAW_KEY_QUEUE_SHIFT);
+        fields.mesh_batch = static_cast<uint32_t>(key & get_field_mask(DRAW_KEY_MESH_BATCH_BITS));
+
+        if(fields.queue == DrawQueue::Transparent) {
+            fields.depth = static_cast<uint16_t>(~(key >> 46));
+            fields.pipeline = static_cast<uint32_t>((key >> 34) & get_field_mask(DRAW_KEY_PIPELINE_BITS));
+            fields.material_pass = static_cast<uint32_t>((key >> 20) & get_field_mask(DRAW_KEY_MATERIAL_PASS_BITS));
+
+        } else {
+            fields.pipeline = static_cast<uint32_t>((key >> 50) & get_field_mask(DRAW_KEY_PIPELINE_BITS));
+            fields.material_pass = static_cast<uint32_t>((key >> 36) & get_field_mask(DRAW_KEY_MATERIAL_PASS_BITS));
+            fields.depth = static_cast<uint16_t>(key >> 20);
+        }
+
+        return fields;
+    }
+
+    uint16_t quantize_depth(const float depth) {
+        // Non-negative floats sort the same as their bits, and the top 16 bits of a positive float are the exponent and the top seven
+        // bits of the mantissa. NaNs fail the comparison and become zero too
+        const float clamped_depth = depth > 0.0F ? depth : 0.0F;
+
+        uint32_t depth_bits;
+        std::memcpy(&depth_bits, &clamped_depth, sizeof(depth_bits));
+
+        return static_cast<uint16_t>(depth_bits >> 16);
+    }
+
+    /*!
+     * \brief Runs `func` once for each block, using the scheduler's threads for every block but the first
+     */
+    template <typename BlockFunc>
+    void for_each_block(ttl::task_scheduler* scheduler, const uint32_t num_blocks, const BlockFunc& func) {
+        if(num_blocks == 1) {
+            func(0);
+            return;
+        }
+
+        ttl::condition_counter blocks_remaining;
+        for(uint32_t block = 1; block < num_blocks; block++) {
+            scheduler->add_task(&blocks_remaining, [&func, block](ttl::task_scheduler* /* scheduler */) { func(block); });
+        }
+
+        func(0);
+
+        blocks_remaining.wait_for_value(0);
+    }
+
+    void sort_draw_keys(std::vector<DrawKey>& keys, std::vector<DrawKey>& scratch, ttl::task_scheduler* scheduler) {
+        const size_t num_keys = keys.size();
+        if(num_keys < MIN_KEYS_FOR_RADIX_SORT) {
+            std::sort(keys.begin(), keys.end());
+            return;
+        }
+
+        scratch.resize(num_keys);
+
+        uint32_t num_blocks = 1;
+        if(scheduler != nullptr) {
+            num_blocks = static_cast<uint32_t>(std::clamp<size_t>(num_keys / MIN_KEYS_PER_BLOCK, 1, scheduler->get_num_threads()));
+        }
+
+        const size_t keys_per_block = (num_keys + num_blocks - 1) / num_blocks;
+        const auto get_block_range = [&](const uint32_t block) {
+            const size_t block_start = std::min(block * keys_per_block, num_keys);
+            return std::make_pair(block_start, std::min(block_start + keys_per_block, num_keys));
+        };
+
+        std::vector<Histogram> block_histograms(num_blocks);
+
+        // Find which bits differ between keys, so that passes over bytes that every key shares can be skipped
+        std::vector<DrawKey> block_and(num_blocks, ~DrawKey(0));
+        std::vector<DrawKey> block_or(num_blocks, 0);
+        for_each_block(scheduler, num_blocks, [&](const uint32_t block) {
+            const auto [block_start, block_end] = get_block_range(block);
+
+            DrawKey and_bits = ~DrawKey(0);
+            DrawKey or_bits = 0;
+            for(size_t i = block_start; i < block_end; i++) {
+                and_bits &= keys[i];
+                or_bits |= keys[i];
+            }
+
+            block_and[block] = and_bits;
+            block_or[block] = or_bits;
+        });
+
+        DrawKey all_and = ~DrawKey(0);
+        DrawKey all_or = 0;
+        for(uint32_t block = 0; block < num_blocks; block++) {
+            all_and &= block_and[block];
+            all_or |= block_or[block];
+        }
+        const DrawKey differing_bits = all_and ^ all_or;
+
+        DrawKey* source = keys.data();
+        DrawKey* destination = scratch.data();
+
+        for(uint32_t pass = 0; pass < NUM_PASSES; pass++) {
+            const uint32_t shift = pass * 8;
+            if(((differing_bits >> shift) & 0xFF) == 0) {
+                continue;
+            }
+
+            for_each_block(scheduler, num_blocks, [&](const uint32_t block) {
+                const auto [block_start, block_end] = get_block_range(block);
+
+                Histogram& histogram = block_histograms[block];
+                histogram.fill(0);
+                for(size_t i = block_start; i < block_end; i++) {
+                    histogram[(source[i] >> shift) & 0xFF]++;
+                }
+            });
+
+            // Each block scatters to its own part of each bucket, after the parts of the blocks before it, so the sort is stable
+            uint32_t offset = 0;
+            for(uint32_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+                for(Histogram& histogram : block_histograms) {
+                    const uint32_t count = histogram[bucket];
+                    histogram[bucket] = offset;
+                    offset += count;
+                }
+            }
+
+            for_each_block(scheduler, num_blocks, [&](const uint32_t block) {
+                const auto [block_start, block_end] = get_block_range(block);
+
+                Histogram& offsets = block_histograms[block];
+                for(size_t i = block_start; i < block_end; i++) {
+                    const DrawKey key = source[i];
+                    destination[offsets[(key >> shift) & 0xFF]++] = key;
+                }
+            });
+
+            std::swap(source, destination);
+        }
+
+        if(source != keys.data()) {
+            keys.swap(scratch);
+        }
+    }
+} // namespace nova::renderer
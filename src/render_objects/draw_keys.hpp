@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace nova::ttl {
+    class task_scheduler;
+}
+
+namespace nova::renderer {
+    /*!
+     * \brief A 64-bit key for one draw, which sorts draws into the order they should be recorded in
+     *
+     * The top two bits are the draw's queue, so opaque draws come before cutout draws, which come before transparent draws. Opaque and
+     * cutout draws are then sorted by pipeline, then material pass, then depth front-to-back, so that they change as little state as
+     * possible and still get some early-Z rejection. Transparent draws are sorted by depth back-to-front before anything else, since they
+     * have to blend in the right order
+     *
+     * The lowest bits are the draw's mesh batch, which makes every key unique and lets the key be decoded back into the draw it came from
+     */
+    using DrawKey = uint64_t;
+
+    /*!
+     * \brief Which queue a draw goes in. The queues are drawn in the order they're declared in
+     */
+    enum class DrawQueue : uint8_t {
+        Opaque = 0,
+        Cutout = 1,
+        Transparent = 2,
+    };
+
+    /*!
+     * \brief Everything that a draw key is made of
+     */
+    struct DrawKeyFields {
+        DrawQueue queue = DrawQueue::Opaque;
+
+        /*!
+         * \brief Index of the draw's pipeline in its renderpass. Must be less than `MAX_PIPELINE`
+         */
+        uint32_t pipeline = 0;
+
+        /*!
+         * \brief Index of the draw's material pass in its pipeline. Must be less than `MAX_MATERIAL_PASS`
+         */
+        uint32_t material_pass = 0;
+
+        /*!
+         * \brief Index of the draw's mesh batch in its material pass. Must be less than `MAX_MESH_BATCH`
+         */
+        uint32_t mesh_batch = 0;
+
+        /*!
+         * \brief The draw's depth, from `quantize_depth`. Larger is further from the camera
+         */
+        uint16_t depth = 0;
+    };
+
+    constexpr uint32_t DRAW_KEY_PIPELINE_BITS = 12;
+    constexpr uint32_t DRAW_KEY_MATERIAL_PASS_BITS = 14;
+    constexpr uint32_t DRAW_KEY_MESH_BATCH_BITS = 20;
+    constexpr uint32_t DRAW_KEY_DEPTH_BITS = 16;
+
+    constexpr uint32_t MAX_PIPELINE = 1U << DRAW_KEY_PIPELINE_BITS;
+    constexpr uint32_t MAX_MATERIAL_PASS = 1U << DRAW_KEY_MATERIAL_PASS_BITS;
+    constexpr uint32_t MAX_MESH_BATCH = 1U << DRAW_KEY_MESH_BATCH_BITS;
+
+    [[nodiscard]] DrawKey make_draw_key(const DrawKeyFields& fields);
+
+    [[nodiscard]] DrawKeyFields decode_draw_key(DrawKey key);
+
+    /*!
+     * \brief Quantizes a view-space depth to 16 bits, keeping its order
+     *
+     * The depth's float bits are truncated, so the quantized depth has the same relative precision everywhere and doesn't need the near
+     * and far planes. Negative depths, which are behind the camera, become zero
+     */
+    [[nodiscard]] uint16_t quantize_depth(float depth);
+
+    /*!
+     * \brief Sorts draw keys in ascending order with an LSD radix sort, one byte at a time
+     *
+     * Bytes that are the same in every key are skipped, which is most of them when there's only a few pipelines and material passes
+     *
+     * \param keys The keys to sort. They're sorted in-place
+     * \param scratch Space for the sort to write keys to between passes. It's resized to fit, and its contents afterwards are undefined
+     * \param scheduler If not null, large sorts are split into blocks that are counted and scattered on the scheduler's threads. This
+     * method waits for those tasks, so it must not be called from one of the scheduler's threads
+     */
+    void sort_draw_keys(std::vector<DrawKey>& keys, std::vector<DrawKey>& scratch, ttl::task_scheduler* scheduler = nullptr);
+} // namespace nova::renderer
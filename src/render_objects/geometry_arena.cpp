@@ -0,0 +1,132 @@
+#include "geometry_arena.hpp"
+
+#include "nova_renderer/allocation_structs.hpp"
+#include "nova_renderer/command_list.hpp"
+
+#include "../util/logger.hpp"
+
+using namespace bvestl::polyalloc;
+
+namespace nova::renderer {
+    GeometryArena::GeometryArena(rhi::RenderEngine& rhi,
+                                 DeviceMemoryResource& memory,
+                                 const allocator_handle& allocator,
+                                 const NovaSettings::BlockAllocatorSettings& vertex_settings,
+                                 const NovaSettings::BlockAllocatorSettings& index_settings)
+        : rhi(&rhi), memory(&memory), allocator(allocator), vertex_settings(vertex_settings), index_settings(index_settings) {
+        pages.reserve(vertex_settings.max_total_allocation / vertex_settings.new_buffer_size);
+    }
+
+    bool GeometryArena::allocate(const uint32_t num_vertices, const uint32_t num_indices, Mesh& mesh) {
+        if(num_vertices * sizeof(FullVertex) > vertex_settings.new_buffer_size || num_indices * sizeof(uint32_t) > index_settings.new_buffer_size) {
+            NOVA_LOG(ERROR) << "Mesh with " << num_vertices << " vertices and " << num_indices
+                            << " indices is too large to fit in a single geometry arena page";
+            return false;
+        }
+
+        // Prefer the newest pages, since they're the ones most likely to have space
+        for(uint32_t i = static_cast<uint32_t>(pages.size()); i > 0; i--) {
+            if(allocate_from_page(pages[i - 1], num_vertices, num_indices, mesh)) {
+                mesh.page = i - 1;
+                return true;
+            }
+        }
+
+        if(!add_page()) {
+            NOVA_LOG(ERROR) << "Geometry arena is out of memory";
+            return false;
+        }
+
+        const auto new_page_idx = static_cast<uint32_t>(pages.size() - 1);
+        if(allocate_from_page(pages[new_page_idx], num_vertices, num_indices, mesh)) {
+            mesh.page = new_page_idx;
+            return true;
+        }
+
+        return false;
+    }
+
+    void GeometryArena::free(const Mesh& mesh) {
+        Page& page = pages.at(mesh.page);
+
+        page.vertex_allocator->free(mesh.vertex_allocation);
+        page.index_allocator->free(mesh.index_allocation);
+    }
+
+    void GeometryArena::bind_page(const uint32_t page_idx, rhi::CommandList* cmds) const {
+        const Page& page = pages.at(page_idx);
+
+        // One binding per vertex attribute, see `get_vertex_input_binding_descriptions`
+        const std::vector<rhi::Buffer*> vertex_buffers = {page.vertex_buffer,
+                                                          page.vertex_buffer,
+                                                          page.vertex_buffer,
+                                                          page.vertex_buffer,
+                                                          page.vertex_buffer,
+                                                          page.vertex_buffer,
+                                                          page.vertex_buffer};
+        cmds->bind_vertex_buffers(vertex_buffers);
+        cmds->bind_index_buffer(page.index_buffer);
+    }
+
+    rhi::Buffer* GeometryArena::get_vertex_buffer(const uint32_t page_idx) const { return pages.at(page_idx).vertex_buffer; }
+
+    rhi::Buffer* GeometryArena::get_index_buffer(const uint32_t page_idx) const { return pages.at(page_idx).index_buffer; }
+
+    uint32_t GeometryArena::get_num_pages() const { return static_cast<uint32_t>(pages.size()); }
+
+    bool GeometryArena::add_page() {
+        const uint64_t next_page_count = pages.size() + 1;
+        if(next_page_count * vertex_settings.new_buffer_size > vertex_settings.max_total_allocation ||
+           next_page_count * index_settings.new_buffer_size > index_settings.max_total_allocation) {
+            return false;
+        }
+
+        Page page;
+
+        rhi::BufferCreateInfo vertex_buffer_create_info = {};
+        vertex_buffer_create_info.buffer_usage = rhi::BufferUsage::VertexBuffer;
+        vertex_buffer_create_info.size = vertex_settings.new_buffer_size;
+        page.vertex_buffer = rhi->create_buffer(vertex_buffer_create_info, *memory);
+
+        rhi::BufferCreateInfo index_buffer_create_info = {};
+        index_buffer_create_info.buffer_usage = rhi::BufferUsage::IndexBuffer;
+        index_buffer_create_info.size = index_settings.new_buffer_size;
+        page.index_buffer = rhi->create_buffer(index_buffer_create_info, *memory);
+
+        // Aligning every vertex allocation to the size of a vertex means every allocation's offset is a whole number of vertices
+        page.vertex_allocator = std::make_unique<BlockAllocationStrategy>(allocator,
+                                                                          Bytes(vertex_settings.new_buffer_size),
+                                                                          Bytes(sizeof(FullVertex)));
+        page.index_allocator = std::make_unique<BlockAllocationStrategy>(allocator,
+                                                                         Bytes(index_settings.new_buffer_size),
+                                                                         Bytes(sizeof(uint32_t)));
+
+        pages.push_back(std::move(page));
+
+        NOVA_LOG(DEBUG) << "Added geometry arena page " << pages.size() - 1;
+
+        return true;
+    }
+
+    bool GeometryArena::allocate_from_page(Page& page, const uint32_t num_vertices, const uint32_t num_indices, Mesh& mesh) {
+        AllocationInfo vertex_allocation;
+        if(!page.vertex_allocator->allocate(Bytes(num_vertices * sizeof(FullVertex)), vertex_allocation)) {
+            return false;
+        }
+
+        AllocationInfo index_allocation;
+        if(!page.index_allocator->allocate(Bytes(num_indices * sizeof(uint32_t)), index_allocation)) {
+            page.vertex_allocator->free(vertex_allocation);
+            return false;
+        }
+
+        mesh.vertex_allocation = vertex_allocation;
+        mesh.index_allocation = index_allocation;
+        mesh.vertex_offset = static_cast<int32_t>(vertex_allocation.offset.b_count() / sizeof(FullVertex));
+        mesh.first_index = static_cast<uint32_t>(index_allocation.offset.b_count() / sizeof(uint32_t));
+        mesh.num_vertices = num_vertices;
+        mesh.num_indices = num_indices;
+
+        return true;
+    }
+} // namespace nova::renderer
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "nova_renderer/nova_renderer.hpp"
+#include "nova_renderer/nova_settings.hpp"
+
+#include "../memory/block_allocation_strategy.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Sub-allocates mesh data out of a handful of large vertex and index buffers
+     *
+     * The arena is split into pages. Each page is one vertex buffer and one index buffer, and every mesh lives entirely within a single
+     * page. Meshes in the same page share buffer bindings, so drawing them only needs the mesh's first index and vertex offset. That's
+     * also exactly the data an indirect draw needs, so this is the first step towards GPU-driven rendering
+     *
+     * Pages are created lazily, using the sizes from `NovaSettings::vertex_memory_settings` and `NovaSettings::index_memory_settings`
+     */
+    class GeometryArena {
+    public:
+        /*!
+         * \brief Index of a page that doesn't exist. Use this to say "nothing is bound"
+         */
+        static constexpr uint32_t NO_PAGE = std::numeric_limits<uint32_t>::max();
+
+        /*!
+         * \brief Creates an empty geometry arena
+         *
+         * \param rhi The render engine to create the page buffers with
+         * \param memory The device memory to allocate the page buffers from
+         * \param allocator The allocator to use for the arena's internal bookkeeping
+         * \param vertex_settings How large each page's vertex buffer is, and how much vertex memory the arena may use in total
+         * \param index_settings How large each page's index buffer is, and how much index memory the arena may use in total
+         */
+        GeometryArena(rhi::RenderEngine& rhi,
+                      DeviceMemoryResource& memory,
+                      const bvestl::polyalloc::allocator_handle& allocator,
+                      const NovaSettings::BlockAllocatorSettings& vertex_settings,
+                      const NovaSettings::BlockAllocatorSettings& index_settings);
+
+        GeometryArena(GeometryArena&& old) noexcept = default;
+        GeometryArena& operator=(GeometryArena&& old) noexcept = default;
+
+        GeometryArena(const GeometryArena& other) = delete;
+        GeometryArena& operator=(const GeometryArena& other) = delete;
+
+        ~GeometryArena() = default;
+
+        /*!
+         * \brief Finds space for a mesh with the given number of vertices and indices, filling out the mesh's page, allocations, first
+         * index, and vertex offset
+         *
+         * \return True if the allocation succeeded, false if the mesh is larger than a page or the arena is full
+         */
+        [[nodiscard]] bool allocate(uint32_t num_vertices, uint32_t num_indices, Mesh& mesh);
+
+        /*!
+         * \brief Returns the mesh's vertex and index ranges to the arena so that other meshes can use them
+         *
+         * The caller is responsible for making sure that the GPU is no longer reading from the mesh
+         */
+        void free(const Mesh& mesh);
+
+        /*!
+         * \brief Binds the vertex and index buffers of the provided page
+         */
+        void bind_page(uint32_t page_idx, rhi::CommandList* cmds) const;
+
+        [[nodiscard]] rhi::Buffer* get_vertex_buffer(uint32_t page_idx) const;
+
+        [[nodiscard]] rhi::Buffer* get_index_buffer(uint32_t page_idx) const;
+
+        [[nodiscard]] uint32_t get_num_pages() const;
+
+    private:
+        struct Page {
+            rhi::Buffer* vertex_buffer = nullptr;
+            rhi::Buffer* index_buffer = nullptr;
+
+            std::unique_ptr<bvestl::polyalloc::BlockAllocationStrategy> vertex_allocator;
+            std::unique_ptr<bvestl::polyalloc::BlockAllocationStrategy> index_allocator;
+        };
+
+        rhi::RenderEngine* rhi;
+        DeviceMemoryResource* memory;
+        bvestl::polyalloc::allocator_handle allocator;
+
+        NovaSettings::BlockAllocatorSettings vertex_settings;
+        NovaSettings::BlockAllocatorSettings index_settings;
+
+        std::vector<Page> pages;
+
+        /*!
+         * \brief Creates a new page, returning false if doing so would go over the arena's memory budget
+         */
+        bool add_page();
+
+        static bool allocate_from_page(Page& page, uint32_t num_vertices, uint32_t num_indices, Mesh& mesh);
+    };
+} // namespace nova::renderer
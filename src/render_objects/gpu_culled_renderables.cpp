@@ -0,0 +1,159 @@
+#include "gpu_culled_renderables.hpp"
+
+#include "../util/logger.hpp"
+
+namespace nova::renderer {
+    GpuCulledRenderables::GpuCulledRenderables(const uint32_t max_num_renderables, const uint32_t max_num_draws)
+        : max_num_renderables(max_num_renderables), max_num_draws(max_num_draws) {
+        renderables.reserve(max_num_renderables);
+        draws.reserve(max_num_draws);
+        num_renderables_per_draw.reserve(max_num_draws);
+    }
+
+    uint32_t GpuCulledRenderables::add_draw() {
+        if(draws.size() == max_num_draws) {
+            NOVA_LOG(WARN) << "Can't add more than " << max_num_draws << " draws to GPU culling";
+            return NO_DRAW;
+        }
+
+        draws.push_back({});
+        num_renderables_per_draw.push_back(0);
+        draws_changed = true;
+
+        return static_cast<uint32_t>(draws.size() - 1);
+    }
+
+    void GpuCulledRenderables::set_draw_geometry(const uint32_t draw,
+                                                 const uint32_t num_indices,
+                                                 const uint32_t first_index,
+                                                 const int32_t vertex_offset) {
+        rhi::IndexedIndirectDrawCommand& command = draws[draw];
+        command.num_indices = num_indices;
+        command.first_index = first_index;
+        command.vertex_offset = vertex_offset;
+
+        draws_changed = true;
+    }
+
+    uint32_t GpuCulledRenderables::insert(const RenderableId id,
+                                          const uint32_t draw,
+                                          const glm::mat4& model_matrix,
+                                          const InstanceData& instance_data,
+                                          const Aabb& bounds,
+                                          const bool is_visible) {
+        uint32_t slot;
+        if(!free_slots.empty()) {
+            slot = free_slots.back();
+            free_slots.pop_back();
+
+        } else if(renderables.size() < max_num_renderables) {
+            slot = static_cast<uint32_t>(renderables.size());
+            renderables.emplace_back();
+
+        } else {
+            NOVA_LOG(WARN) << "Can't cull more than " << max_num_renderables << " static renderables on the GPU";
+            return NO_SLOT;
+        }
+
+        renderables[slot] = {model_matrix, instance_data, bounds.min, draw, bounds.max, is_visible ? 1U : 0U};
+        renderable_slots.emplace(id, slot);
+
+        num_renderables_per_draw[draw]++;
+        draws_changed = true;
+
+        return slot;
+    }
+
+    uint32_t GpuCulledRenderables::update(const RenderableId id,
+                                          const uint32_t draw,
+                                          const glm::mat4& model_matrix,
+                                          const InstanceData& instance_data,
+                                          const Aabb& bounds) {
+        const auto slot_itr = renderable_slots.find(id);
+        if(slot_itr == renderable_slots.end()) {
+            return NO_SLOT;
+        }
+
+        Renderable& renderable = renderables[slot_itr->second];
+        if(renderable.draw_index != draw) {
+            num_renderables_per_draw[renderable.draw_index]--;
+            num_renderables_per_draw[draw]++;
+            draws_changed = true;
+        }
+
+        renderable.model_matrix = model_matrix;
+        renderable.instance_data = instance_data;
+        renderable.bounds_min = bounds.min;
+        renderable.bounds_max = bounds.max;
+        renderable.draw_index = draw;
+
+        return slot_itr->second;
+    }
+
+    uint32_t GpuCulledRenderables::set_visibility(const RenderableId id, const bool is_visible) {
+        const auto slot_itr = renderable_slots.find(id);
+        if(slot_itr == renderable_slots.end()) {
+            return NO_SLOT;
+        }
+
+        renderables[slot_itr->second].is_enabled = is_visible ? 1 : 0;
+
+        return slot_itr->second;
+    }
+
+    uint32_t GpuCulledRenderables::remove(const RenderableId id) {
+        const auto slot_itr = renderable_slots.find(id);
+        if(slot_itr == renderable_slots.end()) {
+            return NO_SLOT;
+        }
+
+        const uint32_t slot = slot_itr->second;
+        renderable_slots.erase(slot_itr);
+
+        Renderable& renderable = renderables[slot];
+        num_renderables_per_draw[renderable.draw_index]--;
+        draws_changed = true;
+
+        // Disabled renderables are skipped by the shader, so the slot can stay in the buffer until it's reused
+        renderable.is_enabled = 0;
+        free_slots.push_back(slot);
+
+        return slot;
+    }
+
+    bool GpuCulledRenderables::contains(const RenderableId id) const { return renderable_slots.find(id) != renderable_slots.end(); }
+
+    void GpuCulledRenderables::clear() {
+        renderables.clear();
+        free_slots.clear();
+        renderable_slots.clear();
+        draws.clear();
+        num_renderables_per_draw.clear();
+        num_instances = 0;
+        draws_changed = false;
+    }
+
+    bool GpuCulledRenderables::update_draw_ranges() {
+        if(!draws_changed) {
+            return false;
+        }
+
+        num_instances = 0;
+        for(uint32_t draw = 0; draw < draws.size(); draw++) {
+            draws[draw].num_instances = 0;
+            draws[draw].first_instance = num_instances;
+            num_instances += num_renderables_per_draw[draw];
+        }
+
+        draws_changed = false;
+        return true;
+    }
+
+    const GpuCulledRenderables::Renderable& GpuCulledRenderables::get_renderable(const uint32_t slot) const { return renderables[slot]; }
+
+    uint32_t GpuCulledRenderables::get_num_slots() const { return static_cast<uint32_t>(renderables.size()); }
+
+    const std::vector<rhi::IndexedIndirectDrawCommand>& GpuCulledRenderables::get_draws() const { return draws; }
+
+    uint32_t GpuCulledRenderables::get_num_instances() const { return num_instances; }
+} // namespace nova::renderer
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "nova_renderer/culling.hpp"
+#include "nova_renderer/renderables.hpp"
+#include "nova_renderer/rhi_types.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief The CPU's copy of everything that GPU culling reads: each static renderable, and each indirect draw that renderables are
+     * culled into
+     *
+     * Renderables live in slots, which are their indices in the GPU's renderable buffer. Removing a renderable disables its slot rather
+     * than moving another renderable into it, so that a removal only has to write one renderable to the GPU. Disabled slots are reused by
+     * later insertions
+     *
+     * Each method that changes a renderable returns the slot that changed, so that the caller can write that slot to the GPU
+     */
+    class GpuCulledRenderables {
+    public:
+        static constexpr uint32_t NO_DRAW = std::numeric_limits<uint32_t>::max();
+
+        static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+        /*!
+         * \brief One renderable, laid out the way the culling shader reads it
+         */
+        struct Renderable {
+            glm::mat4 model_matrix;
+            InstanceData instance_data;
+            glm::vec3 bounds_min;
+            uint32_t draw_index;
+            glm::vec3 bounds_max;
+            uint32_t is_enabled;
+        };
+
+        static_assert(sizeof(Renderable) == 128, "Renderable must match the std430 layout of the culling shader's renderables");
+
+        GpuCulledRenderables(uint32_t max_num_renderables, uint32_t max_num_draws);
+
+        /*!
+         * \brief Adds a draw with no geometry and no renderables, returning its index or NO_DRAW if there's no room for it
+         */
+        [[nodiscard]] uint32_t add_draw();
+
+        void set_draw_geometry(uint32_t draw, uint32_t num_indices, uint32_t first_index, int32_t vertex_offset);
+
+        /*!
+         * \brief Adds a renderable to a draw, returning its slot or NO_SLOT if there's no room for it
+         */
+        [[nodiscard]] uint32_t insert(RenderableId id,
+                                      uint32_t draw,
+                                      const glm::mat4& model_matrix,
+                                      const InstanceData& instance_data,
+                                      const Aabb& bounds,
+                                      bool is_visible);
+
+        /*!
+         * \brief Changes a renderable's transform, instance data, bounds, and draw, returning its slot or NO_SLOT if there's no renderable
+         * with that ID
+         */
+        [[nodiscard]] uint32_t update(
+            RenderableId id, uint32_t draw, const glm::mat4& model_matrix, const InstanceData& instance_data, const Aabb& bounds);
+
+        /*!
+         * \brief Returns the renderable's slot, or NO_SLOT if there's no renderable with that ID
+         */
+        [[nodiscard]] uint32_t set_visibility(RenderableId id, bool is_visible);
+
+        /*!
+         * \brief Removes a renderable, returning the slot that it was disabled in or NO_SLOT if there's no renderable with that ID
+         */
+        [[nodiscard]] uint32_t remove(RenderableId id);
+
+        [[nodiscard]] bool contains(RenderableId id) const;
+
+        /*!
+         * \brief Removes every renderable and every draw
+         */
+        void clear();
+
+        /*!
+         * \brief Gives each draw a range of instances that's large enough for all its renderables, if the draws changed since the last
+         * call. Returns whether they did
+         *
+         * The ranges are packed together starting at instance 0, in the order the draws were added. Every draw's instance count is
+         * reset to zero, since the culling shader counts the instances
+         */
+        bool update_draw_ranges();
+
+        [[nodiscard]] const Renderable& get_renderable(uint32_t slot) const;
+
+        /*!
+         * \brief How many slots there are, including the disabled ones. The culling shader has to test this many renderables
+         */
+        [[nodiscard]] uint32_t get_num_slots() const;
+
+        [[nodiscard]] const std::vector<rhi::IndexedIndirectDrawCommand>& get_draws() const;
+
+        /*!
+         * \brief The number of instances that the draws' ranges cover, as of the last `update_draw_ranges`
+         */
+        [[nodiscard]] uint32_t get_num_instances() const;
+
+    private:
+        uint32_t max_num_renderables;
+        uint32_t max_num_draws;
+
+        std::vector<Renderable> renderables;
+
+        /*!
+         * \brief Slots in `renderables` below the high water mark that no renderable uses. Their renderables are disabled
+         */
+        std::vector<uint32_t> free_slots;
+
+        std::unordered_map<RenderableId, uint32_t> renderable_slots;
+
+        std::vector<rhi::IndexedIndirectDrawCommand> draws;
+
+        /*!
+         * \brief How many renderables each draw has, which is how many instances the draw has space for
+         */
+        std::vector<uint32_t> num_renderables_per_draw;
+
+        uint32_t num_instances = 0;
+
+        /*!
+         * \brief Whether the draws' geometry or instance ranges changed since `update_draw_ranges` was last called
+         */
+        bool draws_changed = false;
+    };
+} // namespace nova::renderer
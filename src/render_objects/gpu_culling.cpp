@@ -0,0 +1,380 @@
+#include "gpu_culling.hpp"
+
+#pragma warning(push, 0)
+#include <minitrace.h>
+#pragma warning(pop)
+
+#include "nova_renderer/command_list.hpp"
+
+#include "../loading/shaderpack/shader_reflection.hpp"
+#include "../loading/shaderpack/shaderpack_loading.hpp"
+#include "../util/logger.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Alignment of every buffer in the culling memory. Large enough for any storage buffer offset alignment we know of
+     */
+    constexpr uint64_t BUFFER_ALIGNMENT = 256;
+
+    constexpr uint32_t CULLING_GROUP_SIZE = 64;
+
+    /*!
+     * \brief The culling compute shader
+     *
+     * The plane test is the same as `cull_aabbs`, so the GPU and CPU agree on which renderables are visible
+     */
+    const char* CULLING_SHADER_SOURCE = R"(
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct InstanceData {
+    vec4 tint;
+    float animation_frame;
+    float light_level;
+    uvec2 custom_data;
+};
+
+struct Renderable {
+    mat4 model_matrix;
+    InstanceData instance_data;
+    vec3 bounds_min;
+    uint draw_index;
+    vec3 bounds_max;
+    uint is_enabled;
+};
+
+struct DrawCommand {
+    uint num_indices;
+    uint num_instances;
+    uint first_index;
+    int vertex_offset;
+    uint first_instance;
+};
+
+layout(set = 0, binding = 0) uniform CullingUniforms {
+    vec4 frustum_planes[6];
+    uint num_renderables;
+};
+
+layout(set = 0, binding = 1, std430) readonly buffer Renderables {
+    Renderable renderables[];
+};
+
+layout(set = 0, binding = 2, std430) buffer Draws {
+    DrawCommand draws[];
+};
+
+layout(set = 0, binding = 3, std430) writeonly buffer ModelMatrices {
+    mat4 model_matrices[];
+};
+
+layout(set = 0, binding = 4, std430) writeonly buffer Instances {
+    InstanceData instance_data[];
+};
+
+void main() {
+    const uint index = gl_GlobalInvocationID.x;
+    if(index >= num_renderables || renderables[index].is_enabled == 0) {
+        return;
+    }
+
+    const vec3 bounds_min = renderables[index].bounds_min;
+    const vec3 bounds_max = renderables[index].bounds_max;
+    for(int i = 0; i < 6; i++) {
+        const vec4 plane = frustum_planes[i];
+        const vec3 far_corner = mix(bounds_min, bounds_max, greaterThanEqual(plane.xyz, vec3(0)));
+        if(plane.x * far_corner.x + (plane.y * far_corner.y + (plane.z * far_corner.z + plane.w)) < 0) {
+            return;
+        }
+    }
+
+    const uint draw_index = renderables[index].draw_index;
+    const uint instance = draws[draw_index].first_instance + atomicAdd(draws[draw_index].num_instances, 1);
+    model_matrices[instance] = renderables[index].model_matrix;
+    instance_data[instance] = renderables[index].instance_data;
+}
+)";
+
+    uint64_t align_buffer_size(const uint64_t size) { return (size + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT; }
+
+    uint64_t GpuCulling::get_memory_size(const uint32_t max_num_renderables, const uint32_t max_num_draws) {
+        return align_buffer_size(sizeof(CullingUniforms)) +
+               align_buffer_size(sizeof(GpuCulledRenderables::Renderable) * max_num_renderables) +
+               align_buffer_size(sizeof(rhi::IndexedIndirectDrawCommand) * max_num_draws) * 2;
+    }
+
+    GpuCulling::GpuCulling(rhi::RenderEngine& rhi,
+                           DeviceMemoryResource& memory,
+                           rhi::Buffer* model_matrix_buffer,
+                           rhi::Buffer* instance_data_buffer,
+                           const uint32_t max_num_renderables,
+                           const uint32_t max_num_draws)
+        : rhi(rhi),
+          max_num_renderables(max_num_renderables),
+          max_num_draws(max_num_draws),
+          model_matrix_buffer(model_matrix_buffer),
+          instance_data_buffer(instance_data_buffer),
+          culled_renderables(max_num_renderables, max_num_draws) {
+        MTR_SCOPE("Init", "GpuCulling");
+
+        create_pipeline();
+        if(!is_valid()) {
+            return;
+        }
+
+        create_buffers(memory);
+    }
+
+    GpuCulling::~GpuCulling() {
+        if(descriptor_pool != nullptr) {
+            rhi.destroy_descriptor_pool(descriptor_pool);
+        }
+        if(pipeline != nullptr) {
+            rhi.destroy_pipeline(pipeline);
+        }
+        if(pipeline_interface != nullptr) {
+            rhi.destroy_pipeline_interface(pipeline_interface);
+        }
+
+        for(rhi::Buffer* buffer : {uniform_buffer, renderable_buffer, draw_template_buffer, draw_buffer}) {
+            if(buffer != nullptr) {
+                rhi.destroy_buffer(buffer);
+            }
+        }
+    }
+
+    bool GpuCulling::is_valid() const { return pipeline != nullptr; }
+
+    uint32_t GpuCulling::add_draw() { return culled_renderables.add_draw(); }
+
+    void GpuCulling::set_draw_geometry(const uint32_t draw, const uint32_t num_indices, const uint32_t first_index, const int32_t vertex_offset) {
+        culled_renderables.set_draw_geometry(draw, num_indices, first_index, vertex_offset);
+    }
+
+    bool GpuCulling::insert(const RenderableId id,
+                            const uint32_t draw,
+                            const glm::mat4& model_matrix,
+                            const InstanceData& instance_data,
+                            const Aabb& bounds,
+                            const bool is_visible) {
+        const uint32_t slot = culled_renderables.insert(id, draw, model_matrix, instance_data, bounds, is_visible);
+        write_renderable(slot);
+
+        return slot != GpuCulledRenderables::NO_SLOT;
+    }
+
+    void GpuCulling::update(const RenderableId id,
+                            const uint32_t draw,
+                            const glm::mat4& model_matrix,
+                            const InstanceData& instance_data,
+                            const Aabb& bounds) {
+        write_renderable(culled_renderables.update(id, draw, model_matrix, instance_data, bounds));
+    }
+
+    void GpuCulling::set_visibility(const RenderableId id, const bool is_visible) {
+        write_renderable(culled_renderables.set_visibility(id, is_visible));
+    }
+
+    bool GpuCulling::remove(const RenderableId id) {
+        const uint32_t slot = culled_renderables.remove(id);
+        write_renderable(slot);
+
+        return slot != GpuCulledRenderables::NO_SLOT;
+    }
+
+    void GpuCulling::clear() { culled_renderables.clear(); }
+
+    void GpuCulling::record_culling(const Frustum& frustum, rhi::CommandList* cmds) {
+        MTR_SCOPE("RenderLoop", "record_gpu_culling");
+
+        const std::vector<rhi::IndexedIndirectDrawCommand>& draws = culled_renderables.get_draws();
+        if(draws.empty()) {
+            return;
+        }
+
+        if(culled_renderables.update_draw_ranges()) {
+            rhi.write_data_to_buffer(draws.data(), sizeof(rhi::IndexedIndirectDrawCommand) * draws.size(), 0, draw_template_buffer);
+        }
+
+        const uint32_t num_renderables = culled_renderables.get_num_slots();
+        const uint32_t num_instances = culled_renderables.get_num_instances();
+        const CullingUniforms uniforms = {frustum.planes, num_renderables};
+        rhi.write_data_to_buffer(&uniforms, sizeof(CullingUniforms), 0, uniform_buffer);
+
+        const uint64_t draws_size = sizeof(rhi::IndexedIndirectDrawCommand) * draws.size();
+        const uint64_t model_matrices_size = sizeof(glm::mat4) * num_instances;
+        const uint64_t instance_data_size = sizeof(InstanceData) * num_instances;
+
+        const auto make_buffer_barrier = [](rhi::Buffer* buffer,
+                                            const uint64_t size,
+                                            const rhi::AccessFlags access_before,
+                                            const rhi::AccessFlags access_after) {
+            rhi::ResourceBarrier barrier = {};
+            barrier.resource_to_barrier = buffer;
+            barrier.old_state = rhi::ResourceState::Common;
+            barrier.new_state = rhi::ResourceState::Common;
+            barrier.access_before_barrier = access_before;
+            barrier.access_after_barrier = access_after;
+            barrier.source_queue = rhi::QueueType::Graphics;
+            barrier.destination_queue = rhi::QueueType::Graphics;
+            barrier.buffer_memory_barrier.offset = 0;
+            barrier.buffer_memory_barrier.size = size;
+            return barrier;
+        };
+
+        // The last frame's draws and vertex shaders have to be done with the buffers before this frame overwrites them
+        cmds->resource_barriers(rhi::PipelineStageFlags::DrawIndirect,
+                                rhi::PipelineStageFlags::Transfer,
+                                {make_buffer_barrier(draw_buffer, draws_size, rhi::AccessFlags::IndirectCommandRead, rhi::AccessFlags::CopyWrite)});
+        if(num_instances > 0) {
+            cmds->resource_barriers(rhi::PipelineStageFlags::VertexShader,
+                                    rhi::PipelineStageFlags::ComputeShader,
+                                    {make_buffer_barrier(model_matrix_buffer,
+                                                         model_matrices_size,
+                                                         rhi::AccessFlags::ShaderRead,
+                                                         rhi::AccessFlags::ShaderWrite),
+                                     make_buffer_barrier(instance_data_buffer,
+                                                         instance_data_size,
+                                                         rhi::AccessFlags::ShaderRead,
+                                                         rhi::AccessFlags::ShaderWrite)});
+        }
+
+        cmds->copy_buffer(draw_buffer, 0, draw_template_buffer, 0, draws_size);
+
+        cmds->resource_barriers(rhi::PipelineStageFlags::Transfer,
+                                rhi::PipelineStageFlags::ComputeShader,
+                                {make_buffer_barrier(draw_buffer, draws_size, rhi::AccessFlags::CopyWrite, rhi::AccessFlags::ShaderRead),
+                                 make_buffer_barrier(draw_buffer, draws_size, rhi::AccessFlags::CopyWrite, rhi::AccessFlags::ShaderWrite)});
+
+        cmds->bind_pipeline(pipeline);
+        cmds->bind_descriptor_sets(descriptor_sets, pipeline_interface);
+
+        cmds->dispatch((num_renderables + CULLING_GROUP_SIZE - 1) / CULLING_GROUP_SIZE, 1, 1);
+
+        cmds->resource_barriers(rhi::PipelineStageFlags::ComputeShader,
+                                rhi::PipelineStageFlags::DrawIndirect,
+                                {make_buffer_barrier(draw_buffer,
+                                                     draws_size,
+                                                     rhi::AccessFlags::ShaderWrite,
+                                                     rhi::AccessFlags::IndirectCommandRead)});
+        if(num_instances > 0) {
+            cmds->resource_barriers(rhi::PipelineStageFlags::ComputeShader,
+                                    rhi::PipelineStageFlags::VertexShader,
+                                    {make_buffer_barrier(model_matrix_buffer,
+                                                         model_matrices_size,
+                                                         rhi::AccessFlags::ShaderWrite,
+                                                         rhi::AccessFlags::ShaderRead),
+                                     make_buffer_barrier(instance_data_buffer,
+                                                         instance_data_size,
+                                                         rhi::AccessFlags::ShaderWrite,
+                                                         rhi::AccessFlags::ShaderRead)});
+        }
+    }
+
+    rhi::Buffer* GpuCulling::get_draw_buffer() const { return draw_buffer; }
+
+    uint64_t GpuCulling::get_draw_offset(const uint32_t draw) { return sizeof(rhi::IndexedIndirectDrawCommand) * draw; }
+
+    uint32_t GpuCulling::get_num_instances() const { return culled_renderables.get_num_instances(); }
+
+    void GpuCulling::create_pipeline() {
+        if(!rhi.supports_gpu_driven_rendering()) {
+            NOVA_LOG(INFO) << "The render engine doesn't support GPU-driven rendering, static renderables will be culled on the CPU";
+            return;
+        }
+
+        shaderpack::ShaderSource shader;
+        shader.filename = "gpu_culling.comp";
+        shader.source = shaderpack::compile_shader_source(CULLING_SHADER_SOURCE,
+                                                          EShLangCompute,
+                                                          glslang::EShSourceGlsl,
+                                                          shader.filename.string());
+        if(shader.source.empty()) {
+            NOVA_LOG(ERROR) << "Could not compile the GPU culling shader, static renderables will be culled on the CPU";
+            return;
+        }
+
+        shader.reflection = shaderpack::reflect_shader(shader.source);
+
+        const auto make_binding = [](const uint32_t binding, const rhi::DescriptorType type) {
+            rhi::ResourceBindingDescription description = {};
+            description.set = 0;
+            description.binding = binding;
+            description.count = 1;
+            description.type = type;
+            description.stages = rhi::ShaderStageFlags::Compute;
+            return description;
+        };
+
+        const std::unordered_map<std::string, rhi::ResourceBindingDescription> bindings =
+            {{"CullingUniforms", make_binding(0, rhi::DescriptorType::UniformBuffer)},
+             {"Renderables", make_binding(1, rhi::DescriptorType::StorageBuffer)},
+             {"Draws", make_binding(2, rhi::DescriptorType::StorageBuffer)},
+             {"ModelMatrices", make_binding(3, rhi::DescriptorType::StorageBuffer)},
+             {"Instances", make_binding(4, rhi::DescriptorType::StorageBuffer)}};
+
+        ntl::Result<rhi::PipelineInterface*> interface_result = rhi.create_compute_pipeline_interface(bindings);
+        if(!interface_result) {
+            NOVA_LOG(ERROR) << "Could not create the GPU culling pipeline interface: " << interface_result.error.to_string();
+            return;
+        }
+        pipeline_interface = interface_result.value;
+
+        ntl::Result<rhi::Pipeline*> pipeline_result = rhi.create_compute_pipeline(pipeline_interface, shader);
+        if(!pipeline_result) {
+            NOVA_LOG(ERROR) << "Could not create the GPU culling pipeline: " << pipeline_result.error.to_string();
+            return;
+        }
+        pipeline = pipeline_result.value;
+    }
+
+    void GpuCulling::create_buffers(DeviceMemoryResource& memory) {
+        const auto create_buffer = [&](const rhi::BufferUsage usage, const uint64_t size) {
+            rhi::BufferCreateInfo create_info = {};
+            create_info.buffer_usage = usage;
+            create_info.size = align_buffer_size(size);
+            return rhi.create_buffer(create_info, memory);
+        };
+
+        const uint64_t draws_size = sizeof(rhi::IndexedIndirectDrawCommand) * max_num_draws;
+
+        uniform_buffer = create_buffer(rhi::BufferUsage::UniformBuffer, sizeof(CullingUniforms));
+        renderable_buffer = create_buffer(rhi::BufferUsage::StorageBuffer, sizeof(GpuCulledRenderables::Renderable) * max_num_renderables);
+        draw_template_buffer = create_buffer(rhi::BufferUsage::StagingBuffer, draws_size);
+        draw_buffer = create_buffer(rhi::BufferUsage::IndirectBuffer, draws_size);
+
+        descriptor_pool = rhi.create_descriptor_pool(0, 0, 1, 4);
+        descriptor_sets = rhi.create_descriptor_sets(pipeline_interface, descriptor_pool);
+
+        const std::array<rhi::DescriptorBufferUpdate, 5> buffer_updates = {{{uniform_buffer},
+                                                                            {renderable_buffer},
+                                                                            {draw_buffer},
+                                                                            {model_matrix_buffer},
+                                                                            {instance_data_buffer}}};
+
+        std::vector<rhi::DescriptorSetWrite> writes;
+        writes.reserve(buffer_updates.size());
+        for(uint32_t binding = 0; binding < buffer_updates.size(); binding++) {
+            rhi::DescriptorSetWrite write = {};
+            write.set = descriptor_sets.at(0);
+            write.binding = binding;
+            write.type = binding == 0 ? rhi::DescriptorType::UniformBuffer : rhi::DescriptorType::StorageBuffer;
+            write.buffer_info = &buffer_updates[binding];
+            writes.push_back(write);
+        }
+
+        rhi.update_descriptor_sets(writes);
+    }
+
+    void GpuCulling::write_renderable(const uint32_t slot) {
+        if(slot == GpuCulledRenderables::NO_SLOT) {
+            return;
+        }
+
+        rhi.write_data_to_buffer(&culled_renderables.get_renderable(slot),
+                                 sizeof(GpuCulledRenderables::Renderable),
+                                 sizeof(GpuCulledRenderables::Renderable) * slot,
+                                 renderable_buffer);
+    }
+} // namespace nova::renderer
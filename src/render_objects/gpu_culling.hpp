@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "nova_renderer/culling.hpp"
+#include "nova_renderer/nova_renderer.hpp"
+
+#include "gpu_culled_renderables.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Frustum culls static renderables in a compute shader, and writes one indirect draw per mesh batch
+     *
+     * Every static renderable's model matrix and world-space bounds live in a persistent storage buffer, which is only written to when a
+     * renderable changes. Each frame, the culling pass resets the instance count of every draw, then the compute shader tests every
+     * renderable against the frustum. Each visible renderable claims the next instance of its draw with an atomic add, and writes its model
+     * matrix and instance data to that instance's slot in the model matrix and instance data buffers
+     *
+     * Each draw owns a range of the model matrix and instance data buffers that's large enough for all of its renderables, starting at the
+     * draw's first instance. The ranges are packed at the start of the buffers, so anything else that writes instances in a frame must
+     * start after `get_num_instances`
+     *
+     * The CPU only has to write the frustum planes each frame, no matter how many static renderables there are
+     *
+     * This class is not thread-safe. All its methods must be called from the thread that executes frames
+     */
+    class GpuCulling {
+    public:
+        static constexpr uint32_t NO_DRAW = GpuCulledRenderables::NO_DRAW;
+
+        /*!
+         * \brief How many bytes of memory a GpuCulling with the given limits needs
+         */
+        [[nodiscard]] static uint64_t get_memory_size(uint32_t max_num_renderables, uint32_t max_num_draws);
+
+        /*!
+         * \brief Creates the culling pipeline and buffers
+         *
+         * \param rhi The render engine to create resources with. It must support GPU-driven rendering
+         * \param memory Host-visible memory to create the culling buffers in. It must have at least `get_memory_size` bytes free
+         * \param model_matrix_buffer The storage buffer to write the model matrices of visible renderables to
+         * \param instance_data_buffer The storage buffer to write the instance data of visible renderables to
+         * \param max_num_renderables The maximum number of static renderables that can be culled
+         * \param max_num_draws The maximum number of draws that renderables can be added to
+         */
+        GpuCulling(rhi::RenderEngine& rhi,
+                   DeviceMemoryResource& memory,
+                   rhi::Buffer* model_matrix_buffer,
+                   rhi::Buffer* instance_data_buffer,
+                   uint32_t max_num_renderables,
+                   uint32_t max_num_draws);
+
+        GpuCulling(GpuCulling&& old) noexcept = delete;
+        GpuCulling& operator=(GpuCulling&& old) noexcept = delete;
+
+        GpuCulling(const GpuCulling& other) = delete;
+        GpuCulling& operator=(const GpuCulling& other) = delete;
+
+        ~GpuCulling();
+
+        /*!
+         * \brief Checks if the culling pipeline was created successfully. If it wasn't, nothing can be culled on the GPU
+         */
+        [[nodiscard]] bool is_valid() const;
+
+        /*!
+         * \brief Adds a draw with no geometry and no renderables, returning its index or NO_DRAW if there's no room for it
+         */
+        [[nodiscard]] uint32_t add_draw();
+
+        /*!
+         * \brief Sets which indices a draw reads, for when the mesh it draws is created or moves in the geometry arena
+         */
+        void set_draw_geometry(uint32_t draw, uint32_t num_indices, uint32_t first_index, int32_t vertex_offset);
+
+        /*!
+         * \brief Adds a renderable to a draw. Returns false if there's no room for the renderable, in which case it has to be culled
+         * some other way
+         */
+        bool insert(RenderableId id,
+                    uint32_t draw,
+                    const glm::mat4& model_matrix,
+                    const InstanceData& instance_data,
+                    const Aabb& bounds,
+                    bool is_visible);
+
+        /*!
+         * \brief Changes a renderable's transform, instance data, bounds, and draw
+         */
+        void update(RenderableId id, uint32_t draw, const glm::mat4& model_matrix, const InstanceData& instance_data, const Aabb& bounds);
+
+        void set_visibility(RenderableId id, bool is_visible);
+
+        /*!
+         * \brief Removes a renderable, returning false if there's no renderable with that ID
+         */
+        bool remove(RenderableId id);
+
+        /*!
+         * \brief Removes every renderable and every draw
+         */
+        void clear();
+
+        /*!
+         * \brief Records the culling pass. Record this before any draw that reads this frame's draws, model matrices, or instance data
+         */
+        void record_culling(const Frustum& frustum, rhi::CommandList* cmds);
+
+        [[nodiscard]] rhi::Buffer* get_draw_buffer() const;
+
+        /*!
+         * \brief The offset of a draw's arguments in the draw buffer
+         */
+        [[nodiscard]] static uint64_t get_draw_offset(uint32_t draw);
+
+        /*!
+         * \brief The number of instances at the start of the model matrix and instance data buffers that the culling pass may write to
+         */
+        [[nodiscard]] uint32_t get_num_instances() const;
+
+    private:
+        struct CullingUniforms {
+            std::array<glm::vec4, 6> frustum_planes;
+            uint32_t num_renderables;
+        };
+
+        rhi::RenderEngine& rhi;
+
+        uint32_t max_num_renderables;
+        uint32_t max_num_draws;
+
+        rhi::PipelineInterface* pipeline_interface = nullptr;
+        rhi::Pipeline* pipeline = nullptr;
+        rhi::DescriptorPool* descriptor_pool = nullptr;
+        std::vector<rhi::DescriptorSet*> descriptor_sets;
+
+        rhi::Buffer* uniform_buffer = nullptr;
+        rhi::Buffer* renderable_buffer = nullptr;
+
+        /*!
+         * \brief Every draw with an instance count of zero, which is copied over `draw_buffer` at the start of each frame's culling pass
+         */
+        rhi::Buffer* draw_template_buffer = nullptr;
+        rhi::Buffer* draw_buffer = nullptr;
+
+        rhi::Buffer* model_matrix_buffer;
+        rhi::Buffer* instance_data_buffer;
+
+        GpuCulledRenderables culled_renderables;
+
+        void create_pipeline();
+
+        void create_buffers(DeviceMemoryResource& memory);
+
+        /*!
+         * \brief Writes a renderable to the renderable buffer, unless the slot is `GpuCulledRenderables::NO_SLOT`
+         */
+        void write_renderable(uint32_t slot);
+    };
+} // namespace nova::renderer
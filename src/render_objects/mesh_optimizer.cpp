@@ -0,0 +1,456 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace nova::renderer {
+    constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+    constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+    /*!
+     * \brief The size of the LRU cache that Forsyth's algorithm scores vertices with
+     */
+    constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+
+    /*!
+     * \brief Valences at or above this all get the same score, since their score is already tiny
+     */
+    constexpr uint32_t FORSYTH_MAX_VALENCE = 32;
+
+    /*!
+     * \brief Scores for each position in the LRU cache, and for each number of triangles that still use a vertex
+     *
+     * The last triangle's vertices get a fixed score so that the next triangle doesn't just reuse them in a strip. Vertices with few
+     * triangles left get a boost, so that they're finished off rather than left behind as lone triangles
+     */
+    struct ForsythScoreTables {
+        std::array<float, FORSYTH_CACHE_SIZE> cache_scores{};
+        std::array<float, FORSYTH_MAX_VALENCE + 1> valence_scores{};
+
+        ForsythScoreTables() {
+            constexpr float CACHE_DECAY_POWER = 1.5F;
+            constexpr float LAST_TRIANGLE_SCORE = 0.75F;
+            constexpr float VALENCE_BOOST_SCALE = 2.0F;
+            constexpr float VALENCE_BOOST_POWER = 0.5F;
+
+            for(uint32_t position = 0; position < FORSYTH_CACHE_SIZE; position++) {
+                if(position < 3) {
+                    cache_scores[position] = LAST_TRIANGLE_SCORE;
+
+                } else {
+                    const float scale = 1.0F / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+                    cache_scores[position] = std::pow(1.0F - static_cast<float>(position - 3) * scale, CACHE_DECAY_POWER);
+                }
+            }
+
+            for(uint32_t valence = 1; valence <= FORSYTH_MAX_VALENCE; valence++) {
+                valence_scores[valence] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(valence), -VALENCE_BOOST_POWER);
+            }
+        }
+
+        [[nodiscard]] float get_vertex_score(const uint32_t cache_position, const uint32_t remaining_valence) const {
+            if(remaining_valence == 0) {
+                // Vertices that no triangles need anymore shouldn't pull any triangles forward
+                return -1.0F;
+            }
+
+            const float cache_score = cache_position < FORSYTH_CACHE_SIZE ? cache_scores[cache_position] : 0.0F;
+            return cache_score + valence_scores[std::min(remaining_valence, FORSYTH_MAX_VALENCE)];
+        }
+    };
+
+    VertexCacheStats analyze_vertex_cache(const uint32_t* indices,
+                                          const size_t num_indices,
+                                          const uint32_t num_vertices,
+                                          const uint32_t cache_size) {
+        VertexCacheStats stats;
+
+        const size_t num_triangles = num_indices / 3;
+        if(num_triangles == 0 || num_vertices == 0) {
+            return stats;
+        }
+
+        // A vertex is in the FIFO cache if fewer than `cache_size` vertices have been added since it was
+        std::vector<uint32_t> cache_timestamps(num_vertices, 0);
+        uint32_t timestamp = cache_size + 1;
+
+        for(size_t i = 0; i < num_triangles * 3; i++) {
+            const uint32_t vertex = indices[i];
+            if(timestamp - cache_timestamps[vertex] > cache_size) {
+                cache_timestamps[vertex] = timestamp;
+                timestamp++;
+                stats.num_transformed_vertices++;
+            }
+        }
+
+        stats.acmr = static_cast<float>(stats.num_transformed_vertices) / static_cast<float>(num_triangles);
+        stats.atvr = static_cast<float>(stats.num_transformed_vertices) / static_cast<float>(num_vertices);
+
+        return stats;
+    }
+
+    void optimize_vertex_cache(uint32_t* indices, const size_t num_indices, const uint32_t num_vertices) {
+        static const ForsythScoreTables SCORES;
+
+        const size_t num_triangles = num_indices / 3;
+        if(num_triangles == 0) {
+            return;
+        }
+
+        const std::vector<uint32_t> input_indices(indices, indices + num_triangles * 3);
+
+        // Each vertex's triangles, packed together. Emitted triangles are swap-removed from the end of each vertex's list
+        std::vector<uint32_t> remaining_valences(num_vertices, 0);
+        for(const uint32_t vertex : input_indices) {
+            remaining_valences[vertex]++;
+        }
+
+        std::vector<uint32_t> triangle_list_offsets(num_vertices, 0);
+        std::exclusive_scan(remaining_valences.begin(), remaining_valences.end(), triangle_list_offsets.begin(), 0U);
+
+        std::vector<uint32_t> vertex_triangles(input_indices.size());
+        {
+            std::vector<uint32_t> fill_counts(num_vertices, 0);
+            for(size_t i = 0; i < input_indices.size(); i++) {
+                const uint32_t vertex = input_indices[i];
+                vertex_triangles[triangle_list_offsets[vertex] + fill_counts[vertex]] = static_cast<uint32_t>(i / 3);
+                fill_counts[vertex]++;
+            }
+        }
+
+        std::vector<uint32_t> cache_positions(num_vertices, FORSYTH_CACHE_SIZE);
+        std::vector<float> vertex_scores(num_vertices);
+        for(uint32_t vertex = 0; vertex < num_vertices; vertex++) {
+            vertex_scores[vertex] = SCORES.get_vertex_score(FORSYTH_CACHE_SIZE, remaining_valences[vertex]);
+        }
+
+        const auto get_triangle_score = [&](const uint32_t triangle) {
+            const uint32_t* triangle_vertices = &input_indices[triangle * 3];
+            return vertex_scores[triangle_vertices[0]] + vertex_scores[triangle_vertices[1]] + vertex_scores[triangle_vertices[2]];
+        };
+
+        std::vector<uint8_t> is_emitted(num_triangles, 0);
+
+        uint32_t best_triangle = 0;
+        float best_score = get_triangle_score(0);
+        for(uint32_t triangle = 1; triangle < num_triangles; triangle++) {
+            const float score = get_triangle_score(triangle);
+            if(score > best_score) {
+                best_score = score;
+                best_triangle = triangle;
+            }
+        }
+
+        // The cache has room for the new triangle's vertices on top of a full cache, so the vertices that fall out can be rescored
+        std::array<uint32_t, FORSYTH_CACHE_SIZE + 3> cache{};
+        std::array<uint32_t, FORSYTH_CACHE_SIZE + 3> new_cache{};
+        uint32_t cache_count = 0;
+
+        size_t next_unemitted_triangle = 0;
+
+        for(size_t num_emitted = 0; num_emitted < num_triangles; num_emitted++) {
+            if(best_triangle == NO_TRIANGLE) {
+                // Nothing in the cache has triangles left, so start again from whichever triangle comes next
+                while(is_emitted[next_unemitted_triangle] != 0) {
+                    next_unemitted_triangle++;
+                }
+                best_triangle = static_cast<uint32_t>(next_unemitted_triangle);
+            }
+
+            const uint32_t* triangle_vertices = &input_indices[best_triangle * 3];
+            std::copy(triangle_vertices, triangle_vertices + 3, &indices[num_emitted * 3]);
+            is_emitted[best_triangle] = 1;
+
+            uint32_t new_cache_count = 0;
+            for(uint32_t i = 0; i < 3; i++) {
+                const uint32_t vertex = triangle_vertices[i];
+                if(std::find(new_cache.begin(), new_cache.begin() + new_cache_count, vertex) == new_cache.begin() + new_cache_count) {
+                    new_cache[new_cache_count] = vertex;
+                    new_cache_count++;
+                }
+
+                // The triangle is somewhere in the vertex's list, and the list's last triangle takes its place
+                uint32_t* triangles = &vertex_triangles[triangle_list_offsets[vertex]];
+                uint32_t& valence = remaining_valences[vertex];
+                uint32_t* triangle_itr = std::find(triangles, triangles + valence, best_triangle);
+                *triangle_itr = triangles[valence - 1];
+                valence--;
+            }
+
+            for(uint32_t i = 0; i < cache_count; i++) {
+                const uint32_t vertex = cache[i];
+                if(std::find(new_cache.begin(), new_cache.begin() + new_cache_count, vertex) == new_cache.begin() + new_cache_count) {
+                    new_cache[new_cache_count] = vertex;
+                    new_cache_count++;
+                }
+            }
+
+            for(uint32_t i = 0; i < new_cache_count; i++) {
+                const uint32_t vertex = new_cache[i];
+                cache_positions[vertex] = std::min(i, FORSYTH_CACHE_SIZE);
+                vertex_scores[vertex] = SCORES.get_vertex_score(cache_positions[vertex], remaining_valences[vertex]);
+            }
+
+            // Only triangles that use a vertex whose score changed can have a new score, and the best of those is almost always the best
+            // triangle overall
+            best_triangle = NO_TRIANGLE;
+            best_score = -std::numeric_limits<float>::max();
+            for(uint32_t i = 0; i < new_cache_count; i++) {
+                const uint32_t vertex = new_cache[i];
+                const uint32_t* triangles = &vertex_triangles[triangle_list_offsets[vertex]];
+
+                for(uint32_t j = 0; j < remaining_valences[vertex]; j++) {
+                    const uint32_t triangle = triangles[j];
+                    const float score = get_triangle_score(triangle);
+                    if(score > best_score) {
+                        best_score = score;
+                        best_triangle = triangle;
+                    }
+                }
+            }
+
+            cache_count = std::min(new_cache_count, FORSYTH_CACHE_SIZE);
+            std::copy(new_cache.begin(), new_cache.begin() + cache_count, cache.begin());
+        }
+    }
+
+    /*!
+     * \brief Splits the triangles into clusters that can be drawn in any order without hurting the vertex cache much
+     *
+     * A triangle whose vertices all miss the cache starts a new strip of triangles, so those are natural places to split. Each of those
+     * clusters is split further wherever the cluster's triangles so far use the cache well enough to stay under the threshold
+     *
+     * \return The index of the first triangle of each cluster
+     */
+    std::vector<uint32_t> find_triangle_clusters(const uint32_t* indices,
+                                                 const size_t num_triangles,
+                                                 const uint32_t num_vertices,
+                                                 const float threshold) {
+        const auto count_misses = [&](std::vector<uint32_t>& cache_timestamps, uint32_t& timestamp, const size_t triangle) {
+            uint32_t misses = 0;
+            for(uint32_t i = 0; i < 3; i++) {
+                const uint32_t vertex = indices[triangle * 3 + i];
+                if(timestamp - cache_timestamps[vertex] > ANALYSIS_VERTEX_CACHE_SIZE) {
+                    cache_timestamps[vertex] = timestamp;
+                    timestamp++;
+                    misses++;
+                }
+            }
+            return misses;
+        };
+
+        std::vector<uint32_t> hard_clusters;
+        {
+            std::vector<uint32_t> cache_timestamps(num_vertices, 0);
+            uint32_t timestamp = ANALYSIS_VERTEX_CACHE_SIZE + 1;
+
+            for(size_t triangle = 0; triangle < num_triangles; triangle++) {
+                if(count_misses(cache_timestamps, timestamp, triangle) == 3 || triangle == 0) {
+                    hard_clusters.push_back(static_cast<uint32_t>(triangle));
+                }
+            }
+        }
+
+        std::vector<uint32_t> clusters;
+        std::vector<uint32_t> cache_timestamps(num_vertices, 0);
+        uint32_t timestamp = ANALYSIS_VERTEX_CACHE_SIZE + 1;
+
+        for(size_t cluster = 0; cluster < hard_clusters.size(); cluster++) {
+            const uint32_t cluster_start = hard_clusters[cluster];
+            const uint32_t cluster_end = cluster + 1 < hard_clusters.size() ? hard_clusters[cluster + 1]
+                                                                            : static_cast<uint32_t>(num_triangles);
+
+            // Each cluster is drawn after some other cluster, so it can't count on any of its vertices already being in the cache
+            timestamp += ANALYSIS_VERTEX_CACHE_SIZE + 1;
+
+            uint32_t cluster_misses = 0;
+            for(uint32_t triangle = cluster_start; triangle < cluster_end; triangle++) {
+                cluster_misses += count_misses(cache_timestamps, timestamp, triangle);
+            }
+
+            const float max_acmr = threshold * static_cast<float>(cluster_misses) / static_cast<float>(cluster_end - cluster_start);
+
+            timestamp += ANALYSIS_VERTEX_CACHE_SIZE + 1;
+            clusters.push_back(cluster_start);
+
+            uint32_t split_start = cluster_start;
+            uint32_t split_misses = 0;
+            for(uint32_t triangle = cluster_start; triangle < cluster_end; triangle++) {
+                split_misses += count_misses(cache_timestamps, timestamp, triangle);
+
+                const uint32_t split_size = triangle + 1 - split_start;
+                if(triangle + 1 < cluster_end && static_cast<float>(split_misses) <= max_acmr * static_cast<float>(split_size)) {
+                    clusters.push_back(triangle + 1);
+                    split_start = triangle + 1;
+                    split_misses = 0;
+                    timestamp += ANALYSIS_VERTEX_CACHE_SIZE + 1;
+                }
+            }
+        }
+
+        return clusters;
+    }
+
+    void optimize_overdraw(
+        uint32_t* indices, const size_t num_indices, const FullVertex* vertices, const uint32_t num_vertices, const float threshold) {
+        const size_t num_triangles = num_indices / 3;
+        if(num_triangles < 2) {
+            return;
+        }
+
+        const std::vector<uint32_t> clusters = find_triangle_clusters(indices, num_triangles, num_vertices, threshold);
+        if(clusters.size() < 2) {
+            return;
+        }
+
+        // Each cluster's area-weighted center and normal. The lengths of the normals add up to twice the cluster's area
+        std::vector<glm::vec3> cluster_centers(clusters.size(), glm::vec3(0));
+        std::vector<glm::vec3> cluster_normals(clusters.size(), glm::vec3(0));
+        std::vector<float> cluster_areas(clusters.size(), 0.0F);
+
+        glm::vec3 mesh_center(0);
+        float mesh_area = 0;
+
+        for(size_t cluster = 0; cluster < clusters.size(); cluster++) {
+            const uint32_t cluster_end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : static_cast<uint32_t>(num_triangles);
+
+            for(uint32_t triangle = clusters[cluster]; triangle < cluster_end; triangle++) {
+                const glm::vec3& a = vertices[indices[triangle * 3]].position;
+                const glm::vec3& b = vertices[indices[triangle * 3 + 1]].position;
+                const glm::vec3& c = vertices[indices[triangle * 3 + 2]].position;
+
+                const glm::vec3 normal = glm::cross(b - a, c - a);
+                const float area = glm::length(normal);
+
+                cluster_centers[cluster] += (a + b + c) * (area / 3.0F);
+                cluster_normals[cluster] += normal;
+                cluster_areas[cluster] += area;
+            }
+
+            mesh_center += cluster_centers[cluster];
+            mesh_area += cluster_areas[cluster];
+        }
+
+        if(mesh_area == 0) {
+            return;
+        }
+        mesh_center /= mesh_area;
+
+        // Clusters that face away from the center of the mesh are on its outside, and are drawn first
+        std::vector<float> cluster_scores(clusters.size(), 0.0F);
+        for(size_t cluster = 0; cluster < clusters.size(); cluster++) {
+            const float normal_length = glm::length(cluster_normals[cluster]);
+            if(cluster_areas[cluster] == 0 || normal_length == 0) {
+                continue;
+            }
+
+            const glm::vec3 center = cluster_centers[cluster] * (1.0F / cluster_areas[cluster]);
+            cluster_scores[cluster] = glm::dot(center - mesh_center, cluster_normals[cluster] * (1.0F / normal_length));
+        }
+
+        std::vector<uint32_t> cluster_order(clusters.size());
+        std::iota(cluster_order.begin(), cluster_order.end(), 0U);
+        std::stable_sort(cluster_order.begin(), cluster_order.end(), [&](const uint32_t first, const uint32_t second) {
+            return cluster_scores[first] > cluster_scores[second];
+        });
+
+        const std::vector<uint32_t> input_indices(indices, indices + num_triangles * 3);
+        size_t write_index = 0;
+        for(const uint32_t cluster : cluster_order) {
+            const uint32_t cluster_end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : static_cast<uint32_t>(num_triangles);
+            const auto cluster_begin_itr = input_indices.begin() + clusters[cluster] * 3;
+            const auto cluster_end_itr = input_indices.begin() + cluster_end * 3;
+
+            std::copy(cluster_begin_itr, cluster_end_itr, &indices[write_index]);
+            write_index += static_cast<size_t>(cluster_end_itr - cluster_begin_itr);
+        }
+    }
+
+    void optimize_vertex_fetch(std::vector<FullVertex>& vertices, uint32_t* indices, const size_t num_indices) {
+        const auto num_vertices = static_cast<uint32_t>(vertices.size());
+
+        std::vector<uint32_t> new_locations(num_vertices, NO_VERTEX);
+        uint32_t next_location = 0;
+        for(size_t i = 0; i < num_indices; i++) {
+            uint32_t& location = new_locations[indices[i]];
+            if(location == NO_VERTEX) {
+                location = next_location;
+                next_location++;
+            }
+
+            indices[i] = location;
+        }
+
+        for(uint32_t& location : new_locations) {
+            if(location == NO_VERTEX) {
+                location = next_location;
+                next_location++;
+            }
+        }
+
+        std::vector<FullVertex> reordered_vertices(num_vertices);
+        for(uint32_t vertex = 0; vertex < num_vertices; vertex++) {
+            reordered_vertices[new_locations[vertex]] = vertices[vertex];
+        }
+
+        vertices = std::move(reordered_vertices);
+    }
+
+    MeshOptimizationReport optimize_mesh(MeshData& mesh, const NovaSettings::MeshOptimizationOptions& options) {
+        const auto num_vertices = static_cast<uint32_t>(mesh.vertex_data.size());
+
+        MeshOptimizationReport report;
+
+        // Every step below looks up per-vertex data by index, so a mesh with indices past its vertices is left alone
+        if(std::any_of(mesh.indices.begin(), mesh.indices.end(), [&](const uint32_t index) { return index >= num_vertices; })) {
+            return report;
+        }
+
+        report.before = analyze_vertex_cache(mesh.indices.data(), mesh.indices.size(), num_vertices);
+
+        // Only whole triangles of indices that don't belong to more than one LOD can be reordered
+        std::vector<MeshLod> ranges = mesh.lods;
+        if(ranges.empty()) {
+            ranges.push_back({0, static_cast<uint32_t>(mesh.indices.size() / 3 * 3), 0});
+        }
+
+        std::sort(ranges.begin(), ranges.end(), [](const MeshLod& first, const MeshLod& second) {
+            return first.first_index < second.first_index;
+        });
+
+        // The LODs come from whoever made the mesh, so they might not be inside its indices
+        bool can_reorder_triangles = std::all_of(ranges.begin(), ranges.end(), [&](const MeshLod& range) {
+            return range.num_indices % 3 == 0 && uint64_t{range.first_index} + range.num_indices <= mesh.indices.size();
+        });
+        for(size_t i = 1; i < ranges.size(); i++) {
+            if(ranges[i - 1].first_index + ranges[i - 1].num_indices > ranges[i].first_index) {
+                can_reorder_triangles = false;
+            }
+        }
+
+        if(can_reorder_triangles) {
+            for(const MeshLod& range : ranges) {
+                uint32_t* range_indices = mesh.indices.data() + range.first_index;
+
+                if(options.optimize_vertex_cache) {
+                    optimize_vertex_cache(range_indices, range.num_indices, num_vertices);
+                }
+
+                if(options.optimize_overdraw) {
+                    optimize_overdraw(range_indices, range.num_indices, mesh.vertex_data.data(), num_vertices, options.overdraw_threshold);
+                }
+            }
+        }
+
+        if(options.optimize_vertex_fetch) {
+            optimize_vertex_fetch(mesh.vertex_data, mesh.indices.data(), mesh.indices.size());
+        }
+
+        report.after = analyze_vertex_cache(mesh.indices.data(), mesh.indices.size(), num_vertices);
+
+        return report;
+    }
+} // namespace nova::renderer
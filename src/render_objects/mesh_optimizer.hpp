@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nova_renderer/nova_settings.hpp"
+#include "nova_renderer/renderables.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief The size of the FIFO vertex cache that meshes are analyzed with. Most GPUs reuse about this many vertices
+     */
+    constexpr uint32_t ANALYSIS_VERTEX_CACHE_SIZE = 16;
+
+    /*!
+     * \brief How well a list of triangles reuses transformed vertices
+     */
+    struct VertexCacheStats {
+        /*!
+         * \brief Average cache miss ratio: how many vertices are transformed per triangle. 3 is the worst, 0.5 is about the best a
+         * regular grid can do
+         */
+        float acmr = 0;
+
+        /*!
+         * \brief Average transformed vertex ratio: how many times each vertex is transformed. 1 is the best
+         */
+        float atvr = 0;
+
+        uint32_t num_transformed_vertices = 0;
+    };
+
+    /*!
+     * \brief How well a mesh used the vertex cache before and after it was optimized
+     */
+    struct MeshOptimizationReport {
+        VertexCacheStats before;
+        VertexCacheStats after;
+    };
+
+    /*!
+     * \brief Simulates drawing triangles through a FIFO vertex cache, and counts how many vertices miss the cache
+     *
+     * \param indices The triangle list to analyze
+     * \param num_indices How many indices there are. Indices after the last full triangle are ignored
+     * \param num_vertices How many vertices the indices index into
+     * \param cache_size How many vertices the simulated cache holds
+     */
+    [[nodiscard]] VertexCacheStats analyze_vertex_cache(const uint32_t* indices,
+                                                        size_t num_indices,
+                                                        uint32_t num_vertices,
+                                                        uint32_t cache_size = ANALYSIS_VERTEX_CACHE_SIZE);
+
+    /*!
+     * \brief Reorders a triangle list's triangles so that triangles which share vertices are drawn close together
+     *
+     * This is Tom Forsyth's linear-speed vertex cache optimization. It doesn't rely on the size of the GPU's cache, so it works about as
+     * well on every GPU
+     */
+    void optimize_vertex_cache(uint32_t* indices, size_t num_indices, uint32_t num_vertices);
+
+    /*!
+     * \brief Reorders clusters of triangles so that triangles that face away from the mesh's center are drawn first
+     *
+     * Those triangles are the most likely to be in front of the rest of the mesh, so drawing them first lets early-Z reject more of the
+     * mesh. The triangles should have been reordered with `optimize_vertex_cache` first, since this keeps the order of triangles inside
+     * each cluster
+     *
+     * \param threshold How much worse the vertex cache ACMR may get, as a multiple of the ACMR before this method. Higher thresholds
+     * give smaller clusters, which can be sorted better
+     */
+    void optimize_overdraw(uint32_t* indices, size_t num_indices, const FullVertex* vertices, uint32_t num_vertices, float threshold);
+
+    /*!
+     * \brief Reorders a mesh's vertices into the order that its indices first use them, so that drawing reads vertex memory in order
+     *
+     * Vertices that no index uses are moved to the end. The mesh's vertex count doesn't change
+     */
+    void optimize_vertex_fetch(std::vector<FullVertex>& vertices, uint32_t* indices, size_t num_indices);
+
+    /*!
+     * \brief Runs the optimizations that the options enable over a mesh's triangles
+     *
+     * Each LOD's triangles are reordered on their own, so the mesh's LODs still draw the same triangles afterwards. If the mesh's LODs
+     * share indices, its triangles can't be reordered without changing what the other LODs draw, so only the vertices are reordered. The
+     * same goes for LODs that aren't whole triangles inside the mesh's indices. A mesh with indices past the end of its vertices isn't
+     * changed at all, and gets an empty report
+     *
+     * The mesh is analyzed as a whole before and after, so that the report can be compared with other meshes
+     */
+    MeshOptimizationReport optimize_mesh(MeshData& mesh, const NovaSettings::MeshOptimizationOptions& options);
+} // namespace nova::renderer
@@ -0,0 +1,317 @@
+#include "mesh_upload_manager.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+#pragma warning(push, 0)
+#include <minitrace.h>
+#pragma warning(pop)
+
+#include "nova_renderer/command_list.hpp"
+
+#include "../util/logger.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Alignment of every allocation in the staging ring. Large enough for any copy offset alignment requirement we know of
+     */
+    constexpr uint64_t STAGING_ALIGNMENT = 16;
+
+    uint64_t align_to_staging(const uint64_t size) { return (size + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT; }
+
+    MeshUploadManager::MeshUploadManager(rhi::RenderEngine& rhi, DeviceMemoryResource& staging_memory, const uint64_t staging_buffer_size)
+        : rhi(rhi), ring_size(staging_buffer_size) {
+        rhi::BufferCreateInfo staging_buffer_create_info = {};
+        staging_buffer_create_info.buffer_usage = rhi::BufferUsage::StagingBuffer;
+        staging_buffer_create_info.size = staging_buffer_size;
+
+        staging_buffer = rhi.create_buffer(staging_buffer_create_info, staging_memory);
+
+        upload_semaphores = rhi.create_semaphores(NUM_IN_FLIGHT_FRAMES);
+    }
+
+    MeshUploadManager::~MeshUploadManager() { rhi.destroy_semaphores(upload_semaphores); }
+
+    bool MeshUploadManager::enqueue_upload(const MeshId mesh,
+                                           rhi::Buffer* dst_buffer,
+                                           const uint64_t dst_offset,
+                                           const void* data,
+                                           const uint64_t size,
+                                           const rhi::AccessFlags access_after_upload) {
+        if(size == 0) {
+            return true;
+        }
+
+        if(!can_upload(size)) {
+            NOVA_LOG(ERROR) << "Can't upload " << size << " bytes for mesh " << mesh << ", the staging ring is only " << ring_size
+                            << " bytes";
+            return false;
+        }
+
+        Upload upload = {mesh, dst_buffer, dst_offset, size, access_after_upload};
+
+        // Don't let this upload jump ahead of any that are still waiting for space
+        if(unstaged_uploads.empty() && allocate_staging_space(size, upload.src_offset)) {
+            rhi.write_data_to_buffer(data, size, upload.src_offset, staging_buffer);
+
+        } else {
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            upload.unstaged_data.assign(bytes, bytes + size);
+        }
+
+        enqueue(std::move(upload));
+
+        return true;
+    }
+
+    void MeshUploadManager::enqueue_copy(const MeshId mesh,
+                                         rhi::Buffer* src_buffer,
+                                         const uint64_t src_offset,
+                                         rhi::Buffer* dst_buffer,
+                                         const uint64_t dst_offset,
+                                         const uint64_t size,
+                                         const rhi::AccessFlags access_after_copy) {
+        if(size == 0) {
+            return;
+        }
+
+        Upload copy = {mesh, dst_buffer, dst_offset, size, access_after_copy, src_buffer, src_offset};
+
+        pending_copy_counts[mesh]++;
+
+        enqueue(std::move(copy));
+    }
+
+    void MeshUploadManager::begin_frame(const uint32_t frame_idx) {
+        // Frames can finish out of order if the swapchain hands us images out of order, so never move the tail backwards
+        ring_tail = std::max(ring_tail, frame_ring_heads.at(frame_idx));
+    }
+
+    MeshUploadManager::FlushResult MeshUploadManager::flush(const uint32_t frame_idx) {
+        MTR_SCOPE("MeshUploadManager", "flush");
+
+        stage_pending_uploads();
+
+        FlushResult result;
+        frame_ring_heads.at(frame_idx) = ring_head;
+
+        if(staged_uploads.empty()) {
+            return result;
+        }
+
+        rhi::CommandList* upload_cmds = nullptr;
+
+        std::vector<rhi::ResourceBarrier> release_barriers;
+        release_barriers.reserve(staged_uploads.size());
+        result.acquire_barriers.reserve(staged_uploads.size());
+        result.uploaded_meshes.reserve(staged_uploads.size());
+
+        // Different meshes never share memory, but two uploads to the same mesh might overlap and have to be ordered
+        std::unordered_set<MeshId> uploaded_meshes;
+
+        for(const Upload& upload : staged_uploads) {
+            if(--pending_operation_counts.at(upload.mesh) == 0) {
+                pending_operation_counts.erase(upload.mesh);
+                result.uploaded_meshes.push_back(upload.mesh);
+            }
+
+            if(upload.src_buffer != nullptr) {
+                if(--pending_copy_counts.at(upload.mesh) == 0) {
+                    pending_copy_counts.erase(upload.mesh);
+                }
+
+                result.gpu_copies.push_back(
+                    {upload.src_buffer, upload.src_offset, upload.dst_buffer, upload.dst_offset, upload.size, upload.access_after_upload});
+                continue;
+            }
+
+            if(upload_cmds == nullptr) {
+                upload_cmds = rhi.get_command_list(0, rhi::QueueType::Transfer);
+            }
+
+            if(!uploaded_meshes.insert(upload.mesh).second) {
+                rhi::ResourceBarrier write_after_write_barrier = {};
+                write_after_write_barrier.resource_to_barrier = upload.dst_buffer;
+                write_after_write_barrier.old_state = rhi::ResourceState::CopyDestination;
+                write_after_write_barrier.new_state = rhi::ResourceState::CopyDestination;
+                write_after_write_barrier.access_before_barrier = rhi::AccessFlags::CopyWrite;
+                write_after_write_barrier.access_after_barrier = rhi::AccessFlags::CopyWrite;
+                write_after_write_barrier.source_queue = rhi::QueueType::Transfer;
+                write_after_write_barrier.destination_queue = rhi::QueueType::Transfer;
+                write_after_write_barrier.buffer_memory_barrier.offset = upload.dst_offset;
+                write_after_write_barrier.buffer_memory_barrier.size = upload.size;
+
+                upload_cmds->resource_barriers(rhi::PipelineStageFlags::Transfer,
+                                               rhi::PipelineStageFlags::Transfer,
+                                               {write_after_write_barrier});
+            }
+
+            upload_cmds->copy_buffer(upload.dst_buffer, upload.dst_offset, staging_buffer, upload.src_offset, upload.size);
+
+            rhi::ResourceBarrier barrier = {};
+            barrier.resource_to_barrier = upload.dst_buffer;
+            barrier.old_state = rhi::ResourceState::CopyDestination;
+            barrier.new_state = rhi::ResourceState::Common;
+            barrier.access_before_barrier = rhi::AccessFlags::CopyWrite;
+            barrier.access_after_barrier = upload.access_after_upload;
+            barrier.source_queue = rhi::QueueType::Transfer;
+            barrier.destination_queue = rhi::QueueType::Graphics;
+            barrier.buffer_memory_barrier.offset = upload.dst_offset;
+            barrier.buffer_memory_barrier.size = upload.size;
+
+            // The same barrier releases the range from the transfer queue and acquires it on the graphics queue
+            release_barriers.push_back(barrier);
+            result.acquire_barriers.push_back(barrier);
+        }
+
+        if(upload_cmds != nullptr) {
+            upload_cmds->resource_barriers(rhi::PipelineStageFlags::Transfer, rhi::PipelineStageFlags::BottomOfPipe, release_barriers);
+
+            rhi::Semaphore* upload_done_semaphore = upload_semaphores.at(frame_idx);
+            rhi.submit_command_list(upload_cmds, rhi::QueueType::Transfer, nullptr, {}, {upload_done_semaphore});
+
+            result.upload_done_semaphore = upload_done_semaphore;
+        }
+
+        NOVA_LOG(TRACE) << "Submitted " << release_barriers.size() << " mesh uploads and " << result.gpu_copies.size()
+                        << " mesh copies for frame " << frame_idx;
+
+        staged_uploads.clear();
+
+        return result;
+    }
+
+    void MeshUploadManager::record_graphics_commands(const FlushResult& flush_result, rhi::CommandList* cmds) {
+        if(flush_result.gpu_copies.empty()) {
+            if(!flush_result.acquire_barriers.empty()) {
+                cmds->resource_barriers(rhi::PipelineStageFlags::Transfer,
+                                        rhi::PipelineStageFlags::VertexInput,
+                                        flush_result.acquire_barriers);
+            }
+
+            return;
+        }
+
+        // The copies may read from ranges that were just uploaded, so everything after the acquire has to wait for it
+        if(!flush_result.acquire_barriers.empty()) {
+            cmds->resource_barriers(rhi::PipelineStageFlags::Transfer, rhi::PipelineStageFlags::AllCommands, flush_result.acquire_barriers);
+        }
+
+        std::vector<rhi::ResourceBarrier> copy_done_barriers;
+        copy_done_barriers.reserve(flush_result.gpu_copies.size());
+
+        for(const BufferCopy& copy : flush_result.gpu_copies) {
+            // The source may have been written by an earlier copy
+            rhi::ResourceBarrier read_after_write_barrier = {};
+            read_after_write_barrier.resource_to_barrier = copy.src_buffer;
+            read_after_write_barrier.old_state = rhi::ResourceState::Common;
+            read_after_write_barrier.new_state = rhi::ResourceState::CopySource;
+            read_after_write_barrier.access_before_barrier = rhi::AccessFlags::CopyWrite;
+            read_after_write_barrier.access_after_barrier = rhi::AccessFlags::CopyRead;
+            read_after_write_barrier.source_queue = rhi::QueueType::Graphics;
+            read_after_write_barrier.destination_queue = rhi::QueueType::Graphics;
+            read_after_write_barrier.buffer_memory_barrier.offset = copy.src_offset;
+            read_after_write_barrier.buffer_memory_barrier.size = copy.size;
+
+            cmds->resource_barriers(rhi::PipelineStageFlags::Transfer, rhi::PipelineStageFlags::Transfer, {read_after_write_barrier});
+
+            cmds->copy_buffer(copy.dst_buffer, copy.dst_offset, copy.src_buffer, copy.src_offset, copy.size);
+
+            rhi::ResourceBarrier copy_done_barrier = {};
+            copy_done_barrier.resource_to_barrier = copy.dst_buffer;
+            copy_done_barrier.old_state = rhi::ResourceState::CopyDestination;
+            copy_done_barrier.new_state = rhi::ResourceState::Common;
+            copy_done_barrier.access_before_barrier = rhi::AccessFlags::CopyWrite;
+            copy_done_barrier.access_after_barrier = copy.access_after_copy;
+            copy_done_barrier.source_queue = rhi::QueueType::Graphics;
+            copy_done_barrier.destination_queue = rhi::QueueType::Graphics;
+            copy_done_barrier.buffer_memory_barrier.offset = copy.dst_offset;
+            copy_done_barrier.buffer_memory_barrier.size = copy.size;
+
+            copy_done_barriers.push_back(copy_done_barrier);
+        }
+
+        cmds->resource_barriers(rhi::PipelineStageFlags::Transfer, rhi::PipelineStageFlags::VertexInput, copy_done_barriers);
+    }
+
+    bool MeshUploadManager::has_pending_uploads() const { return !staged_uploads.empty() || !unstaged_uploads.empty(); }
+
+    void MeshUploadManager::cancel_operations(const MeshId mesh) {
+        const auto is_for_mesh = [&](const Upload& upload) { return upload.mesh == mesh; };
+
+        // Any staging space the uploads used is reclaimed along with the rest of the frame's, so there's nothing else to clean up
+        staged_uploads.erase(std::remove_if(staged_uploads.begin(), staged_uploads.end(), is_for_mesh), staged_uploads.end());
+        unstaged_uploads.erase(std::remove_if(unstaged_uploads.begin(), unstaged_uploads.end(), is_for_mesh), unstaged_uploads.end());
+
+        pending_operation_counts.erase(mesh);
+        pending_copy_counts.erase(mesh);
+    }
+
+    bool MeshUploadManager::can_upload(const uint64_t size) const { return align_to_staging(size) <= ring_size; }
+
+    bool MeshUploadManager::has_pending_operations(const MeshId mesh) const {
+        return pending_operation_counts.find(mesh) != pending_operation_counts.end();
+    }
+
+    bool MeshUploadManager::has_pending_copies(const MeshId mesh) const {
+        return pending_copy_counts.find(mesh) != pending_copy_counts.end();
+    }
+
+    void MeshUploadManager::enqueue(Upload&& upload) {
+        pending_operation_counts[upload.mesh]++;
+
+        if(unstaged_uploads.empty() && (upload.src_buffer != nullptr || upload.unstaged_data.empty())) {
+            staged_uploads.push_back(std::move(upload));
+
+        } else {
+            unstaged_uploads.push_back(std::move(upload));
+        }
+    }
+
+    bool MeshUploadManager::allocate_staging_space(const uint64_t size, uint64_t& offset) {
+        const uint64_t aligned_size = align_to_staging(size);
+        if(aligned_size > ring_size) {
+            return false;
+        }
+
+        if(ring_head == ring_tail) {
+            // Nothing is using the ring, so we can start from the beginning and give this allocation as much room as possible
+            ring_head = (ring_head + ring_size - 1) / ring_size * ring_size;
+            ring_tail = ring_head;
+        }
+
+        // Copies read from a single contiguous region, so an allocation that would run off the end of the ring starts back at the
+        // beginning instead. The bytes we skip over are reclaimed along with the rest of the frame's allocations
+        const uint64_t write_position = ring_head % ring_size;
+        const uint64_t padding = write_position + aligned_size > ring_size ? ring_size - write_position : 0;
+
+        if(ring_head + padding + aligned_size - ring_tail > ring_size) {
+            return false;
+        }
+
+        ring_head += padding;
+        offset = ring_head % ring_size;
+        ring_head += aligned_size;
+
+        return true;
+    }
+
+    void MeshUploadManager::stage_pending_uploads() {
+        while(!unstaged_uploads.empty()) {
+            Upload& upload = unstaged_uploads.front();
+
+            // GPU copies don't need any staging memory, they only wait in line so they happen after the uploads before them
+            if(upload.src_buffer == nullptr) {
+                if(!allocate_staging_space(upload.size, upload.src_offset)) {
+                    break;
+                }
+
+                rhi.write_data_to_buffer(upload.unstaged_data.data(), upload.size, upload.src_offset, staging_buffer);
+                upload.unstaged_data = {};
+            }
+
+            staged_uploads.push_back(std::move(upload));
+            unstaged_uploads.pop_front();
+        }
+    }
+} // namespace nova::renderer
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "nova_renderer/nova_renderer.hpp"
+
+#include "../render_engine/configuration.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Uploads mesh data to the GPU asynchronously, through a ring buffer of staging memory
+     *
+     * Data is written into the staging ring as soon as it's enqueued. Once per frame, every pending upload is recorded into a single
+     * transfer command list, which signals a semaphore that the frame's graphics work waits on. The uploaded ranges are released from the
+     * transfer queue and acquired by the graphics queue, so anything flushed in a frame may be drawn by that same frame
+     *
+     * The staging memory that a frame used is reclaimed the next time that frame index begins, since by then the frame's fence has
+     * signaled. Uploads that don't fit in the ring wait in system memory until enough of the ring has been reclaimed
+     *
+     * Copies between GPU buffers, such as when a mesh moves to a larger range, go through the same queue so they happen in order with the
+     * uploads. They're recorded on the graphics queue since that queue owns the mesh data once it's been uploaded
+     *
+     * This class is not thread-safe. All uploads must be enqueued from the thread that executes frames
+     */
+    class MeshUploadManager {
+    public:
+        /*!
+         * \brief A copy from one GPU buffer to another
+         */
+        struct BufferCopy {
+            rhi::Buffer* src_buffer;
+            uint64_t src_offset;
+
+            rhi::Buffer* dst_buffer;
+            uint64_t dst_offset;
+
+            uint64_t size;
+
+            rhi::AccessFlags access_after_copy;
+        };
+
+        /*!
+         * \brief Everything the graphics queue needs to know about the uploads submitted by `flush`
+         */
+        struct FlushResult {
+            /*!
+             * \brief Semaphore that's signaled when the uploads have finished, or nullptr if there was nothing to upload
+             */
+            rhi::Semaphore* upload_done_semaphore = nullptr;
+
+            /*!
+             * \brief Barriers that acquire the uploaded ranges for the graphics queue. Record these before drawing anything
+             */
+            std::vector<rhi::ResourceBarrier> acquire_barriers;
+
+            /*!
+             * \brief Copies between GPU buffers, which the graphics queue must execute after acquiring the uploaded ranges
+             */
+            std::vector<BufferCopy> gpu_copies;
+
+            /*!
+             * \brief The meshes that have no more pending uploads or copies once this frame's work has executed
+             */
+            std::vector<MeshId> uploaded_meshes;
+        };
+
+        /*!
+         * \brief Creates a staging ring of the given size
+         *
+         * \param rhi The render engine to record and submit uploads with
+         * \param staging_memory The host-visible memory to create the staging ring in. It must have at least `staging_buffer_size` bytes
+         * free
+         * \param staging_buffer_size The size of the staging ring, in bytes
+         */
+        MeshUploadManager(rhi::RenderEngine& rhi, DeviceMemoryResource& staging_memory, uint64_t staging_buffer_size);
+
+        MeshUploadManager(MeshUploadManager&& old) noexcept = delete;
+        MeshUploadManager& operator=(MeshUploadManager&& old) noexcept = delete;
+
+        MeshUploadManager(const MeshUploadManager& other) = delete;
+        MeshUploadManager& operator=(const MeshUploadManager& other) = delete;
+
+        ~MeshUploadManager();
+
+        /*!
+         * \brief Queues a copy of `size` bytes of `data` to `dst_offset` in `dst_buffer`
+         *
+         * The data is copied out of `data` before this method returns, so the caller may free it immediately
+         *
+         * \param mesh The mesh that the data belongs to. `flush` reports this mesh once the upload has been submitted
+         * \param dst_buffer The buffer to upload the data to
+         * \param dst_offset The offset in `dst_buffer` to upload to
+         * \param data The data to upload
+         * \param size The number of bytes to upload
+         * \param access_after_upload How the graphics queue will read from the uploaded data
+         *
+         * \return True if the upload was queued, false if it can never fit in the staging ring
+         */
+        [[nodiscard]] bool enqueue_upload(MeshId mesh,
+                                          rhi::Buffer* dst_buffer,
+                                          uint64_t dst_offset,
+                                          const void* data,
+                                          uint64_t size,
+                                          rhi::AccessFlags access_after_upload);
+
+        /*!
+         * \brief Queues a copy of `size` bytes from one GPU buffer to another
+         *
+         * The copy happens after every upload and copy that was enqueued before it, so the source may be a range that's still being
+         * uploaded. The source range must not be written to or freed until the frame that flushes this copy has finished
+         *
+         * \param mesh The mesh that the data belongs to
+         * \param src_buffer The buffer to copy from
+         * \param src_offset The offset in `src_buffer` to copy from
+         * \param dst_buffer The buffer to copy to
+         * \param dst_offset The offset in `dst_buffer` to copy to
+         * \param size The number of bytes to copy
+         * \param access_after_copy How the graphics queue will read from the copied data
+         */
+        void enqueue_copy(MeshId mesh,
+                          rhi::Buffer* src_buffer,
+                          uint64_t src_offset,
+                          rhi::Buffer* dst_buffer,
+                          uint64_t dst_offset,
+                          uint64_t size,
+                          rhi::AccessFlags access_after_copy);
+
+        /*!
+         * \brief Reclaims the staging memory that was used by the last frame with this index
+         *
+         * Must only be called after the GPU has finished executing the last frame with this index
+         */
+        void begin_frame(uint32_t frame_idx);
+
+        /*!
+         * \brief Records every pending upload into a single transfer command list and submits it
+         *
+         * The graphics submission for this frame must wait on the returned semaphore, and must pass the result to
+         * `record_graphics_commands`
+         */
+        [[nodiscard]] FlushResult flush(uint32_t frame_idx);
+
+        /*!
+         * \brief Records the graphics queue's half of the work from `flush`: acquiring the uploaded ranges, then the GPU copies
+         *
+         * This should be the first thing recorded in the frame's graphics command list
+         */
+        static void record_graphics_commands(const FlushResult& flush_result, rhi::CommandList* cmds);
+
+        /*!
+         * \brief Checks if there's any uploads that haven't been submitted yet
+         */
+        [[nodiscard]] bool has_pending_uploads() const;
+
+        /*!
+         * \brief Drops every upload and copy for the mesh that hasn't been flushed yet
+         *
+         * Use this when the mesh's memory is about to be freed, so that later flushes don't write to memory the mesh no longer owns
+         */
+        void cancel_operations(MeshId mesh);
+
+        /*!
+         * \brief Checks if an upload of this many bytes could ever fit in the staging ring
+         */
+        [[nodiscard]] bool can_upload(uint64_t size) const;
+
+        /*!
+         * \brief Checks if the mesh has any uploads or copies that haven't been flushed yet
+         */
+        [[nodiscard]] bool has_pending_operations(MeshId mesh) const;
+
+        /*!
+         * \brief Checks if the mesh has a GPU copy that hasn't been flushed yet
+         *
+         * Writing to the destination of a pending copy would race with the copy, so don't
+         */
+        [[nodiscard]] bool has_pending_copies(MeshId mesh) const;
+
+    private:
+        struct Upload {
+            MeshId mesh;
+
+            rhi::Buffer* dst_buffer;
+            uint64_t dst_offset;
+            uint64_t size;
+
+            rhi::AccessFlags access_after_upload;
+
+            /*!
+             * \brief The buffer to copy from, or nullptr if the data comes from the staging ring
+             */
+            rhi::Buffer* src_buffer = nullptr;
+
+            /*!
+             * \brief The offset to copy from in `src_buffer`, or where the upload's data lives in the staging ring once it's been staged
+             */
+            uint64_t src_offset = 0;
+
+            /*!
+             * \brief The upload's data, if it didn't fit in the staging ring when it was enqueued
+             */
+            std::vector<uint8_t> unstaged_data;
+        };
+
+        rhi::RenderEngine& rhi;
+
+        rhi::Buffer* staging_buffer;
+        uint64_t ring_size;
+
+        /*!
+         * \brief Total number of bytes that have ever been allocated from the ring. `ring_head % ring_size` is the next write position
+         */
+        uint64_t ring_head = 0;
+
+        /*!
+         * \brief Total number of bytes that have ever been reclaimed from the ring
+         */
+        uint64_t ring_tail = 0;
+
+        /*!
+         * \brief The value of `ring_head` when each frame was flushed. Everything before it is free once that frame has finished
+         */
+        std::array<uint64_t, NUM_IN_FLIGHT_FRAMES> frame_ring_heads{};
+
+        std::vector<rhi::Semaphore*> upload_semaphores;
+
+        /*!
+         * \brief Uploads that are in the staging ring and ready to be recorded
+         */
+        std::vector<Upload> staged_uploads;
+
+        /*!
+         * \brief Uploads that are waiting for space in the staging ring, oldest first
+         *
+         * Uploads are staged strictly in order, so that later uploads to the same range always overwrite earlier ones
+         */
+        std::deque<Upload> unstaged_uploads;
+
+        /*!
+         * \brief How many uploads and copies each mesh has waiting to be flushed
+         */
+        std::unordered_map<MeshId, uint32_t> pending_operation_counts;
+
+        /*!
+         * \brief How many copies each mesh has waiting to be flushed
+         */
+        std::unordered_map<MeshId, uint32_t> pending_copy_counts;
+
+        void enqueue(Upload&& upload);
+
+        /*!
+         * \brief Allocates a contiguous region of the staging ring, returning false if the ring doesn't have enough free space
+         */
+        bool allocate_staging_space(uint64_t size, uint64_t& offset);
+
+        /*!
+         * \brief Moves as many unstaged uploads into the staging ring as will fit
+         */
+        void stage_pending_uploads();
+    };
+} // namespace nova::renderer
@@ -0,0 +1,74 @@
+#include "renderable_registry.hpp"
+
+namespace nova::renderer {
+    RenderableId make_renderable_id(const uint32_t slot_index, const uint32_t generation) {
+        return static_cast<RenderableId>(generation) << 32 | slot_index;
+    }
+
+    uint32_t get_slot_index(const RenderableId id) { return static_cast<uint32_t>(id & 0xFFFFFFFF); }
+
+    uint32_t get_generation(const RenderableId id) { return static_cast<uint32_t>(id >> 32); }
+
+    RenderableId RenderableRegistry::add(const RenderableLocation& location) {
+        uint32_t slot_index;
+        if(!free_slots.empty()) {
+            slot_index = free_slots.back();
+            free_slots.pop_back();
+
+        } else {
+            slot_index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+
+        Slot& slot = slots[slot_index];
+        slot.location = location;
+        slot.is_alive = true;
+        num_alive++;
+
+        return make_renderable_id(slot_index, slot.generation);
+    }
+
+    RenderableLocation* RenderableRegistry::find(const RenderableId id) {
+        const uint32_t slot_index = get_slot_index(id);
+        if(slot_index >= slots.size()) {
+            return nullptr;
+        }
+
+        Slot& slot = slots[slot_index];
+        if(!slot.is_alive || slot.generation != get_generation(id)) {
+            return nullptr;
+        }
+
+        return &slot.location;
+    }
+
+    bool RenderableRegistry::remove(const RenderableId id) {
+        if(find(id) == nullptr) {
+            return false;
+        }
+
+        const uint32_t slot_index = get_slot_index(id);
+        Slot& slot = slots[slot_index];
+        slot.is_alive = false;
+        slot.generation++;
+        free_slots.push_back(slot_index);
+        num_alive--;
+
+        return true;
+    }
+
+    void RenderableRegistry::clear() {
+        for(uint32_t slot_index = 0; slot_index < slots.size(); slot_index++) {
+            Slot& slot = slots[slot_index];
+            if(slot.is_alive) {
+                slot.is_alive = false;
+                slot.generation++;
+                free_slots.push_back(slot_index);
+            }
+        }
+
+        num_alive = 0;
+    }
+
+    uint32_t RenderableRegistry::size() const { return num_alive; }
+} // namespace nova::renderer
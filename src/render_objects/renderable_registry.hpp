@@ -0,0 +1,92 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "nova_renderer/nova_renderer.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Where a renderable's data lives in the render graph
+     */
+    struct RenderableLocation {
+        /*!
+         * \brief The material pass that the renderable is drawn with
+         */
+        MaterialPassKey material_pass;
+
+        /*!
+         * \brief Index of the renderable's mesh batch in the material pass's `static_mesh_draws`
+         */
+        uint32_t batch_index = 0;
+
+        /*!
+         * \brief Index of the renderable in its mesh batch's arrays
+         */
+        uint32_t index_in_batch = 0;
+    };
+
+    /*!
+     * \brief Maps renderable IDs to where their data lives
+     *
+     * This is a slot map: each ID holds the index of a slot and the generation of that slot when the ID was handed out. Removing a
+     * renderable bumps its slot's generation and puts the slot on a free list, so stale IDs are detected instead of silently referring to
+     * whichever renderable reused the slot. Adding, finding, and removing renderables are all O(1)
+     *
+     * The renderables' actual data lives in their mesh batches, packed tightly so that recording a frame is a linear walk over memory.
+     * Whatever moves a renderable within its batch must update the renderable's location here
+     */
+    class RenderableRegistry {
+    public:
+        /*!
+         * \brief An ID that no renderable will ever have
+         */
+        static constexpr RenderableId INVALID_ID = std::numeric_limits<RenderableId>::max();
+
+        /*!
+         * \brief Adds a renderable at the given location, returning its new ID
+         */
+        [[nodiscard]] RenderableId add(const RenderableLocation& location);
+
+        /*!
+         * \brief Finds the location of the renderable with the given ID
+         *
+         * \return A pointer to the renderable's location, which may be modified to move the renderable, or nullptr if there's no renderable
+         * with that ID. The pointer is invalidated by the next call to `add`
+         */
+        [[nodiscard]] RenderableLocation* find(RenderableId id);
+
+        /*!
+         * \brief Removes the renderable with the given ID, returning false if there was no such renderable
+         */
+        bool remove(RenderableId id);
+
+        /*!
+         * \brief Removes every renderable. IDs that were handed out before this call will never be valid again
+         */
+        void clear();
+
+        /*!
+         * \brief The number of renderables currently in the registry
+         */
+        [[nodiscard]] uint32_t size() const;
+
+    private:
+        struct Slot {
+            RenderableLocation location;
+
+            uint32_t generation = 0;
+
+            bool is_alive = false;
+        };
+
+        std::vector<Slot> slots;
+
+        /*!
+         * \brief Indices of the slots that aren't used by any renderable
+         */
+        std::vector<uint32_t> free_slots;
+
+        uint32_t num_alive = 0;
+    };
+} // namespace nova::renderer
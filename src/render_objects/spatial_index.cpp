@@ -0,0 +1,324 @@
+#include "spatial_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nova::renderer {
+    /*!
+     * \brief How a box relates to a frustum
+     */
+    enum class FrustumOverlap {
+        Outside,
+        Intersecting,
+        Inside,
+    };
+
+    FrustumOverlap get_frustum_overlap(const Frustum& frustum, const Aabb& aabb) {
+        FrustumOverlap overlap = FrustumOverlap::Inside;
+
+        for(const glm::vec4& plane : frustum.planes) {
+            // The corner furthest along the plane's normal, and the corner furthest against it. Same order of operations as
+            // `cull_aabbs`, so both agree on which boxes are visible
+            const float far_x = plane.x >= 0 ? aabb.max.x : aabb.min.x;
+            const float far_y = plane.y >= 0 ? aabb.max.y : aabb.min.y;
+            const float far_z = plane.z >= 0 ? aabb.max.z : aabb.min.z;
+            if(plane.x * far_x + (plane.y * far_y + (plane.z * far_z + plane.w)) < 0) {
+                return FrustumOverlap::Outside;
+            }
+
+            const float near_x = plane.x >= 0 ? aabb.min.x : aabb.max.x;
+            const float near_y = plane.y >= 0 ? aabb.min.y : aabb.max.y;
+            const float near_z = plane.z >= 0 ? aabb.min.z : aabb.max.z;
+            if(plane.x * near_x + (plane.y * near_y + (plane.z * near_z + plane.w)) < 0) {
+                overlap = FrustumOverlap::Intersecting;
+            }
+        }
+
+        return overlap;
+    }
+
+    bool intersects_sphere(const Aabb& aabb, const glm::vec3& center, const float radius) {
+        float distance_squared = 0;
+        for(int i = 0; i < 3; i++) {
+            const float closest = std::clamp(center[i], aabb.min[i], aabb.max[i]);
+            distance_squared += (center[i] - closest) * (center[i] - closest);
+        }
+
+        return distance_squared <= radius * radius;
+    }
+
+    /*!
+     * \brief Which of its parent's children a cell is, from the low bit of each of its coordinates
+     */
+    uint32_t get_child_slot(const int32_t x, const int32_t y, const int32_t z) {
+        return static_cast<uint32_t>(x & 1) | static_cast<uint32_t>(y & 1) << 1 | static_cast<uint32_t>(z & 1) << 2;
+    }
+
+    bool SpatialIndex::CellKey::operator==(const CellKey& other) const {
+        return x == other.x && y == other.y && z == other.z && level == other.level;
+    }
+
+    std::size_t SpatialIndex::CellKeyHasher::operator()(const CellKey& key) const {
+        std::size_t hash = std::hash<int32_t>()(key.x);
+        hash = hash * 31 + std::hash<int32_t>()(key.y);
+        hash = hash * 31 + std::hash<int32_t>()(key.z);
+        hash = hash * 31 + std::hash<uint32_t>()(key.level);
+        return hash;
+    }
+
+    SpatialIndex::SpatialIndex(const float leaf_size, const uint32_t num_levels) : leaf_size(leaf_size), num_levels(num_levels) {}
+
+    void SpatialIndex::insert(const RenderableId id, const Aabb& bounds) {
+        CellKey key;
+        if(!get_cell_key(bounds, key)) {
+            entry_locations[id] = {NO_CELL, static_cast<uint32_t>(oversized_entries.size())};
+            oversized_entries.push_back({id, bounds});
+            return;
+        }
+
+        const uint32_t cell_index = get_or_create_cell(key);
+        Cell& cell = cells[cell_index];
+        entry_locations[id] = {cell_index, static_cast<uint32_t>(cell.entries.size())};
+        cell.entries.push_back({id, bounds});
+    }
+
+    void SpatialIndex::update(const RenderableId id, const Aabb& bounds) {
+        const auto location_itr = entry_locations.find(id);
+        if(location_itr == entry_locations.end()) {
+            return;
+        }
+
+        // Most updates are small moves that leave the box in the same cell
+        const EntryLocation& location = location_itr->second;
+        CellKey key;
+        const bool fits_in_a_cell = get_cell_key(bounds, key);
+        if(location.cell == NO_CELL && !fits_in_a_cell) {
+            oversized_entries[location.index_in_cell].bounds = bounds;
+            return;
+        }
+
+        if(location.cell != NO_CELL && fits_in_a_cell && cells[location.cell].key == key) {
+            cells[location.cell].entries[location.index_in_cell].bounds = bounds;
+            return;
+        }
+
+        remove(id);
+        insert(id, bounds);
+    }
+
+    bool SpatialIndex::remove(const RenderableId id) {
+        const auto location_itr = entry_locations.find(id);
+        if(location_itr == entry_locations.end()) {
+            return false;
+        }
+
+        const EntryLocation location = location_itr->second;
+        entry_locations.erase(location_itr);
+        remove_entry(location);
+
+        if(location.cell != NO_CELL) {
+            free_cell_if_empty(location.cell);
+        }
+
+        return true;
+    }
+
+    void SpatialIndex::clear() {
+        cells.clear();
+        free_cells.clear();
+        cell_indices.clear();
+        top_level_cells.clear();
+        oversized_entries.clear();
+        entry_locations.clear();
+    }
+
+    void SpatialIndex::query_frustum(const Frustum& frustum, std::vector<RenderableId>& ids) const {
+        for(const uint32_t cell_index : top_level_cells) {
+            query_frustum(cell_index, frustum, false, ids);
+        }
+
+        for(const Entry& entry : oversized_entries) {
+            if(get_frustum_overlap(frustum, entry.bounds) != FrustumOverlap::Outside) {
+                ids.push_back(entry.id);
+            }
+        }
+    }
+
+    void SpatialIndex::query_sphere(const glm::vec3& center, const float radius, std::vector<RenderableId>& ids) const {
+        for(const uint32_t cell_index : top_level_cells) {
+            query_sphere(cell_index, center, radius, ids);
+        }
+
+        for(const Entry& entry : oversized_entries) {
+            if(intersects_sphere(entry.bounds, center, radius)) {
+                ids.push_back(entry.id);
+            }
+        }
+    }
+
+    uint32_t SpatialIndex::size() const { return static_cast<uint32_t>(entry_locations.size()); }
+
+    uint32_t SpatialIndex::get_num_cells() const { return static_cast<uint32_t>(cell_indices.size()); }
+
+    bool SpatialIndex::get_cell_key(const Aabb& bounds, CellKey& key) const {
+        const float extent = std::max({bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y, bounds.max.z - bounds.min.z});
+
+        uint32_t level = 0;
+        while(get_cell_size(level) < extent) {
+            level++;
+            if(level == num_levels) {
+                return false;
+            }
+        }
+
+        const float cell_size = get_cell_size(level);
+        key.x = static_cast<int32_t>(std::floor((bounds.min.x + bounds.max.x) * 0.5F / cell_size));
+        key.y = static_cast<int32_t>(std::floor((bounds.min.y + bounds.max.y) * 0.5F / cell_size));
+        key.z = static_cast<int32_t>(std::floor((bounds.min.z + bounds.max.z) * 0.5F / cell_size));
+        key.level = level;
+
+        return true;
+    }
+
+    float SpatialIndex::get_cell_size(const uint32_t level) const { return std::ldexp(leaf_size, static_cast<int>(level)); }
+
+    uint32_t SpatialIndex::get_or_create_cell(const CellKey& key) {
+        if(const auto cell_itr = cell_indices.find(key); cell_itr != cell_indices.end()) {
+            return cell_itr->second;
+        }
+
+        // Create the parent first, since creating cells may reallocate `cells`
+        uint32_t parent_index = NO_CELL;
+        if(key.level + 1 < num_levels) {
+            // Arithmetic shifts round towards negative infinity, which is what we want for negative coordinates
+            parent_index = get_or_create_cell({key.x >> 1, key.y >> 1, key.z >> 1, key.level + 1});
+        }
+
+        uint32_t cell_index;
+        if(!free_cells.empty()) {
+            cell_index = free_cells.back();
+            free_cells.pop_back();
+
+        } else {
+            cell_index = static_cast<uint32_t>(cells.size());
+            cells.emplace_back();
+        }
+
+        Cell& cell = cells[cell_index];
+        cell.key = key;
+        cell.parent = parent_index;
+        cell.children.fill(NO_CELL);
+        cell.num_children = 0;
+        cell.entries.clear();
+
+        const float cell_size = get_cell_size(key.level);
+        const float looseness = cell_size * 0.5F;
+        cell.loose_bounds = {glm::vec3(static_cast<float>(key.x) * cell_size - looseness,
+                                       static_cast<float>(key.y) * cell_size - looseness,
+                                       static_cast<float>(key.z) * cell_size - looseness),
+                             glm::vec3(static_cast<float>(key.x + 1) * cell_size + looseness,
+                                       static_cast<float>(key.y + 1) * cell_size + looseness,
+                                       static_cast<float>(key.z + 1) * cell_size + looseness)};
+
+        if(parent_index != NO_CELL) {
+            Cell& parent = cells[parent_index];
+            parent.children[get_child_slot(key.x, key.y, key.z)] = cell_index;
+            parent.num_children++;
+
+        } else {
+            top_level_cells.push_back(cell_index);
+        }
+
+        cell_indices.emplace(key, cell_index);
+
+        return cell_index;
+    }
+
+    void SpatialIndex::free_cell_if_empty(uint32_t cell_index) {
+        while(cell_index != NO_CELL) {
+            Cell& cell = cells[cell_index];
+            if(!cell.entries.empty() || cell.num_children > 0) {
+                return;
+            }
+
+            if(cell.parent != NO_CELL) {
+                Cell& parent = cells[cell.parent];
+                parent.children[get_child_slot(cell.key.x, cell.key.y, cell.key.z)] = NO_CELL;
+                parent.num_children--;
+
+            } else {
+                const auto top_level_itr = std::find(top_level_cells.begin(), top_level_cells.end(), cell_index);
+                *top_level_itr = top_level_cells.back();
+                top_level_cells.pop_back();
+            }
+
+            cell_indices.erase(cell.key);
+            free_cells.push_back(cell_index);
+
+            cell_index = cell.parent;
+        }
+    }
+
+    void SpatialIndex::remove_entry(const EntryLocation& location) {
+        std::vector<Entry>& entries = location.cell == NO_CELL ? oversized_entries : cells[location.cell].entries;
+
+        const auto last_index = static_cast<uint32_t>(entries.size() - 1);
+        if(location.index_in_cell != last_index) {
+            entries[location.index_in_cell] = entries[last_index];
+            entry_locations[entries[location.index_in_cell].id].index_in_cell = location.index_in_cell;
+        }
+
+        entries.pop_back();
+    }
+
+    void SpatialIndex::query_frustum(const uint32_t cell_index,
+                                     const Frustum& frustum,
+                                     bool is_inside,
+                                     std::vector<RenderableId>& ids) const {
+        const Cell& cell = cells[cell_index];
+
+        // Everything in a cell that's inside the frustum is also inside the frustum, so there's no need to test it
+        if(!is_inside) {
+            const FrustumOverlap overlap = get_frustum_overlap(frustum, cell.loose_bounds);
+            if(overlap == FrustumOverlap::Outside) {
+                return;
+            }
+
+            is_inside = overlap == FrustumOverlap::Inside;
+        }
+
+        for(const Entry& entry : cell.entries) {
+            if(is_inside || get_frustum_overlap(frustum, entry.bounds) != FrustumOverlap::Outside) {
+                ids.push_back(entry.id);
+            }
+        }
+
+        for(const uint32_t child_index : cell.children) {
+            if(child_index != NO_CELL) {
+                query_frustum(child_index, frustum, is_inside, ids);
+            }
+        }
+    }
+
+    void SpatialIndex::query_sphere(const uint32_t cell_index,
+                                    const glm::vec3& center,
+                                    const float radius,
+                                    std::vector<RenderableId>& ids) const {
+        const Cell& cell = cells[cell_index];
+        if(!intersects_sphere(cell.loose_bounds, center, radius)) {
+            return;
+        }
+
+        for(const Entry& entry : cell.entries) {
+            if(intersects_sphere(entry.bounds, center, radius)) {
+                ids.push_back(entry.id);
+            }
+        }
+
+        for(const uint32_t child_index : cell.children) {
+            if(child_index != NO_CELL) {
+                query_sphere(child_index, center, radius, ids);
+            }
+        }
+    }
+} // namespace nova::renderer
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "nova_renderer/culling.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief A loose octree of renderables' world-space bounds
+     *
+     * The octree has a fixed number of levels. Leaf cells are `leaf_size` units wide, which should match the world's chunk size, and each
+     * level up doubles the size. Cells are only allocated when something is in them or in one of their descendants, and the tree has as
+     * many top-level cells as it needs, so it never has to be rebuilt as the world grows.
+     *
+     * Each box goes into the smallest cell that's at least as large as the box, picking the cell that contains the box's center. Each
+     * cell's loose bounds are the cell expanded by half of its size in every direction, so a box always fits in its cell's loose bounds.
+     * Boxes larger than the top-level cells are kept in a separate list that every query tests
+     *
+     * Inserting, updating, and removing boxes touches one cell per level at most. Queries only visit cells whose loose bounds pass the
+     * query, and don't test any boxes in cells that are entirely inside a frustum, so their cost scales with the number of boxes they find
+     */
+    class SpatialIndex {
+    public:
+        /*!
+         * \param leaf_size The width of the smallest cells
+         * \param num_levels How many levels of cells there are. The top-level cells are `leaf_size * 2^(num_levels - 1)` units wide
+         */
+        explicit SpatialIndex(float leaf_size = 16, uint32_t num_levels = 8);
+
+        /*!
+         * \brief Adds a box to the index. The ID must not already be in the index
+         */
+        void insert(RenderableId id, const Aabb& bounds);
+
+        /*!
+         * \brief Changes the bounds of a box that's in the index, moving it to a different cell if needed
+         */
+        void update(RenderableId id, const Aabb& bounds);
+
+        /*!
+         * \brief Removes a box from the index, returning false if there's no box with that ID
+         */
+        bool remove(RenderableId id);
+
+        void clear();
+
+        /*!
+         * \brief Appends the IDs of every box that intersects the frustum to `ids`
+         *
+         * Like `cull_aabbs`, the test is conservative
+         */
+        void query_frustum(const Frustum& frustum, std::vector<RenderableId>& ids) const;
+
+        /*!
+         * \brief Appends the IDs of every box that intersects the sphere to `ids`
+         */
+        void query_sphere(const glm::vec3& center, float radius, std::vector<RenderableId>& ids) const;
+
+        /*!
+         * \brief The number of boxes in the index
+         */
+        [[nodiscard]] uint32_t size() const;
+
+        /*!
+         * \brief The number of cells that are currently allocated
+         */
+        [[nodiscard]] uint32_t get_num_cells() const;
+
+    private:
+        static constexpr uint32_t NO_CELL = std::numeric_limits<uint32_t>::max();
+
+        struct CellKey {
+            int32_t x;
+            int32_t y;
+            int32_t z;
+            uint32_t level;
+
+            bool operator==(const CellKey& other) const;
+        };
+
+        struct CellKeyHasher {
+            std::size_t operator()(const CellKey& key) const;
+        };
+
+        struct Entry {
+            RenderableId id;
+            Aabb bounds;
+        };
+
+        struct Cell {
+            CellKey key;
+
+            Aabb loose_bounds;
+
+            uint32_t parent = NO_CELL;
+
+            std::array<uint32_t, 8> children;
+
+            uint32_t num_children = 0;
+
+            std::vector<Entry> entries;
+        };
+
+        struct EntryLocation {
+            /*!
+             * \brief The cell the entry is in, or NO_CELL if the entry is in `oversized_entries`
+             */
+            uint32_t cell;
+
+            uint32_t index_in_cell;
+        };
+
+        float leaf_size;
+        uint32_t num_levels;
+
+        /*!
+         * \brief All the cells. Cells that aren't used are on `free_cells`
+         */
+        std::vector<Cell> cells;
+        std::vector<uint32_t> free_cells;
+
+        std::unordered_map<CellKey, uint32_t, CellKeyHasher> cell_indices;
+
+        std::vector<uint32_t> top_level_cells;
+
+        /*!
+         * \brief Entries that are too large for even the top-level cells
+         */
+        std::vector<Entry> oversized_entries;
+
+        std::unordered_map<RenderableId, EntryLocation> entry_locations;
+
+        /*!
+         * \brief Finds the cell that a box belongs in. Returns false if the box is too large for any cell
+         */
+        [[nodiscard]] bool get_cell_key(const Aabb& bounds, CellKey& key) const;
+
+        [[nodiscard]] float get_cell_size(uint32_t level) const;
+
+        /*!
+         * \brief Finds the cell with the given key, creating it and all its missing ancestors if needed
+         */
+        uint32_t get_or_create_cell(const CellKey& key);
+
+        /*!
+         * \brief Frees the cell, and then its ancestors, for as long as they're empty
+         */
+        void free_cell_if_empty(uint32_t cell_index);
+
+        /*!
+         * \brief Removes the entry at the location, updating the location of the entry that moves into its place
+         */
+        void remove_entry(const EntryLocation& location);
+
+        void query_frustum(uint32_t cell_index, const Frustum& frustum, bool is_inside, std::vector<RenderableId>& ids) const;
+
+        void query_sphere(uint32_t cell_index, const glm::vec3& center, float radius, std::vector<RenderableId>& ids) const;
+    };
+} // namespace nova::renderer
@@ -0,0 +1,464 @@
+#include "transform_hierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#pragma warning(push, 0)
+#include <minitrace.h>
+#pragma warning(pop)
+
+#include "../tasks/task_scheduler.hpp"
+#include "../util/logger.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOVA_TRANSFORM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace nova::renderer {
+    constexpr uint32_t NO_LEVEL = std::numeric_limits<uint32_t>::max();
+
+    constexpr RenderableId NO_RENDERABLE = std::numeric_limits<RenderableId>::max();
+
+    TransformId make_transform_id(const uint32_t slot_index, const uint32_t generation) {
+        return static_cast<TransformId>(generation) << 32 | slot_index;
+    }
+
+    uint32_t get_transform_slot_index(const TransformId id) { return static_cast<uint32_t>(id & 0xFFFFFFFF); }
+
+    uint32_t get_transform_generation(const TransformId id) { return static_cast<uint32_t>(id >> 32); }
+
+    glm::vec4 make_rotation_quaternion(const glm::vec3& euler_angles) {
+        const auto multiply = [](const glm::vec4& a, const glm::vec4& b) {
+            return glm::vec4(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                             a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                             a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                             a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+        };
+
+        const glm::vec3 half_angles = euler_angles * 0.5F;
+        const glm::vec4 x_rotation(std::sin(half_angles.x), 0.0F, 0.0F, std::cos(half_angles.x));
+        const glm::vec4 y_rotation(0.0F, std::sin(half_angles.y), 0.0F, std::cos(half_angles.y));
+        const glm::vec4 z_rotation(0.0F, 0.0F, std::sin(half_angles.z), std::cos(half_angles.z));
+
+        return multiply(multiply(x_rotation, y_rotation), z_rotation);
+    }
+
+    void compose_world_matrix(
+        const glm::mat4& parent, const glm::vec3& position, const glm::vec4& rotation, const glm::vec3& scale, glm::mat4& world_matrix) {
+        const float x = rotation.x;
+        const float y = rotation.y;
+        const float z = rotation.z;
+        const float w = rotation.w;
+
+        // The columns of the local matrix. The fourth element of each is implied: 0 for the first three and 1 for the translation
+        const float local[4][3] = {{(1.0F - 2.0F * (y * y + z * z)) * scale.x,
+                                    2.0F * (x * y + w * z) * scale.x,
+                                    2.0F * (x * z - w * y) * scale.x},
+                                   {2.0F * (x * y - w * z) * scale.y,
+                                    (1.0F - 2.0F * (x * x + z * z)) * scale.y,
+                                    2.0F * (y * z + w * x) * scale.y},
+                                   {2.0F * (x * z + w * y) * scale.z,
+                                    2.0F * (y * z - w * x) * scale.z,
+                                    (1.0F - 2.0F * (x * x + y * y)) * scale.z},
+                                   {position.x, position.y, position.z}};
+
+#ifdef NOVA_TRANSFORM_SSE2
+        const __m128 parent_0 = _mm_loadu_ps(&parent[0][0]);
+        const __m128 parent_1 = _mm_loadu_ps(&parent[1][0]);
+        const __m128 parent_2 = _mm_loadu_ps(&parent[2][0]);
+        const __m128 parent_3 = _mm_loadu_ps(&parent[3][0]);
+
+        for(int column = 0; column < 4; column++) {
+            __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(parent_0, _mm_set1_ps(local[column][0])),
+                                                  _mm_mul_ps(parent_1, _mm_set1_ps(local[column][1]))),
+                                       _mm_mul_ps(parent_2, _mm_set1_ps(local[column][2])));
+            if(column == 3) {
+                result = _mm_add_ps(result, parent_3);
+            }
+
+            _mm_storeu_ps(&world_matrix[column][0], result);
+        }
+#else
+        for(int column = 0; column < 4; column++) {
+            for(int row = 0; row < 4; row++) {
+                world_matrix[column][row] = parent[0][row] * local[column][0] + parent[1][row] * local[column][1] +
+                                            parent[2][row] * local[column][2] + (column == 3 ? parent[3][row] : 0.0F);
+            }
+        }
+#endif
+    }
+
+    TransformId TransformHierarchy::add(const TransformData& data, const RenderableId renderable) {
+        uint32_t parent_index = NO_INDEX;
+        if(data.parent != NO_TRANSFORM) {
+            parent_index = find_index(data.parent);
+            if(parent_index == NO_INDEX) {
+                NOVA_LOG(ERROR) << "Can't add a transform to parent transform " << data.parent << " because the parent doesn't exist";
+                return NO_TRANSFORM;
+            }
+        }
+
+        uint32_t slot_index;
+        if(!free_slots.empty()) {
+            slot_index = free_slots.back();
+            free_slots.pop_back();
+
+        } else {
+            slot_index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+
+        const auto index = static_cast<uint32_t>(slot_indices.size());
+
+        Slot& slot = slots[slot_index];
+        slot.index = index;
+        slot.is_alive = true;
+        num_alive++;
+
+        slot_indices.push_back(slot_index);
+        parents.push_back(parent_index);
+        positions.push_back(data.position);
+        rotations.push_back(make_rotation_quaternion(data.rotation));
+        scales.push_back(data.scale);
+        world_matrices.emplace_back();
+        is_dirty.push_back(0);
+        renderables.push_back(renderable);
+
+        static const glm::mat4 IDENTITY(1.0F);
+        const glm::mat4& parent_matrix = parent_index == NO_INDEX ? IDENTITY : world_matrices[parent_index];
+        compose_world_matrix(parent_matrix, positions[index], rotations[index], scales[index], world_matrices[index]);
+
+        // The new transform stays sorted if it goes in the deepest level or one past it
+        if(is_sorted) {
+            const uint32_t level = parent_index == NO_INDEX ? 0 : get_level(parent_index) + 1;
+            if(level + 1 == level_ends.size()) {
+                level_ends.back()++;
+
+            } else if(level == level_ends.size()) {
+                level_ends.push_back(index + 1);
+
+            } else {
+                is_sorted = false;
+            }
+        }
+
+        return make_transform_id(slot_index, slot.generation);
+    }
+
+    bool TransformHierarchy::set_local_transform(const TransformId id, const TransformData& data) {
+        const uint32_t index = find_index(id);
+        if(index == NO_INDEX) {
+            NOVA_LOG(ERROR) << "Can't change transform " << id << " because it doesn't exist";
+            return false;
+        }
+
+        uint32_t parent_index = NO_INDEX;
+        if(data.parent != NO_TRANSFORM) {
+            parent_index = find_index(data.parent);
+            if(parent_index == NO_INDEX) {
+                NOVA_LOG(ERROR) << "Can't attach transform " << id << " to transform " << data.parent << " because it doesn't exist";
+                return false;
+            }
+        }
+
+        if(parent_index != parents[index]) {
+            // The transform can't be its own ancestor
+            for(uint32_t ancestor = parent_index; ancestor != NO_INDEX; ancestor = parents[ancestor]) {
+                if(ancestor == index) {
+                    NOVA_LOG(ERROR) << "Can't attach transform " << id << " to transform " << data.parent
+                                    << " because that would make it its own ancestor";
+                    return false;
+                }
+            }
+
+            parents[index] = parent_index;
+            is_sorted = false;
+        }
+
+        positions[index] = data.position;
+        rotations[index] = make_rotation_quaternion(data.rotation);
+        scales[index] = data.scale;
+        mark_dirty(index);
+
+        return true;
+    }
+
+    bool TransformHierarchy::remove(const TransformId id) {
+        const uint32_t index = find_index(id);
+        if(index == NO_INDEX) {
+            return false;
+        }
+
+        const uint32_t slot_index = get_transform_slot_index(id);
+        Slot& slot = slots[slot_index];
+        slot.is_alive = false;
+        slot.generation++;
+        free_slots.push_back(slot_index);
+        num_alive--;
+
+        // The transform stays in the arrays until the next sort, so its children can still find their new parent through it
+        slot_indices[index] = REMOVED;
+        renderables[index] = NO_RENDERABLE;
+        is_sorted = false;
+
+        return true;
+    }
+
+    void TransformHierarchy::clear() {
+        for(uint32_t slot_index = 0; slot_index < slots.size(); slot_index++) {
+            Slot& slot = slots[slot_index];
+            if(slot.is_alive) {
+                slot.is_alive = false;
+                slot.generation++;
+                free_slots.push_back(slot_index);
+            }
+        }
+
+        num_alive = 0;
+
+        slot_indices.clear();
+        parents.clear();
+        positions.clear();
+        rotations.clear();
+        scales.clear();
+        world_matrices.clear();
+        is_dirty.clear();
+        renderables.clear();
+        level_ends.clear();
+        moved_renderables.clear();
+
+        is_sorted = true;
+        first_dirty_level = NO_LEVEL;
+    }
+
+    bool TransformHierarchy::contains(const TransformId id) const { return find_index(id) != NO_INDEX; }
+
+    const glm::mat4* TransformHierarchy::get_world_matrix(const TransformId id) const {
+        const uint32_t index = find_index(id);
+        if(index == NO_INDEX) {
+            return nullptr;
+        }
+
+        return &world_matrices[index];
+    }
+
+    uint32_t TransformHierarchy::update(ttl::task_scheduler* scheduler) {
+        MTR_SCOPE("TransformHierarchy", "update");
+
+        moved_renderables.clear();
+
+        if(!is_sorted) {
+            sort();
+        }
+
+        if(first_dirty_level == NO_LEVEL) {
+            return 0;
+        }
+
+        // Nothing before the first dirty level can have changed
+        const uint32_t first_index = first_dirty_level == 0 ? 0 : level_ends[first_dirty_level - 1];
+
+        uint32_t level_start = first_index;
+        for(uint32_t level = first_dirty_level; level < level_ends.size(); level++) {
+            const uint32_t level_end = level_ends[level];
+            const uint32_t num_chunks = (level_end - level_start + UPDATE_CHUNK_SIZE - 1) / UPDATE_CHUNK_SIZE;
+
+            const auto update_chunk = [&, level_start, level_end](const uint32_t chunk) {
+                const uint32_t chunk_start = level_start + chunk * UPDATE_CHUNK_SIZE;
+                update_range(chunk_start, std::min(chunk_start + UPDATE_CHUNK_SIZE, level_end));
+            };
+
+            if(scheduler == nullptr || num_chunks <= 1) {
+                for(uint32_t chunk = 0; chunk < num_chunks; chunk++) {
+                    update_chunk(chunk);
+                }
+
+            } else {
+                // Every transform in this level has to be done before the next level reads them
+                ttl::condition_counter chunks_remaining;
+                for(uint32_t chunk = 1; chunk < num_chunks; chunk++) {
+                    scheduler->add_task(&chunks_remaining, [&update_chunk, chunk](ttl::task_scheduler* /* scheduler */) {
+                        update_chunk(chunk);
+                    });
+                }
+
+                update_chunk(0);
+
+                chunks_remaining.wait_for_value(0);
+            }
+
+            level_start = level_end;
+        }
+
+        uint32_t num_recomputed = 0;
+        const auto num_transforms = static_cast<uint32_t>(slot_indices.size());
+        for(uint32_t i = first_index; i < num_transforms; i++) {
+            if(is_dirty[i] == 0) {
+                continue;
+            }
+
+            num_recomputed++;
+            if(renderables[i] != NO_RENDERABLE) {
+                moved_renderables.push_back(renderables[i]);
+            }
+
+            is_dirty[i] = 0;
+        }
+
+        first_dirty_level = NO_LEVEL;
+
+        return num_recomputed;
+    }
+
+    const std::vector<RenderableId>& TransformHierarchy::get_moved_renderables() const { return moved_renderables; }
+
+    uint32_t TransformHierarchy::size() const { return num_alive; }
+
+    uint32_t TransformHierarchy::find_index(const TransformId id) const {
+        const uint32_t slot_index = get_transform_slot_index(id);
+        if(slot_index >= slots.size()) {
+            return NO_INDEX;
+        }
+
+        const Slot& slot = slots[slot_index];
+        if(!slot.is_alive || slot.generation != get_transform_generation(id)) {
+            return NO_INDEX;
+        }
+
+        return slot.index;
+    }
+
+    uint32_t TransformHierarchy::get_level(const uint32_t index) const {
+        return static_cast<uint32_t>(std::upper_bound(level_ends.begin(), level_ends.end(), index) - level_ends.begin());
+    }
+
+    void TransformHierarchy::mark_dirty(const uint32_t index) {
+        is_dirty[index] = 1;
+
+        // Levels aren't known until the hierarchy is sorted again, and sorting doesn't keep track of the dirty levels
+        const uint32_t level = is_sorted ? get_level(index) : 0;
+        first_dirty_level = std::min(first_dirty_level, level);
+    }
+
+    void TransformHierarchy::sort() {
+        MTR_SCOPE("TransformHierarchy", "sort");
+
+        const auto num_transforms = static_cast<uint32_t>(slot_indices.size());
+
+        // Removed transforms' children are attached to their closest ancestor that's still around. Their world matrices change, so
+        // they're dirty
+        for(uint32_t i = 0; i < num_transforms; i++) {
+            uint32_t parent = parents[i];
+            if(parent == NO_INDEX || slot_indices[parent] != REMOVED) {
+                continue;
+            }
+
+            while(parent != NO_INDEX && slot_indices[parent] == REMOVED) {
+                parent = parents[parent];
+            }
+            parents[i] = parent;
+            is_dirty[i] = 1;
+        }
+
+        // Find each transform's level by walking up to the closest ancestor whose level is known. Each transform is only walked over once
+        std::vector<uint32_t> levels(num_transforms, NO_LEVEL);
+        std::vector<uint32_t> ancestors;
+        uint32_t num_levels = 0;
+        for(uint32_t i = 0; i < num_transforms; i++) {
+            if(slot_indices[i] == REMOVED) {
+                continue;
+            }
+
+            uint32_t transform = i;
+            while(transform != NO_INDEX && levels[transform] == NO_LEVEL) {
+                ancestors.push_back(transform);
+                transform = parents[transform];
+            }
+
+            uint32_t level = transform == NO_INDEX ? 0 : levels[transform] + 1;
+            while(!ancestors.empty()) {
+                levels[ancestors.back()] = level;
+                ancestors.pop_back();
+                level++;
+            }
+
+            num_levels = std::max(num_levels, levels[i] + 1);
+        }
+
+        // Counting sort by level, which keeps the order of the transforms within each level
+        level_ends.assign(num_levels, 0);
+        for(uint32_t i = 0; i < num_transforms; i++) {
+            if(levels[i] != NO_LEVEL) {
+                level_ends[levels[i]]++;
+            }
+        }
+
+        std::vector<uint32_t> level_starts(num_levels, 0);
+        uint32_t num_sorted = 0;
+        for(uint32_t level = 0; level < num_levels; level++) {
+            level_starts[level] = num_sorted;
+            num_sorted += level_ends[level];
+            level_ends[level] = num_sorted;
+        }
+
+        std::vector<uint32_t> new_indices(num_transforms, NO_INDEX);
+        for(uint32_t i = 0; i < num_transforms; i++) {
+            if(levels[i] != NO_LEVEL) {
+                new_indices[i] = level_starts[levels[i]]++;
+            }
+        }
+
+        const auto permute = [&](auto& array) {
+            std::remove_reference_t<decltype(array)> sorted_array(num_sorted);
+            for(uint32_t i = 0; i < num_transforms; i++) {
+                if(new_indices[i] != NO_INDEX) {
+                    sorted_array[new_indices[i]] = std::move(array[i]);
+                }
+            }
+            array = std::move(sorted_array);
+        };
+
+        permute(slot_indices);
+        permute(parents);
+        permute(positions);
+        permute(rotations);
+        permute(scales);
+        permute(world_matrices);
+        permute(is_dirty);
+        permute(renderables);
+
+        bool has_dirty = false;
+        for(uint32_t i = 0; i < num_sorted; i++) {
+            if(parents[i] != NO_INDEX) {
+                parents[i] = new_indices[parents[i]];
+            }
+            slots[slot_indices[i]].index = i;
+            has_dirty = has_dirty || is_dirty[i] != 0;
+        }
+
+        first_dirty_level = has_dirty ? 0 : NO_LEVEL;
+        is_sorted = true;
+    }
+
+    void TransformHierarchy::update_range(const uint32_t start, const uint32_t end) {
+        static const glm::mat4 IDENTITY(1.0F);
+
+        // The parents are all in earlier levels, so their flags are final
+        for(uint32_t i = start; i < end; i++) {
+            if(parents[i] != NO_INDEX && is_dirty[parents[i]] != 0) {
+                is_dirty[i] = 1;
+            }
+        }
+
+        for(uint32_t i = start; i < end; i++) {
+            if(is_dirty[i] == 0) {
+                continue;
+            }
+
+            const glm::mat4& parent_matrix = parents[i] == NO_INDEX ? IDENTITY : world_matrices[parents[i]];
+            compose_world_matrix(parent_matrix, positions[i], rotations[i], scales[i], world_matrices[i]);
+        }
+    }
+} // namespace nova::renderer
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "nova_renderer/renderables.hpp"
+
+namespace nova::ttl {
+    class task_scheduler;
+}
+
+namespace nova::renderer {
+    /*!
+     * \brief Converts Euler angles, in radians, to a quaternion stored as (x, y, z, w)
+     *
+     * The rotation is the same as rotating around X, then Y, then Z with `glm::rotate`, like renderables always have been
+     */
+    [[nodiscard]] glm::vec4 make_rotation_quaternion(const glm::vec3& euler_angles);
+
+    /*!
+     * \brief Computes `parent * translate(position) * rotate(rotation) * scale(scale)`
+     */
+    void compose_world_matrix(
+        const glm::mat4& parent, const glm::vec3& position, const glm::vec4& rotation, const glm::vec3& scale, glm::mat4& world_matrix);
+
+    /*!
+     * \brief Every transform in the scene, and the parent-child relationships between them
+     *
+     * The hierarchy is flat: each transform's data lives in parallel arrays, sorted by depth so that every transform comes after its
+     * parent. Each transform keeps its local position, rotation, and scale, which is smaller than a matrix and is what the host application
+     * changes anyways. Changing a transform marks it dirty, and `update` recomputes the world matrices of the dirty transforms and all
+     * their descendants, one depth level at a time. The transforms in a level only depend on the levels before it, so each level is split
+     * between worker threads
+     *
+     * Adding a transform whose parent is in the deepest level is O(1). Anything else that changes the structure of the hierarchy, like
+     * reparenting or removing a transform, marks it unsorted, and the next `update` sorts it again in O(n)
+     *
+     * This class is not thread-safe
+     */
+    class TransformHierarchy {
+    public:
+        /*!
+         * \brief How many transforms in one level are updated as one task
+         */
+        static constexpr uint32_t UPDATE_CHUNK_SIZE = 1024;
+
+        /*!
+         * \brief Adds a transform, returning its ID or NO_TRANSFORM if its parent doesn't exist
+         *
+         * The new transform's world matrix is computed right away, from its parent's current world matrix
+         *
+         * \param data The transform's local position, rotation, scale, and parent
+         * \param renderable The renderable that this transform positions, if any. `update` reports when its world matrix changes
+         */
+        [[nodiscard]] TransformId add(const TransformData& data, RenderableId renderable = std::numeric_limits<RenderableId>::max());
+
+        /*!
+         * \brief Changes a transform's local position, rotation, scale, and parent
+         *
+         * \return False if the transform or its new parent doesn't exist, or if the new parent is the transform or one of its descendants.
+         * The transform isn't changed in that case
+         */
+        bool set_local_transform(TransformId id, const TransformData& data);
+
+        /*!
+         * \brief Removes a transform, returning false if there's no transform with that ID
+         *
+         * The transform's children are attached to its parent. Their local transforms are now relative to that parent
+         */
+        bool remove(TransformId id);
+
+        /*!
+         * \brief Removes every transform. IDs that were handed out before this call will never be valid again
+         */
+        void clear();
+
+        [[nodiscard]] bool contains(TransformId id) const;
+
+        /*!
+         * \brief The world matrix that the transform had after the last update, or nullptr if there's no transform with that ID
+         */
+        [[nodiscard]] const glm::mat4* get_world_matrix(TransformId id) const;
+
+        /*!
+         * \brief Recomputes the world matrix of every dirty transform and every descendant of a dirty transform
+         *
+         * \param scheduler The scheduler to split large levels between. If this is nullptr, everything is updated on this thread
+         *
+         * \return How many world matrices were recomputed
+         */
+        uint32_t update(ttl::task_scheduler* scheduler = nullptr);
+
+        /*!
+         * \brief The renderables whose world matrices were recomputed by the last update
+         */
+        [[nodiscard]] const std::vector<RenderableId>& get_moved_renderables() const;
+
+        [[nodiscard]] uint32_t size() const;
+
+    private:
+        /*!
+         * \brief An array index that no transform has, for root transforms' parents and for transforms that don't exist
+         */
+        static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+        /*!
+         * \brief Marks the transforms in `slot_indices` that were removed but are still in the arrays
+         */
+        static constexpr uint32_t REMOVED = std::numeric_limits<uint32_t>::max();
+
+        struct Slot {
+            /*!
+             * \brief Index of the transform in the arrays
+             */
+            uint32_t index = 0;
+
+            uint32_t generation = 0;
+
+            bool is_alive = false;
+        };
+
+        std::vector<Slot> slots;
+
+        /*!
+         * \brief Indices of the slots that aren't used by any transform
+         */
+        std::vector<uint32_t> free_slots;
+
+        uint32_t num_alive = 0;
+
+        std::vector<uint32_t> slot_indices;
+
+        /*!
+         * \brief Array index of each transform's parent, or NO_INDEX for root transforms
+         */
+        std::vector<uint32_t> parents;
+
+        std::vector<glm::vec3> positions;
+
+        /*!
+         * \brief Each transform's rotation, as a quaternion
+         */
+        std::vector<glm::vec4> rotations;
+
+        std::vector<glm::vec3> scales;
+
+        std::vector<glm::mat4> world_matrices;
+
+        /*!
+         * \brief Whether each transform's world matrix has to be recomputed. Bytes rather than bools so that workers can write them at the
+         * same time
+         */
+        std::vector<uint8_t> is_dirty;
+
+        std::vector<RenderableId> renderables;
+
+        /*!
+         * \brief The array index after the last transform in each level. Level 0 is the root transforms
+         *
+         * Only valid while the hierarchy is sorted
+         */
+        std::vector<uint32_t> level_ends;
+
+        bool is_sorted = true;
+
+        /*!
+         * \brief The shallowest level that has a dirty transform, or `std::numeric_limits<uint32_t>::max()` if no transform is dirty
+         */
+        uint32_t first_dirty_level = std::numeric_limits<uint32_t>::max();
+
+        std::vector<RenderableId> moved_renderables;
+
+        /*!
+         * \brief Finds the array index of the transform with the given ID, or NO_INDEX if there's no such transform
+         */
+        [[nodiscard]] uint32_t find_index(TransformId id) const;
+
+        [[nodiscard]] uint32_t get_level(uint32_t index) const;
+
+        void mark_dirty(uint32_t index);
+
+        /*!
+         * \brief Drops the removed transforms, and sorts the rest by depth
+         */
+        void sort();
+
+        /*!
+         * \brief Propagates dirty flags from the parents of the transforms in the range, then recomputes the dirty transforms' world
+         * matrices
+         */
+        void update_range(uint32_t start, uint32_t end);
+    };
+} // namespace nova::renderer
@@ -0,0 +1,207 @@
+#include "nova_renderer/vertex_formats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOVA_VERTEX_CONVERSION_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace nova::renderer {
+    /*
+     * The scalar and SIMD conversions do their math in the same order, and both round to nearest even, so that they produce the same
+     * results
+     */
+
+    uint16_t quantize_unorm16(const float value) {
+        return static_cast<uint16_t>(std::nearbyint(std::clamp(value, 0.0F, 1.0F) * 65535.0F));
+    }
+
+    int16_t quantize_snorm16(const float value) {
+        return static_cast<int16_t>(std::nearbyint(std::clamp(value, -1.0F, 1.0F) * 32767.0F));
+    }
+
+    uint8_t quantize_unorm8(const float value) { return static_cast<uint8_t>(std::nearbyint(std::clamp(value, 0.0F, 1.0F) * 255.0F)); }
+
+    float sign_not_zero(const float value) { return std::signbit(value) ? -1.0F : 1.0F; }
+
+    void convert_attributes(const FullVertex& src, CompactVertex& dst) {
+        dst.main_uv = src.main_uv;
+        dst.secondary_uv = src.secondary_uv;
+        dst.padding = 0;
+        dst.virtual_texture_id = src.virtual_texture_id;
+        dst.additional_data = glm::u8vec4(quantize_unorm8(src.additional_stuff.x),
+                                          quantize_unorm8(src.additional_stuff.y),
+                                          quantize_unorm8(src.additional_stuff.z),
+                                          quantize_unorm8(src.additional_stuff.w));
+    }
+
+    glm::i16vec2 encode_octahedral(const glm::vec3& vector) {
+        const float l1_norm = std::max((std::abs(vector.x) + std::abs(vector.y)) + std::abs(vector.z), std::numeric_limits<float>::min());
+        const float inverse_l1_norm = 1.0F / l1_norm;
+
+        float x = vector.x * inverse_l1_norm;
+        float y = vector.y * inverse_l1_norm;
+
+        // The bottom half of the octahedron folds out over the corners of the square
+        if(vector.z < 0.0F) {
+            const float folded_x = (1.0F - std::abs(y)) * sign_not_zero(x);
+            const float folded_y = (1.0F - std::abs(x)) * sign_not_zero(y);
+            x = folded_x;
+            y = folded_y;
+        }
+
+        return glm::i16vec2(quantize_snorm16(x), quantize_snorm16(y));
+    }
+
+    glm::vec3 decode_octahedral(const glm::i16vec2& encoded) {
+        float x = std::max(static_cast<float>(encoded.x) / 32767.0F, -1.0F);
+        float y = std::max(static_cast<float>(encoded.y) / 32767.0F, -1.0F);
+        const float z = 1.0F - std::abs(x) - std::abs(y);
+
+        if(z < 0.0F) {
+            const float unfolded_x = (1.0F - std::abs(y)) * sign_not_zero(x);
+            const float unfolded_y = (1.0F - std::abs(x)) * sign_not_zero(y);
+            x = unfolded_x;
+            y = unfolded_y;
+        }
+
+        const float length = std::sqrt(x * x + y * y + z * z);
+        return glm::vec3(x / length, y / length, z / length);
+    }
+
+    glm::vec3 decode_position(const glm::u16vec4& encoded, const PositionQuantization& quantization) {
+        const float scale = quantization.size / 65535.0F;
+        return glm::vec3(quantization.origin.x + static_cast<float>(encoded.x) * scale,
+                         quantization.origin.y + static_cast<float>(encoded.y) * scale,
+                         quantization.origin.z + static_cast<float>(encoded.z) * scale);
+    }
+
+    void convert_to_compact_vertices_scalar(const FullVertex* src,
+                                            const size_t num_vertices,
+                                            const PositionQuantization& quantization,
+                                            CompactVertex* dst) {
+        const float inverse_size = 1.0F / quantization.size;
+
+        for(size_t i = 0; i < num_vertices; i++) {
+            const FullVertex& vertex = src[i];
+            CompactVertex& compact_vertex = dst[i];
+
+            compact_vertex.position = glm::u16vec4(quantize_unorm16((vertex.position.x - quantization.origin.x) * inverse_size),
+                                                   quantize_unorm16((vertex.position.y - quantization.origin.y) * inverse_size),
+                                                   quantize_unorm16((vertex.position.z - quantization.origin.z) * inverse_size),
+                                                   0);
+            compact_vertex.normal = encode_octahedral(vertex.normal);
+            compact_vertex.tangent = encode_octahedral(vertex.tangent);
+
+            convert_attributes(vertex, compact_vertex);
+        }
+    }
+
+#ifdef NOVA_VERTEX_CONVERSION_SSE2
+    /*!
+     * \brief Quantizes four floats in [0, 1] to unsigned normalized integers with the given maximum value
+     */
+    __m128i quantize_unorm(const __m128 values, const float max_value) {
+        const __m128 clamped = _mm_min_ps(_mm_max_ps(values, _mm_setzero_ps()), _mm_set1_ps(1.0F));
+        return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(max_value)));
+    }
+
+    /*!
+     * \brief Octahedral encodes four vectors at once, writing the quantized results to `encoded_x` and `encoded_y`
+     */
+    void encode_octahedral(const __m128 x, const __m128 y, const __m128 z, __m128i& encoded_x, __m128i& encoded_y) {
+        const __m128 sign_mask = _mm_set1_ps(-0.0F);
+        const __m128 one = _mm_set1_ps(1.0F);
+
+        const __m128 abs_x = _mm_andnot_ps(sign_mask, x);
+        const __m128 abs_y = _mm_andnot_ps(sign_mask, y);
+        const __m128 abs_z = _mm_andnot_ps(sign_mask, z);
+
+        const __m128 l1_norm = _mm_max_ps(_mm_add_ps(_mm_add_ps(abs_x, abs_y), abs_z), _mm_set1_ps(std::numeric_limits<float>::min()));
+        const __m128 inverse_l1_norm = _mm_div_ps(one, l1_norm);
+
+        const __m128 projected_x = _mm_mul_ps(x, inverse_l1_norm);
+        const __m128 projected_y = _mm_mul_ps(y, inverse_l1_norm);
+
+        const __m128 sign_x = _mm_or_ps(_mm_and_ps(projected_x, sign_mask), one);
+        const __m128 sign_y = _mm_or_ps(_mm_and_ps(projected_y, sign_mask), one);
+        const __m128 folded_x = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign_mask, projected_y)), sign_x);
+        const __m128 folded_y = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign_mask, projected_x)), sign_y);
+
+        const __m128 is_bottom_half = _mm_cmplt_ps(z, _mm_setzero_ps());
+        const __m128 result_x = _mm_or_ps(_mm_and_ps(is_bottom_half, folded_x), _mm_andnot_ps(is_bottom_half, projected_x));
+        const __m128 result_y = _mm_or_ps(_mm_and_ps(is_bottom_half, folded_y), _mm_andnot_ps(is_bottom_half, projected_y));
+
+        const __m128 min_value = _mm_set1_ps(-1.0F);
+        const __m128 snorm_scale = _mm_set1_ps(32767.0F);
+        encoded_x = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(result_x, min_value), one), snorm_scale));
+        encoded_y = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(result_y, min_value), one), snorm_scale));
+    }
+#endif
+
+    void convert_to_compact_vertices(const FullVertex* src,
+                                     const size_t num_vertices,
+                                     const PositionQuantization& quantization,
+                                     CompactVertex* dst) {
+        size_t i = 0;
+
+#ifdef NOVA_VERTEX_CONVERSION_SSE2
+        const __m128 origin_x = _mm_set1_ps(quantization.origin.x);
+        const __m128 origin_y = _mm_set1_ps(quantization.origin.y);
+        const __m128 origin_z = _mm_set1_ps(quantization.origin.z);
+        const __m128 inverse_size = _mm_set1_ps(1.0F / quantization.size);
+
+        alignas(16) int32_t position_x[4];
+        alignas(16) int32_t position_y[4];
+        alignas(16) int32_t position_z[4];
+        alignas(16) int32_t normal_x[4];
+        alignas(16) int32_t normal_y[4];
+        alignas(16) int32_t tangent_x[4];
+        alignas(16) int32_t tangent_y[4];
+
+        // FullVertex is an array of structures, so each group of four vertices is transposed into registers before converting it
+        for(; i + 4 <= num_vertices; i += 4) {
+            const FullVertex* v = src + i;
+
+            const __m128 px = _mm_setr_ps(v[0].position.x, v[1].position.x, v[2].position.x, v[3].position.x);
+            const __m128 py = _mm_setr_ps(v[0].position.y, v[1].position.y, v[2].position.y, v[3].position.y);
+            const __m128 pz = _mm_setr_ps(v[0].position.z, v[1].position.z, v[2].position.z, v[3].position.z);
+            _mm_store_si128(reinterpret_cast<__m128i*>(position_x), quantize_unorm(_mm_mul_ps(_mm_sub_ps(px, origin_x), inverse_size), 65535.0F));
+            _mm_store_si128(reinterpret_cast<__m128i*>(position_y), quantize_unorm(_mm_mul_ps(_mm_sub_ps(py, origin_y), inverse_size), 65535.0F));
+            _mm_store_si128(reinterpret_cast<__m128i*>(position_z), quantize_unorm(_mm_mul_ps(_mm_sub_ps(pz, origin_z), inverse_size), 65535.0F));
+
+            __m128i encoded_x;
+            __m128i encoded_y;
+            encode_octahedral(_mm_setr_ps(v[0].normal.x, v[1].normal.x, v[2].normal.x, v[3].normal.x),
+                              _mm_setr_ps(v[0].normal.y, v[1].normal.y, v[2].normal.y, v[3].normal.y),
+                              _mm_setr_ps(v[0].normal.z, v[1].normal.z, v[2].normal.z, v[3].normal.z),
+                              encoded_x,
+                              encoded_y);
+            _mm_store_si128(reinterpret_cast<__m128i*>(normal_x), encoded_x);
+            _mm_store_si128(reinterpret_cast<__m128i*>(normal_y), encoded_y);
+
+            encode_octahedral(_mm_setr_ps(v[0].tangent.x, v[1].tangent.x, v[2].tangent.x, v[3].tangent.x),
+                              _mm_setr_ps(v[0].tangent.y, v[1].tangent.y, v[2].tangent.y, v[3].tangent.y),
+                              _mm_setr_ps(v[0].tangent.z, v[1].tangent.z, v[2].tangent.z, v[3].tangent.z),
+                              encoded_x,
+                              encoded_y);
+            _mm_store_si128(reinterpret_cast<__m128i*>(tangent_x), encoded_x);
+            _mm_store_si128(reinterpret_cast<__m128i*>(tangent_y), encoded_y);
+
+            for(size_t lane = 0; lane < 4; lane++) {
+                CompactVertex& compact_vertex = dst[i + lane];
+                compact_vertex.position = glm::u16vec4(position_x[lane], position_y[lane], position_z[lane], 0);
+                compact_vertex.normal = glm::i16vec2(normal_x[lane], normal_y[lane]);
+                compact_vertex.tangent = glm::i16vec2(tangent_x[lane], tangent_y[lane]);
+
+                convert_attributes(v[lane], compact_vertex);
+            }
+        }
+#endif
+
+        convert_to_compact_vertices_scalar(src + i, num_vertices - i, quantization, dst + i);
+    }
+} // namespace nova::renderer
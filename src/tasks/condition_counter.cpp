@@ -4,36 +4,28 @@ namespace nova::ttl {
     condition_counter::condition_counter(uint32_t initial_value) : counter(initial_value) {}
 
     void condition_counter::add(const uint32_t num) {
-        bool should_trigger = false;
-        {
-            std::unique_lock l(mut);
-            counter += num;
-            should_trigger = counter == wait_val;
-        }
-
-        if(should_trigger) {
+        // See sub
+        std::unique_lock l(mut);
+        counter += num;
+        if(counter == wait_val) {
             cv.notify_all();
         }
     }
 
     void condition_counter::sub(const uint32_t num) {
-        bool should_trigger;
-        {
-            std::unique_lock l(mut);
-            counter -= (counter < num) ? counter : num;
-            should_trigger = counter == wait_val;
-        }
-
-        if(should_trigger) {
+        // Notify while holding the lock. Otherwise the waiting thread can wake up, return, and destroy this counter before
+        // notify_all is called
+        std::unique_lock l(mut);
+        counter -= (counter < num) ? counter : num;
+        if(counter == wait_val) {
             cv.notify_all();
         }
     }
 
     void condition_counter::wait_for_value(const uint32_t val) {
-        wait_val = val;
-
         {
             std::unique_lock l(mut);
+            wait_val = val;
             // I want to explicitly copy wait_val so that the same condition variable can be waited on for different
             // values, but I need to copy counter by reference
             cv.wait(l, [&, this] { return counter == this->wait_val; });
@@ -3,29 +3,21 @@
 #include <utility>
 
 namespace nova::ttl {
-    task_scheduler::per_thread_data::per_thread_data()
-        : task_queue(new wait_free_queue<std::function<void()>>),
-          things_in_queue_mutex(new std::mutex),
-          things_in_queue_cv(new std::condition_variable),
-          is_sleeping(new std::atomic<bool>(false)) {}
+    task_scheduler::per_thread_data::per_thread_data() : task_queue(new wait_free_queue<std::function<void()>>) {}
 
-    task_scheduler::task_scheduler(const uint32_t num_threads, const empty_queue_behavior /* behavior */)
+    task_scheduler::task_scheduler(const uint32_t num_threads, const empty_queue_behavior behavior)
         : num_threads(num_threads),
           should_shutdown(new std::atomic<bool>(false)),
+          behavior_of_empty_queues(behavior),
           initialized_mutex(new std::mutex),
-          initialized_cv(new std::condition_variable) {
+          initialized_cv(new std::condition_variable),
+          external_tasks_mutex(new std::mutex),
+          tasks_added_mutex(new std::mutex),
+          tasks_added_cv(new std::condition_variable) {
         threads.reserve(num_threads);
         thread_local_data.resize(num_threads);
 
         for(uint32_t i = 0; i < num_threads; i++) {
-            per_thread_data data;
-            data.task_queue = std::make_unique<wait_free_queue<std::function<void()>>>();
-            data.is_sleeping = std::make_unique<std::atomic<bool>>();
-            data.last_successful_steal = 0;
-            data.things_in_queue_cv = std::make_unique<std::condition_variable>();
-            data.things_in_queue_mutex = std::make_unique<std::mutex>();
-            thread_local_data.push_back(std::move(data));
-
             threads.emplace_back(thread_func, this);
         }
 
@@ -37,7 +29,12 @@ namespace nova::ttl {
     }
 
     task_scheduler::~task_scheduler() {
-        should_shutdown->store(true);
+        {
+            // Sleeping workers check this before they wait, so it's set with the lock held to make sure none of them miss it
+            std::lock_guard lock(*tasks_added_mutex);
+            should_shutdown->store(true);
+            tasks_added_cv->notify_all();
+        }
 
         for(auto& thread : threads) {
             thread.join();
@@ -59,41 +56,45 @@ namespace nova::ttl {
         return 0;
     }
 
+    bool task_scheduler::is_worker_thread() const {
+        const std::thread::id thread_id = std::this_thread::get_id();
+        for(const std::thread& thread : threads) {
+            if(thread.get_id() == thread_id) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     uint32_t task_scheduler::get_num_threads() const { return num_threads; }
 
     void task_scheduler::add_task(std::function<void()> task) {
-        size_t thread_idx = 0;
-        if(behavior_of_task_queue_search == task_queue_search_behavior::NEXT) {
-            if(last_task_queue_index >= thread_local_data.size()) {
-                last_task_queue_index = 0;
+        if(!is_worker_thread()) {
+            {
+                std::lock_guard lock(*external_tasks_mutex);
+                external_tasks.push_back(std::move(task));
             }
 
-            thread_idx = last_task_queue_index++;
-        } else if(behavior_of_task_queue_search == task_queue_search_behavior::MOST_EMPTY) {
-            size_t lowest_size = std::numeric_limits<size_t>::max();
-            for(size_t i = 0; i < thread_local_data.size(); i++) {
-                size_t size = thread_local_data[i].task_queue->size();
-                if(size < lowest_size) {
-                    thread_idx = i;
-                    lowest_size = size;
-                }
-            }
+            wake_sleeping_thread();
+            return;
         }
 
+        // Only the owner of a queue may push to it
+        const std::size_t thread_idx = get_current_thread_idx();
         thread_local_data[thread_idx].task_queue->push(std::move(task));
 
-        if(behavior_of_empty_queues == empty_queue_behavior::SLEEP) {
-            // Find a thread that is sleeping and wake it
-            for(uint32_t i = 0; i < num_threads; ++i) {
-                std::unique_lock<std::mutex> lock(*thread_local_data[i].things_in_queue_mutex);
-                if(thread_local_data[i].is_sleeping) {
-                    thread_local_data[i].is_sleeping->store(false);
-                    thread_local_data[i].things_in_queue_cv->notify_one();
+        wake_sleeping_thread();
+    }
 
-                    break;
-                }
-            }
+    void task_scheduler::wake_sleeping_thread() {
+        if(behavior_of_empty_queues != empty_queue_behavior::SLEEP) {
+            return;
         }
+
+        std::lock_guard lock(*tasks_added_mutex);
+        num_tasks_added++;
+        tasks_added_cv->notify_one();
     }
 
     void task_scheduler::add_task_proxy(std::function<void()> task) { add_task(std::move(task)); }
@@ -107,6 +108,16 @@ namespace nova::ttl {
             return true;
         }
 
+        // Then look for tasks from outside the pool
+        {
+            std::lock_guard lock(*external_tasks_mutex);
+            if(!external_tasks.empty()) {
+                *task = std::move(external_tasks.front());
+                external_tasks.pop_front();
+                return true;
+            }
+        }
+
         // Ours is empty, try to steal from the others'
         const std::size_t thread_index = tls.last_successful_steal;
         for(std::size_t i = 0; i < num_threads; ++i) {
@@ -135,10 +146,13 @@ namespace nova::ttl {
             pool->initialized_cv->wait(l, [=] { return pool->initialized; });
         }
 
-        const std::size_t thread_idx = pool->get_current_thread_idx();
-        task_scheduler::per_thread_data& tls = pool->thread_local_data[thread_idx];
-
         while(!pool->should_shutdown->load()) {
+            uint64_t num_tasks_added_before_search = 0;
+            if(pool->behavior_of_empty_queues == empty_queue_behavior::SLEEP) {
+                std::lock_guard lock(*pool->tasks_added_mutex);
+                num_tasks_added_before_search = pool->num_tasks_added;
+            }
+
             // Get a new task from the queue, and execute it
             std::function<void()> next_task;
             const bool success = pool->get_next_task(&next_task);
@@ -155,10 +169,11 @@ namespace nova::ttl {
                         break;
 
                     case empty_queue_behavior::SLEEP: {
-                        std::unique_lock<std::mutex> lock(*tls.things_in_queue_mutex);
-                        tls.is_sleeping->store(true);
-
-                        tls.things_in_queue_cv->wait(lock);
+                        // If a task was added while we were looking, look again instead of sleeping through it
+                        std::unique_lock<std::mutex> lock(*pool->tasks_added_mutex);
+                        pool->tasks_added_cv->wait(lock, [&] {
+                            return pool->num_tasks_added != num_tasks_added_before_search || pool->should_shutdown->load();
+                        });
 
                         break;
                     }
@@ -8,6 +8,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <future>
@@ -94,10 +95,6 @@ namespace nova::ttl {
              */
             std::size_t last_successful_steal = 0;
 
-            std::unique_ptr<std::mutex> things_in_queue_mutex;
-            std::unique_ptr<std::condition_variable> things_in_queue_cv;
-            std::unique_ptr<std::atomic<bool>> is_sleeping;
-
             per_thread_data();
 
             per_thread_data(per_thread_data&& other) noexcept = default;
@@ -213,6 +210,11 @@ namespace nova::ttl {
          */
         std::size_t get_current_thread_idx();
 
+        /*!
+         * \brief Checks if the calling thread is one of this scheduler's worker threads
+         */
+        [[nodiscard]] bool is_worker_thread() const;
+
         friend void thread_func(task_scheduler* pool);
 
         [[nodiscard]] uint32_t get_num_threads() const;
@@ -225,12 +227,30 @@ namespace nova::ttl {
         std::unique_ptr<std::atomic<bool>> should_shutdown;
 
         empty_queue_behavior behavior_of_empty_queues = empty_queue_behavior::YIELD;
-        task_queue_search_behavior behavior_of_task_queue_search = task_queue_search_behavior::NEXT;
         bool initialized = false;
         std::unique_ptr<std::mutex> initialized_mutex;
         std::unique_ptr<std::condition_variable> initialized_cv;
 
-        uint32_t last_task_queue_index = 0;
+        /*!
+         * \brief Tasks added by threads outside of the pool
+         *
+         * Each worker's queue may only be pushed to by that worker, so other threads put their tasks here for the workers to pick up
+         */
+        std::deque<std::function<void()>> external_tasks;
+        std::unique_ptr<std::mutex> external_tasks_mutex;
+
+        std::unique_ptr<std::mutex> tasks_added_mutex;
+
+        /*!
+         * \brief Signaled when a task is added, so that a sleeping worker can pick it up
+         */
+        std::unique_ptr<std::condition_variable> tasks_added_cv;
+
+        /*!
+         * \brief How many tasks have ever been added. Workers only go to sleep if this hasn't changed since they last looked for a task,
+         * so they can't miss a task that's added while they're looking
+         */
+        uint64_t num_tasks_added = 0;
 
         /*!
          * \brief Adds a task to the internal queue.
@@ -245,6 +265,11 @@ namespace nova::ttl {
          */
         void add_task_proxy(std::function<void()> task);
 
+        /*!
+         * \brief Counts a task that was just added, and wakes up one sleeping worker if the workers sleep when they run out of tasks
+         */
+        void wake_sleeping_thread();
+
         /*!
          * \brief Attempts to get the next task, returning success
          *
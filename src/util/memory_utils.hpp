@@ -11,7 +11,7 @@ namespace bvestl {
 		constexpr Bytes align(const Bytes value, const Bytes alignment) noexcept {
 		    // TODO: Make faster
 			return alignment == Bytes(0) ? value :
-			    (value % alignment == Bytes(0) ? value : value + value % alignment);
+			    (value % alignment == Bytes(0) ? value : value + (alignment - value % alignment));
 		}
 	}
 }
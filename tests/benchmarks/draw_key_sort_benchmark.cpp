@@ -0,0 +1,100 @@
+/*!
+ * \brief Measures how quickly a million draw keys can be sorted with std::sort, with the radix sort on one thread, and with the radix
+ * sort on every core
+ *
+ * The keys look like a busy frame: a few dozen pipelines, a few hundred material passes, and draws at every depth
+ */
+
+#include "../src/general_test_setup.hpp"
+
+#undef TEST
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../../src/render_objects/draw_keys.hpp"
+#include "../../src/tasks/task_scheduler.hpp"
+
+namespace nova::renderer {
+    constexpr uint32_t NUM_KEYS = 1000000;
+    constexpr uint32_t NUM_ITERATIONS = 20;
+
+    template <typename SortFunc>
+    double measure_sort_time(const std::vector<DrawKey>& unsorted_keys, SortFunc&& sort, bool& is_sorted) {
+        std::vector<DrawKey> keys;
+
+        double total_ms = 0;
+        for(uint32_t iteration = 0; iteration < NUM_ITERATIONS; iteration++) {
+            keys = unsorted_keys;
+
+            const auto start_time = std::chrono::high_resolution_clock::now();
+            sort(keys);
+            const auto end_time = std::chrono::high_resolution_clock::now();
+
+            const std::chrono::duration<double, std::milli> sort_time = end_time - start_time;
+            total_ms += sort_time.count();
+        }
+
+        is_sorted = std::is_sorted(keys.begin(), keys.end());
+        return total_ms / NUM_ITERATIONS;
+    }
+
+    void print_result(const char* name, const double time_ms, const bool is_sorted) {
+        std::cout << name << ": " << time_ms << " ms (" << NUM_KEYS / time_ms / 1000.0 << " million keys per second"
+                  << (is_sorted ? "" : ", NOT SORTED") << ")" << std::endl;
+    }
+
+    int main() {
+        TEST_SETUP_LOGGER();
+
+        std::srand(1234);
+
+        std::vector<DrawKey> unsorted_keys;
+        unsorted_keys.reserve(NUM_KEYS);
+        for(uint32_t i = 0; i < NUM_KEYS; i++) {
+            DrawKeyFields fields;
+            fields.queue = std::rand() % 10 == 0 ? DrawQueue::Transparent : DrawQueue::Opaque;
+            fields.pipeline = static_cast<uint32_t>(std::rand()) % 32;
+            fields.material_pass = static_cast<uint32_t>(std::rand()) % 256;
+            fields.mesh_batch = i % MAX_MESH_BATCH;
+            fields.depth = quantize_depth(static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 500.0F);
+            unsorted_keys.push_back(make_draw_key(fields));
+        }
+
+        bool std_sorted = false;
+        const double std_ms = measure_sort_time(
+            unsorted_keys,
+            [](std::vector<DrawKey>& keys) { std::sort(keys.begin(), keys.end()); },
+            std_sorted);
+
+        std::vector<DrawKey> scratch;
+
+        bool radix_sorted = false;
+        const double radix_ms = measure_sort_time(
+            unsorted_keys,
+            [&](std::vector<DrawKey>& keys) { sort_draw_keys(keys, scratch); },
+            radix_sorted);
+
+        const uint32_t num_cores = std::thread::hardware_concurrency();
+        ttl::task_scheduler scheduler(num_cores > 1 ? num_cores - 1 : 1, ttl::empty_queue_behavior::SLEEP);
+
+        bool threaded_sorted = false;
+        const double threaded_ms = measure_sort_time(
+            unsorted_keys,
+            [&](std::vector<DrawKey>& keys) { sort_draw_keys(keys, scratch, &scheduler); },
+            threaded_sorted);
+
+        std::cout << NUM_KEYS << " keys, " << scheduler.get_num_threads() << " sorting threads" << std::endl;
+        print_result("std::sort", std_ms, std_sorted);
+        print_result("Radix sort", radix_ms, radix_sorted);
+        print_result("Radix sort, multithreaded", threaded_ms, threaded_sorted);
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::main(); }
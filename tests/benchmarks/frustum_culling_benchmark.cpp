@@ -0,0 +1,146 @@
+/*!
+ * \brief Measures how quickly a million renderables can be frustum culled, one box at a time, with SIMD, with SIMD on every core, and
+ * through the spatial index that static renderables live in
+ *
+ * The renderables are scattered through a world that's much wider than it is tall, like a voxel world, and only a few percent of them
+ * end up in the frustum
+ */
+
+#include "../src/general_test_setup.hpp"
+
+#undef TEST
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "nova_renderer/culling.hpp"
+
+#include "../../src/render_objects/spatial_index.hpp"
+#include "../../src/tasks/task_scheduler.hpp"
+
+namespace nova::renderer {
+    constexpr uint32_t NUM_RENDERABLES = 1000000;
+    constexpr uint32_t CHUNK_SIZE = 1024;
+    constexpr uint32_t NUM_ITERATIONS = 20;
+
+    glm::mat4 make_view_projection() {
+        // A 90 degree perspective projection looking down -Z, with a depth range of [0, 1]
+        constexpr float NEAR_PLANE = 0.1F;
+        constexpr float FAR_PLANE = 500.0F;
+
+        glm::mat4 projection(0.0F);
+        projection[0][0] = 1.0F;
+        projection[1][1] = 1.0F;
+        projection[2][2] = FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+        projection[2][3] = -1.0F;
+        projection[3][2] = NEAR_PLANE * FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+        return projection;
+    }
+
+    template <typename CullFunc>
+    double measure_culling_time(CullFunc&& cull, uint32_t& num_visible) {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        for(uint32_t iteration = 0; iteration < NUM_ITERATIONS; iteration++) {
+            num_visible = cull();
+        }
+        const auto end_time = std::chrono::high_resolution_clock::now();
+
+        const std::chrono::duration<double, std::milli> total_time = end_time - start_time;
+        return total_time.count() / NUM_ITERATIONS;
+    }
+
+    void print_result(const char* name, const double time_ms, const uint32_t num_visible) {
+        std::cout << name << ": " << time_ms << " ms (" << NUM_RENDERABLES / time_ms / 1000.0 << " million renderables per second, "
+                  << num_visible << " visible)" << std::endl;
+    }
+
+    int main() {
+        TEST_SETUP_LOGGER();
+
+        std::srand(1234);
+        const auto random_float = [] { return static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 2.0F - 1.0F; };
+
+        AabbList aabbs;
+        std::vector<uint8_t> enabled(NUM_RENDERABLES, 1);
+        for(uint32_t i = 0; i < NUM_RENDERABLES; i++) {
+            const glm::vec3 center(random_float() * 2000.0F, random_float() * 250.0F, random_float() * 2000.0F);
+            aabbs.push_back({glm::vec3(center.x - 1.0F, center.y - 1.0F, center.z - 1.0F),
+                             glm::vec3(center.x + 1.0F, center.y + 1.0F, center.z + 1.0F)});
+        }
+
+        const Frustum frustum = make_frustum(make_view_projection());
+        std::vector<uint32_t> visible_indices(NUM_RENDERABLES);
+
+        uint32_t num_scalar_visible = 0;
+        const double scalar_ms = measure_culling_time(
+            [&] { return cull_aabbs_scalar(frustum, aabbs, 0, NUM_RENDERABLES, enabled.data(), visible_indices.data()); },
+            num_scalar_visible);
+
+        uint32_t num_simd_visible = 0;
+        const double simd_ms = measure_culling_time(
+            [&] { return cull_aabbs(frustum, aabbs, 0, NUM_RENDERABLES, enabled.data(), visible_indices.data()); },
+            num_simd_visible);
+
+        // The same split that the renderer uses: chunks are culled on their own and write to their own part of the output
+        const uint32_t num_cores = std::thread::hardware_concurrency();
+        ttl::task_scheduler scheduler(num_cores > 1 ? num_cores - 1 : 1, ttl::empty_queue_behavior::SLEEP);
+
+        const uint32_t num_chunks = (NUM_RENDERABLES + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        std::vector<uint32_t> num_visible_per_chunk(num_chunks);
+
+        uint32_t num_threaded_visible = 0;
+        const double threaded_ms = measure_culling_time(
+            [&] {
+                ttl::condition_counter chunks_remaining;
+                for(uint32_t chunk_index = 0; chunk_index < num_chunks; chunk_index++) {
+                    scheduler.add_task(&chunks_remaining, [&, chunk_index](ttl::task_scheduler* /* scheduler */) {
+                        const uint32_t chunk_start = chunk_index * CHUNK_SIZE;
+                        const uint32_t chunk_end = std::min(chunk_start + CHUNK_SIZE, NUM_RENDERABLES);
+                        num_visible_per_chunk[chunk_index] = cull_aabbs(frustum,
+                                                                        aabbs,
+                                                                        chunk_start,
+                                                                        chunk_end,
+                                                                        enabled.data(),
+                                                                        &visible_indices[chunk_start]);
+                    });
+                }
+                chunks_remaining.wait_for_value(0);
+
+                uint32_t num_visible = 0;
+                for(const uint32_t num_visible_in_chunk : num_visible_per_chunk) {
+                    num_visible += num_visible_in_chunk;
+                }
+                return num_visible;
+            },
+            num_threaded_visible);
+
+        SpatialIndex index;
+        for(uint32_t i = 0; i < NUM_RENDERABLES; i++) {
+            index.insert(i, aabbs.get(i));
+        }
+
+        std::vector<RenderableId> visible_ids;
+        uint32_t num_index_visible = 0;
+        const double index_ms = measure_culling_time(
+            [&] {
+                visible_ids.clear();
+                index.query_frustum(frustum, visible_ids);
+                return static_cast<uint32_t>(visible_ids.size());
+            },
+            num_index_visible);
+
+        std::cout << NUM_RENDERABLES << " renderables, " << scheduler.get_num_threads() << " culling threads" << std::endl;
+        print_result("Scalar", scalar_ms, num_scalar_visible);
+        print_result("SIMD", simd_ms, num_simd_visible);
+        print_result("SIMD, multithreaded", threaded_ms, num_threaded_visible);
+        print_result("Spatial index", index_ms, num_index_visible);
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::main(); }
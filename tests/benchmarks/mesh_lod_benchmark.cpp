@@ -0,0 +1,135 @@
+/*!
+ * \brief Measures how much geometry LOD selection saves when flying over a world of chunks, and how much hysteresis cuts down on LOD
+ * switches
+ *
+ * Every chunk draws the same mesh, which has four LODs that each have a quarter of the indices and vertices of the LOD before them. The
+ * camera flies across the world with a small wobble back and forth, like a player that's walking, so chunks near a LOD threshold cross it
+ * over and over
+ */
+
+#include "../src/general_test_setup.hpp"
+
+#undef TEST
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "nova_renderer/culling.hpp"
+
+namespace nova::renderer {
+    constexpr uint32_t GRID_SIZE = 128;
+    constexpr float CHUNK_SIZE = 16.0F;
+    constexpr uint32_t NUM_FRAMES = 600;
+
+    constexpr uint32_t NUM_LODS = 4;
+
+    /*!
+     * \brief How many vertices each LOD uses. LODs share one vertex buffer, so this is how many vertices the GPU transforms for each LOD
+     */
+    constexpr std::array<uint32_t, NUM_LODS> LOD_VERTEX_COUNTS = {4096, 1024, 256, 64};
+
+    const std::array<MeshLod, NUM_LODS> LODS = {MeshLod{0, 6144, 0.3F},
+                                                MeshLod{6144, 1536, 0.12F},
+                                                MeshLod{7680, 384, 0.05F},
+                                                MeshLod{8064, 96, 0.0F}};
+
+    glm::mat4 make_projection() {
+        // A 90 degree perspective projection looking down -Z, with a depth range of [0, 1]
+        constexpr float NEAR_PLANE = 0.1F;
+        constexpr float FAR_PLANE = 1000.0F;
+
+        glm::mat4 projection(0.0F);
+        projection[0][0] = 1.0F;
+        projection[1][1] = 1.0F;
+        projection[2][2] = FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+        projection[2][3] = -1.0F;
+        projection[3][2] = NEAR_PLANE * FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+        return projection;
+    }
+
+    glm::mat4 get_view_projection(const uint32_t frame) {
+        const float distance_flown = static_cast<float>(frame) * 0.5F + std::sin(static_cast<float>(frame) * 0.8F) * 3.0F;
+        const glm::vec3 camera_position(GRID_SIZE * CHUNK_SIZE * 0.5F, 40.0F, GRID_SIZE * CHUNK_SIZE - distance_flown);
+
+        return make_projection() * glm::translate(glm::mat4(1.0F), -camera_position);
+    }
+
+    struct LodRunResult {
+        double ms_per_frame = 0;
+        uint64_t num_visible = 0;
+        uint64_t num_indices = 0;
+        uint64_t num_vertices = 0;
+        uint64_t num_lod_switches = 0;
+    };
+
+    LodRunResult fly_over_world(const AabbList& chunks, const bool use_lods, const float hysteresis) {
+        LodRunResult result;
+
+        std::vector<uint8_t> chunk_lods(chunks.size(), 0);
+        std::vector<uint32_t> visible_indices(chunks.size());
+
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        for(uint32_t frame = 0; frame < NUM_FRAMES; frame++) {
+            const glm::mat4 view_projection = get_view_projection(frame);
+            const Frustum frustum = make_frustum(view_projection);
+            const LodSelector selector = use_lods ? make_lod_selector(view_projection, hysteresis) : LodSelector{};
+
+            const uint32_t num_visible = cull_aabbs(frustum, chunks, 0, chunks.size(), nullptr, visible_indices.data());
+            result.num_visible += num_visible;
+
+            for(uint32_t i = 0; i < num_visible; i++) {
+                const uint32_t chunk = visible_indices[i];
+                const float screen_size = selector.get_screen_size(chunks.get(chunk));
+                const uint32_t lod = selector.select_lod(screen_size, chunk_lods[chunk], LODS.data(), NUM_LODS);
+
+                if(lod != chunk_lods[chunk]) {
+                    result.num_lod_switches++;
+                    chunk_lods[chunk] = static_cast<uint8_t>(lod);
+                }
+
+                result.num_indices += LODS[lod].num_indices;
+                result.num_vertices += LOD_VERTEX_COUNTS[lod];
+            }
+        }
+        const auto end_time = std::chrono::high_resolution_clock::now();
+
+        const std::chrono::duration<double, std::milli> total_time = end_time - start_time;
+        result.ms_per_frame = total_time.count() / NUM_FRAMES;
+
+        return result;
+    }
+
+    void print_result(const char* name, const LodRunResult& result) {
+        std::cout << name << ": " << result.num_visible / NUM_FRAMES << " visible chunks, " << result.num_indices / NUM_FRAMES
+                  << " indices and " << result.num_vertices / NUM_FRAMES << " vertices per frame, " << result.num_lod_switches
+                  << " LOD switches, " << result.ms_per_frame << " ms per frame to cull and select LODs" << std::endl;
+    }
+
+    int main() {
+        TEST_SETUP_LOGGER();
+
+        AabbList chunks;
+        for(uint32_t z = 0; z < GRID_SIZE; z++) {
+            for(uint32_t x = 0; x < GRID_SIZE; x++) {
+                const glm::vec3 min(static_cast<float>(x) * CHUNK_SIZE, 0.0F, static_cast<float>(z) * CHUNK_SIZE);
+                chunks.push_back({min, glm::vec3(min.x + CHUNK_SIZE, CHUNK_SIZE, min.z + CHUNK_SIZE)});
+            }
+        }
+
+        const LodRunResult without_lods = fly_over_world(chunks, false, 0.0F);
+        const LodRunResult with_lods = fly_over_world(chunks, true, 0.0F);
+        const LodRunResult with_hysteresis = fly_over_world(chunks, true, 0.1F);
+
+        std::cout << chunks.size() << " chunks, " << NUM_FRAMES << " frames" << std::endl;
+        print_result("Without LODs", without_lods);
+        print_result("LODs without hysteresis", with_lods);
+        print_result("LODs with 10% hysteresis", with_hysteresis);
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::main(); }
@@ -0,0 +1,163 @@
+/*!
+ * \brief Prints how well a few kinds of meshes use the vertex cache before and after each mesh optimization, and how long the
+ * optimizations take
+ *
+ * Everything is simulated on the CPU, so this doesn't need a GPU. ACMR is the average number of vertices transformed per triangle, and
+ * ATVR is the average number of times each vertex is transformed, both with a 16-entry FIFO cache
+ */
+
+#include "../src/general_test_setup.hpp"
+
+#undef TEST
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../../src/render_objects/mesh_optimizer.hpp"
+
+namespace nova::renderer {
+    FullVertex make_vertex(const glm::vec3& position) {
+        FullVertex vertex{};
+        vertex.position = position;
+        return vertex;
+    }
+
+    /*!
+     * \brief Shuffles a mesh's triangles, like a mesh that was built in no particular order
+     */
+    void shuffle_triangles(MeshData& mesh) {
+        std::srand(1234);
+
+        const size_t num_triangles = mesh.indices.size() / 3;
+        for(size_t i = num_triangles - 1; i > 0; i--) {
+            const size_t other = static_cast<size_t>(std::rand()) % (i + 1);
+            std::swap_ranges(&mesh.indices[i * 3], &mesh.indices[i * 3 + 3], &mesh.indices[other * 3]);
+        }
+    }
+
+    MeshData make_grid(const uint32_t size) {
+        MeshData mesh;
+        for(uint32_t y = 0; y <= size; y++) {
+            for(uint32_t x = 0; x <= size; x++) {
+                mesh.vertex_data.push_back(make_vertex(glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0F)));
+            }
+        }
+
+        for(uint32_t y = 0; y < size; y++) {
+            for(uint32_t x = 0; x < size; x++) {
+                const uint32_t corner = y * (size + 1) + x;
+                mesh.indices.insert(mesh.indices.end(), {corner, corner + 1, corner + size + 1});
+                mesh.indices.insert(mesh.indices.end(), {corner + 1, corner + size + 2, corner + size + 1});
+            }
+        }
+
+        return mesh;
+    }
+
+    MeshData make_sphere(const uint32_t num_rings, const uint32_t num_segments) {
+        MeshData mesh;
+        for(uint32_t ring = 0; ring <= num_rings; ring++) {
+            const float polar_angle = 3.14159265F * static_cast<float>(ring) / static_cast<float>(num_rings);
+            for(uint32_t segment = 0; segment <= num_segments; segment++) {
+                const float azimuth = 2.0F * 3.14159265F * static_cast<float>(segment) / static_cast<float>(num_segments);
+                mesh.vertex_data.push_back(make_vertex(glm::vec3(std::sin(polar_angle) * std::cos(azimuth),
+                                                                 std::cos(polar_angle),
+                                                                 std::sin(polar_angle) * std::sin(azimuth))));
+            }
+        }
+
+        for(uint32_t ring = 0; ring < num_rings; ring++) {
+            for(uint32_t segment = 0; segment < num_segments; segment++) {
+                const uint32_t corner = ring * (num_segments + 1) + segment;
+                mesh.indices.insert(mesh.indices.end(), {corner, corner + num_segments + 1, corner + 1});
+                mesh.indices.insert(mesh.indices.end(), {corner + 1, corner + num_segments + 1, corner + num_segments + 2});
+            }
+        }
+
+        return mesh;
+    }
+
+    /*!
+     * \brief A chunk full of cubes that each have their own vertices, like a voxel chunk mesh without its hidden faces removed
+     */
+    MeshData make_chunk(const uint32_t size) {
+        MeshData mesh;
+        for(uint32_t z = 0; z < size; z++) {
+            for(uint32_t y = 0; y < size; y++) {
+                for(uint32_t x = 0; x < size; x++) {
+                    const auto first_vertex = static_cast<uint32_t>(mesh.vertex_data.size());
+                    for(uint32_t corner = 0; corner < 8; corner++) {
+                        mesh.vertex_data.push_back(make_vertex(glm::vec3(static_cast<float>(x + (corner & 1)),
+                                                                         static_cast<float>(y + ((corner >> 1) & 1)),
+                                                                         static_cast<float>(z + ((corner >> 2) & 1)))));
+                    }
+
+                    const std::vector<uint32_t> cube_indices = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                                                                2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+                    for(const uint32_t index : cube_indices) {
+                        mesh.indices.push_back(first_vertex + index);
+                    }
+                }
+            }
+        }
+
+        return mesh;
+    }
+
+    void print_stats(const char* name, const MeshData& mesh, const double time_ms) {
+        const VertexCacheStats stats = analyze_vertex_cache(mesh.indices.data(),
+                                                            mesh.indices.size(),
+                                                            static_cast<uint32_t>(mesh.vertex_data.size()));
+        std::cout << "    " << name << ": ACMR " << stats.acmr << ", ATVR " << stats.atvr;
+        if(time_ms > 0) {
+            std::cout << " (" << time_ms << " ms)";
+        }
+        std::cout << std::endl;
+    }
+
+    template <typename OptimizeFunc>
+    double measure_time(OptimizeFunc&& optimize) {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        optimize();
+        const auto end_time = std::chrono::high_resolution_clock::now();
+
+        const std::chrono::duration<double, std::milli> total_time = end_time - start_time;
+        return total_time.count();
+    }
+
+    void report_mesh(const char* name, MeshData mesh) {
+        const auto num_vertices = static_cast<uint32_t>(mesh.vertex_data.size());
+
+        std::cout << name << ": " << num_vertices << " vertices, " << mesh.indices.size() / 3 << " triangles" << std::endl;
+        print_stats("As built", mesh, 0);
+
+        shuffle_triangles(mesh);
+        print_stats("Shuffled", mesh, 0);
+
+        const double cache_ms = measure_time([&] { optimize_vertex_cache(mesh.indices.data(), mesh.indices.size(), num_vertices); });
+        print_stats("Vertex cache optimized", mesh, cache_ms);
+
+        const double overdraw_ms = measure_time([&] {
+            optimize_overdraw(mesh.indices.data(), mesh.indices.size(), mesh.vertex_data.data(), num_vertices, 1.05F);
+        });
+        print_stats("Overdraw optimized", mesh, overdraw_ms);
+
+        const double fetch_ms = measure_time([&] { optimize_vertex_fetch(mesh.vertex_data, mesh.indices.data(), mesh.indices.size()); });
+        print_stats("Vertex fetch optimized", mesh, fetch_ms);
+    }
+
+    int main() {
+        TEST_SETUP_LOGGER();
+
+        report_mesh("Grid", make_grid(256));
+        report_mesh("Sphere", make_sphere(128, 256));
+        report_mesh("Chunk", make_chunk(16));
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::main(); }
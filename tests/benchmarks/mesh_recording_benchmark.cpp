@@ -0,0 +1,94 @@
+/*!
+ * \brief Measures how long Nova takes to record and submit frames with lots of distinct meshes
+ *
+ * Every mesh is a slightly different cube with a single renderable, so every mesh is its own draw. This is the worst case for
+ * Nova's binding behavior, which makes it a good way to see what the geometry arena buys us
+ */
+
+#include "../src/general_test_setup.hpp"
+
+#undef TEST
+
+#include <array>
+#include <chrono>
+#include <iostream>
+
+#include "nova_renderer/window.hpp"
+
+namespace nova::renderer {
+    constexpr uint32_t NUM_WARMUP_FRAMES = 3;
+    constexpr uint32_t NUM_MEASURED_FRAMES = 30;
+
+    MeshData make_cube(const uint32_t seed) {
+        // Scale the cube a tiny bit per mesh so that no two meshes have the same data
+        const float size = 1.0F + static_cast<float>(seed % 1024) / 1024.0F;
+
+        MeshData cube = {};
+        cube.vertex_data = {
+            FullVertex{{-size, -size, -size}, {}, {}, {}, {}, {}, {}},
+            FullVertex{{-size, -size, size}, {}, {}, {}, {}, {}, {}},
+            FullVertex{{-size, size, -size}, {}, {}, {}, {}, {}, {}},
+            FullVertex{{-size, size, size}, {}, {}, {}, {}, {}, {}},
+            FullVertex{{size, -size, -size}, {}, {}, {}, {}, {}, {}},
+            FullVertex{{size, -size, size}, {}, {}, {}, {}, {}, {}},
+            FullVertex{{size, size, -size}, {}, {}, {}, {}, {}, {}},
+            FullVertex{{size, size, size}, {}, {}, {}, {}, {}, {}},
+        };
+        cube.indices = {0, 1, 3, 6, 0, 2, 5, 0, 4, 6, 4, 0, 0, 3, 2, 5, 1, 0, 3, 1, 5, 7, 4, 6, 4, 7, 5, 7, 6, 2, 7, 2, 3, 7, 3, 5};
+
+        return cube;
+    }
+
+    int main() {
+        TEST_SETUP_LOGGER();
+
+        NovaSettings settings;
+        settings.vulkan.application_name = "Nova Renderer mesh recording benchmark";
+        settings.vulkan.application_version = {0, 9, 0};
+        settings.window.width = 640;
+        settings.window.height = 480;
+
+        auto* renderer = NovaRenderer::initialize(settings);
+
+        renderer->load_shaderpack(CMAKE_DEFINED_RESOURCES_PREFIX "shaderpacks/DefaultShaderpack");
+
+        Window& window = renderer->get_engine()->get_window();
+
+        const std::array<uint32_t, 3> mesh_counts = {10000, 50000, 200000};
+        renderer->set_num_meshes(mesh_counts.back());
+
+        uint32_t num_meshes = 0;
+        for(const uint32_t mesh_count : mesh_counts) {
+            for(; num_meshes < mesh_count; num_meshes++) {
+                const MeshId mesh_id = renderer->create_mesh(make_cube(num_meshes));
+
+                StaticMeshRenderableData data = {};
+                data.mesh = mesh_id;
+                data.position = glm::vec3(num_meshes % 256, (num_meshes / 256) % 256, -5.0F - num_meshes / 65536);
+
+                renderer->add_renderable_for_material(FullMaterialPassName{"gbuffers_terrain", "forward"}, data);
+            }
+
+            for(uint32_t i = 0; i < NUM_WARMUP_FRAMES; i++) {
+                renderer->execute_frame();
+                window.on_frame_end();
+            }
+
+            const auto start_time = std::chrono::high_resolution_clock::now();
+            for(uint32_t i = 0; i < NUM_MEASURED_FRAMES; i++) {
+                renderer->execute_frame();
+                window.on_frame_end();
+            }
+            const auto end_time = std::chrono::high_resolution_clock::now();
+
+            const std::chrono::duration<double, std::milli> total_time = end_time - start_time;
+            std::cout << num_meshes << " meshes: " << total_time.count() / NUM_MEASURED_FRAMES << " ms per frame" << std::endl;
+        }
+
+        NovaRenderer::deinitialize();
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::main(); }
@@ -0,0 +1,181 @@
+/*!
+ * \brief Measures how long it takes to load a shaderpack, with and without the shader cache, and with different numbers of threads
+ *
+ * The shader cache is measured with the default shaderpack, loaded on one thread. A cold load compiles every shader and saves it to the
+ * cache, so it's a bit slower than not having a cache at all. A warm load is what every load after the first one is like, and shouldn't
+ * run glslang at all
+ *
+ * The default shaderpack is also loaded from a zip file and from a baked shaderpack bundle. A bundle is mapped and read in place, without
+ * parsing JSON or running glslang, so it should be the fastest of them all
+ *
+ * The default shaderpack only has a handful of shaders, so threading is measured with a copy of it that has every pipeline many times
+ * over, without the shader cache
+ */
+
+#include "../src/general_test_setup.hpp"
+
+#undef TEST
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include <miniz.h>
+
+#include "../../src/loading/shaderpack/shader_cache.hpp"
+#include "../../src/loading/shaderpack/shaderpack_bundle.hpp"
+#include "../../src/loading/shaderpack/shaderpack_loading.hpp"
+#include "../../src/tasks/task_scheduler.hpp"
+
+namespace nova::renderer {
+    constexpr uint32_t NUM_ITERATIONS = 10;
+
+    constexpr uint32_t NUM_PIPELINE_COPIES = 32;
+
+    const fs::path SHADERPACK_PATH = CMAKE_DEFINED_RESOURCES_PREFIX "shaderpacks/DefaultShaderpack";
+
+    template <typename LoadFunc>
+    double measure_load_time(LoadFunc&& load) {
+        double total_ms = 0;
+        for(uint32_t iteration = 0; iteration < NUM_ITERATIONS; iteration++) {
+            const auto start_time = std::chrono::high_resolution_clock::now();
+            load(iteration);
+            const auto end_time = std::chrono::high_resolution_clock::now();
+
+            const std::chrono::duration<double, std::milli> load_time = end_time - start_time;
+            total_ms += load_time.count();
+        }
+
+        return total_ms / NUM_ITERATIONS;
+    }
+
+    /*!
+     * \brief Copies the default shaderpack to the given folder, with NUM_PIPELINE_COPIES copies of each pipeline
+     */
+    void make_large_shaderpack(const fs::path& folder) {
+        fs::create_directories(folder);
+        fs::copy(SHADERPACK_PATH, folder, fs::copy_options::recursive);
+
+        for(const fs::directory_entry& entry : fs::directory_iterator(SHADERPACK_PATH / "materials")) {
+            if(entry.path().extension() != ".pipeline") {
+                continue;
+            }
+
+            for(uint32_t copy = 1; copy < NUM_PIPELINE_COPIES; copy++) {
+                const std::string copy_name = entry.path().stem().string() + "_" + std::to_string(copy) + ".pipeline";
+                fs::copy_file(entry.path(), folder / "materials" / copy_name);
+            }
+        }
+    }
+
+    /*!
+     * \brief Zips the default shaderpack, so that it can be loaded from a zip file with the same contents as its folder
+     */
+    bool make_zipped_shaderpack(const fs::path& zip_path) {
+        for(const fs::directory_entry& entry : fs::recursive_directory_iterator(SHADERPACK_PATH)) {
+            if(!entry.is_regular_file()) {
+                continue;
+            }
+
+            std::ifstream file(entry.path(), std::ios::binary);
+            const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            const std::string archive_name = fs::relative(entry.path(), SHADERPACK_PATH).generic_string();
+            if(!mz_zip_add_mem_to_archive_file_in_place(zip_path.string().c_str(),
+                                                        archive_name.c_str(),
+                                                        contents.data(),
+                                                        contents.size(),
+                                                        nullptr,
+                                                        0,
+                                                        MZ_DEFAULT_LEVEL)) {
+                std::cerr << "Could not add " << archive_name << " to " << zip_path.string() << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    int main() {
+        TEST_SETUP_LOGGER();
+
+        shaderpack::initialize_glslang();
+
+        const fs::path benchmark_folder = fs::temp_directory_path() / "nova_shaderpack_loading_benchmark";
+        fs::remove_all(benchmark_folder);
+
+        const fs::path cache_folder = benchmark_folder / "cache";
+
+        const double uncached_ms = measure_load_time([](uint32_t /* iteration */) { shaderpack::load_shaderpack_data(SHADERPACK_PATH); });
+
+        // Every cold load gets a new folder, so that it has to compile every shader
+        uint32_t num_cold_hits = 0;
+        uint32_t num_cold_misses = 0;
+        const double cold_ms = measure_load_time([&](const uint32_t iteration) {
+            shaderpack::ShaderCache cache(cache_folder / std::to_string(iteration));
+            shaderpack::load_shaderpack_data(SHADERPACK_PATH, &cache);
+            num_cold_hits += cache.get_num_hits();
+            num_cold_misses += cache.get_num_misses();
+        });
+
+        // Every warm load opens the cache again, like a new run of the program would
+        uint32_t num_warm_hits = 0;
+        uint32_t num_warm_misses = 0;
+        const double warm_ms = measure_load_time([&](uint32_t /* iteration */) {
+            shaderpack::ShaderCache cache(cache_folder / "0");
+            shaderpack::load_shaderpack_data(SHADERPACK_PATH, &cache);
+            num_warm_hits += cache.get_num_hits();
+            num_warm_misses += cache.get_num_misses();
+        });
+
+        std::cout << "Loading " << SHADERPACK_PATH.string() << ", " << NUM_ITERATIONS << " times each" << std::endl;
+        std::cout << "No cache: " << uncached_ms << " ms" << std::endl;
+        std::cout << "Cold cache: " << cold_ms << " ms (" << num_cold_hits / NUM_ITERATIONS << " shaders loaded from the cache, "
+                  << num_cold_misses / NUM_ITERATIONS << " compiled)" << std::endl;
+        std::cout << "Warm cache: " << warm_ms << " ms (" << num_warm_hits / NUM_ITERATIONS << " shaders loaded from the cache, "
+                  << num_warm_misses / NUM_ITERATIONS << " compiled)" << std::endl;
+
+        const fs::path zip_path = benchmark_folder / "DefaultShaderpack.zip";
+        if(!make_zipped_shaderpack(zip_path)) {
+            return 1;
+        }
+        const double zip_ms = measure_load_time([&](uint32_t /* iteration */) { shaderpack::load_shaderpack_data(zip_path); });
+
+        const fs::path bundle_path = benchmark_folder / (std::string("DefaultShaderpack") + shaderpack::SHADERPACK_BUNDLE_EXTENSION);
+        if(!shaderpack::write_shaderpack_bundle(shaderpack::load_shaderpack_data(SHADERPACK_PATH), bundle_path)) {
+            return 1;
+        }
+        const double bundle_ms = measure_load_time([&](uint32_t /* iteration */) { shaderpack::load_shaderpack_data(bundle_path); });
+
+        std::cout << std::endl << "Loading the default shaderpack from different kinds of files, with no cache" << std::endl;
+        std::cout << "Folder: " << uncached_ms << " ms" << std::endl;
+        std::cout << "Zip file: " << zip_ms << " ms" << std::endl;
+        std::cout << "Bundle: " << bundle_ms << " ms (" << fs::file_size(bundle_path) << " bytes, " << uncached_ms / bundle_ms
+                  << "x as fast as the folder)" << std::endl;
+
+        const fs::path large_shaderpack_path = benchmark_folder / "LargeShaderpack";
+        make_large_shaderpack(large_shaderpack_path);
+
+        const double single_threaded_ms = measure_load_time(
+            [&](uint32_t /* iteration */) { shaderpack::load_shaderpack_data(large_shaderpack_path); });
+
+        std::cout << std::endl << "Loading the default shaderpack with " << NUM_PIPELINE_COPIES << " copies of each pipeline" << std::endl;
+        std::cout << "This thread: " << single_threaded_ms << " ms" << std::endl;
+
+        const uint32_t num_cores = std::thread::hardware_concurrency();
+        for(uint32_t num_threads = 1; num_threads <= num_cores; num_threads *= 2) {
+            ttl::task_scheduler scheduler(num_threads, ttl::empty_queue_behavior::SLEEP);
+            const double threaded_ms = measure_load_time(
+                [&](uint32_t /* iteration */) { shaderpack::load_shaderpack_data(large_shaderpack_path, nullptr, &scheduler); });
+
+            std::cout << num_threads << " worker threads: " << threaded_ms << " ms (" << single_threaded_ms / threaded_ms
+                      << "x as fast as this thread)" << std::endl;
+        }
+
+        fs::remove_all(benchmark_folder);
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::main(); }
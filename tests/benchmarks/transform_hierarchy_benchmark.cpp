@@ -0,0 +1,149 @@
+/*!
+ * \brief Measures how many world matrices the transform hierarchy recomputes each frame, and how long that takes, when a few entities
+ * move every frame
+ *
+ * The scene is a thousand entities with a hundred child transforms each, like mobs with bones or vehicles with parts. Every frame a tenth
+ * of the entities move. That's compared to recomputing every world matrix every frame, which is what happens when nothing keeps track of
+ * which transforms changed
+ */
+
+#include "../src/general_test_setup.hpp"
+
+#undef TEST
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../../src/render_objects/transform_hierarchy.hpp"
+#include "../../src/tasks/task_scheduler.hpp"
+
+namespace nova::renderer {
+    constexpr uint32_t NUM_ENTITIES = 1000;
+    constexpr uint32_t NUM_CHILDREN_PER_ENTITY = 100;
+    constexpr uint32_t NUM_MOVED_ENTITIES_PER_FRAME = NUM_ENTITIES / 10;
+    constexpr uint32_t NUM_FRAMES = 200;
+
+    struct Scene {
+        TransformHierarchy hierarchy;
+
+        std::vector<TransformId> entities;
+
+        std::vector<TransformId> all_transforms;
+
+        std::vector<TransformData> all_transform_data;
+    };
+
+    void add_transform(Scene& scene, const TransformData& data, const RenderableId renderable) {
+        scene.all_transforms.push_back(scene.hierarchy.add(data, renderable));
+        scene.all_transform_data.push_back(data);
+    }
+
+    void build_scene(Scene& scene) {
+        const auto random_float = [] { return static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 2.0F - 1.0F; };
+
+        RenderableId renderable = 0;
+        for(uint32_t entity = 0; entity < NUM_ENTITIES; entity++) {
+            TransformData entity_data;
+            entity_data.position = glm::vec3(random_float() * 500.0F, random_float() * 50.0F, random_float() * 500.0F);
+            entity_data.rotation = glm::vec3(0.0F, random_float() * 3.14F, 0.0F);
+            add_transform(scene, entity_data, renderable++);
+            scene.entities.push_back(scene.all_transforms.back());
+
+            // Each entity's children are a chain of four deep, so the hierarchy has five levels
+            TransformId parent = scene.entities.back();
+            for(uint32_t child = 0; child < NUM_CHILDREN_PER_ENTITY; child++) {
+                TransformData child_data;
+                child_data.position = glm::vec3(random_float(), random_float(), random_float());
+                child_data.rotation = glm::vec3(random_float(), random_float(), random_float());
+                child_data.parent = child % 4 == 0 ? scene.entities.back() : parent;
+                add_transform(scene, child_data, renderable++);
+                parent = scene.all_transforms.back();
+            }
+        }
+
+        scene.hierarchy.update();
+    }
+
+    template <typename FrameFunc>
+    double measure_frame_time(FrameFunc&& run_frame, uint32_t& num_recomputed_per_frame) {
+        uint64_t total_recomputed = 0;
+
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        for(uint32_t frame = 0; frame < NUM_FRAMES; frame++) {
+            total_recomputed += run_frame(frame);
+        }
+        const auto end_time = std::chrono::high_resolution_clock::now();
+
+        num_recomputed_per_frame = static_cast<uint32_t>(total_recomputed / NUM_FRAMES);
+
+        const std::chrono::duration<double, std::milli> total_time = end_time - start_time;
+        return total_time.count() / NUM_FRAMES;
+    }
+
+    void print_result(const char* name, const double time_ms, const uint32_t num_recomputed_per_frame) {
+        std::cout << name << ": " << time_ms << " ms per frame, " << num_recomputed_per_frame << " world matrices recomputed per frame"
+                  << std::endl;
+    }
+
+    int main() {
+        TEST_SETUP_LOGGER();
+
+        std::srand(1234);
+
+        Scene scene;
+        build_scene(scene);
+
+        const auto move_entities = [&](const uint32_t frame) {
+            for(uint32_t i = 0; i < NUM_MOVED_ENTITIES_PER_FRAME; i++) {
+                const uint32_t entity = (frame * NUM_MOVED_ENTITIES_PER_FRAME + i) % NUM_ENTITIES;
+                TransformData& data = scene.all_transform_data[entity * (NUM_CHILDREN_PER_ENTITY + 1)];
+                data.position.x += 0.1F;
+                scene.hierarchy.set_local_transform(scene.entities[entity], data);
+            }
+        };
+
+        uint32_t num_dirty_recomputed = 0;
+        const double dirty_ms = measure_frame_time(
+            [&](const uint32_t frame) {
+                move_entities(frame);
+                return scene.hierarchy.update();
+            },
+            num_dirty_recomputed);
+
+        const uint32_t num_cores = std::thread::hardware_concurrency();
+        ttl::task_scheduler scheduler(num_cores > 1 ? num_cores - 1 : 1, ttl::empty_queue_behavior::SLEEP);
+
+        uint32_t num_threaded_recomputed = 0;
+        const double threaded_ms = measure_frame_time(
+            [&](const uint32_t frame) {
+                move_entities(frame);
+                return scene.hierarchy.update(&scheduler);
+            },
+            num_threaded_recomputed);
+
+        // Setting every transform marks everything dirty, like a renderer that rebuilds every model matrix every frame
+        uint32_t num_full_recomputed = 0;
+        const double full_ms = measure_frame_time(
+            [&](const uint32_t frame) {
+                move_entities(frame);
+                for(uint32_t i = 0; i < scene.all_transforms.size(); i++) {
+                    scene.hierarchy.set_local_transform(scene.all_transforms[i], scene.all_transform_data[i]);
+                }
+                return scene.hierarchy.update(&scheduler);
+            },
+            num_full_recomputed);
+
+        std::cout << scene.hierarchy.size() << " transforms, " << NUM_MOVED_ENTITIES_PER_FRAME << " entities moved per frame, "
+                  << scheduler.get_num_threads() << " worker threads" << std::endl;
+        print_result("Dirty transforms", dirty_ms, num_dirty_recomputed);
+        print_result("Dirty transforms, multithreaded", threaded_ms, num_threaded_recomputed);
+        print_result("Every transform, multithreaded", full_ms, num_full_recomputed);
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::main(); }
@@ -0,0 +1,143 @@
+/*!
+ * \brief Measures how quickly chunk vertices can be converted to `CompactVertex`es, and how much memory that saves
+ *
+ * Nova doesn't have any chunk data of its own, so this benchmark builds chunk meshes the way a Minecraft-style mesher would: a 16x256x16
+ * column of blocks with a rolling heightmap, and a quad for every block face that touches air
+ */
+
+#include "../src/general_test_setup.hpp"
+
+#undef TEST
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "nova_renderer/vertex_formats.hpp"
+
+namespace nova::renderer {
+    constexpr uint32_t CHUNK_WIDTH = 16;
+    constexpr uint32_t CHUNK_HEIGHT = 256;
+    constexpr uint32_t NUM_CHUNKS = 64;
+    constexpr uint32_t NUM_ITERATIONS = 20;
+
+    uint32_t terrain_height(const int32_t x, const int32_t z) {
+        const float height = 64.0F + 12.0F * std::sin(static_cast<float>(x) * 0.11F) + 9.0F * std::cos(static_cast<float>(z) * 0.07F) +
+                             3.0F * std::sin(static_cast<float>(x + z) * 0.53F);
+        return static_cast<uint32_t>(height);
+    }
+
+    void add_face(std::vector<FullVertex>& vertices,
+                  const glm::vec3& block_position,
+                  const glm::vec3& normal,
+                  const glm::vec3& tangent,
+                  const glm::vec3& bitangent,
+                  const uint32_t block_id) {
+        // The face's center is half a block out from the block's center, along the normal
+        const glm::vec3 center(block_position.x + 0.5F + normal.x * 0.5F,
+                               block_position.y + 0.5F + normal.y * 0.5F,
+                               block_position.z + 0.5F + normal.z * 0.5F);
+
+        const float corners[4][2] = {{-0.5F, -0.5F}, {0.5F, -0.5F}, {0.5F, 0.5F}, {-0.5F, 0.5F}};
+        for(const auto& corner : corners) {
+            FullVertex vertex = {};
+            vertex.position = glm::vec3(center.x + tangent.x * corner[0] + bitangent.x * corner[1],
+                                        center.y + tangent.y * corner[0] + bitangent.y * corner[1],
+                                        center.z + tangent.z * corner[0] + bitangent.z * corner[1]);
+            vertex.normal = normal;
+            vertex.tangent = tangent;
+            vertex.main_uv = glm::u16vec2(corner[0] > 0 ? 65535 : 0, corner[1] > 0 ? 65535 : 0);
+            vertex.secondary_uv = glm::u8vec2(static_cast<uint8_t>(block_position.y), 255);
+            vertex.virtual_texture_id = block_id;
+            vertex.additional_stuff = glm::vec4(1.0F, 1.0F, 1.0F, 0.0F);
+            vertices.push_back(vertex);
+        }
+    }
+
+    std::vector<FullVertex> make_chunk(const int32_t chunk_x, const int32_t chunk_z) {
+        std::vector<FullVertex> vertices;
+
+        for(uint32_t x = 0; x < CHUNK_WIDTH; x++) {
+            for(uint32_t z = 0; z < CHUNK_WIDTH; z++) {
+                const int32_t world_x = chunk_x * static_cast<int32_t>(CHUNK_WIDTH) + static_cast<int32_t>(x);
+                const int32_t world_z = chunk_z * static_cast<int32_t>(CHUNK_WIDTH) + static_cast<int32_t>(z);
+                const uint32_t height = std::min(terrain_height(world_x, world_z), CHUNK_HEIGHT - 1);
+
+                // Top face, then any side faces that are exposed because the neighboring column is lower
+                const glm::vec3 top(static_cast<float>(x), static_cast<float>(height), static_cast<float>(z));
+                add_face(vertices, top, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}, 2);
+
+                const struct {
+                    int32_t dx;
+                    int32_t dz;
+                    glm::vec3 normal;
+                    glm::vec3 tangent;
+                } sides[] = {{1, 0, {1, 0, 0}, {0, 0, -1}},
+                             {-1, 0, {-1, 0, 0}, {0, 0, 1}},
+                             {0, 1, {0, 0, 1}, {1, 0, 0}},
+                             {0, -1, {0, 0, -1}, {-1, 0, 0}}};
+
+                for(const auto& side : sides) {
+                    const uint32_t neighbor_height = terrain_height(world_x + side.dx, world_z + side.dz);
+                    for(uint32_t y = neighbor_height + 1; y <= height; y++) {
+                        const glm::vec3 block(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+                        add_face(vertices, block, side.normal, side.tangent, {0, 1, 0}, y + 4 < height ? 1 : 3);
+                    }
+                }
+            }
+        }
+
+        return vertices;
+    }
+
+    template <typename ConversionFunc>
+    double measure_conversion_time(const std::vector<std::vector<FullVertex>>& chunks,
+                                   std::vector<std::vector<CompactVertex>>& compact_chunks,
+                                   ConversionFunc&& convert) {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        for(uint32_t iteration = 0; iteration < NUM_ITERATIONS; iteration++) {
+            for(size_t i = 0; i < chunks.size(); i++) {
+                const PositionQuantization quantization = {glm::vec3(0.0F), static_cast<float>(CHUNK_HEIGHT)};
+                convert(chunks[i].data(), chunks[i].size(), quantization, compact_chunks[i].data());
+            }
+        }
+        const auto end_time = std::chrono::high_resolution_clock::now();
+
+        const std::chrono::duration<double, std::milli> total_time = end_time - start_time;
+        return total_time.count() / NUM_ITERATIONS;
+    }
+
+    int main() {
+        TEST_SETUP_LOGGER();
+
+        std::vector<std::vector<FullVertex>> chunks;
+        std::vector<std::vector<CompactVertex>> compact_chunks;
+        size_t num_vertices = 0;
+
+        for(uint32_t i = 0; i < NUM_CHUNKS; i++) {
+            chunks.push_back(make_chunk(static_cast<int32_t>(i % 8), static_cast<int32_t>(i / 8)));
+            compact_chunks.emplace_back(chunks.back().size());
+            num_vertices += chunks.back().size();
+        }
+
+        const double scalar_ms = measure_conversion_time(chunks, compact_chunks, convert_to_compact_vertices_scalar);
+        const double simd_ms = measure_conversion_time(chunks, compact_chunks, convert_to_compact_vertices);
+
+        const double full_megabytes = static_cast<double>(num_vertices * sizeof(FullVertex)) / (1024.0 * 1024.0);
+        const double compact_megabytes = static_cast<double>(num_vertices * sizeof(CompactVertex)) / (1024.0 * 1024.0);
+
+        std::cout << NUM_CHUNKS << " chunks, " << num_vertices << " vertices" << std::endl;
+        std::cout << "FullVertex: " << full_megabytes << " MB, CompactVertex: " << compact_megabytes << " MB ("
+                  << full_megabytes - compact_megabytes << " MB saved)" << std::endl;
+        std::cout << "Scalar conversion: " << scalar_ms << " ms (" << num_vertices / scalar_ms / 1000.0 << " million vertices per second)"
+                  << std::endl;
+        std::cout << "SIMD conversion: " << simd_ms << " ms (" << num_vertices / simd_ms / 1000.0 << " million vertices per second)"
+                  << std::endl;
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::main(); }
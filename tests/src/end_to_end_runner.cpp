@@ -71,7 +71,7 @@ namespace nova::renderer {
 
         StaticMeshRenderableData data = {};
         data.mesh = mesh_id;
-        data.initial_position = glm::vec3(0, 0, -5);
+        data.position = glm::vec3(0, 0, -5);
 
         renderer->add_renderable_for_material(FullMaterialPassName{"gbuffers_terrain", "forward"}, data);
 
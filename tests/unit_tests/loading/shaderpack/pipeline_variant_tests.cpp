@@ -0,0 +1,99 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../../src/general_test_setup.hpp"
+
+#include "nova_renderer/shaderpack_data.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer::shaderpack;
+
+PipelineCreateInfo make_pipeline_with_permutations() {
+    PipelineCreateInfo pipeline;
+    pipeline.name = "Terrain";
+    pipeline.pass = "Forward";
+    pipeline.defines = {"USE_NORMALMAP"};
+    pipeline.vertex_shader.filename = "shaders/terrain.vert";
+    pipeline.vertex_shader.source = {0x07230203};
+    pipeline.permutations = {{"FOG", {"0", "1"}}, {"SHADOW_QUALITY", {"1", "2", "3"}}};
+
+    return pipeline;
+}
+
+TEST(PipelineVariants, NamesOnlyIncludeValuesThatArentTheDefault) {
+    const PipelineCreateInfo pipeline = make_pipeline_with_permutations();
+
+    EXPECT_EQ(get_pipeline_variant_name(pipeline, {}), "Terrain");
+    EXPECT_EQ(get_pipeline_variant_name(pipeline, {{"FOG", "0"}}), "Terrain");
+    EXPECT_EQ(get_pipeline_variant_name(pipeline, {{"SHADOW_QUALITY", "3"}}), "Terrain[SHADOW_QUALITY=3]");
+    EXPECT_EQ(get_pipeline_variant_name(pipeline, {{"SHADOW_QUALITY", "2"}, {"FOG", "1"}}), "Terrain[FOG=1,SHADOW_QUALITY=2]");
+
+    // Values that the permutation doesn't have use the default value
+    EXPECT_EQ(get_pipeline_variant_name(pipeline, {{"FOG", "2"}, {"WIND", "1"}}), "Terrain");
+}
+
+TEST(PipelineVariants, DefaultVariantIsCompiledWithTheShaderpack) {
+    const PipelineCreateInfo pipeline = make_pipeline_with_permutations();
+
+    const PipelineCreateInfo variant = make_pipeline_variant(pipeline, {});
+    EXPECT_EQ(variant.name, "Terrain");
+    EXPECT_FALSE(variant.compile_on_first_use);
+    EXPECT_FALSE(variant.fallback);
+
+    const std::vector<std::string> expected_defines = {"USE_NORMALMAP", "FOG 0", "SHADOW_QUALITY 1"};
+    EXPECT_EQ(variant.defines, expected_defines);
+}
+
+TEST(PipelineVariants, OtherVariantsFallBackToTheDefaultVariant) {
+    const PipelineCreateInfo pipeline = make_pipeline_with_permutations();
+
+    const PipelineCreateInfo variant = make_pipeline_variant(pipeline, {{"FOG", "1"}});
+    EXPECT_EQ(variant.name, "Terrain[FOG=1]");
+    EXPECT_TRUE(variant.compile_on_first_use);
+    ASSERT_TRUE(variant.fallback);
+    EXPECT_EQ(*variant.fallback, "Terrain");
+    ASSERT_TRUE(variant.parent_name);
+    EXPECT_EQ(*variant.parent_name, "Terrain");
+
+    EXPECT_EQ(variant.pass, pipeline.pass);
+    EXPECT_EQ(variant.vertex_shader.filename, pipeline.vertex_shader.filename);
+    EXPECT_EQ(variant.permutations.size(), pipeline.permutations.size());
+
+    const std::vector<std::string> expected_defines = {"USE_NORMALMAP", "FOG 1", "SHADOW_QUALITY 1"};
+    EXPECT_EQ(variant.defines, expected_defines);
+
+    // The pipeline's SPIR-V was compiled without the variant's defines
+    EXPECT_TRUE(variant.vertex_shader.source.empty());
+}
+
+TEST(PipelineVariants, VariantsKeepThePipelinesFallback) {
+    PipelineCreateInfo pipeline = make_pipeline_with_permutations();
+    pipeline.fallback = "Basic";
+
+    const PipelineCreateInfo variant = make_pipeline_variant(pipeline, {{"SHADOW_QUALITY", "2"}});
+    ASSERT_TRUE(variant.fallback);
+    EXPECT_EQ(*variant.fallback, "Basic");
+}
+
+TEST(PipelineVariants, MergingWithAParentOnlyOverridesWhatTheChildSets) {
+    PipelineCreateInfo parent = make_pipeline_with_permutations();
+    parent.render_queue = RenderQueueEnum::Cutout;
+    parent.states = {StateEnum::DisableCulling};
+
+    PipelineCreateInfo child;
+    child.name = "TerrainLeaves";
+    child.defines = {"USE_WIND"};
+    child.render_queue = RenderQueueEnum::Opaque;
+
+    const PipelineCreateInfo merged = child.merge_with_parent(parent);
+    EXPECT_EQ(merged.name, "TerrainLeaves");
+    ASSERT_TRUE(merged.parent_name);
+    EXPECT_EQ(*merged.parent_name, "Terrain");
+    EXPECT_EQ(merged.pass, "Forward");
+    EXPECT_EQ(merged.render_queue, RenderQueueEnum::Opaque);
+    EXPECT_EQ(merged.states, parent.states);
+    EXPECT_EQ(merged.vertex_shader.filename, parent.vertex_shader.filename);
+
+    const std::vector<std::string> expected_defines = {"USE_NORMALMAP", "USE_WIND"};
+    EXPECT_EQ(merged.defines, expected_defines);
+}
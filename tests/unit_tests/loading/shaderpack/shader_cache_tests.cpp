@@ -0,0 +1,138 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../../src/general_test_setup.hpp"
+
+#include "../../../../src/loading/shaderpack/shader_cache.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer::shaderpack;
+
+const std::string TEST_SHADER_SOURCE = "#version 450\nvoid main() {}\n";
+
+fs::path make_empty_cache_folder(const std::string& name) {
+    const fs::path folder = fs::temp_directory_path() / "nova_shader_cache_tests" / name;
+    fs::remove_all(folder);
+    return folder;
+}
+
+TEST(ShaderCache, KeysDependOnEverythingThatAffectsCompilation) {
+    const ShaderCacheKey key = make_shader_cache_key(TEST_SHADER_SOURCE, EShLangVertex, glslang::EShSourceGlsl, {"A", "B"});
+
+    EXPECT_EQ(key, make_shader_cache_key(TEST_SHADER_SOURCE, EShLangVertex, glslang::EShSourceGlsl, {"A", "B"}));
+
+    EXPECT_NE(key, make_shader_cache_key(TEST_SHADER_SOURCE + " ", EShLangVertex, glslang::EShSourceGlsl, {"A", "B"}));
+    EXPECT_NE(key, make_shader_cache_key(TEST_SHADER_SOURCE, EShLangFragment, glslang::EShSourceGlsl, {"A", "B"}));
+    EXPECT_NE(key, make_shader_cache_key(TEST_SHADER_SOURCE, EShLangVertex, glslang::EShSourceHlsl, {"A", "B"}));
+    EXPECT_NE(key, make_shader_cache_key(TEST_SHADER_SOURCE, EShLangVertex, glslang::EShSourceGlsl, {"AB"}));
+    EXPECT_NE(key, make_shader_cache_key(TEST_SHADER_SOURCE, EShLangVertex, glslang::EShSourceGlsl, {"B", "A"}));
+
+    EXPECT_EQ(key.to_string().size(), 32U);
+}
+
+TEST(ShaderCache, StoredShadersAreFoundByLaterCaches) {
+    const fs::path folder = make_empty_cache_folder("stored_shaders");
+    const ShaderCacheKey key = make_shader_cache_key(TEST_SHADER_SOURCE, EShLangVertex, glslang::EShSourceGlsl, {});
+    const std::vector<uint32_t> spirv = {0x07230203, 0x00010000, 1, 2, 3};
+
+    {
+        ShaderCache cache(folder);
+        EXPECT_FALSE(cache.find(key));
+        cache.store(key, spirv);
+        EXPECT_EQ(cache.get_num_misses(), 1U);
+    }
+
+    ShaderCache cache(folder);
+    const auto cached_spirv = cache.find(key);
+    ASSERT_TRUE(cached_spirv);
+    EXPECT_EQ(*cached_spirv, spirv);
+    EXPECT_EQ(cache.get_num_hits(), 1U);
+
+    // Only the entry itself is left in the folder, not the temporary file it was written to
+    uint32_t num_files = 0;
+    for(const fs::directory_entry& entry : fs::directory_iterator(folder)) {
+        EXPECT_EQ(entry.path().filename().string(), key.to_string());
+        num_files++;
+    }
+    EXPECT_EQ(num_files, 1U);
+}
+
+TEST(ShaderCache, InvalidEntriesAreMisses) {
+    const fs::path folder = make_empty_cache_folder("invalid_entries");
+    const ShaderCacheKey key = make_shader_cache_key(TEST_SHADER_SOURCE, EShLangVertex, glslang::EShSourceGlsl, {});
+
+    ShaderCache cache(folder);
+    nova::renderer::write_to_file(std::string("not SPIR-V"), folder / key.to_string());
+
+    EXPECT_FALSE(cache.find(key));
+    EXPECT_EQ(cache.get_num_misses(), 1U);
+}
+
+TEST(ShaderCache, PipelineKeysDependOnEverythingThatAffectsThePipeline) {
+    PipelineCreateInfo pipeline;
+    pipeline.name = "TestPipeline";
+    pipeline.pass = "TestPass";
+    pipeline.vertex_shader.source = {0x07230203, 0x00010000, 1, 2, 3};
+
+    TextureAttachmentInfo color_attachment;
+    color_attachment.name = "TestColor";
+    color_attachment.pixel_format = PixelFormatEnum::RGBA8;
+    const std::vector<TextureAttachmentInfo> color_attachments = {color_attachment};
+
+    const glm::uvec2 viewport_size = {640, 480};
+
+    const ShaderCacheKey key = make_pipeline_cache_key(pipeline, color_attachments, {}, viewport_size);
+    EXPECT_EQ(key, make_pipeline_cache_key(pipeline, color_attachments, {}, viewport_size));
+
+    PipelineCreateInfo changed_shader = pipeline;
+    changed_shader.vertex_shader.source.push_back(4);
+    EXPECT_NE(key, make_pipeline_cache_key(changed_shader, color_attachments, {}, viewport_size));
+
+    PipelineCreateInfo added_stage = pipeline;
+    added_stage.fragment_shader = pipeline.vertex_shader;
+    EXPECT_NE(key, make_pipeline_cache_key(added_stage, color_attachments, {}, viewport_size));
+
+    PipelineCreateInfo changed_state = pipeline;
+    changed_state.states.push_back(StateEnum::DisableDepthTest);
+    EXPECT_NE(key, make_pipeline_cache_key(changed_state, color_attachments, {}, viewport_size));
+
+    PipelineCreateInfo changed_depth_bias = pipeline;
+    changed_depth_bias.depth_bias = 0.5F;
+    EXPECT_NE(key, make_pipeline_cache_key(changed_depth_bias, color_attachments, {}, viewport_size));
+
+    TextureAttachmentInfo changed_attachment = color_attachment;
+    changed_attachment.pixel_format = PixelFormatEnum::RGBA16F;
+    EXPECT_NE(key, make_pipeline_cache_key(pipeline, {changed_attachment}, {}, viewport_size));
+    EXPECT_NE(key, make_pipeline_cache_key(pipeline, color_attachments, color_attachment, viewport_size));
+    EXPECT_NE(key, make_pipeline_cache_key(pipeline, color_attachments, {}, {1280, 720}));
+}
+
+TEST(ShaderCache, ReflectionRecordsAreStoredNextToTheSpirv) {
+    const fs::path folder = make_empty_cache_folder("reflection_records");
+    const ShaderCacheKey key = make_shader_cache_key(TEST_SHADER_SOURCE, EShLangFragment, glslang::EShSourceGlsl, {});
+
+    ShaderReflection reflection;
+    reflection.resources.push_back({"albedo", 1, 2, 4, ShaderResourceTypeEnum::SampledImage});
+    reflection.outputs.push_back({"color", 0});
+
+    {
+        ShaderCache cache(folder);
+        EXPECT_FALSE(cache.find_reflection(key));
+        cache.store(key, {0x07230203, 0x00010000, 1, 2, 3});
+        cache.store_reflection(key, reflection);
+    }
+
+    ShaderCache cache(folder);
+    ASSERT_TRUE(cache.find(key));
+
+    const auto cached_reflection = cache.find_reflection(key);
+    ASSERT_TRUE(cached_reflection);
+    ASSERT_EQ(cached_reflection->resources.size(), 1U);
+    EXPECT_EQ(cached_reflection->resources[0].name, "albedo");
+    EXPECT_EQ(cached_reflection->resources[0].count, 4U);
+    ASSERT_EQ(cached_reflection->outputs.size(), 1U);
+    EXPECT_EQ(cached_reflection->outputs[0].name, "color");
+
+    // Looking up the reflection record doesn't count as another hit
+    EXPECT_EQ(cache.get_num_hits(), 1U);
+}
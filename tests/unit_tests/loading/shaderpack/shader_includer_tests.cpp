@@ -0,0 +1,105 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../../src/general_test_setup.hpp"
+
+#include <fstream>
+
+#include "../../../../src/loading/regular_folder_accessor.hpp"
+#include "../../../../src/loading/shaderpack/shader_cache.hpp"
+#include "../../../../src/loading/shaderpack/shader_includer.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+using namespace nova::renderer::shaderpack;
+
+const std::string INCLUDING_SHADER_SOURCE = R"(#version 450
+#include "lighting.glsl"
+  #  include <common/constants.glsl>
+#include "missing.glsl"
+void main() {}
+)";
+
+void write_include_test_file(const fs::path& path, const std::string& text) {
+    fs::create_directories(path.parent_path());
+    std::ofstream file(path);
+    file << text;
+}
+
+/*!
+ * \brief Makes a shaderpack folder with a few files to include
+ *
+ * There are two `common/constants.glsl` files, one in the shaderpack's root and one next to `shaders/lighting.glsl`. The one in the root
+ * includes `shaders/lighting.glsl`, which includes the one next to it
+ */
+fs::path make_include_test_folder(const std::string& name) {
+    const fs::path folder = fs::temp_directory_path() / "nova_shader_includer_tests" / name;
+    fs::remove_all(folder);
+
+    write_include_test_file(folder / "shaders/lighting.glsl", "#include \"common/constants.glsl\"\nfloat light() { return PI; }\n");
+    write_include_test_file(folder / "common/constants.glsl", "#define PI 3.14159\n#include \"../shaders/lighting.glsl\"\n");
+    write_include_test_file(folder / "shaders/common/constants.glsl", "#define PI 3\n");
+
+    return folder;
+}
+
+TEST(ShaderIncludeCache, QuotedIncludesAreRelativeToTheirFileFirst) {
+    const fs::path folder = make_include_test_folder("relative_includes");
+    ShaderIncludeCache include_cache(std::make_shared<RegularFolderAccessor>(folder));
+
+    EXPECT_EQ(include_cache.resolve("common/constants.glsl", "shaders/gbuffer.frag", false), fs::path("shaders/common/constants.glsl"));
+    EXPECT_EQ(include_cache.resolve("common/constants.glsl", "shaders/gbuffer.frag", true), fs::path("common/constants.glsl"));
+    EXPECT_EQ(include_cache.resolve("../shaders/lighting.glsl", "common/constants.glsl", false), fs::path("shaders/lighting.glsl"));
+    EXPECT_EQ(include_cache.resolve("lighting.glsl", "materials/gbuffer.frag", false), std::nullopt);
+
+    // Files outside the shaderpack can't be included
+    EXPECT_EQ(include_cache.resolve("../relative_includes/shaders/lighting.glsl", "shaders/gbuffer.frag", true), std::nullopt);
+}
+
+TEST(ShaderIncludeCache, IncludesAreFoundThroughOtherFiles) {
+    const fs::path folder = make_include_test_folder("include_graph");
+    ShaderIncludeCache include_cache(std::make_shared<RegularFolderAccessor>(folder));
+
+    const std::vector<fs::path> includes = include_cache.find_includes(INCLUDING_SHADER_SOURCE, "shaders/gbuffer.frag");
+
+    // lighting.glsl includes the constants next to it, not the ones in the root
+    const std::vector<fs::path> expected_includes = {"common/constants.glsl",
+                                                     "shaders/common/constants.glsl",
+                                                     "shaders/lighting.glsl"};
+    EXPECT_EQ(includes, expected_includes);
+}
+
+TEST(ShaderIncludeCache, FilesAreOnlyReadOnce) {
+    const fs::path folder = make_include_test_folder("read_once");
+    ShaderIncludeCache include_cache(std::make_shared<RegularFolderAccessor>(folder));
+
+    const std::string* text = include_cache.read("shaders/lighting.glsl");
+    ASSERT_NE(text, nullptr);
+    const std::string original_text = *text;
+
+    // Shaders that are loaded at the same time all see the same version of each file
+    write_include_test_file(folder / "shaders/lighting.glsl", "float light() { return 1; }\n");
+    EXPECT_EQ(include_cache.read("shaders/lighting.glsl"), text);
+    EXPECT_EQ(*text, original_text);
+
+    EXPECT_EQ(include_cache.read("shaders/missing.glsl"), nullptr);
+}
+
+TEST(ShaderIncludeCache, CacheKeysChangeWhenAnIncludedFileChanges) {
+    const fs::path folder = make_include_test_folder("cache_keys");
+
+    const auto make_key = [&] {
+        ShaderIncludeCache include_cache(std::make_shared<RegularFolderAccessor>(folder));
+        const std::vector<fs::path> includes = include_cache.find_includes(INCLUDING_SHADER_SOURCE, "shaders/gbuffer.frag");
+
+        ShaderCacheKey key = make_shader_cache_key(INCLUDING_SHADER_SOURCE, EShLangFragment, glslang::EShSourceGlsl, {});
+        include_cache.add_to_key(key, includes);
+        return key;
+    };
+
+    const ShaderCacheKey key = make_key();
+    EXPECT_EQ(key, make_key());
+
+    write_include_test_file(folder / "common/constants.glsl", "#define PI 3.1415926\n");
+    EXPECT_NE(key, make_key());
+}
@@ -0,0 +1,111 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../../src/general_test_setup.hpp"
+
+#include "../../../../src/loading/shaderpack/shader_cache.hpp"
+#include "../../../../src/loading/shaderpack/shader_optimizer.hpp"
+#include "../../../../src/loading/shaderpack/shaderpack_loading.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer::shaderpack;
+
+const std::string OPTIMIZER_TEST_SHADER_SOURCE = R"(#version 450
+layout(set = 0, binding = 0) uniform sampler2D albedo_texture;
+layout(location = 0) in vec2 uv;
+layout(location = 0) out vec4 color;
+void main() {
+    vec4 unused = vec4(uv, 0, 1) * 2;
+    color = texture(albedo_texture, uv);
+}
+)";
+
+constexpr uint32_t SPIRV_OP_NAME = 5;
+
+bool has_names(const std::vector<uint32_t>& spirv) {
+    for(size_t word = 5; word < spirv.size() && (spirv[word] >> 16) > 0; word += spirv[word] >> 16) {
+        if((spirv[word] & 0xFFFF) == SPIRV_OP_NAME) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ShaderSource compile_optimizer_test_shader() {
+    initialize_glslang();
+
+    ShaderSource shader;
+    shader.filename = "optimizer_test.frag";
+    shader.source = compile_shader_source(OPTIMIZER_TEST_SHADER_SOURCE, EShLangFragment, glslang::EShSourceGlsl, "optimizer_test.frag");
+
+    return shader;
+}
+
+TEST(ShaderOptimizer, InstructionsAreCountedByTheirLength) {
+    // The header, then OpCapability Shader and OpMemoryModel Logical GLSL450
+    const std::vector<uint32_t> spirv = {0x07230203, 0x00010000, 0, 10, 0, 0x00020011, 1, 0x0003000E, 0, 1};
+
+    EXPECT_EQ(count_spirv_instructions(spirv), 2U);
+    EXPECT_EQ(count_spirv_instructions({spirv.begin(), spirv.begin() + 5}), 0U);
+}
+
+TEST(ShaderOptimizer, StrippedShadersKeepTheirResourceNames) {
+    ShaderSource shader = compile_optimizer_test_shader();
+    ASSERT_FALSE(shader.source.empty());
+    ASSERT_TRUE(has_names(shader.source));
+
+    ShaderOptimizer optimizer(true, true);
+    ValidationReport report;
+    optimizer.optimize(shader, shader.filename.string(), report);
+    EXPECT_TRUE(report.warnings.empty());
+
+    EXPECT_FALSE(has_names(shader.source));
+
+    ASSERT_EQ(shader.reflection.resources.size(), 1U);
+    EXPECT_EQ(shader.reflection.resources[0].name, "albedo_texture");
+}
+
+TEST(ShaderOptimizer, StatisticsAreRecordedForEachShader) {
+    ShaderSource shader = compile_optimizer_test_shader();
+    const uint32_t num_instructions = count_spirv_instructions(shader.source);
+    const size_t num_bytes = shader.source.size() * sizeof(uint32_t);
+
+    ShaderOptimizer optimizer(true, true);
+    ValidationReport report;
+    optimizer.optimize(shader, shader.filename.string(), report);
+
+    const ShaderOptimizationStatistics statistics = optimizer.get_statistics();
+    EXPECT_EQ(statistics.num_shaders, 1U);
+    EXPECT_EQ(statistics.num_instructions_before, num_instructions);
+    EXPECT_EQ(statistics.num_bytes_before, num_bytes);
+    EXPECT_EQ(statistics.num_instructions_after, count_spirv_instructions(shader.source));
+    EXPECT_EQ(statistics.num_bytes_after, shader.source.size() * sizeof(uint32_t));
+    EXPECT_LT(statistics.num_bytes_after, statistics.num_bytes_before);
+}
+
+TEST(ShaderOptimizer, ShadersThatCantBeOptimizedAreLeftAlone) {
+    ShaderSource shader;
+    shader.source = {0xDEADBEEF, 1, 2, 3, 4, 5};
+    const std::vector<uint32_t> original_source = shader.source;
+
+    ShaderOptimizer optimizer(true, true);
+    ValidationReport report;
+    optimizer.optimize(shader, "broken.frag", report);
+
+    EXPECT_EQ(shader.source, original_source);
+    EXPECT_FALSE(report.warnings.empty());
+    EXPECT_TRUE(report.errors.empty());
+}
+
+TEST(ShaderOptimizer, CacheKeysDependOnTheOptimizations) {
+    const ShaderOptimizer optimizer(true, false);
+    const ShaderCacheKey key = make_shader_cache_key(OPTIMIZER_TEST_SHADER_SOURCE, EShLangFragment, glslang::EShSourceGlsl, {}, &optimizer);
+
+    const ShaderOptimizer same_optimizer(true, false);
+    EXPECT_EQ(key, make_shader_cache_key(OPTIMIZER_TEST_SHADER_SOURCE, EShLangFragment, glslang::EShSourceGlsl, {}, &same_optimizer));
+
+    const ShaderOptimizer stripping_optimizer(true, true);
+    EXPECT_NE(key, make_shader_cache_key(OPTIMIZER_TEST_SHADER_SOURCE, EShLangFragment, glslang::EShSourceGlsl, {}, &stripping_optimizer));
+    EXPECT_NE(key, make_shader_cache_key(OPTIMIZER_TEST_SHADER_SOURCE, EShLangFragment, glslang::EShSourceGlsl, {}));
+}
@@ -0,0 +1,75 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../../src/general_test_setup.hpp"
+
+#include "../../../../src/loading/shaderpack/shader_reflection.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer::shaderpack;
+
+ShaderReflection make_test_reflection() {
+    ShaderReflection reflection;
+    reflection.resources.push_back({"per_model_uniforms", 0, 0, 1, ShaderResourceTypeEnum::UniformBuffer});
+    reflection.resources.push_back({"textures", 1, 3, 16, ShaderResourceTypeEnum::SampledImage});
+    reflection.resources.push_back({"lights", 2, 0, 1, ShaderResourceTypeEnum::StorageBuffer});
+    reflection.push_constants_size = 64;
+    reflection.inputs.push_back({"position_in", 0});
+    reflection.inputs.push_back({"uv_in", 3});
+    reflection.outputs.push_back({"uv", 1});
+
+    return reflection;
+}
+
+TEST(ShaderReflection, SerializedRecordsRoundTrip) {
+    const ShaderReflection reflection = make_test_reflection();
+
+    const std::optional<ShaderReflection> deserialized = deserialize_reflection(serialize_reflection(reflection));
+    ASSERT_TRUE(deserialized);
+
+    ASSERT_EQ(deserialized->resources.size(), reflection.resources.size());
+    for(size_t i = 0; i < reflection.resources.size(); i++) {
+        EXPECT_EQ(deserialized->resources[i].name, reflection.resources[i].name);
+        EXPECT_EQ(deserialized->resources[i].set, reflection.resources[i].set);
+        EXPECT_EQ(deserialized->resources[i].binding, reflection.resources[i].binding);
+        EXPECT_EQ(deserialized->resources[i].count, reflection.resources[i].count);
+        EXPECT_EQ(deserialized->resources[i].type, reflection.resources[i].type);
+    }
+
+    EXPECT_EQ(deserialized->push_constants_size, 64U);
+
+    ASSERT_EQ(deserialized->inputs.size(), 2U);
+    EXPECT_EQ(deserialized->inputs[1].name, "uv_in");
+    EXPECT_EQ(deserialized->inputs[1].location, 3U);
+
+    ASSERT_EQ(deserialized->outputs.size(), 1U);
+    EXPECT_EQ(deserialized->outputs[0].name, "uv");
+    EXPECT_EQ(deserialized->outputs[0].location, 1U);
+}
+
+TEST(ShaderReflection, DamagedRecordsAreRejected) {
+    const std::vector<uint32_t> data = serialize_reflection(make_test_reflection());
+
+    EXPECT_FALSE(deserialize_reflection({}));
+
+    // Every prefix of a record is missing something
+    for(size_t size = 0; size < data.size(); size++) {
+        EXPECT_FALSE(deserialize_reflection(std::vector<uint32_t>(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(size))));
+    }
+
+    std::vector<uint32_t> extra_data = data;
+    extra_data.push_back(0);
+    EXPECT_FALSE(deserialize_reflection(extra_data));
+
+    std::vector<uint32_t> wrong_version = data;
+    wrong_version[0]++;
+    EXPECT_FALSE(deserialize_reflection(wrong_version));
+}
+
+TEST(ShaderReflection, EmptySpirvHasNoReflection) {
+    const ShaderReflection reflection = reflect_shader({});
+    EXPECT_TRUE(reflection.resources.empty());
+    EXPECT_TRUE(reflection.inputs.empty());
+    EXPECT_TRUE(reflection.outputs.empty());
+    EXPECT_EQ(reflection.push_constants_size, 0U);
+}
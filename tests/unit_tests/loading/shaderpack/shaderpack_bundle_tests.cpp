@@ -0,0 +1,124 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../../src/general_test_setup.hpp"
+
+#include "../../../../src/loading/shaderpack/shader_reflection.hpp"
+#include "../../../../src/loading/shaderpack/shaderpack_bundle.hpp"
+#include "../../../../src/loading/shaderpack/shaderpack_loading.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer::shaderpack;
+
+const fs::path BUNDLE_TEST_SHADERPACK_PATH = CMAKE_DEFINED_RESOURCES_PREFIX "shaderpacks/DefaultShaderpack";
+
+void expect_same_shaders(const ShaderSource& expected, const ShaderSource& actual) {
+    EXPECT_EQ(expected.filename, actual.filename);
+    EXPECT_EQ(expected.source, actual.source);
+    EXPECT_EQ(serialize_reflection(expected.reflection), serialize_reflection(actual.reflection));
+}
+
+void expect_same_shaderpacks(const ShaderpackData& expected, const ShaderpackData& actual) {
+    ASSERT_EQ(expected.resources.textures.size(), actual.resources.textures.size());
+    for(size_t i = 0; i < expected.resources.textures.size(); i++) {
+        EXPECT_EQ(expected.resources.textures[i].name, actual.resources.textures[i].name);
+        EXPECT_EQ(expected.resources.textures[i].format, actual.resources.textures[i].format);
+    }
+
+    ASSERT_EQ(expected.resources.samplers.size(), actual.resources.samplers.size());
+    for(size_t i = 0; i < expected.resources.samplers.size(); i++) {
+        EXPECT_EQ(expected.resources.samplers[i].name, actual.resources.samplers[i].name);
+        EXPECT_EQ(expected.resources.samplers[i].filter, actual.resources.samplers[i].filter);
+    }
+
+    ASSERT_EQ(expected.passes.size(), actual.passes.size());
+    for(size_t i = 0; i < expected.passes.size(); i++) {
+        EXPECT_EQ(expected.passes[i].name, actual.passes[i].name);
+        EXPECT_EQ(expected.passes[i].texture_inputs, actual.passes[i].texture_inputs);
+        EXPECT_EQ(expected.passes[i].texture_outputs, actual.passes[i].texture_outputs);
+        EXPECT_EQ(expected.passes[i].depth_texture, actual.passes[i].depth_texture);
+    }
+
+    ASSERT_EQ(expected.pipelines.size(), actual.pipelines.size());
+    for(size_t i = 0; i < expected.pipelines.size(); i++) {
+        const PipelineCreateInfo& expected_pipeline = expected.pipelines[i];
+        const PipelineCreateInfo& actual_pipeline = actual.pipelines[i];
+        EXPECT_EQ(expected_pipeline.name, actual_pipeline.name);
+        EXPECT_EQ(expected_pipeline.pass, actual_pipeline.pass);
+        EXPECT_EQ(expected_pipeline.defines, actual_pipeline.defines);
+        EXPECT_EQ(expected_pipeline.states, actual_pipeline.states);
+        EXPECT_EQ(expected_pipeline.vertex_fields.size(), actual_pipeline.vertex_fields.size());
+        EXPECT_EQ(expected_pipeline.depth_bias, actual_pipeline.depth_bias);
+        EXPECT_EQ(expected_pipeline.render_queue, actual_pipeline.render_queue);
+
+        expect_same_shaders(expected_pipeline.vertex_shader, actual_pipeline.vertex_shader);
+        ASSERT_EQ(expected_pipeline.fragment_shader.has_value(), actual_pipeline.fragment_shader.has_value());
+        if(expected_pipeline.fragment_shader) {
+            expect_same_shaders(*expected_pipeline.fragment_shader, *actual_pipeline.fragment_shader);
+        }
+    }
+
+    ASSERT_EQ(expected.materials.size(), actual.materials.size());
+    for(size_t i = 0; i < expected.materials.size(); i++) {
+        EXPECT_EQ(expected.materials[i].name, actual.materials[i].name);
+        ASSERT_EQ(expected.materials[i].passes.size(), actual.materials[i].passes.size());
+        for(size_t j = 0; j < expected.materials[i].passes.size(); j++) {
+            EXPECT_EQ(expected.materials[i].passes[j].pipeline, actual.materials[i].passes[j].pipeline);
+            EXPECT_EQ(expected.materials[i].passes[j].bindings, actual.materials[i].passes[j].bindings);
+        }
+    }
+}
+
+TEST(ShaderpackBundle, BundlesHaveEverythingThatWasBaked) {
+    const ShaderpackData data = load_shaderpack_data(BUNDLE_TEST_SHADERPACK_PATH);
+    ASSERT_FALSE(data.pipelines.empty());
+
+    const std::vector<uint32_t> bundle = serialize_shaderpack_bundle(data);
+    const std::optional<ShaderpackData> bundled_data = deserialize_shaderpack_bundle(bundle.data(), bundle.size());
+    ASSERT_TRUE(bundled_data);
+
+    expect_same_shaderpacks(data, *bundled_data);
+}
+
+TEST(ShaderpackBundle, BundleFilesLoadLikeOtherShaderpacks) {
+    const fs::path bundle_folder = fs::temp_directory_path() / "nova_shaderpack_bundle_tests";
+    fs::remove_all(bundle_folder);
+    fs::create_directories(bundle_folder);
+
+    const fs::path bundle_path = bundle_folder / (std::string("DefaultShaderpack") + SHADERPACK_BUNDLE_EXTENSION);
+    ASSERT_TRUE(is_shaderpack_bundle(bundle_path));
+
+    const ShaderpackData data = load_shaderpack_data(BUNDLE_TEST_SHADERPACK_PATH);
+    ASSERT_TRUE(write_shaderpack_bundle(data, bundle_path));
+
+    const ShaderpackData bundled_data = load_shaderpack_data(bundle_path);
+    expect_same_shaderpacks(data, bundled_data);
+
+    fs::remove_all(bundle_folder);
+}
+
+TEST(ShaderpackBundle, DamagedBundlesAreRejected) {
+    const ShaderpackData data = load_shaderpack_data(BUNDLE_TEST_SHADERPACK_PATH);
+    std::vector<uint32_t> bundle = serialize_shaderpack_bundle(data);
+
+    for(const size_t size : {size_t(0), size_t(3), bundle.size() / 2, bundle.size() - 1}) {
+        EXPECT_FALSE(deserialize_shaderpack_bundle(bundle.data(), size)) << "Bundle cut off after " << size << " words was accepted";
+    }
+
+    // The format version
+    bundle[1]++;
+    EXPECT_FALSE(deserialize_shaderpack_bundle(bundle.data(), bundle.size()));
+}
+
+TEST(ShaderpackBundle, UncompiledVariantsCantBeBundled) {
+    ShaderpackData data = load_shaderpack_data(BUNDLE_TEST_SHADERPACK_PATH);
+    ASSERT_FALSE(data.pipelines.empty());
+
+    PipelineCreateInfo& variant = data.pipelines.front();
+    variant.compile_on_first_use = true;
+    variant.vertex_shader.source.clear();
+
+    const fs::path bundle_path = fs::temp_directory_path() / (std::string("nova_uncompiled_variant") + SHADERPACK_BUNDLE_EXTENSION);
+    EXPECT_FALSE(write_shaderpack_bundle(data, bundle_path));
+    EXPECT_FALSE(fs::exists(bundle_path));
+}
@@ -0,0 +1,61 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../../src/general_test_setup.hpp"
+
+#include "../../../../src/loading/shaderpack/shaderpack_loading.hpp"
+#include "../../../../src/tasks/task_scheduler.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer::shaderpack;
+
+const fs::path DEFAULT_SHADERPACK_PATH = CMAKE_DEFINED_RESOURCES_PREFIX "shaderpacks/DefaultShaderpack";
+
+TEST(ShaderpackLoading, ParallelLoadsMatchSerialLoads) {
+    nova::ttl::task_scheduler scheduler(4, nova::ttl::empty_queue_behavior::SLEEP);
+
+    const ShaderpackData serial_data = load_shaderpack_data(DEFAULT_SHADERPACK_PATH);
+    const ShaderpackData parallel_data = load_shaderpack_data(DEFAULT_SHADERPACK_PATH, nullptr, &scheduler);
+
+    ASSERT_EQ(serial_data.resources.textures.size(), parallel_data.resources.textures.size());
+    ASSERT_EQ(serial_data.passes.size(), parallel_data.passes.size());
+    for(size_t i = 0; i < serial_data.passes.size(); i++) {
+        EXPECT_EQ(serial_data.passes[i].name, parallel_data.passes[i].name);
+    }
+
+    ASSERT_FALSE(serial_data.pipelines.empty());
+    ASSERT_EQ(serial_data.pipelines.size(), parallel_data.pipelines.size());
+    for(size_t i = 0; i < serial_data.pipelines.size(); i++) {
+        const PipelineCreateInfo& serial_pipeline = serial_data.pipelines[i];
+        const PipelineCreateInfo& parallel_pipeline = parallel_data.pipelines[i];
+        EXPECT_EQ(serial_pipeline.name, parallel_pipeline.name);
+
+        EXPECT_FALSE(parallel_pipeline.vertex_shader.source.empty());
+        EXPECT_EQ(serial_pipeline.vertex_shader.source, parallel_pipeline.vertex_shader.source);
+
+        ASSERT_EQ(serial_pipeline.fragment_shader.has_value(), parallel_pipeline.fragment_shader.has_value());
+        if(serial_pipeline.fragment_shader) {
+            EXPECT_EQ(serial_pipeline.fragment_shader->source, parallel_pipeline.fragment_shader->source);
+        }
+    }
+
+    ASSERT_EQ(serial_data.materials.size(), parallel_data.materials.size());
+    for(size_t i = 0; i < serial_data.materials.size(); i++) {
+        EXPECT_EQ(serial_data.materials[i].name, parallel_data.materials[i].name);
+    }
+}
+
+TEST(ShaderpackLoading, SinglePipelineLoadsMatchFullLoads) {
+    const ShaderpackData data = load_shaderpack_data(DEFAULT_SHADERPACK_PATH);
+
+    ASSERT_FALSE(data.pipelines.empty());
+    for(const PipelineCreateInfo& pipeline : data.pipelines) {
+        const auto pipeline_file = data.pipeline_files.find(pipeline.name);
+        ASSERT_NE(pipeline_file, data.pipeline_files.end());
+
+        const std::optional<PipelineCreateInfo> reloaded_pipeline = load_pipeline(DEFAULT_SHADERPACK_PATH, pipeline_file->second);
+        ASSERT_TRUE(reloaded_pipeline);
+        EXPECT_EQ(reloaded_pipeline->name, pipeline.name);
+        EXPECT_EQ(reloaded_pipeline->vertex_shader.source, pipeline.vertex_shader.source);
+    }
+}
@@ -0,0 +1,112 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../../src/general_test_setup.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include "../../../../src/loading/shaderpack/shaderpack_watcher.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer::shaderpack;
+
+const fs::path TEST_SHADERPACK_PATH = "shaderpacks/TestShaderpack";
+
+ShaderpackData make_test_shaderpack_data() {
+    ShaderpackData data;
+
+    PipelineCreateInfo gui_pipeline;
+    gui_pipeline.name = "gui";
+    gui_pipeline.vertex_shader.filename = "shaders/gui";
+    gui_pipeline.fragment_shader = ShaderSource{"shaders/gui", {}};
+    data.pipelines.push_back(gui_pipeline);
+    data.pipeline_files.emplace("gui", TEST_SHADERPACK_PATH / "materials/gui.pipeline");
+
+    PipelineCreateInfo text_pipeline;
+    text_pipeline.name = "gui_text";
+    text_pipeline.vertex_shader.filename = "shaders/gui";
+    text_pipeline.fragment_shader = ShaderSource{"shaders/text", {}};
+    data.pipelines.push_back(text_pipeline);
+    data.pipeline_files.emplace("gui_text", TEST_SHADERPACK_PATH / "materials/gui_text.pipeline");
+
+    return data;
+}
+
+TEST(ShaderpackDependencies, ShaderChangesReloadThePipelinesThatUseThem) {
+    const ShaderpackDependencies dependencies(TEST_SHADERPACK_PATH, make_test_shaderpack_data());
+
+    const ShaderpackReload text_reload = dependencies.get_reload({TEST_SHADERPACK_PATH / "shaders/text.frag"});
+    EXPECT_FALSE(text_reload.needs_full_reload);
+    ASSERT_EQ(text_reload.pipeline_files.size(), 1U);
+    EXPECT_EQ(text_reload.pipeline_files[0], TEST_SHADERPACK_PATH / "materials/gui_text.pipeline");
+
+    // Both pipelines use the vertex shader, and a shader can have more than one extension
+    const ShaderpackReload gui_reload = dependencies.get_reload({TEST_SHADERPACK_PATH / "shaders/gui.vert.hlsl"});
+    EXPECT_FALSE(gui_reload.needs_full_reload);
+    EXPECT_EQ(gui_reload.pipeline_files.size(), 2U);
+}
+
+TEST(ShaderpackDependencies, PipelineChangesReloadOnlyThatPipeline) {
+    const ShaderpackDependencies dependencies(TEST_SHADERPACK_PATH, make_test_shaderpack_data());
+
+    const ShaderpackReload reload = dependencies.get_reload({TEST_SHADERPACK_PATH / "materials/gui.pipeline"});
+    EXPECT_FALSE(reload.needs_full_reload);
+    ASSERT_EQ(reload.pipeline_files.size(), 1U);
+    EXPECT_EQ(reload.pipeline_files[0], TEST_SHADERPACK_PATH / "materials/gui.pipeline");
+
+    EXPECT_TRUE(dependencies.get_reload({TEST_SHADERPACK_PATH / "materials/new.pipeline"}).needs_full_reload);
+}
+
+TEST(ShaderpackDependencies, IncludedFileChangesReloadThePipelinesThatIncludeThem) {
+    ShaderpackData data = make_test_shaderpack_data();
+    data.pipelines[1].fragment_shader->includes = {"shaders/lib/text_rendering.glsl"};
+    ShaderpackDependencies dependencies(TEST_SHADERPACK_PATH, data);
+
+    const ShaderpackReload reload = dependencies.get_reload({TEST_SHADERPACK_PATH / "shaders/lib/text_rendering.glsl"});
+    EXPECT_FALSE(reload.needs_full_reload);
+    ASSERT_EQ(reload.pipeline_files.size(), 1U);
+    EXPECT_EQ(reload.pipeline_files[0], TEST_SHADERPACK_PATH / "materials/gui_text.pipeline");
+
+    // Pipelines that are reloaded on their own can include new files
+    PipelineCreateInfo gui_pipeline = data.pipelines[0];
+    gui_pipeline.vertex_shader.includes = {"shaders/lib/text_rendering.glsl"};
+    dependencies.add_pipeline(TEST_SHADERPACK_PATH, gui_pipeline, TEST_SHADERPACK_PATH / "materials/gui.pipeline");
+    EXPECT_EQ(dependencies.get_reload({TEST_SHADERPACK_PATH / "shaders/lib/text_rendering.glsl"}).pipeline_files.size(), 2U);
+}
+
+TEST(ShaderpackDependencies, OtherShaderpackFilesReloadEverything) {
+    const ShaderpackDependencies dependencies(TEST_SHADERPACK_PATH, make_test_shaderpack_data());
+
+    EXPECT_TRUE(dependencies.get_reload({TEST_SHADERPACK_PATH / "passes.json"}).needs_full_reload);
+    EXPECT_TRUE(dependencies.get_reload({TEST_SHADERPACK_PATH / "resources.json"}).needs_full_reload);
+    EXPECT_TRUE(dependencies.get_reload({TEST_SHADERPACK_PATH / "materials/gui.mat"}).needs_full_reload);
+
+    EXPECT_TRUE(dependencies.get_reload({TEST_SHADERPACK_PATH / "shaders/.gui.frag.swp", TEST_SHADERPACK_PATH / "README.md"}).empty());
+}
+
+TEST(ShaderpackWatcher, FindsChangedFiles) {
+    const fs::path folder = fs::temp_directory_path() / "nova_shaderpack_watcher_tests";
+    fs::remove_all(folder);
+    fs::create_directories(folder / "shaders");
+    std::ofstream(folder / "shaders/gui.frag") << "#version 450\n";
+
+    ShaderpackWatcher watcher(folder);
+    EXPECT_TRUE(watcher.get_changed_files().empty());
+
+    std::ofstream(folder / "shaders/gui.frag") << "#version 450\nvoid main() {}\n";
+
+    // Some platforms scan for changes every so often, rather than being told about them
+    std::vector<fs::path> changed_files;
+    for(uint32_t attempt = 0; attempt < 20 && changed_files.empty(); attempt++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        changed_files = watcher.get_changed_files();
+    }
+
+    ASSERT_EQ(changed_files.size(), 1U);
+    EXPECT_EQ(changed_files[0].lexically_normal(), (folder / "shaders/gui.frag").lexically_normal());
+    EXPECT_TRUE(watcher.get_changed_files().empty());
+
+    fs::remove_all(folder);
+}
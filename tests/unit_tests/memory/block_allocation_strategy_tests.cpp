@@ -0,0 +1,62 @@
+#include "../../src/general_test_setup.hpp"
+
+#include "../../../src/memory/block_allocation_strategy.hpp"
+#include "../../../src/memory/mallocator.hpp"
+#include "nova_renderer/allocation_structs.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace bvestl::polyalloc;
+
+TEST(BlockAllocationStrategy, AllocationsDoNotOverlap) {
+    const allocator_handle allocator(new Mallocator);
+    BlockAllocationStrategy strategy(allocator, Bytes(1024), Bytes(64));
+
+    AllocationInfo first;
+    AllocationInfo second;
+    ASSERT_TRUE(strategy.allocate(Bytes(100), first));
+    ASSERT_TRUE(strategy.allocate(Bytes(64), second));
+
+    EXPECT_EQ(first.offset, Bytes(0));
+    EXPECT_EQ(first.size, Bytes(128));
+    EXPECT_EQ(second.offset, Bytes(128));
+}
+
+TEST(BlockAllocationStrategy, FreedRangesAreReused) {
+    const allocator_handle allocator(new Mallocator);
+    BlockAllocationStrategy strategy(allocator, Bytes(1024), Bytes(64));
+
+    AllocationInfo first;
+    AllocationInfo second;
+    AllocationInfo third;
+    ASSERT_TRUE(strategy.allocate(Bytes(64), first));
+    ASSERT_TRUE(strategy.allocate(Bytes(64), second));
+    ASSERT_TRUE(strategy.allocate(Bytes(64), third));
+
+    strategy.free(second);
+
+    AllocationInfo reused;
+    ASSERT_TRUE(strategy.allocate(Bytes(64), reused));
+    EXPECT_EQ(reused.offset, second.offset);
+}
+
+TEST(BlockAllocationStrategy, FreeingEverythingMergesBlocks) {
+    const allocator_handle allocator(new Mallocator);
+    BlockAllocationStrategy strategy(allocator, Bytes(1024), Bytes(64));
+
+    AllocationInfo first;
+    AllocationInfo second;
+    ASSERT_TRUE(strategy.allocate(Bytes(512), first));
+    ASSERT_TRUE(strategy.allocate(Bytes(512), second));
+
+    AllocationInfo too_big;
+    EXPECT_FALSE(strategy.allocate(Bytes(64), too_big));
+
+    strategy.free(first);
+    strategy.free(second);
+
+    AllocationInfo everything;
+    ASSERT_TRUE(strategy.allocate(Bytes(1024), everything));
+    EXPECT_EQ(everything.offset, Bytes(0));
+}
@@ -0,0 +1,76 @@
+#include "../../src/general_test_setup.hpp"
+
+#include <vector>
+
+#include "nova_renderer/rhi_types.hpp"
+
+#include "../../../src/render_engine/command_list_state_cache.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer::rhi;
+
+TEST(CommandListStateCache, RepeatedBindsAreDroppedAndCounted) {
+    Pipeline pipeline;
+    PipelineInterface pipeline_interface;
+    DescriptorSet set;
+    Buffer vertex_buffer;
+    Buffer index_buffer;
+
+    const std::vector<DescriptorSet*> sets = {&set};
+    const std::vector<Buffer*> vertex_buffers = {&vertex_buffer};
+
+    CommandListStateCache cache;
+    EXPECT_TRUE(cache.should_bind_pipeline(&pipeline));
+    EXPECT_TRUE(cache.should_bind_descriptor_sets(sets, &pipeline_interface));
+    EXPECT_TRUE(cache.should_bind_vertex_buffers(vertex_buffers));
+    EXPECT_TRUE(cache.should_bind_index_buffer(&index_buffer));
+
+    for(int i = 0; i < 3; i++) {
+        EXPECT_FALSE(cache.should_bind_pipeline(&pipeline));
+        EXPECT_FALSE(cache.should_bind_descriptor_sets(sets, &pipeline_interface));
+        EXPECT_FALSE(cache.should_bind_vertex_buffers(vertex_buffers));
+        EXPECT_FALSE(cache.should_bind_index_buffer(&index_buffer));
+    }
+
+    const EliminatedCommandCounts& counts = cache.get_eliminated_command_counts();
+    EXPECT_EQ(counts.pipeline_binds, 3U);
+    EXPECT_EQ(counts.descriptor_set_binds, 3U);
+    EXPECT_EQ(counts.vertex_buffer_binds, 3U);
+    EXPECT_EQ(counts.index_buffer_binds, 3U);
+}
+
+TEST(CommandListStateCache, ChangingThePipelineForgetsTheDescriptorSets) {
+    Pipeline first_pipeline;
+    Pipeline second_pipeline;
+    PipelineInterface pipeline_interface;
+    DescriptorSet set;
+    const std::vector<DescriptorSet*> sets = {&set};
+
+    CommandListStateCache cache;
+    EXPECT_TRUE(cache.should_bind_pipeline(&first_pipeline));
+    EXPECT_TRUE(cache.should_bind_descriptor_sets(sets, &pipeline_interface));
+
+    EXPECT_TRUE(cache.should_bind_pipeline(&second_pipeline));
+    EXPECT_TRUE(cache.should_bind_descriptor_sets(sets, &pipeline_interface));
+    EXPECT_FALSE(cache.should_bind_descriptor_sets(sets, &pipeline_interface));
+}
+
+TEST(CommandListStateCache, InvalidatingForgetsEverything) {
+    Pipeline pipeline;
+    Buffer buffer;
+    const std::vector<Buffer*> no_buffers;
+
+    CommandListStateCache cache;
+    EXPECT_TRUE(cache.should_bind_pipeline(&pipeline));
+    EXPECT_TRUE(cache.should_bind_vertex_buffers(no_buffers));
+    EXPECT_TRUE(cache.should_bind_index_buffer(&buffer));
+
+    cache.invalidate();
+
+    EXPECT_TRUE(cache.should_bind_pipeline(&pipeline));
+    EXPECT_TRUE(cache.should_bind_vertex_buffers(no_buffers));
+    EXPECT_TRUE(cache.should_bind_index_buffer(&buffer));
+    EXPECT_EQ(cache.get_eliminated_command_counts().pipeline_binds, 0U);
+}
@@ -0,0 +1,51 @@
+#include "nova_renderer/util/utils.hpp"
+
+#include "../../src/general_test_setup.hpp"
+
+#include "../../../src/loading/shaderpack/shaderpack_loading.hpp"
+#include "../../../src/render_engine/gl3/gl3_command_list.hpp"
+#include "../../../src/render_engine/gl3/gl3_render_engine.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+using namespace nova::renderer::rhi;
+
+const std::string INSTANCE_INDEX_TEST_SHADER_SOURCE = R"(#version 450
+layout(location = 0) out float instance;
+void main() {
+    instance = float(gl_InstanceIndex);
+    gl_Position = vec4(0, 0, 0, 1);
+}
+)";
+
+TEST(Gl3BaseInstance, SecondBatchDrawsWithItsFirstInstance) {
+    Gl3Pipeline pipeline;
+    pipeline.id = 1;
+    pipeline.base_instance_location = 7;
+
+    Gl3CommandList list;
+    list.bind_pipeline(&pipeline);
+    list.draw_indexed_mesh(36, 4, 0, 0, 0);
+    list.draw_indexed_mesh(36, 3, 36, 0, 4);
+
+    const std::vector<Gl3Command> commands = list.get_commands();
+    ASSERT_EQ(commands.size(), 3U);
+    ASSERT_EQ(commands[2].type, Gl3CommandType::DrawIndexedMesh);
+    EXPECT_EQ(commands[2].draw_indexed_mesh.first_instance, 4U);
+    EXPECT_EQ(commands[2].draw_indexed_mesh.base_instance_location, 7);
+}
+
+TEST(Gl3BaseInstance, InstanceIndexIncludesTheBaseInstance) {
+    shaderpack::initialize_glslang();
+
+    const std::vector<uint32_t> spirv = shaderpack::compile_shader_source(INSTANCE_INDEX_TEST_SHADER_SOURCE,
+                                                                          EShLangVertex,
+                                                                          glslang::EShSourceGlsl,
+                                                                          "instance_index_test.vert");
+    ASSERT_FALSE(spirv.empty());
+
+    const std::string glsl = translate_spirv_to_glsl(spirv);
+    EXPECT_NE(glsl.find("gl_InstanceID + SPIRV_Cross_BaseInstance"), std::string::npos);
+    EXPECT_NE(glsl.find("#define SPIRV_Cross_BaseInstance gl_BaseInstanceARB"), std::string::npos);
+}
@@ -0,0 +1,165 @@
+#include "../../src/general_test_setup.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "nova_renderer/culling.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+/*!
+ * \brief A Vulkan-style perspective projection with a 90 degree field of view, looking down -Z from the origin
+ */
+glm::mat4 make_test_projection() {
+    constexpr float NEAR_PLANE = 0.1F;
+    constexpr float FAR_PLANE = 100.0F;
+
+    glm::mat4 projection(0.0F);
+    projection[0][0] = 1.0F;
+    projection[1][1] = 1.0F;
+    projection[2][2] = FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+    projection[2][3] = -1.0F;
+    projection[3][2] = NEAR_PLANE * FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+    return projection;
+}
+
+Aabb make_box(const glm::vec3& center, const float half_size) {
+    return {glm::vec3(center.x - half_size, center.y - half_size, center.z - half_size),
+            glm::vec3(center.x + half_size, center.y + half_size, center.z + half_size)};
+}
+
+TEST(Culling, BoxesOutsideTheFrustumAreCulled) {
+    const Frustum frustum = make_frustum(make_test_projection());
+
+    AabbList aabbs;
+    aabbs.push_back(make_box({0, 0, -10}, 1));    // In front of the camera
+    aabbs.push_back(make_box({0, 0, 10}, 1));     // Behind the camera
+    aabbs.push_back(make_box({50, 0, -10}, 1));   // Off to the right
+    aabbs.push_back(make_box({0, 0, -200}, 1));   // Past the far plane
+    aabbs.push_back(make_box({10.5F, 0, -10}, 1)); // Straddling the right plane
+
+    std::vector<uint32_t> visible_indices(aabbs.size());
+    const uint32_t num_visible = cull_aabbs(frustum, aabbs, 0, aabbs.size(), nullptr, visible_indices.data());
+
+    ASSERT_EQ(num_visible, 2U);
+    EXPECT_EQ(visible_indices[0], 0U);
+    EXPECT_EQ(visible_indices[1], 4U);
+}
+
+TEST(Culling, DisabledBoxesAreNeverVisible) {
+    AabbList aabbs;
+    for(uint32_t i = 0; i < 10; i++) {
+        aabbs.push_back(make_box({0, 0, -10}, 1));
+    }
+
+    std::vector<uint8_t> enabled(aabbs.size(), 1);
+    enabled[3] = 0;
+    enabled[8] = 0;
+
+    std::vector<uint32_t> visible_indices(aabbs.size());
+    const uint32_t num_visible = cull_aabbs(make_infinite_frustum(), aabbs, 0, aabbs.size(), enabled.data(), visible_indices.data());
+
+    ASSERT_EQ(num_visible, 8U);
+    for(uint32_t i = 0; i < num_visible; i++) {
+        EXPECT_NE(visible_indices[i], 3U);
+        EXPECT_NE(visible_indices[i], 8U);
+    }
+}
+
+TEST(Culling, SimdMatchesScalar) {
+    const Frustum frustum = make_frustum(make_test_projection());
+
+    std::srand(1234);
+    const auto random_float = [] { return static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 2.0F - 1.0F; };
+
+    AabbList aabbs;
+    std::vector<uint8_t> enabled;
+    for(uint32_t i = 0; i < 1003; i++) {
+        aabbs.push_back(make_box({random_float() * 60.0F, random_float() * 60.0F, random_float() * 120.0F}, std::abs(random_float()) * 4));
+        enabled.push_back(i % 7 == 0 ? 0 : 1);
+    }
+
+    // Start and end in the middle of a SIMD group, so both partial groups are tested
+    const uint32_t begin = 3;
+    const uint32_t end = aabbs.size() - 2;
+
+    std::vector<uint32_t> simd_indices(aabbs.size());
+    std::vector<uint32_t> scalar_indices(aabbs.size());
+    const uint32_t num_simd_visible = cull_aabbs(frustum, aabbs, begin, end, enabled.data(), simd_indices.data());
+    const uint32_t num_scalar_visible = cull_aabbs_scalar(frustum, aabbs, begin, end, enabled.data(), scalar_indices.data());
+
+    ASSERT_EQ(num_simd_visible, num_scalar_visible);
+    EXPECT_GT(num_simd_visible, 0U);
+    EXPECT_LT(num_simd_visible, end - begin);
+    for(uint32_t i = 0; i < num_simd_visible; i++) {
+        EXPECT_EQ(simd_indices[i], scalar_indices[i]);
+        EXPECT_GE(simd_indices[i], begin);
+        EXPECT_LT(simd_indices[i], end);
+    }
+}
+
+TEST(Culling, TransformedBoundsContainTheTransformedVertices) {
+    std::vector<FullVertex> vertices(3);
+    vertices[0].position = glm::vec3(-1, 0, 0);
+    vertices[1].position = glm::vec3(1, 2, 0);
+    vertices[2].position = glm::vec3(0, 1, 3);
+
+    const Aabb bounds = compute_bounds(vertices.data(), vertices.size());
+    EXPECT_EQ(bounds.min, glm::vec3(-1, 0, 0));
+    EXPECT_EQ(bounds.max, glm::vec3(1, 2, 3));
+
+    // Rotate 90 degrees around Y, then move 10 units along X
+    glm::mat4 transform(0.0F);
+    transform[0][2] = -1.0F;
+    transform[1][1] = 1.0F;
+    transform[2][0] = 1.0F;
+    transform[3][0] = 10.0F;
+    transform[3][3] = 1.0F;
+
+    const Aabb world_bounds = transform_aabb(bounds, transform);
+    EXPECT_EQ(world_bounds.min, glm::vec3(10, 0, -1));
+    EXPECT_EQ(world_bounds.max, glm::vec3(13, 2, 1));
+}
+
+TEST(Culling, ScreenSizeShrinksWithDistance) {
+    const LodSelector selector = make_lod_selector(make_test_projection(), 0.0F);
+
+    // The bounding sphere of a box with a half size of one has a radius of sqrt(3)
+    EXPECT_NEAR(selector.get_screen_size(make_box({0, 0, -10}, 1)), std::sqrt(3.0F) / 10.0F, 0.0001F);
+    EXPECT_NEAR(selector.get_screen_size(make_box({0, 0, -100}, 1)), std::sqrt(3.0F) / 100.0F, 0.0001F);
+
+    // Boxes around the camera cover the whole screen
+    EXPECT_TRUE(std::isinf(selector.get_screen_size(make_box({0, 0, 0}, 1))));
+}
+
+TEST(Culling, LodsAreSelectedByScreenSize) {
+    const LodSelector selector = make_lod_selector(make_test_projection(), 0.0F);
+
+    const std::vector<MeshLod> lods = {{0, 300, 0.2F}, {300, 120, 0.05F}, {420, 30, 0.0F}};
+
+    EXPECT_EQ(selector.select_lod(0.5F, 2, lods.data(), lods.size()), 0U);
+    EXPECT_EQ(selector.select_lod(0.1F, 0, lods.data(), lods.size()), 1U);
+    EXPECT_EQ(selector.select_lod(0.01F, 0, lods.data(), lods.size()), 2U);
+    EXPECT_EQ(selector.select_lod(0.0F, 0, lods.data(), lods.size()), 2U);
+
+    // A selector without a camera always picks the first LOD
+    const LodSelector no_camera;
+    EXPECT_EQ(no_camera.select_lod(0.01F, 2, lods.data(), lods.size()), 0U);
+}
+
+TEST(Culling, HysteresisKeepsLodsFromFlickering) {
+    const LodSelector selector = make_lod_selector(make_test_projection(), 0.1F);
+
+    const std::vector<MeshLod> lods = {{0, 300, 0.2F}, {300, 120, 0.0F}};
+
+    // Just under the threshold isn't far enough to leave the first LOD, and just over it isn't far enough to come back
+    EXPECT_EQ(selector.select_lod(0.19F, 0, lods.data(), lods.size()), 0U);
+    EXPECT_EQ(selector.select_lod(0.21F, 1, lods.data(), lods.size()), 1U);
+
+    EXPECT_EQ(selector.select_lod(0.17F, 0, lods.data(), lods.size()), 1U);
+    EXPECT_EQ(selector.select_lod(0.23F, 1, lods.data(), lods.size()), 0U);
+}
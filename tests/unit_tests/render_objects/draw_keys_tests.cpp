@@ -0,0 +1,118 @@
+#include "../../src/general_test_setup.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "../../../src/render_objects/draw_keys.hpp"
+#include "../../../src/tasks/task_scheduler.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+std::vector<DrawKey> make_random_draw_keys(const uint32_t num_keys) {
+    std::srand(1234);
+
+    std::vector<DrawKey> keys;
+    keys.reserve(num_keys);
+    for(uint32_t i = 0; i < num_keys; i++) {
+        DrawKeyFields fields;
+        fields.queue = static_cast<DrawQueue>(std::rand() % 3);
+        fields.pipeline = static_cast<uint32_t>(std::rand()) % 16;
+        fields.material_pass = static_cast<uint32_t>(std::rand()) % 64;
+        fields.mesh_batch = i % MAX_MESH_BATCH;
+        fields.depth = quantize_depth(static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 1000.0F);
+        keys.push_back(make_draw_key(fields));
+    }
+
+    return keys;
+}
+
+TEST(DrawKeys, DecodingAKeyGivesBackItsFields) {
+    for(const DrawQueue queue : {DrawQueue::Opaque, DrawQueue::Cutout, DrawQueue::Transparent}) {
+        DrawKeyFields fields;
+        fields.queue = queue;
+        fields.pipeline = MAX_PIPELINE - 1;
+        fields.material_pass = 1234;
+        fields.mesh_batch = MAX_MESH_BATCH - 2;
+        fields.depth = 0xABCD;
+
+        const DrawKeyFields decoded = decode_draw_key(make_draw_key(fields));
+        EXPECT_EQ(decoded.queue, fields.queue);
+        EXPECT_EQ(decoded.pipeline, fields.pipeline);
+        EXPECT_EQ(decoded.material_pass, fields.material_pass);
+        EXPECT_EQ(decoded.mesh_batch, fields.mesh_batch);
+        EXPECT_EQ(decoded.depth, fields.depth);
+    }
+}
+
+TEST(DrawKeys, QueuesAreDrawnInOrder) {
+    DrawKeyFields opaque;
+    opaque.queue = DrawQueue::Opaque;
+    opaque.pipeline = MAX_PIPELINE - 1;
+    opaque.depth = 0xFFFF;
+
+    DrawKeyFields cutout;
+    cutout.queue = DrawQueue::Cutout;
+
+    DrawKeyFields transparent;
+    transparent.queue = DrawQueue::Transparent;
+    transparent.depth = 0xFFFF;
+
+    EXPECT_LT(make_draw_key(opaque), make_draw_key(cutout));
+    EXPECT_LT(make_draw_key(cutout), make_draw_key(transparent));
+}
+
+TEST(DrawKeys, OpaqueDrawsSortFrontToBackAndTransparentDrawsSortBackToFront) {
+    DrawKeyFields near_draw;
+    near_draw.depth = quantize_depth(1.0F);
+    near_draw.mesh_batch = 1;
+
+    DrawKeyFields far_draw;
+    far_draw.depth = quantize_depth(100.0F);
+    far_draw.mesh_batch = 0;
+
+    EXPECT_LT(make_draw_key(near_draw), make_draw_key(far_draw));
+
+    near_draw.queue = DrawQueue::Transparent;
+    far_draw.queue = DrawQueue::Transparent;
+    near_draw.pipeline = 0;
+    far_draw.pipeline = 5;
+
+    EXPECT_GT(make_draw_key(near_draw), make_draw_key(far_draw));
+}
+
+TEST(DrawKeys, QuantizingKeepsDepthOrder) {
+    EXPECT_EQ(quantize_depth(-5.0F), 0U);
+    EXPECT_LT(quantize_depth(0.5F), quantize_depth(1.0F));
+    EXPECT_LT(quantize_depth(1.0F), quantize_depth(1.1F));
+    EXPECT_LT(quantize_depth(100.0F), quantize_depth(200.0F));
+}
+
+TEST(DrawKeys, RadixSortMatchesStdSort) {
+    for(const uint32_t num_keys : {0U, 10U, 1000U, 100000U}) {
+        std::vector<DrawKey> keys = make_random_draw_keys(num_keys);
+        std::vector<DrawKey> expected_keys = keys;
+        std::sort(expected_keys.begin(), expected_keys.end());
+
+        std::vector<DrawKey> scratch;
+        sort_draw_keys(keys, scratch);
+
+        EXPECT_EQ(keys, expected_keys);
+    }
+}
+
+TEST(DrawKeys, ParallelRadixSortMatchesStdSort) {
+    nova::ttl::task_scheduler scheduler(4, nova::ttl::empty_queue_behavior::SLEEP);
+
+    std::vector<DrawKey> keys = make_random_draw_keys(500000);
+    std::vector<DrawKey> expected_keys = keys;
+    std::sort(expected_keys.begin(), expected_keys.end());
+
+    std::vector<DrawKey> scratch;
+    sort_draw_keys(keys, scratch, &scheduler);
+
+    EXPECT_EQ(keys, expected_keys);
+}
@@ -0,0 +1,94 @@
+#include "../../src/general_test_setup.hpp"
+
+#include "../../../src/render_objects/gpu_culled_renderables.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+/*!
+ * \brief Adds a visible renderable at the origin to a draw, returning its slot
+ */
+uint32_t insert_test_renderable(GpuCulledRenderables& renderables, const RenderableId id, const uint32_t draw) {
+    return renderables.insert(id, draw, glm::mat4(1), InstanceData{}, Aabb{glm::vec3(-1), glm::vec3(1)}, true);
+}
+
+TEST(GpuCulledRenderables, AddDrawReturnsNoDrawWhenFull) {
+    GpuCulledRenderables renderables(4, 2);
+
+    EXPECT_EQ(renderables.add_draw(), 0U);
+    EXPECT_EQ(renderables.add_draw(), 1U);
+    EXPECT_EQ(renderables.add_draw(), GpuCulledRenderables::NO_DRAW);
+    EXPECT_EQ(renderables.get_draws().size(), 2U);
+}
+
+TEST(GpuCulledRenderables, InsertFailsAtCapacity) {
+    GpuCulledRenderables renderables(2, 1);
+    const uint32_t draw = renderables.add_draw();
+
+    EXPECT_EQ(insert_test_renderable(renderables, 10, draw), 0U);
+    EXPECT_EQ(insert_test_renderable(renderables, 11, draw), 1U);
+    EXPECT_EQ(insert_test_renderable(renderables, 12, draw), GpuCulledRenderables::NO_SLOT);
+
+    EXPECT_TRUE(renderables.contains(11));
+    EXPECT_FALSE(renderables.contains(12));
+
+    // The renderable that didn't fit doesn't take up an instance
+    EXPECT_TRUE(renderables.update_draw_ranges());
+    EXPECT_EQ(renderables.get_num_instances(), 2U);
+}
+
+TEST(GpuCulledRenderables, UpdateMovesRenderableBetweenDraws) {
+    GpuCulledRenderables renderables(8, 2);
+    const uint32_t first_draw = renderables.add_draw();
+    const uint32_t second_draw = renderables.add_draw();
+
+    (void) insert_test_renderable(renderables, 1, first_draw);
+    (void) insert_test_renderable(renderables, 2, first_draw);
+    (void) insert_test_renderable(renderables, 3, second_draw);
+
+    EXPECT_TRUE(renderables.update_draw_ranges());
+    EXPECT_EQ(renderables.get_draws()[second_draw].first_instance, 2U);
+    EXPECT_FALSE(renderables.update_draw_ranges());
+
+    glm::mat4 moved_matrix(1);
+    moved_matrix[3] = glm::vec4(5, 0, 0, 1);
+    const uint32_t slot = renderables.update(2, second_draw, moved_matrix, InstanceData{}, Aabb{glm::vec3(4), glm::vec3(6)});
+    ASSERT_EQ(slot, 1U);
+    EXPECT_EQ(renderables.get_renderable(slot).draw_index, second_draw);
+    EXPECT_EQ(renderables.get_renderable(slot).model_matrix[3].x, 5.0F);
+
+    // The second draw's range starts earlier and is larger now
+    EXPECT_TRUE(renderables.update_draw_ranges());
+    EXPECT_EQ(renderables.get_draws()[second_draw].first_instance, 1U);
+    EXPECT_EQ(renderables.get_num_instances(), 3U);
+
+    EXPECT_EQ(renderables.update(4, second_draw, moved_matrix, InstanceData{}, Aabb{}), GpuCulledRenderables::NO_SLOT);
+}
+
+TEST(GpuCulledRenderables, RemoveDisablesSlotForReuse) {
+    GpuCulledRenderables renderables(2, 1);
+    const uint32_t draw = renderables.add_draw();
+
+    (void) insert_test_renderable(renderables, 1, draw);
+    (void) insert_test_renderable(renderables, 2, draw);
+
+    const uint32_t removed_slot = renderables.remove(1);
+    ASSERT_EQ(removed_slot, 0U);
+    EXPECT_EQ(renderables.get_renderable(removed_slot).is_enabled, 0U);
+    EXPECT_FALSE(renderables.contains(1));
+    EXPECT_EQ(renderables.remove(1), GpuCulledRenderables::NO_SLOT);
+
+    // The other renderable stays where it was, so only the removed slot has to be written to the GPU
+    EXPECT_EQ(renderables.get_num_slots(), 2U);
+    EXPECT_EQ(renderables.set_visibility(2, true), 1U);
+
+    EXPECT_TRUE(renderables.update_draw_ranges());
+    EXPECT_EQ(renderables.get_num_instances(), 1U);
+
+    // The freed slot is reused, so a full list has room again
+    EXPECT_EQ(insert_test_renderable(renderables, 3, draw), removed_slot);
+    EXPECT_EQ(renderables.get_renderable(removed_slot).is_enabled, 1U);
+    EXPECT_EQ(renderables.get_num_slots(), 2U);
+}
@@ -0,0 +1,200 @@
+#include "../../src/general_test_setup.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+#include "../../../src/render_objects/mesh_optimizer.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+using Triangle = std::array<glm::vec3, 3>;
+
+/*!
+ * \brief A flat grid of quads, with its triangles shuffled so that it uses the vertex cache badly
+ */
+MeshData make_shuffled_grid(const uint32_t size) {
+    MeshData mesh;
+    for(uint32_t y = 0; y <= size; y++) {
+        for(uint32_t x = 0; x <= size; x++) {
+            FullVertex vertex{};
+            vertex.position = glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0F);
+            mesh.vertex_data.push_back(vertex);
+        }
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for(uint32_t y = 0; y < size; y++) {
+        for(uint32_t x = 0; x < size; x++) {
+            const uint32_t corner = y * (size + 1) + x;
+            triangles.push_back({corner, corner + 1, corner + size + 1});
+            triangles.push_back({corner + 1, corner + size + 2, corner + size + 1});
+        }
+    }
+
+    std::srand(1234);
+    for(size_t i = triangles.size() - 1; i > 0; i--) {
+        std::swap(triangles[i], triangles[static_cast<size_t>(std::rand()) % (i + 1)]);
+    }
+
+    for(const auto& triangle : triangles) {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+
+    return mesh;
+}
+
+/*!
+ * \brief The positions of each triangle in a range of a mesh's indices, sorted so that two lists of the same triangles compare equal
+ */
+std::vector<Triangle> get_triangles(const MeshData& mesh, const uint32_t first_index, const uint32_t num_indices) {
+    std::vector<Triangle> triangles;
+    for(uint32_t i = first_index; i < first_index + num_indices; i += 3) {
+        triangles.push_back({mesh.vertex_data[mesh.indices[i]].position,
+                             mesh.vertex_data[mesh.indices[i + 1]].position,
+                             mesh.vertex_data[mesh.indices[i + 2]].position});
+    }
+
+    const auto to_tuple = [](const Triangle& triangle) {
+        return std::make_tuple(triangle[0].x, triangle[0].y, triangle[1].x, triangle[1].y, triangle[2].x, triangle[2].y);
+    };
+    std::sort(triangles.begin(), triangles.end(), [&](const Triangle& first, const Triangle& second) {
+        return to_tuple(first) < to_tuple(second);
+    });
+
+    return triangles;
+}
+
+TEST(MeshOptimizer, AnalysisCountsCacheMisses) {
+    // Two triangles that share an edge only transform four vertices
+    const std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 3};
+    const VertexCacheStats stats = analyze_vertex_cache(indices.data(), indices.size(), 4);
+
+    EXPECT_EQ(stats.num_transformed_vertices, 4U);
+    EXPECT_FLOAT_EQ(stats.acmr, 2.0F);
+    EXPECT_FLOAT_EQ(stats.atvr, 1.0F);
+
+    // With a cache that only holds one vertex, every vertex but the repeated 2 misses
+    EXPECT_EQ(analyze_vertex_cache(indices.data(), indices.size(), 4, 1).num_transformed_vertices, 5U);
+}
+
+TEST(MeshOptimizer, VertexCacheOptimizationKeepsTrianglesAndReducesMisses) {
+    MeshData mesh = make_shuffled_grid(32);
+    const auto num_vertices = static_cast<uint32_t>(mesh.vertex_data.size());
+    const auto num_indices = static_cast<uint32_t>(mesh.indices.size());
+
+    const std::vector<Triangle> triangles_before = get_triangles(mesh, 0, num_indices);
+    const VertexCacheStats stats_before = analyze_vertex_cache(mesh.indices.data(), num_indices, num_vertices);
+
+    optimize_vertex_cache(mesh.indices.data(), num_indices, num_vertices);
+
+    const VertexCacheStats stats_after = analyze_vertex_cache(mesh.indices.data(), num_indices, num_vertices);
+    EXPECT_EQ(get_triangles(mesh, 0, num_indices), triangles_before);
+    EXPECT_LT(stats_after.acmr, stats_before.acmr * 0.5F);
+    EXPECT_LT(stats_after.acmr, 1.0F);
+}
+
+TEST(MeshOptimizer, OverdrawOptimizationKeepsTriangles) {
+    MeshData mesh = make_shuffled_grid(32);
+    const auto num_vertices = static_cast<uint32_t>(mesh.vertex_data.size());
+    const auto num_indices = static_cast<uint32_t>(mesh.indices.size());
+
+    optimize_vertex_cache(mesh.indices.data(), num_indices, num_vertices);
+    const std::vector<Triangle> triangles_before = get_triangles(mesh, 0, num_indices);
+    const VertexCacheStats stats_before = analyze_vertex_cache(mesh.indices.data(), num_indices, num_vertices);
+
+    optimize_overdraw(mesh.indices.data(), num_indices, mesh.vertex_data.data(), num_vertices, 1.05F);
+
+    const VertexCacheStats stats_after = analyze_vertex_cache(mesh.indices.data(), num_indices, num_vertices);
+    EXPECT_EQ(get_triangles(mesh, 0, num_indices), triangles_before);
+    EXPECT_LT(stats_after.acmr, stats_before.acmr * 1.25F);
+}
+
+TEST(MeshOptimizer, VertexFetchOptimizationOrdersVerticesByFirstUse) {
+    MeshData mesh = make_shuffled_grid(8);
+    const auto num_vertices = static_cast<uint32_t>(mesh.vertex_data.size());
+    const auto num_indices = static_cast<uint32_t>(mesh.indices.size());
+
+    // A vertex that nothing uses stays in the mesh
+    FullVertex unused_vertex{};
+    unused_vertex.position = glm::vec3(-1, -1, -1);
+    mesh.vertex_data.push_back(unused_vertex);
+
+    const std::vector<Triangle> triangles_before = get_triangles(mesh, 0, num_indices);
+
+    optimize_vertex_fetch(mesh.vertex_data, mesh.indices.data(), num_indices);
+
+    ASSERT_EQ(mesh.vertex_data.size(), num_vertices + 1);
+    EXPECT_EQ(mesh.vertex_data.back().position, unused_vertex.position);
+    EXPECT_EQ(get_triangles(mesh, 0, num_indices), triangles_before);
+
+    uint32_t next_new_vertex = 0;
+    for(const uint32_t index : mesh.indices) {
+        ASSERT_LE(index, next_new_vertex);
+        if(index == next_new_vertex) {
+            next_new_vertex++;
+        }
+    }
+}
+
+TEST(MeshOptimizer, EachLodKeepsItsOwnTriangles) {
+    MeshData mesh = make_shuffled_grid(16);
+    const auto num_indices = static_cast<uint32_t>(mesh.indices.size());
+
+    const uint32_t lod_1_start = num_indices / 3 / 4 * 3;
+    mesh.lods = {{0, lod_1_start, 0.5F}, {lod_1_start, num_indices - lod_1_start, 0.0F}};
+
+    const std::vector<Triangle> lod_0_before = get_triangles(mesh, 0, lod_1_start);
+    const std::vector<Triangle> lod_1_before = get_triangles(mesh, lod_1_start, num_indices - lod_1_start);
+
+    NovaSettings::MeshOptimizationOptions options;
+    options.optimize_vertex_cache = true;
+    options.optimize_overdraw = true;
+    options.optimize_vertex_fetch = true;
+
+    const MeshOptimizationReport report = optimize_mesh(mesh, options);
+
+    EXPECT_EQ(get_triangles(mesh, 0, lod_1_start), lod_0_before);
+    EXPECT_EQ(get_triangles(mesh, lod_1_start, num_indices - lod_1_start), lod_1_before);
+    EXPECT_LT(report.after.acmr, report.before.acmr);
+}
+
+TEST(MeshOptimizer, LodsOutsideTheIndicesAreNotReordered) {
+    MeshData mesh = make_shuffled_grid(8);
+    const auto num_indices = static_cast<uint32_t>(mesh.indices.size());
+
+    NovaSettings::MeshOptimizationOptions options;
+    options.optimize_vertex_cache = true;
+    options.optimize_overdraw = true;
+
+    // The second LOD runs past the end of the indices
+    mesh.lods = {{0, num_indices / 2 / 3 * 3, 0.5F}, {num_indices / 2 / 3 * 3, num_indices, 0.0F}};
+    const std::vector<uint32_t> indices_before = mesh.indices;
+    (void) optimize_mesh(mesh, options);
+    EXPECT_EQ(mesh.indices, indices_before);
+
+    // LODs must be made of whole triangles
+    mesh.lods = {{0, 4, 0.5F}, {4, num_indices - 4, 0.0F}};
+    (void) optimize_mesh(mesh, options);
+    EXPECT_EQ(mesh.indices, indices_before);
+}
+
+TEST(MeshOptimizer, MeshesWithIndicesPastTheirVerticesAreNotChanged) {
+    MeshData mesh = make_shuffled_grid(8);
+    mesh.indices.back() = static_cast<uint32_t>(mesh.vertex_data.size());
+
+    NovaSettings::MeshOptimizationOptions options;
+    options.optimize_vertex_cache = true;
+    options.optimize_overdraw = true;
+    options.optimize_vertex_fetch = true;
+
+    const std::vector<uint32_t> indices_before = mesh.indices;
+    const MeshOptimizationReport report = optimize_mesh(mesh, options);
+    EXPECT_EQ(mesh.indices, indices_before);
+    EXPECT_EQ(report.after.num_transformed_vertices, 0U);
+}
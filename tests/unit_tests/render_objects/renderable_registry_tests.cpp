@@ -0,0 +1,76 @@
+#include "../../src/general_test_setup.hpp"
+
+#include "../../../src/render_objects/renderable_registry.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+RenderableLocation make_location(const uint32_t batch_index, const uint32_t index_in_batch) {
+    RenderableLocation location;
+    location.material_pass = {0, 0, 0};
+    location.batch_index = batch_index;
+    location.index_in_batch = index_in_batch;
+    return location;
+}
+
+TEST(RenderableRegistry, FindsAddedRenderables) {
+    RenderableRegistry registry;
+
+    const RenderableId first = registry.add(make_location(0, 0));
+    const RenderableId second = registry.add(make_location(1, 5));
+
+    EXPECT_NE(first, second);
+    EXPECT_EQ(registry.size(), 2U);
+
+    ASSERT_NE(registry.find(first), nullptr);
+    EXPECT_EQ(registry.find(first)->batch_index, 0U);
+
+    ASSERT_NE(registry.find(second), nullptr);
+    EXPECT_EQ(registry.find(second)->batch_index, 1U);
+    EXPECT_EQ(registry.find(second)->index_in_batch, 5U);
+}
+
+TEST(RenderableRegistry, RemovedIdsAreNeverValidAgain) {
+    RenderableRegistry registry;
+
+    const RenderableId removed = registry.add(make_location(0, 0));
+    EXPECT_TRUE(registry.remove(removed));
+    EXPECT_FALSE(registry.remove(removed));
+    EXPECT_EQ(registry.find(removed), nullptr);
+
+    // The new renderable reuses the removed renderable's slot, but the old ID must not find it
+    const RenderableId reused = registry.add(make_location(3, 0));
+    EXPECT_NE(reused, removed);
+    EXPECT_EQ(registry.find(removed), nullptr);
+
+    ASSERT_NE(registry.find(reused), nullptr);
+    EXPECT_EQ(registry.find(reused)->batch_index, 3U);
+    EXPECT_EQ(registry.size(), 1U);
+}
+
+TEST(RenderableRegistry, ClearInvalidatesEveryId) {
+    RenderableRegistry registry;
+
+    const RenderableId first = registry.add(make_location(0, 0));
+    const RenderableId second = registry.add(make_location(0, 1));
+
+    registry.clear();
+
+    EXPECT_EQ(registry.size(), 0U);
+    EXPECT_EQ(registry.find(first), nullptr);
+    EXPECT_EQ(registry.find(second), nullptr);
+
+    const RenderableId third = registry.add(make_location(0, 0));
+    EXPECT_NE(third, first);
+    EXPECT_NE(third, second);
+    EXPECT_NE(registry.find(third), nullptr);
+}
+
+TEST(RenderableRegistry, InvalidIdIsNeverFound) {
+    RenderableRegistry registry;
+    (void) registry.add(make_location(0, 0));
+
+    EXPECT_EQ(registry.find(RenderableRegistry::INVALID_ID), nullptr);
+}
@@ -0,0 +1,125 @@
+#include "../../src/general_test_setup.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "../../../src/render_objects/spatial_index.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+/*!
+ * \brief A Vulkan-style perspective projection with a 90 degree field of view, looking down -Z from the origin
+ */
+glm::mat4 make_spatial_index_test_projection() {
+    constexpr float NEAR_PLANE = 0.1F;
+    constexpr float FAR_PLANE = 300.0F;
+
+    glm::mat4 projection(0.0F);
+    projection[0][0] = 1.0F;
+    projection[1][1] = 1.0F;
+    projection[2][2] = FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+    projection[2][3] = -1.0F;
+    projection[3][2] = NEAR_PLANE * FAR_PLANE / (NEAR_PLANE - FAR_PLANE);
+    return projection;
+}
+
+/*!
+ * \brief Makes boxes of all sizes, from much smaller than a leaf cell to larger than the top-level cells, on both sides of the origin
+ */
+std::vector<Aabb> make_random_boxes(const uint32_t num_boxes) {
+    std::srand(1234);
+    const auto random_float = [] { return static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 2.0F - 1.0F; };
+
+    std::vector<Aabb> boxes;
+    for(uint32_t i = 0; i < num_boxes; i++) {
+        const glm::vec3 center(random_float() * 400.0F, random_float() * 400.0F, random_float() * 400.0F);
+        const float half_size = i % 100 == 0 ? 600.0F : std::abs(random_float()) * (i % 10 == 0 ? 40.0F : 4.0F);
+        boxes.push_back({glm::vec3(center.x - half_size, center.y - half_size, center.z - half_size),
+                         glm::vec3(center.x + half_size, center.y + half_size, center.z + half_size)});
+    }
+
+    return boxes;
+}
+
+TEST(SpatialIndex, FrustumQueryMatchesTestingEveryBox) {
+    const std::vector<Aabb> boxes = make_random_boxes(5000);
+
+    SpatialIndex index(16, 5);
+    AabbList aabbs;
+    for(uint32_t i = 0; i < boxes.size(); i++) {
+        index.insert(i, boxes[i]);
+        aabbs.push_back(boxes[i]);
+    }
+
+    const Frustum frustum = make_frustum(make_spatial_index_test_projection());
+
+    std::vector<uint32_t> expected_indices(boxes.size());
+    expected_indices.resize(cull_aabbs_scalar(frustum, aabbs, 0, aabbs.size(), nullptr, expected_indices.data()));
+
+    std::vector<RenderableId> found_ids;
+    index.query_frustum(frustum, found_ids);
+    std::sort(found_ids.begin(), found_ids.end());
+
+    ASSERT_EQ(found_ids.size(), expected_indices.size());
+    for(size_t i = 0; i < found_ids.size(); i++) {
+        EXPECT_EQ(found_ids[i], expected_indices[i]);
+    }
+}
+
+TEST(SpatialIndex, SphereQueryFindsOnlyNearbyBoxes) {
+    SpatialIndex index;
+    index.insert(0, {glm::vec3(0, 0, 0), glm::vec3(1, 1, 1)});
+    index.insert(1, {glm::vec3(-20, 0, 0), glm::vec3(-19, 1, 1)});
+    index.insert(2, {glm::vec3(500, 0, 0), glm::vec3(501, 1, 1)});
+    index.insert(3, {glm::vec3(-3, -3, -3), glm::vec3(-2, -2, -2)});
+
+    std::vector<RenderableId> found_ids;
+    index.query_sphere(glm::vec3(0, 0, 0), 5, found_ids);
+    std::sort(found_ids.begin(), found_ids.end());
+
+    ASSERT_EQ(found_ids.size(), 2U);
+    EXPECT_EQ(found_ids[0], 0U);
+    EXPECT_EQ(found_ids[1], 3U);
+}
+
+TEST(SpatialIndex, UpdatedBoxesAreFoundAtTheirNewPosition) {
+    SpatialIndex index;
+    index.insert(7, {glm::vec3(0, 0, 0), glm::vec3(1, 1, 1)});
+
+    index.update(7, {glm::vec3(1000, 0, 0), glm::vec3(1001, 1, 1)});
+
+    std::vector<RenderableId> found_ids;
+    index.query_sphere(glm::vec3(0, 0, 0), 5, found_ids);
+    EXPECT_TRUE(found_ids.empty());
+
+    index.query_sphere(glm::vec3(1000, 0, 0), 5, found_ids);
+    ASSERT_EQ(found_ids.size(), 1U);
+    EXPECT_EQ(found_ids[0], 7U);
+    EXPECT_EQ(index.size(), 1U);
+}
+
+TEST(SpatialIndex, RemovingEveryBoxFreesEveryCell) {
+    const std::vector<Aabb> boxes = make_random_boxes(1000);
+
+    SpatialIndex index;
+    for(uint32_t i = 0; i < boxes.size(); i++) {
+        index.insert(i, boxes[i]);
+    }
+    EXPECT_GT(index.get_num_cells(), 0U);
+
+    for(uint32_t i = 0; i < boxes.size(); i++) {
+        EXPECT_TRUE(index.remove(i));
+    }
+    EXPECT_FALSE(index.remove(0));
+
+    EXPECT_EQ(index.size(), 0U);
+    EXPECT_EQ(index.get_num_cells(), 0U);
+
+    std::vector<RenderableId> found_ids;
+    index.query_frustum(make_infinite_frustum(), found_ids);
+    EXPECT_TRUE(found_ids.empty());
+}
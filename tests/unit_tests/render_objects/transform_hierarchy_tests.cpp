@@ -0,0 +1,152 @@
+#include "../../src/general_test_setup.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "../../../src/render_objects/transform_hierarchy.hpp"
+#include "../../../src/tasks/task_scheduler.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+void expect_matrices_near(const glm::mat4& actual, const glm::mat4& expected) {
+    for(int column = 0; column < 4; column++) {
+        for(int row = 0; row < 4; row++) {
+            EXPECT_NEAR(actual[column][row], expected[column][row], 0.0001F) << "at column " << column << ", row " << row;
+        }
+    }
+}
+
+glm::mat4 make_local_matrix(const TransformData& data) {
+    glm::mat4 matrix = glm::translate(glm::mat4(1), data.position);
+    matrix = glm::rotate(matrix, data.rotation.x, glm::vec3(1, 0, 0));
+    matrix = glm::rotate(matrix, data.rotation.y, glm::vec3(0, 1, 0));
+    matrix = glm::rotate(matrix, data.rotation.z, glm::vec3(0, 0, 1));
+    return glm::scale(matrix, data.scale);
+}
+
+TransformData make_transform(const float x, const TransformId parent = NO_TRANSFORM) {
+    TransformData data;
+    data.position = glm::vec3(x, 2.0F, -3.0F);
+    data.rotation = glm::vec3(0.3F, -1.2F, 2.5F);
+    data.scale = glm::vec3(1.0F, 2.0F, 0.5F);
+    data.parent = parent;
+    return data;
+}
+
+TEST(TransformHierarchy, ComposedMatricesMatchGlm) {
+    TransformData data = make_transform(1.0F);
+
+    glm::mat4 parent = make_local_matrix(make_transform(-4.0F));
+    glm::mat4 world_matrix;
+    compose_world_matrix(parent, data.position, make_rotation_quaternion(data.rotation), data.scale, world_matrix);
+
+    expect_matrices_near(world_matrix, parent * make_local_matrix(data));
+}
+
+TEST(TransformHierarchy, ChildrenFollowTheirParents) {
+    TransformHierarchy hierarchy;
+    const TransformId parent = hierarchy.add(make_transform(1.0F));
+    const TransformId child = hierarchy.add(make_transform(2.0F, parent), 42);
+    const TransformId grandchild = hierarchy.add(make_transform(3.0F, child), 43);
+
+    expect_matrices_near(*hierarchy.get_world_matrix(grandchild),
+                         make_local_matrix(make_transform(1.0F)) * make_local_matrix(make_transform(2.0F)) *
+                             make_local_matrix(make_transform(3.0F)));
+
+    EXPECT_TRUE(hierarchy.set_local_transform(parent, make_transform(10.0F)));
+    EXPECT_EQ(hierarchy.update(), 3U);
+
+    const std::vector<RenderableId> moved_renderables = {42, 43};
+    EXPECT_EQ(hierarchy.get_moved_renderables(), moved_renderables);
+
+    expect_matrices_near(*hierarchy.get_world_matrix(grandchild),
+                         make_local_matrix(make_transform(10.0F)) * make_local_matrix(make_transform(2.0F)) *
+                             make_local_matrix(make_transform(3.0F)));
+}
+
+TEST(TransformHierarchy, OnlyDirtyTransformsAreRecomputed) {
+    TransformHierarchy hierarchy;
+    std::vector<TransformId> roots;
+    for(uint32_t i = 0; i < 100; i++) {
+        roots.push_back(hierarchy.add(make_transform(static_cast<float>(i))));
+        (void) hierarchy.add(make_transform(0.0F, roots.back()));
+    }
+
+    EXPECT_EQ(hierarchy.update(), 0U);
+
+    hierarchy.set_local_transform(roots[5], make_transform(-1.0F));
+    hierarchy.set_local_transform(roots[50], make_transform(-1.0F));
+    EXPECT_EQ(hierarchy.update(), 4U);
+    EXPECT_EQ(hierarchy.update(), 0U);
+}
+
+TEST(TransformHierarchy, RemovingATransformAttachesItsChildrenToItsParent) {
+    TransformHierarchy hierarchy;
+    const TransformId root = hierarchy.add(make_transform(1.0F));
+    const TransformId middle = hierarchy.add(make_transform(2.0F, root));
+    const TransformId leaf = hierarchy.add(make_transform(3.0F, middle));
+
+    EXPECT_TRUE(hierarchy.remove(middle));
+    EXPECT_FALSE(hierarchy.contains(middle));
+    EXPECT_FALSE(hierarchy.remove(middle));
+    EXPECT_EQ(hierarchy.size(), 2U);
+
+    EXPECT_EQ(hierarchy.update(), 1U);
+    expect_matrices_near(*hierarchy.get_world_matrix(leaf),
+                         make_local_matrix(make_transform(1.0F)) * make_local_matrix(make_transform(3.0F)));
+
+    // The removed transform's slot is reused, but its old ID stays invalid
+    const TransformId new_transform = hierarchy.add(make_transform(4.0F));
+    EXPECT_NE(new_transform, middle);
+    EXPECT_EQ(hierarchy.get_world_matrix(middle), nullptr);
+}
+
+TEST(TransformHierarchy, ReparentingMovesSubtrees) {
+    TransformHierarchy hierarchy;
+    const TransformId first_root = hierarchy.add(make_transform(1.0F));
+    const TransformId child = hierarchy.add(make_transform(2.0F, first_root));
+    const TransformId second_root = hierarchy.add(make_transform(5.0F));
+
+    // A transform that's added before its new parent has to be sorted after it
+    EXPECT_TRUE(hierarchy.set_local_transform(second_root, make_transform(5.0F, child)));
+    EXPECT_FALSE(hierarchy.set_local_transform(first_root, make_transform(1.0F, second_root)));
+
+    EXPECT_EQ(hierarchy.update(), 1U);
+    expect_matrices_near(*hierarchy.get_world_matrix(second_root),
+                         make_local_matrix(make_transform(1.0F)) * make_local_matrix(make_transform(2.0F)) *
+                             make_local_matrix(make_transform(5.0F)));
+}
+
+TEST(TransformHierarchy, ParallelUpdatesMatchSerialUpdates) {
+    nova::ttl::task_scheduler scheduler(4, nova::ttl::empty_queue_behavior::SLEEP);
+
+    TransformHierarchy serial_hierarchy;
+    TransformHierarchy parallel_hierarchy;
+    std::vector<TransformId> serial_ids;
+    std::vector<TransformId> parallel_ids;
+    for(uint32_t i = 0; i < 20000; i++) {
+        // Each transform's parent is one of the transforms before it, so the hierarchy is wide and several levels deep
+        const bool is_root = i < 100;
+        const uint32_t parent = is_root ? 0 : (i * 7919) % i;
+        serial_ids.push_back(serial_hierarchy.add(make_transform(static_cast<float>(i), is_root ? NO_TRANSFORM : serial_ids[parent])));
+        parallel_ids.push_back(
+            parallel_hierarchy.add(make_transform(static_cast<float>(i), is_root ? NO_TRANSFORM : parallel_ids[parent])));
+    }
+
+    for(uint32_t i = 0; i < 100; i += 3) {
+        serial_hierarchy.set_local_transform(serial_ids[i], make_transform(-static_cast<float>(i)));
+        parallel_hierarchy.set_local_transform(parallel_ids[i], make_transform(-static_cast<float>(i)));
+    }
+
+    EXPECT_EQ(parallel_hierarchy.update(&scheduler), serial_hierarchy.update());
+    for(uint32_t i = 0; i < serial_ids.size(); i++) {
+        const glm::mat4& serial_matrix = *serial_hierarchy.get_world_matrix(serial_ids[i]);
+        const glm::mat4& parallel_matrix = *parallel_hierarchy.get_world_matrix(parallel_ids[i]);
+        for(int column = 0; column < 4; column++) {
+            ASSERT_EQ(serial_matrix[column], parallel_matrix[column]);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include "../../src/general_test_setup.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "nova_renderer/vertex_formats.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+std::vector<FullVertex> make_test_vertices(const size_t num_vertices) {
+    std::vector<FullVertex> vertices(num_vertices);
+
+    std::srand(1234);
+    const auto random_float = [] { return static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 2.0F - 1.0F; };
+    const auto random_unit_vector = [&] {
+        const glm::vec3 vector(random_float(), random_float(), random_float() + 0.01F);
+        const float length = std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z);
+        return glm::vec3(vector.x / length, vector.y / length, vector.z / length);
+    };
+
+    for(size_t i = 0; i < num_vertices; i++) {
+        FullVertex& vertex = vertices[i];
+        vertex.position = glm::vec3(random_float() * 8.0F + 8.0F, random_float() * 8.0F + 8.0F, random_float() * 8.0F + 8.0F);
+        vertex.normal = random_unit_vector();
+        vertex.tangent = random_unit_vector();
+        vertex.main_uv = glm::u16vec2(static_cast<uint16_t>(i * 7), static_cast<uint16_t>(i * 13));
+        vertex.secondary_uv = glm::u8vec2(static_cast<uint8_t>(i), static_cast<uint8_t>(i * 3));
+        vertex.virtual_texture_id = static_cast<uint32_t>(i);
+        vertex.additional_stuff = glm::vec4(random_float() * 0.5F + 0.5F, 0.0F, 1.0F, 0.25F);
+    }
+
+    return vertices;
+}
+
+TEST(VertexFormats, SimdConversionMatchesScalar) {
+    // Not a multiple of four, so that both the SIMD loop and the scalar tail run
+    const std::vector<FullVertex> vertices = make_test_vertices(1027);
+    const PositionQuantization quantization = {glm::vec3(0.0F), 16.0F};
+
+    std::vector<CompactVertex> simd_vertices(vertices.size());
+    std::vector<CompactVertex> scalar_vertices(vertices.size());
+    convert_to_compact_vertices(vertices.data(), vertices.size(), quantization, simd_vertices.data());
+    convert_to_compact_vertices_scalar(vertices.data(), vertices.size(), quantization, scalar_vertices.data());
+
+    for(size_t i = 0; i < vertices.size(); i++) {
+        const CompactVertex& simd = simd_vertices[i];
+        const CompactVertex& scalar = scalar_vertices[i];
+
+        // Allow one step of difference, in case the compiler contracts the scalar math into fused multiply-adds
+        EXPECT_LE(std::abs(simd.position.x - scalar.position.x), 1);
+        EXPECT_LE(std::abs(simd.position.y - scalar.position.y), 1);
+        EXPECT_LE(std::abs(simd.position.z - scalar.position.z), 1);
+        EXPECT_LE(std::abs(simd.normal.x - scalar.normal.x), 1);
+        EXPECT_LE(std::abs(simd.normal.y - scalar.normal.y), 1);
+        EXPECT_LE(std::abs(simd.tangent.x - scalar.tangent.x), 1);
+        EXPECT_LE(std::abs(simd.tangent.y - scalar.tangent.y), 1);
+
+        EXPECT_EQ(simd.main_uv, scalar.main_uv);
+        EXPECT_EQ(simd.secondary_uv, scalar.secondary_uv);
+        EXPECT_EQ(simd.virtual_texture_id, scalar.virtual_texture_id);
+        EXPECT_EQ(simd.additional_data, scalar.additional_data);
+    }
+}
+
+TEST(VertexFormats, CompactVerticesDecodeToTheOriginalData) {
+    const std::vector<FullVertex> vertices = make_test_vertices(256);
+    const PositionQuantization quantization = {glm::vec3(0.0F), 16.0F};
+
+    std::vector<CompactVertex> compact_vertices(vertices.size());
+    convert_to_compact_vertices(vertices.data(), vertices.size(), quantization, compact_vertices.data());
+
+    // Half of a quantization step, plus a little bit for float error
+    const float max_position_error = quantization.size / 65535.0F * 0.5F + 1e-5F;
+    const float max_direction_error = 1e-3F;
+
+    for(size_t i = 0; i < vertices.size(); i++) {
+        const FullVertex& vertex = vertices[i];
+        const CompactVertex& compact_vertex = compact_vertices[i];
+
+        const glm::vec3 position = decode_position(compact_vertex.position, quantization);
+        EXPECT_NEAR(position.x, vertex.position.x, max_position_error);
+        EXPECT_NEAR(position.y, vertex.position.y, max_position_error);
+        EXPECT_NEAR(position.z, vertex.position.z, max_position_error);
+
+        const glm::vec3 normal = decode_octahedral(compact_vertex.normal);
+        EXPECT_NEAR(normal.x, vertex.normal.x, max_direction_error);
+        EXPECT_NEAR(normal.y, vertex.normal.y, max_direction_error);
+        EXPECT_NEAR(normal.z, vertex.normal.z, max_direction_error);
+
+        const glm::vec3 tangent = decode_octahedral(compact_vertex.tangent);
+        EXPECT_NEAR(tangent.x, vertex.tangent.x, max_direction_error);
+        EXPECT_NEAR(tangent.y, vertex.tangent.y, max_direction_error);
+        EXPECT_NEAR(tangent.z, vertex.tangent.z, max_direction_error);
+
+        EXPECT_EQ(compact_vertex.main_uv, vertex.main_uv);
+        EXPECT_EQ(compact_vertex.secondary_uv, vertex.secondary_uv);
+        EXPECT_EQ(compact_vertex.virtual_texture_id, vertex.virtual_texture_id);
+    }
+}
+
+TEST(VertexFormats, AxisAlignedNormalsSurviveEncoding) {
+    const std::vector<glm::vec3> axes = {glm::vec3(1, 0, 0),
+                                         glm::vec3(-1, 0, 0),
+                                         glm::vec3(0, 1, 0),
+                                         glm::vec3(0, -1, 0),
+                                         glm::vec3(0, 0, 1),
+                                         glm::vec3(0, 0, -1)};
+
+    for(const glm::vec3& axis : axes) {
+        const glm::vec3 decoded = decode_octahedral(encode_octahedral(axis));
+        EXPECT_NEAR(decoded.x, axis.x, 1e-4F);
+        EXPECT_NEAR(decoded.y, axis.y, 1e-4F);
+        EXPECT_NEAR(decoded.z, axis.z, 1e-4F);
+    }
+}
+
+TEST(VertexFormats, PositionsOutsideTheCubeAreClamped) {
+    FullVertex vertex = {};
+    vertex.position = glm::vec3(-4.0F, 20.0F, 8.0F);
+
+    CompactVertex compact_vertex;
+    convert_to_compact_vertices_scalar(&vertex, 1, {glm::vec3(0.0F), 16.0F}, &compact_vertex);
+
+    EXPECT_EQ(compact_vertex.position.x, 0);
+    EXPECT_EQ(compact_vertex.position.y, 65535);
+    EXPECT_EQ(compact_vertex.position.z, 32768);
+}
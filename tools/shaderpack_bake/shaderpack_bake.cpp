@@ -0,0 +1,99 @@
+/*!
+ * \brief Bakes a shaderpack folder or zip file into a shaderpack bundle, which Nova can load without parsing JSON or compiling shaders
+ *
+ * Usage: nova-shaderpack-bake <shaderpack folder or zip file> <bundle file>
+ *
+ * The bundle file's name must end with `.novapack`, because that's how Nova knows to load it as a bundle. Every pipeline variant that
+ * the shaderpack's materials use is compiled, including the ones that Nova would otherwise compile when they're first drawn. Bundles
+ * are for shipping, so every shader is optimized and has its debug info stripped, whatever Nova's settings are
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "../../src/loading/shaderpack/shader_optimizer.hpp"
+#include "../../src/loading/shaderpack/shaderpack_bundle.hpp"
+#include "../../src/loading/shaderpack/shaderpack_loading.hpp"
+#include "../../src/tasks/task_scheduler.hpp"
+#include "../../src/util/logger.hpp"
+
+namespace nova::renderer {
+    void set_up_logger() {
+        // The logger needs a handler for every level
+        auto& log = Logger::instance;
+        log.add_log_handler(TRACE, [](const std::string& /* msg */) {});
+        log.add_log_handler(DEBUG, [](const std::string& /* msg */) {});
+        log.add_log_handler(INFO, [](const std::string& msg) { std::cout << msg << std::endl; });
+        log.add_log_handler(WARN, [](const std::string& msg) { std::cerr << "WARN: " << msg << std::endl; });
+        log.add_log_handler(ERROR, [](const std::string& msg) { std::cerr << "ERROR: " << msg << std::endl; });
+        log.add_log_handler(FATAL, [](const std::string& msg) { std::cerr << "FATAL: " << msg << std::endl; });
+        log.add_log_handler(MAX_LEVEL, [](const std::string& msg) { std::cerr << "MAX_LEVEL: " << msg << std::endl; });
+    }
+
+    int main(const int argc, const char** argv) {
+        if(argc != 3) {
+            std::cerr << "Usage: " << argv[0] << " <shaderpack folder or zip file> <bundle file>" << std::endl;
+            return 1;
+        }
+
+        set_up_logger();
+
+        const fs::path shaderpack_path = argv[1];
+        const fs::path bundle_path = argv[2];
+        if(!shaderpack::is_shaderpack_bundle(bundle_path)) {
+            NOVA_LOG(ERROR) << "The bundle file's name must end with " << shaderpack::SHADERPACK_BUNDLE_EXTENSION;
+            return 1;
+        }
+
+        const auto start_time = std::chrono::high_resolution_clock::now();
+
+        const uint32_t num_cores = std::thread::hardware_concurrency();
+        ttl::task_scheduler scheduler(std::max(num_cores, 1U), ttl::empty_queue_behavior::SLEEP);
+        shaderpack::ShaderOptimizer optimizer(true, true);
+        shaderpack::ShaderpackData data = shaderpack::load_shaderpack_data(shaderpack_path, nullptr, &scheduler, &optimizer);
+        if(data.pipelines.empty()) {
+            NOVA_LOG(ERROR) << "Shaderpack " << shaderpack_path.string() << " has no pipelines to bake";
+            return 1;
+        }
+
+        // Nova can't compile shaders from a bundle, so the variants that would be compiled on first use are compiled now
+        uint32_t num_variants = 0;
+        for(shaderpack::PipelineCreateInfo& pipeline : data.pipelines) {
+            if(!pipeline.compile_on_first_use) {
+                continue;
+            }
+
+            std::optional<shaderpack::PipelineCreateInfo> compiled_variant = shaderpack::compile_pipeline_variant(shaderpack_path,
+                                                                                                                   pipeline,
+                                                                                                                   nullptr,
+                                                                                                                   &optimizer);
+            if(!compiled_variant) {
+                NOVA_LOG(ERROR) << "Could not compile pipeline variant " << pipeline.name;
+                return 1;
+            }
+
+            pipeline = std::move(*compiled_variant);
+            num_variants++;
+        }
+
+        if(!shaderpack::write_shaderpack_bundle(data, bundle_path)) {
+            return 1;
+        }
+
+        const std::chrono::duration<double, std::milli> bake_time = std::chrono::high_resolution_clock::now() - start_time;
+        NOVA_LOG(INFO) << "Baked " << data.passes.size() << " passes, " << data.pipelines.size() << " pipelines (" << num_variants
+                       << " of them variants), and " << data.materials.size() << " materials into " << bundle_path.string() << " ("
+                       << fs::file_size(bundle_path) << " bytes) in " << bake_time.count() << " ms";
+
+        const shaderpack::ShaderOptimizationStatistics optimization = optimizer.get_statistics();
+        NOVA_LOG(INFO) << "Optimized " << optimization.num_shaders << " shaders from " << optimization.num_instructions_before
+                       << " instructions (" << optimization.num_bytes_before << " bytes) to " << optimization.num_instructions_after
+                       << " instructions (" << optimization.num_bytes_after << " bytes)";
+
+        return 0;
+    }
+} // namespace nova::renderer
+
+int main(const int argc, const char** argv) { return nova::renderer::main(argc, argv); }